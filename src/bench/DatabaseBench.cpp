@@ -0,0 +1,353 @@
+// TodoDatabase micro/macro benchmarks. Every operation is timed per call at
+// several table sizes, on a file database and on :memory:, and the results
+// are printed as one JSON document so runs can be diffed between builds.
+//
+//   todo_bench [--sizes 1000,100000,1000000] [--backends file,memory]
+//              [--budget-ms 1000] [--max-iterations 10000] [--out report.json]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+#include "analytics/TodoAnalytics.h"
+#include "database/TodoDatabase.h"
+#include "io/TodoExporter.h"
+#include "search/TodoSearch.h"
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::vector<int> sizes = {1000, 100000, 1000000};
+    std::vector<std::string> backends = {"file", "memory"};
+    int budgetMs = 1000;
+    int maxIterations = 10000;
+    std::string outPath;
+};
+
+struct Result {
+    std::string backend;
+    int rows = 0;
+    std::string op;
+    int iterations = 0;
+    double opsPerSec = 0;
+    double rowsPerSec = 0;
+    double p50Us = 0;
+    double p99Us = 0;
+    double meanUs = 0;
+};
+
+const int CategoryCount = 20;
+
+std::string categoryName(int index) {
+    return "category-" + std::to_string(index);
+}
+
+Todo makeTodo(std::mt19937& rng, int n) {
+    std::uniform_int_distribution<int> category(0, CategoryCount - 1);
+    std::uniform_int_distribution<int> priority(1, 3);
+    std::uniform_int_distribution<int> coin(0, 3);
+
+    Todo todo("Benchmark todo " + std::to_string(n),
+              "Generated by todo_bench to exercise the database layer",
+              categoryName(category(rng)), priority(rng));
+    todo.setCompleted(coin(rng) == 0);
+    if (coin(rng) < 2) {
+        todo.setDueDate(std::time(nullptr) + (static_cast<int>(rng() % 60) - 20) * 86400);
+    }
+    return todo;
+}
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+// Runs body until the time budget or iteration cap is hit. body returns the
+// number of rows it touched so reads can report rows/s as well as calls/s.
+Result measure(const Options& options, const std::string& backend, int rows,
+               const std::string& op, int maxIterations, const std::function<size_t(int)>& body) {
+    std::vector<double> samples;
+    size_t rowsTouched = 0;
+    auto deadline = Clock::now() + std::chrono::milliseconds(options.budgetMs);
+    auto started = Clock::now();
+
+    for (int i = 0; i < maxIterations; i++) {
+        auto begin = Clock::now();
+        rowsTouched += body(i);
+        auto end = Clock::now();
+        samples.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+        if (end >= deadline) break;
+    }
+
+    double elapsedSec = std::chrono::duration<double>(Clock::now() - started).count();
+
+    Result result;
+    result.backend = backend;
+    result.rows = rows;
+    result.op = op;
+    result.iterations = static_cast<int>(samples.size());
+    result.opsPerSec = elapsedSec > 0 ? samples.size() / elapsedSec : 0;
+    result.rowsPerSec = elapsedSec > 0 ? rowsTouched / elapsedSec : 0;
+
+    double sum = 0;
+    for (double s : samples) sum += s;
+    result.meanUs = samples.empty() ? 0 : sum / samples.size();
+    result.p50Us = percentile(samples, 0.50);
+    result.p99Us = percentile(samples, 0.99);
+
+    std::cerr << backend << " " << rows << " " << op << ": " << result.iterations
+              << " iterations, p50 " << result.p50Us << " us" << std::endl;
+    return result;
+}
+
+void seed(TodoDatabase& db, std::mt19937& rng, int rows) {
+    const int batch = 50000;
+    for (int done = 0; done < rows;) {
+        db.beginTransaction();
+        int end = std::min(rows, done + batch);
+        for (; done < end; done++) {
+            Todo todo = makeTodo(rng, done);
+            db.createTodo(todo);
+        }
+        db.commitTransaction();
+    }
+}
+
+void runSuite(const Options& options, const std::string& backend, int rows,
+              std::vector<Result>& results) {
+    std::string path = ":memory:";
+    if (backend == "file") {
+        path = (std::filesystem::temp_directory_path() /
+                ("todo_bench_" + std::to_string(rows) + ".db")).string();
+        std::filesystem::remove(path);
+    }
+
+    {
+        TodoDatabase db(path);
+        if (!db.isOpen() || !db.initialize()) {
+            std::cerr << "Could not open " << path << std::endl;
+            return;
+        }
+
+        std::mt19937 rng(42);
+        std::uniform_int_distribution<int> anyId(1, rows);
+        std::uniform_int_distribution<int> anyCategory(0, CategoryCount - 1);
+
+        auto seedStart = Clock::now();
+        seed(db, rng, rows);
+        double seedSec = std::chrono::duration<double>(Clock::now() - seedStart).count();
+
+        Result seeded;
+        seeded.backend = backend;
+        seeded.rows = rows;
+        seeded.op = "seed_batched";
+        seeded.iterations = 1;
+        seeded.rowsPerSec = seedSec > 0 ? rows / seedSec : 0;
+        seeded.opsPerSec = seeded.rowsPerSec;
+        results.push_back(seeded);
+
+        // Full scans get few iterations at large sizes; the budget stops them early
+        int scanIterations = std::max(3, options.maxIterations / std::max(1, rows / 100));
+
+        results.push_back(measure(options, backend, rows, "get_all", scanIterations, [&](int) {
+            return db.getAllTodos().size();
+        }));
+        results.push_back(measure(options, backend, rows, "by_category", scanIterations, [&](int) {
+            return db.getTodosByCategory(categoryName(anyCategory(rng))).size();
+        }));
+        results.push_back(measure(options, backend, rows, "by_id", options.maxIterations, [&](int) {
+            return db.getTodoById(anyId(rng)) ? size_t(1) : size_t(0);
+        }));
+        results.push_back(measure(options, backend, rows, "page", options.maxIterations, [&](int) {
+            return db.getTodosPage(std::nullopt, 100).size();
+        }));
+        results.push_back(measure(options, backend, rows, "categories", scanIterations, [&](int) {
+            return db.getAllCategories().size();
+        }));
+        results.push_back(measure(options, backend, rows, "category_counts", scanIterations, [&](int) {
+            return db.getCategoryCounts().size();
+        }));
+        results.push_back(measure(options, backend, rows, "counts", scanIterations, [&](int) {
+            db.getTodoCounts();
+            return size_t(rows);
+        }));
+        // What a calendar loads for one week row: up to 4 todos per day, and
+        // the day's count once that is full
+        results.push_back(measure(options, backend, rows, "due_week", options.maxIterations, [&](int i) {
+            int64_t monday = TodoAnalytics::bucketStart(TodoAnalytics::today(), AnalyticsBucket::Week) +
+                             7 * (i % 8 - 3);
+            size_t loaded = 0;
+            for (int day = 0; day < 7; day++) {
+                time_t start = TodoAnalytics::startOfDay(monday + day);
+                time_t end = TodoAnalytics::startOfDay(monday + day + 1);
+                std::vector<Todo> todos = db.getTodosDueBetween(start, end, 4);
+                loaded += todos.size() == 4 ? db.countTodosDueBetween(start, end) : todos.size();
+            }
+            return loaded;
+        }));
+        // A board column scrolled to a random spot: seek the cursor in the
+        // index, then one page of cards after it
+        results.push_back(measure(options, backend, rows, "board_jump", options.maxIterations, [&](int) {
+            std::string category = categoryName(anyCategory(rng));
+            int offset = std::uniform_int_distribution<int>(0, std::max(0, rows / CategoryCount - 1))(rng);
+            auto cursor = db.getPageCursorAt(offset, category);
+            return db.getTodosPage(cursor, 50, category).size();
+        }));
+        // One keystroke of search as you type: apply the query (narrowing
+        // from the previous one where it can) and scan one slice
+        TodoSearch search(db);
+        const std::string typed = "todo 4242";
+        results.push_back(measure(options, backend, rows, "search_keystroke", options.maxIterations, [&](int i) {
+            size_t length = i % typed.size() + 1;
+            search.setQuery(typed.substr(0, length));
+            search.step();
+            return search.matches().size();
+        }));
+        results.push_back(measure(options, backend, rows, "report_year", scanIterations, [&](int) {
+            TodoAnalytics analytics(db);
+            int64_t today = TodoAnalytics::today();
+            auto report = analytics.report(today - 364, today, AnalyticsBucket::Week);
+            return report ? size_t(report->total.completed) : size_t(0);
+        }));
+
+        // Exports write to /dev/null so the numbers are formatting plus cursor cost
+        const std::pair<const char*, ExportFormat> exports[] = {
+            {"export_csv", ExportFormat::Csv},
+            {"export_jsonl", ExportFormat::JsonLines},
+            {"export_ical", ExportFormat::ICalendar},
+        };
+        for (const auto& [op, format] : exports) {
+            ExportOptions exportOptions;
+            exportOptions.format = format;
+            results.push_back(measure(options, backend, rows, op, scanIterations, [&](int) {
+                return TodoExporter(db).exportToFile("/dev/null", exportOptions).rowsExported;
+            }));
+        }
+
+        // Writes run in autocommit mode, one transaction per call, like the app
+        results.push_back(measure(options, backend, rows, "create", options.maxIterations, [&](int i) {
+            Todo todo = makeTodo(rng, rows + i);
+            return db.createTodo(todo) ? size_t(1) : size_t(0);
+        }));
+        results.push_back(measure(options, backend, rows, "update", options.maxIterations, [&](int) {
+            auto todo = db.getTodoById(anyId(rng));
+            if (!todo) return size_t(0);
+            todo->setCompleted(!todo->isCompleted());
+            return db.updateTodo(*todo) ? size_t(1) : size_t(0);
+        }));
+        // A multi-select action on up to 10k rows, one transaction
+        int selected = std::min(rows, 10000);
+        results.push_back(measure(options, backend, rows, "bulk_update", scanIterations, [&](int i) {
+            std::vector<int> ids;
+            ids.reserve(selected);
+            for (int n = 0; n < selected; n++) ids.push_back(anyId(rng));
+            TodoBulkChange change;
+            change.completed = i % 2 == 0;
+            return static_cast<size_t>(std::max(0, db.updateTodos(ids, change)));
+        }));
+        results.push_back(measure(options, backend, rows, "delete", options.maxIterations, [&](int) {
+            return db.deleteTodo(anyId(rng)) ? size_t(1) : size_t(0);
+        }));
+    }
+
+    if (backend == "file") {
+        std::filesystem::remove(path);
+    }
+}
+
+std::vector<std::string> split(const std::string& text) {
+    std::vector<std::string> parts;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty()) parts.push_back(part);
+    }
+    return parts;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--sizes") {
+            options.sizes.clear();
+            for (const auto& size : split(value)) options.sizes.push_back(std::stoi(size));
+        } else if (arg == "--backends") {
+            options.backends = split(value);
+        } else if (arg == "--budget-ms") {
+            options.budgetMs = std::stoi(value);
+        } else if (arg == "--max-iterations") {
+            options.maxIterations = std::stoi(value);
+        } else if (arg == "--out") {
+            options.outPath = value;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+void writeReport(std::ostream& out, const std::vector<Result>& results) {
+    out << "{\n";
+    out << "  \"benchmark\": \"database\",\n";
+    out << "  \"sqlite_version\": \"" << sqlite3_libversion() << "\",\n";
+    out << "  \"timestamp\": " << std::time(nullptr) << ",\n";
+    out << "  \"results\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        const Result& r = results[i];
+        out << "    {\"backend\": \"" << r.backend << "\", \"rows\": " << r.rows
+            << ", \"op\": \"" << r.op << "\", \"iterations\": " << r.iterations
+            << ", \"ops_per_sec\": " << r.opsPerSec << ", \"rows_per_sec\": " << r.rowsPerSec
+            << ", \"p50_us\": " << r.p50Us << ", \"p99_us\": " << r.p99Us
+            << ", \"mean_us\": " << r.meanUs << "}" << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}" << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: todo_bench [--sizes 1000,100000,1000000] [--backends file,memory]"
+                     " [--budget-ms 1000] [--max-iterations 10000] [--out report.json]" << std::endl;
+        return 1;
+    }
+
+    std::vector<Result> results;
+    for (const auto& backend : options.backends) {
+        for (int rows : options.sizes) {
+            runSuite(options, backend, rows, results);
+        }
+    }
+
+    if (options.outPath.empty()) {
+        writeReport(std::cout, results);
+    } else {
+        std::ofstream out(options.outPath);
+        writeReport(out, results);
+    }
+
+    return 0;
+}
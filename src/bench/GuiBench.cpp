@@ -0,0 +1,448 @@
+// Headless GUI benchmarks. Runs on the offscreen platform unless
+// QT_QPA_PLATFORM is already set, and prints one JSON report to stdout.
+//
+//   todo_gui_bench [--iterations 20] [--sizes 1000,10000,100000]
+//                  [--scroll-frames 2000] [--out report.json]
+//
+// "style" compares per-widget and application style sheets. "window" runs
+// MainWindow against generated databases of each size and times first
+// paint, refreshTodoList, category switches, checkbox toggles and a full
+// scroll through TodoItemDelegate. Interaction timings include the
+// synchronous repaint of the list viewport that follows them.
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QScrollBar>
+#include <QTemporaryDir>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "MainWindow.h"
+#include "AddTodoDialog.h"
+#include "EditTodoDialog.h"
+#include "Theme.h"
+#include "database/TodoDatabase.h"
+
+// Reaches into MainWindow (friend) so the bench can call the same private
+// paths the UI does instead of synthesizing mouse events
+class MainWindowProbe {
+public:
+    explicit MainWindowProbe(MainWindow& window) : window(window) {}
+
+    QTreeView* list() const { return window.todoList; }
+    TodoListModel* model() const { return window.todoModel; }
+    TodoItemDelegate* delegate() const { return window.todoDelegate; }
+    QComboBox* categoryFilter() const { return window.categoryFilter; }
+
+    void refresh() { window.refreshTodoList(); }
+    void repaintList() { window.todoList->viewport()->repaint(); }
+
+private:
+    MainWindow& window;
+};
+
+namespace {
+
+struct Timing {
+    double medianMs = 0;
+    double minMs = 0;
+    double maxMs = 0;
+};
+
+struct Options {
+    int iterations = 20;
+    std::vector<int> sizes = {1000, 10000, 100000};
+    int scrollFrames = 2000;
+    std::string outPath;
+};
+
+struct ScrollResult {
+    int frames = 0;
+    int rowsLoaded = 0;
+    bool reachedEnd = false;
+    double totalMs = 0;
+    double medianFrameMs = 0;
+    double p99FrameMs = 0;
+    double maxFrameMs = 0;
+    int cacheHits = 0;
+    int cacheMisses = 0;
+    int residentPages = 0;
+};
+
+struct WindowResult {
+    int rows = 0;
+    Timing firstPaint;
+    Timing refresh;
+    Timing categorySwitch;
+    Timing checkboxToggle;
+    ScrollResult scroll;
+};
+
+Timing summarize(std::vector<double> samples) {
+    std::sort(samples.begin(), samples.end());
+    Timing timing;
+    if (samples.empty()) return timing;
+    timing.medianMs = samples[samples.size() / 2];
+    timing.minMs = samples.front();
+    timing.maxMs = samples.back();
+    return timing;
+}
+
+// First run is a warm-up (font database, plugin loading) and is discarded
+Timing measure(int iterations, const std::function<void()>& body) {
+    body();
+
+    std::vector<double> samples;
+    samples.reserve(iterations);
+    for (int i = 0; i < iterations; i++) {
+        QElapsedTimer timer;
+        timer.start();
+        body();
+        samples.push_back(timer.nsecsElapsed() / 1e6);
+    }
+    return summarize(samples);
+}
+
+void printTiming(std::ostream& out, const char* indent, const char* name, const Timing& timing,
+                 bool last = false) {
+    out << indent << "\"" << name << "\": {\"median_ms\": " << timing.medianMs
+        << ", \"min_ms\": " << timing.minMs
+        << ", \"max_ms\": " << timing.maxMs << "}" << (last ? "\n" : ",\n");
+}
+
+// Deterministic data with a realistic mix of categories, due dates and
+// completed rows, seeded in large transactions
+void seedDatabase(const std::string& path, int rows) {
+    TodoDatabase db(path);
+    db.initialize();
+
+    const char* categories[] = {"work", "home", "errands", "health", "finance", "garden",
+                                "reading", "travel", "music", "car", "kids", "admin"};
+    std::mt19937 rng(7);
+    time_t now = std::time(nullptr);
+
+    db.beginTransaction();
+    for (int i = 0; i < rows; i++) {
+        Todo todo("Todo " + std::to_string(i),
+                  i % 3 == 0 ? "" : "Some notes about todo " + std::to_string(i),
+                  categories[rng() % 12], 1 + static_cast<int>(rng() % 3));
+        todo.setCompleted(rng() % 5 == 0);
+        if (rng() % 2 == 0) {
+            todo.setDueDate(now + (static_cast<int>(rng() % 60) - 20) * 86400);
+        }
+        db.createTodo(todo);
+
+        if (i % 50000 == 49999) {
+            db.commitTransaction();
+            db.beginTransaction();
+        }
+    }
+    db.commitTransaction();
+}
+
+// Show and flush paint events so polish and first paint are included
+void present(QWidget& widget) {
+    widget.show();
+    QApplication::processEvents();
+    widget.close();
+}
+
+// Flags the first paint event reaching the list viewport
+class FirstPaintWatcher : public QObject {
+public:
+    bool painted = false;
+
+protected:
+    bool eventFilter(QObject* object, QEvent* event) override {
+        if (event->type() == QEvent::Paint) painted = true;
+        return QObject::eventFilter(object, event);
+    }
+};
+
+Timing measureFirstPaint(int iterations, const std::string& dbPath) {
+    auto once = [&]() {
+        QElapsedTimer timer;
+        timer.start();
+
+        MainWindow window(dbPath);
+        MainWindowProbe probe(window);
+        FirstPaintWatcher watcher;
+        probe.list()->viewport()->installEventFilter(&watcher);
+
+        window.show();
+        while (!watcher.painted && timer.elapsed() < 10000) {
+            QApplication::processEvents();
+        }
+        double ms = timer.nsecsElapsed() / 1e6;
+        window.close();
+        return ms;
+    };
+
+    once();
+    std::vector<double> samples;
+    for (int i = 0; i < iterations; i++) {
+        samples.push_back(once());
+    }
+    return summarize(samples);
+}
+
+// Pages down from the top until the model has no more rows to fetch (or the
+// frame cap is hit), repainting synchronously after every step
+ScrollResult measureScroll(MainWindowProbe& probe, int maxFrames) {
+    QScrollBar* bar = probe.list()->verticalScrollBar();
+    TodoItemDelegate* delegate = probe.delegate();
+
+    bar->setValue(0);
+    delegate->clearCache();
+    QApplication::processEvents();
+    probe.repaintList();
+
+    int hitsBefore = delegate->cacheHits();
+    int missesBefore = delegate->cacheMisses();
+
+    ScrollResult result;
+    std::vector<double> frames;
+    QElapsedTimer total;
+    total.start();
+
+    while (static_cast<int>(frames.size()) < maxFrames) {
+        QElapsedTimer frame;
+        frame.start();
+        bar->setValue(bar->value() + bar->pageStep());
+        QApplication::processEvents();
+        probe.repaintList();
+        frames.push_back(frame.nsecsElapsed() / 1e6);
+
+        if (bar->value() >= bar->maximum() && !probe.model()->canFetchMore(QModelIndex())) {
+            result.reachedEnd = true;
+            break;
+        }
+    }
+
+    result.totalMs = total.nsecsElapsed() / 1e6;
+    result.frames = static_cast<int>(frames.size());
+    result.rowsLoaded = probe.model()->rowCount();
+    result.cacheHits = delegate->cacheHits() - hitsBefore;
+    result.cacheMisses = delegate->cacheMisses() - missesBefore;
+    result.residentPages = probe.model()->residentPageCount();
+
+    if (!frames.empty()) {
+        std::sort(frames.begin(), frames.end());
+        result.medianFrameMs = frames[frames.size() / 2];
+        result.p99FrameMs = frames[static_cast<size_t>((frames.size() - 1) * 0.99)];
+        result.maxFrameMs = frames.back();
+    }
+    return result;
+}
+
+WindowResult runWindowSuite(const Options& options, const std::string& dbPath, int rows) {
+    WindowResult result;
+    result.rows = rows;
+    result.firstPaint = measureFirstPaint(options.iterations, dbPath);
+
+    MainWindow window(dbPath);
+    MainWindowProbe probe(window);
+    window.show();
+    QApplication::processEvents();
+
+    result.refresh = measure(options.iterations, [&]() {
+        probe.refresh();
+        QApplication::processEvents();
+        probe.repaintList();
+    });
+
+    QComboBox* filter = probe.categoryFilter();
+    int switches = 0;
+    result.categorySwitch = measure(options.iterations, [&]() {
+        // Cycle through "All" and every category
+        filter->setCurrentIndex(switches++ % std::max(1, filter->count()));
+        QApplication::processEvents();
+        probe.repaintList();
+    });
+    filter->setCurrentIndex(0);
+    QApplication::processEvents();
+
+    result.checkboxToggle = measure(options.iterations, [&]() {
+        QModelIndex first = probe.model()->index(0, 0);
+        if (!first.isValid()) return;
+        emit probe.delegate()->checkboxClicked(first);
+        QApplication::processEvents();  // Runs the deferred refresh
+        probe.repaintList();
+    });
+
+    result.scroll = measureScroll(probe, options.scrollFrames);
+
+    window.close();
+    return result;
+}
+
+std::vector<int> parseSizes(const std::string& text) {
+    std::vector<int> sizes;
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (!part.empty()) sizes.push_back(std::atoi(part.c_str()));
+    }
+    return sizes;
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--iterations") {
+            options.iterations = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--sizes") {
+            options.sizes = parseSizes(value);
+        } else if (arg == "--scroll-frames") {
+            options.scrollFrames = std::max(1, std::atoi(value.c_str()));
+        } else if (arg == "--out") {
+            options.outPath = value;
+        } else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    if (!qEnvironmentVariableIsSet("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+
+    QApplication app(argc, argv);
+
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: todo_gui_bench [--iterations 20] [--sizes 1000,10000,100000]"
+                     " [--scroll-frames 2000] [--out report.json]" << std::endl;
+        return 1;
+    }
+    int iterations = options.iterations;
+
+    QTemporaryDir dir;
+    std::string dbPath = dir.filePath("bench.db").toStdString();
+    seedDatabase(dbPath, 200);
+
+    TodoDatabase db(dbPath);
+    db.initialize();
+    auto existing = db.getTodoById(1);
+    Todo editTarget = existing ? *existing : Todo("Edit me");
+    CategoryModel categories;
+    categories.load(db);
+
+    Theme::Variant variant = Theme::variantFromEnvironment();
+    QString sheet = Theme::styleSheet(variant);
+
+    // Baseline: every window and dialog carries its own copy of the sheet,
+    // which Qt parses and applies on each construction
+    Timing perWidgetStartup = measure(iterations, [&]() {
+        MainWindow window(dbPath);
+        window.setStyleSheet(sheet);
+        present(window);
+    });
+    Timing perWidgetAdd = measure(iterations, [&]() {
+        AddTodoDialog dialog(categories);
+        dialog.setStyleSheet(sheet);
+        present(dialog);
+    });
+    Timing perWidgetEdit = measure(iterations, [&]() {
+        EditTodoDialog dialog(editTarget, categories);
+        dialog.setStyleSheet(sheet);
+        present(dialog);
+    });
+
+    // Current: one application sheet, applied once
+    QElapsedTimer applyTimer;
+    applyTimer.start();
+    Theme::apply(app, variant);
+    double applyMs = applyTimer.nsecsElapsed() / 1e6;
+
+    Timing appStartup = measure(iterations, [&]() {
+        MainWindow window(dbPath);
+        present(window);
+    });
+    Timing appAdd = measure(iterations, [&]() {
+        AddTodoDialog dialog(categories);
+        present(dialog);
+    });
+    Timing appEdit = measure(iterations, [&]() {
+        EditTodoDialog dialog(editTarget, categories);
+        present(dialog);
+    });
+
+    // MainWindow against generated databases, one file per size
+    std::vector<WindowResult> windows;
+    for (int rows : options.sizes) {
+        std::string path = dir.filePath(QString("window_%1.db").arg(rows)).toStdString();
+        seedDatabase(path, rows);
+        std::cerr << "window suite: " << rows << " rows" << std::endl;
+        windows.push_back(runWindowSuite(options, path, rows));
+    }
+
+    std::ofstream file;
+    if (!options.outPath.empty()) {
+        file.open(options.outPath);
+    }
+    std::ostream& out = options.outPath.empty() ? std::cout : file;
+
+    out << "{\n";
+    out << "  \"benchmark\": \"gui\",\n";
+    out << "  \"variant\": \"" << (variant == Theme::Variant::Dark ? "dark" : "light") << "\",\n";
+    out << "  \"iterations\": " << iterations << ",\n";
+    out << "  \"style\": {\n";
+    out << "    \"app_sheet_apply_ms\": " << applyMs << ",\n";
+    out << "    \"per_widget_sheet\": {\n";
+    printTiming(out, "      ", "startup", perWidgetStartup);
+    printTiming(out, "      ", "add_dialog_open", perWidgetAdd);
+    printTiming(out, "      ", "edit_dialog_open", perWidgetEdit, true);
+    out << "    },\n";
+    out << "    \"app_sheet\": {\n";
+    printTiming(out, "      ", "startup", appStartup);
+    printTiming(out, "      ", "add_dialog_open", appAdd);
+    printTiming(out, "      ", "edit_dialog_open", appEdit, true);
+    out << "    },\n";
+    out << "    \"saved_ms\": {\"startup\": " << perWidgetStartup.medianMs - appStartup.medianMs
+        << ", \"add_dialog_open\": " << perWidgetAdd.medianMs - appAdd.medianMs
+        << ", \"edit_dialog_open\": " << perWidgetEdit.medianMs - appEdit.medianMs << "}\n";
+    out << "  },\n";
+    out << "  \"window\": [\n";
+    for (size_t i = 0; i < windows.size(); i++) {
+        const WindowResult& w = windows[i];
+        out << "    {\n";
+        out << "      \"rows\": " << w.rows << ",\n";
+        printTiming(out, "      ", "startup_to_first_paint", w.firstPaint);
+        printTiming(out, "      ", "refresh_todo_list", w.refresh);
+        printTiming(out, "      ", "category_switch", w.categorySwitch);
+        printTiming(out, "      ", "checkbox_toggle", w.checkboxToggle);
+        out << "      \"scroll\": {\"frames\": " << w.scroll.frames
+            << ", \"rows_loaded\": " << w.scroll.rowsLoaded
+            << ", \"reached_end\": " << (w.scroll.reachedEnd ? "true" : "false")
+            << ", \"total_ms\": " << w.scroll.totalMs
+            << ", \"median_frame_ms\": " << w.scroll.medianFrameMs
+            << ", \"p99_frame_ms\": " << w.scroll.p99FrameMs
+            << ", \"max_frame_ms\": " << w.scroll.maxFrameMs
+            << ", \"cache_hits\": " << w.scroll.cacheHits
+            << ", \"cache_misses\": " << w.scroll.cacheMisses
+            << ", \"resident_pages\": " << w.scroll.residentPages << "}\n";
+        out << "    }" << (i + 1 < windows.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n";
+    out << "}" << std::endl;
+
+    return 0;
+}
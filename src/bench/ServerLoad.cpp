@@ -0,0 +1,400 @@
+// Closed-loop load generator for todo_server. Each connection is kept alive
+// and sends its next request as soon as the previous response arrives; all
+// of them run on one epoll thread. Reports requests/s and latency
+// percentiles per request kind.
+//
+//   todo_load [--host 127.0.0.1] [--port 8080] [--connections 32]
+//             [--seconds 10] [--warmup 1] [--workload read|mixed|write]
+//             [--seed 1] [--out report.json]
+//
+// On a machine with few cores the client competes with the server for CPU;
+// compare runs made on the same machine only.
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct Options {
+    std::string host = "127.0.0.1";
+    int port = 8080;
+    int connections = 32;
+    double seconds = 10;
+    double warmup = 1;
+    std::string workload = "read";
+    unsigned seed = 1;
+    std::string outPath;
+};
+
+struct Request {
+    std::string kind;
+    std::string text;
+};
+
+struct Connection {
+    int fd = -1;
+    std::string kind;
+    std::string out;
+    size_t outOffset = 0;
+    std::string in;
+    Clock::time_point sentAt;
+};
+
+struct KindStats {
+    std::vector<double> latenciesMs;
+    size_t errors = 0;
+};
+
+double percentile(std::vector<double>& samples, double p) {
+    if (samples.empty()) return 0;
+    size_t index = static_cast<size_t>(p * (samples.size() - 1) + 0.5);
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index];
+}
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) return false;
+        std::string value = argv[++i];
+
+        if (arg == "--host") options.host = value;
+        else if (arg == "--port") options.port = std::atoi(value.c_str());
+        else if (arg == "--connections") options.connections = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--seconds") options.seconds = std::atof(value.c_str());
+        else if (arg == "--warmup") options.warmup = std::atof(value.c_str());
+        else if (arg == "--workload") options.workload = value;
+        else if (arg == "--seed") options.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--out") options.outPath = value;
+        else return false;
+    }
+    return options.workload == "read" || options.workload == "mixed" || options.workload == "write";
+}
+
+int connectTo(const Options& options, bool blocking) {
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC | (blocking ? 0 : SOCK_NONBLOCK), 0);
+    if (fd < 0) return -1;
+
+    int enable = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(options.port));
+    ::inet_pton(AF_INET, options.host.c_str(), &address.sin_addr);
+
+    if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 && errno != EINPROGRESS) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Length of a complete response at the start of buffer, 0 if incomplete
+size_t responseLength(const std::string& buffer, int& status) {
+    size_t headerEnd = buffer.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) return 0;
+
+    status = std::atoi(buffer.c_str() + 9);  // "HTTP/1.1 200"
+    size_t contentLength = 0;
+    size_t pos = buffer.find("Content-Length:");
+    if (pos != std::string::npos && pos < headerEnd) {
+        contentLength = std::strtoul(buffer.c_str() + pos + 15, nullptr, 10);
+    }
+
+    size_t total = headerEnd + 4 + contentLength;
+    return buffer.size() >= total ? total : 0;
+}
+
+// Blocking GET used once before the run, to size the id range
+std::string fetch(const Options& options, const std::string& path) {
+    int fd = connectTo(options, true);
+    if (fd < 0) return "";
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: localhost\r\nConnection: close\r\n\r\n";
+    ::send(fd, request.data(), request.size(), MSG_NOSIGNAL);
+
+    std::string response;
+    char buffer[4096];
+    ssize_t count;
+    while ((count = ::recv(fd, buffer, sizeof(buffer), 0)) > 0) {
+        response.append(buffer, static_cast<size_t>(count));
+    }
+    ::close(fd);
+
+    size_t body = response.find("\r\n\r\n");
+    return body == std::string::npos ? "" : response.substr(body + 4);
+}
+
+class RequestMix {
+public:
+    RequestMix(const std::string& workload, int maxId, unsigned seed)
+        : workload(workload), maxId(std::max(1, maxId)), rng(seed) {}
+
+    Request next() {
+        int roll = static_cast<int>(rng() % 100);
+        if (workload == "read") {
+            if (roll < 70) return getById();
+            if (roll < 90) return page();
+            return search();
+        }
+        if (workload == "mixed") {
+            if (roll < 55) return getById();
+            if (roll < 70) return page();
+            if (roll < 80) return search();
+            if (roll < 95) return update();
+            return create();
+        }
+        return roll < 50 ? update() : create();
+    }
+
+private:
+    std::string workload;
+    int maxId;
+    std::mt19937 rng;
+    int created = 0;
+
+    int anyId() { return 1 + static_cast<int>(rng() % maxId); }
+
+    static std::string get(const std::string& path) {
+        return "GET " + path + " HTTP/1.1\r\nHost: localhost\r\n\r\n";
+    }
+
+    static std::string withBody(const std::string& method, const std::string& path, const std::string& body) {
+        return method + " " + path + " HTTP/1.1\r\nHost: localhost\r\nContent-Type: application/json\r\n"
+               "Content-Length: " + std::to_string(body.size()) + "\r\n\r\n" + body;
+    }
+
+    Request getById() { return {"get", get("/todos/" + std::to_string(anyId()))}; }
+    Request page() { return {"page", get("/todos?limit=50")}; }
+
+    Request search() {
+        // Words from todo_gen's vocabulary; a term that matches nothing scans the whole table
+        static const char* words[] = {"report", "invoice", "slides", "budget", "groceries", "taxes"};
+        return {"search", get(std::string("/search?limit=20&q=") + words[rng() % 6])};
+    }
+
+    Request update() {
+        std::string body = std::string("{\"completed\":") + (rng() % 2 ? "true" : "false") + "}";
+        return {"update", withBody("PUT", "/todos/" + std::to_string(anyId()), body)};
+    }
+
+    Request create() {
+        std::string body = "{\"title\":\"Load test " + std::to_string(++created) +
+                           "\",\"category\":\"load\",\"priority\":" + std::to_string(1 + rng() % 3) + "}";
+        return {"create", withBody("POST", "/todos", body)};
+    }
+};
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: todo_load [--host ADDRESS] [--port N] [--connections N] [--seconds S]\n"
+                     "                 [--warmup S] [--workload read|mixed|write] [--seed N] [--out FILE]\n";
+        return 2;
+    }
+
+    // Ids are AUTOINCREMENT, so the row count is a fair upper bound
+    std::string stats = fetch(options, "/stats");
+    if (stats.empty()) {
+        std::cerr << "todo_load: no server at " << options.host << ":" << options.port << std::endl;
+        return 1;
+    }
+    int maxId = 1;
+    size_t totalPos = stats.find("\"total\":");
+    if (totalPos != std::string::npos) maxId = std::atoi(stats.c_str() + totalPos + 8);
+
+    RequestMix mix(options.workload, maxId, options.seed);
+    std::map<std::string, KindStats> results;
+    size_t connectErrors = 0;
+
+    int epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    std::vector<Connection> connections(options.connections);
+
+    auto sendNext = [&](Connection& connection) {
+        Request request = mix.next();
+        connection.kind = request.kind;
+        connection.out = std::move(request.text);
+        connection.outOffset = 0;
+        connection.sentAt = Clock::now();
+
+        ssize_t count = ::send(connection.fd, connection.out.data(), connection.out.size(), MSG_NOSIGNAL);
+        if (count > 0) connection.outOffset = static_cast<size_t>(count);
+
+        epoll_event event = {};
+        bool pending = connection.outOffset < connection.out.size();
+        event.events = EPOLLIN | (pending ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+        event.data.u32 = static_cast<uint32_t>(&connection - connections.data());
+        ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+    };
+
+    auto open = [&](Connection& connection) {
+        connection.fd = connectTo(options, false);
+        connection.in.clear();
+        if (connection.fd < 0) {
+            connectErrors++;
+            return false;
+        }
+        epoll_event event = {};
+        event.events = EPOLLOUT;
+        event.data.u32 = static_cast<uint32_t>(&connection - connections.data());
+        ::epoll_ctl(epollFd, EPOLL_CTL_ADD, connection.fd, &event);
+        sendNext(connection);
+        return true;
+    };
+
+    auto reopen = [&](Connection& connection) {
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+        ::close(connection.fd);
+        return open(connection);
+    };
+
+    for (Connection& connection : connections) {
+        if (!open(connection)) {
+            std::cerr << "todo_load: connect failed: " << std::strerror(errno) << std::endl;
+            return 1;
+        }
+    }
+
+    Clock::time_point start = Clock::now();
+    Clock::time_point measureFrom = start + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.warmup));
+    Clock::time_point end = measureFrom + std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(options.seconds));
+
+    epoll_event events[256];
+    char buffer[64 * 1024];
+
+    while (Clock::now() < end) {
+        int count = ::epoll_wait(epollFd, events, 256, 100);
+        for (int i = 0; i < count; i++) {
+            Connection& connection = connections[events[i].data.u32];
+
+            if (events[i].events & EPOLLOUT && connection.outOffset < connection.out.size()) {
+                ssize_t sent = ::send(connection.fd, connection.out.data() + connection.outOffset,
+                                      connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+                if (sent > 0) connection.outOffset += static_cast<size_t>(sent);
+                if (connection.outOffset == connection.out.size()) {
+                    epoll_event event = {};
+                    event.events = EPOLLIN;
+                    event.data.u32 = events[i].data.u32;
+                    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+                }
+            }
+            if (!(events[i].events & (EPOLLIN | EPOLLERR | EPOLLHUP))) continue;
+
+            bool closed = false;
+            while (true) {
+                ssize_t received = ::recv(connection.fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.in.append(buffer, static_cast<size_t>(received));
+                    continue;
+                }
+                if (received < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+                if (received < 0 && errno == EINTR) continue;
+                closed = true;
+                break;
+            }
+
+            int status = 0;
+            size_t length = responseLength(connection.in, status);
+            if (length > 0) {
+                Clock::time_point now = Clock::now();
+                if (now >= measureFrom) {
+                    KindStats& kind = results[connection.kind];
+                    if (status >= 200 && status < 300) {
+                        kind.latenciesMs.push_back(
+                            std::chrono::duration<double, std::milli>(now - connection.sentAt).count());
+                    } else {
+                        kind.errors++;
+                    }
+                }
+                connection.in.erase(0, length);
+                if (!closed) {
+                    sendNext(connection);
+                    continue;
+                }
+            } else if (!closed) {
+                continue;
+            } else if (Clock::now() >= measureFrom) {
+                results[connection.kind].errors++;  // Dropped mid-response
+            }
+
+            if (!reopen(connection) && Clock::now() >= end) break;
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(Clock::now() - measureFrom).count();
+
+    for (Connection& connection : connections) {
+        if (connection.fd >= 0) ::close(connection.fd);
+    }
+    ::close(epollFd);
+
+    // Overall plus one row per request kind
+    std::vector<double> all;
+    size_t allErrors = 0;
+    for (auto& [kind, stats] : results) {
+        all.insert(all.end(), stats.latenciesMs.begin(), stats.latenciesMs.end());
+        allErrors += stats.errors;
+    }
+    results["all"] = KindStats{all, allErrors + connectErrors};
+
+    std::ostringstream json;
+    json << std::fixed << std::setprecision(3);
+    json << "{\n  \"workload\": \"" << options.workload << "\", \"connections\": " << options.connections
+         << ", \"seconds\": " << seconds << ",\n  \"results\": [\n";
+
+    std::cerr << std::fixed << std::setprecision(3);
+    bool first = true;
+    for (auto& [kind, stats] : results) {
+        size_t requests = stats.latenciesMs.size();
+        double rate = seconds > 0 ? requests / seconds : 0;
+        double p50 = percentile(stats.latenciesMs, 0.50);
+        double p90 = percentile(stats.latenciesMs, 0.90);
+        double p99 = percentile(stats.latenciesMs, 0.99);
+        double p999 = percentile(stats.latenciesMs, 0.999);
+        double max = stats.latenciesMs.empty() ? 0 : *std::max_element(stats.latenciesMs.begin(),
+                                                                        stats.latenciesMs.end());
+
+        std::cerr << std::setw(7) << kind << ": " << std::setw(12) << rate << " req/s  p50 " << p50
+                  << " ms  p99 " << p99 << " ms  p99.9 " << p999 << " ms  max " << max << " ms  errors "
+                  << stats.errors << '\n';
+
+        json << (first ? "" : ",\n") << "    {\"kind\": \"" << kind << "\", \"requests\": " << requests
+             << ", \"errors\": " << stats.errors << ", \"requests_per_sec\": " << rate
+             << ", \"p50_ms\": " << p50 << ", \"p90_ms\": " << p90 << ", \"p99_ms\": " << p99
+             << ", \"p999_ms\": " << p999 << ", \"max_ms\": " << max << "}";
+        first = false;
+    }
+    json << "\n  ]\n}\n";
+
+    if (options.outPath.empty()) {
+        std::cout << json.str();
+    } else {
+        std::ofstream out(options.outPath);
+        out << json.str();
+    }
+    return 0;
+}
@@ -0,0 +1,147 @@
+#include "TodoAnalytics.h"
+#include <cstdio>
+#include <map>
+
+namespace {
+
+// Proleptic Gregorian calendar <-> days since 1970-01-01 (Howard Hinnant's
+// algorithms), free of time zones
+int64_t daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+void civilFromDays(int64_t days, int64_t& year, unsigned& month, unsigned& day) {
+    days += 719468;
+    const int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    const unsigned dayOfEra = static_cast<unsigned>(days - era * 146097);
+    const unsigned yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    const unsigned dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    const unsigned monthIndex = (5 * dayOfYear + 2) / 153;
+    day = dayOfYear - (153 * monthIndex + 2) / 5 + 1;
+    month = monthIndex < 10 ? monthIndex + 3 : monthIndex - 9;
+    year = yearOfEra + era * 400 + (month <= 2);
+}
+
+int64_t floorDiv(int64_t value, int64_t divisor) {
+    int64_t quotient = value / divisor;
+    return (value % divisor != 0 && (value < 0) != (divisor < 0)) ? quotient - 1 : quotient;
+}
+
+}
+
+void CompletionTotals::add(const CompletionDay& day) {
+    completed += day.completed;
+    withDue += day.withDue;
+    late += day.late;
+    leadSeconds += day.leadSeconds;
+}
+
+double CompletionTotals::averageLeadDays() const {
+    return completed > 0 ? static_cast<double>(leadSeconds) / completed / 86400.0 : 0.0;
+}
+
+double CompletionTotals::lateRate() const {
+    return withDue > 0 ? static_cast<double>(late) / withDue : 0.0;
+}
+
+TodoAnalytics::TodoAnalytics(TodoDatabase& database) : database(database) {}
+
+int64_t TodoAnalytics::dayOf(time_t time) {
+    // The same shift SQLite's 'localtime' modifier applies
+    std::tm local{};
+    localtime_r(&time, &local);
+    return floorDiv(static_cast<int64_t>(time) + local.tm_gmtoff, 86400);
+}
+
+int64_t TodoAnalytics::today() {
+    return dayOf(std::time(nullptr));
+}
+
+time_t TodoAnalytics::startOfDay(int64_t day) {
+    int64_t year;
+    unsigned month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+
+    std::tm local{};
+    local.tm_year = static_cast<int>(year - 1900);
+    local.tm_mon = static_cast<int>(month - 1);
+    local.tm_mday = static_cast<int>(dayOfMonth);
+    local.tm_isdst = -1;
+    return std::mktime(&local);
+}
+
+int64_t TodoAnalytics::bucketStart(int64_t day, AnalyticsBucket bucket) {
+    switch (bucket) {
+    case AnalyticsBucket::Day:
+        return day;
+    case AnalyticsBucket::Week:
+        return day - (day + 3 - floorDiv(day + 3, 7) * 7);  // Day 0 was a Thursday
+    case AnalyticsBucket::Month: {
+        int64_t year;
+        unsigned month, dayOfMonth;
+        civilFromDays(day, year, month, dayOfMonth);
+        return day - (dayOfMonth - 1);
+    }
+    }
+    return day;
+}
+
+int64_t TodoAnalytics::bucketEnd(int64_t day, AnalyticsBucket bucket) {
+    switch (bucket) {
+    case AnalyticsBucket::Day:
+        return day;
+    case AnalyticsBucket::Week:
+        return bucketStart(day, bucket) + 6;
+    case AnalyticsBucket::Month: {
+        int64_t year;
+        unsigned month, dayOfMonth;
+        civilFromDays(day, year, month, dayOfMonth);
+        return month == 12 ? daysFromCivil(year + 1, 1, 1) - 1 : daysFromCivil(year, month + 1, 1) - 1;
+    }
+    }
+    return day;
+}
+
+std::string TodoAnalytics::formatDay(int64_t day) {
+    int64_t year;
+    unsigned month, dayOfMonth;
+    civilFromDays(day, year, month, dayOfMonth);
+
+    char text[32];
+    std::snprintf(text, sizeof(text), "%04lld-%02u-%02u", static_cast<long long>(year), month, dayOfMonth);
+    return text;
+}
+
+std::optional<AnalyticsReport> TodoAnalytics::report(int64_t firstDay, int64_t lastDay,
+                                                     AnalyticsBucket bucket) {
+    AnalyticsReport report;
+    report.firstDay = bucketStart(firstDay, bucket);
+    report.lastDay = lastDay;
+
+    for (int64_t day = report.firstDay; day <= lastDay; day = bucketEnd(day, bucket) + 1) {
+        report.buckets.push_back({day, bucketEnd(day, bucket), {}});
+    }
+
+    // Rows arrive in day order, so the bucket only ever moves forward
+    std::map<std::string, CompletionTotals> categories;
+    size_t current = 0;
+    bool ok = database.forEachCompletionDay(report.firstDay, lastDay, [&](const CompletionDay& row) {
+        while (report.buckets[current].lastDay < row.day) current++;
+        report.buckets[current].totals.add(row);
+        categories[row.category].add(row);
+        report.total.add(row);
+        return true;
+    });
+    if (!ok) return std::nullopt;
+
+    report.categories.reserve(categories.size());
+    for (auto& [category, totals] : categories) {
+        report.categories.push_back({category, totals});
+    }
+    return report;
+}
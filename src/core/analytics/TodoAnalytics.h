@@ -0,0 +1,74 @@
+#ifndef TODO_ANALYTICS_H
+#define TODO_ANALYTICS_H
+
+#include <cstdint>
+#include <ctime>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/TodoDatabase.h"
+
+enum class AnalyticsBucket {
+    Day,
+    Week,  // Monday to Sunday
+    Month
+};
+
+struct CompletionTotals {
+    int completed = 0;
+    int withDue = 0;
+    int late = 0;
+    int64_t leadSeconds = 0;
+
+    void add(const CompletionDay& day);
+    double averageLeadDays() const;  // Creation to completion; 0 when nothing was completed
+    double lateRate() const;         // Share of those with a due date; 0 when none had one
+};
+
+struct ThroughputBucket {
+    int64_t firstDay = 0;
+    int64_t lastDay = 0;
+    CompletionTotals totals;
+};
+
+struct CategoryThroughput {
+    std::string category;  // Empty for none
+    CompletionTotals totals;
+};
+
+struct AnalyticsReport {
+    int64_t firstDay = 0;
+    int64_t lastDay = 0;
+    std::vector<ThroughputBucket> buckets;        // Every bucket of the range, empty ones too
+    std::vector<CategoryThroughput> categories;   // By name
+    CompletionTotals total;
+};
+
+// Throughput reports: todos completed per day, week or month, average time
+// from creation to completion, and how often todos with a due date were
+// finished late, per category. Everything comes from the completion_daily
+// rollup (TodoDatabase::forEachCompletionDay), so a year is at most a row
+// per day and category whatever the size of todos.
+//
+// Days are local calendar days counted from 1970-01-01, as the rollup keys
+// them.
+class TodoAnalytics {
+public:
+    explicit TodoAnalytics(TodoDatabase& database);
+
+    static int64_t dayOf(time_t time);
+    static int64_t today();
+    static time_t startOfDay(int64_t day);  // Local midnight
+    static int64_t bucketStart(int64_t day, AnalyticsBucket bucket);
+    static int64_t bucketEnd(int64_t day, AnalyticsBucket bucket);  // Last day of the bucket
+    static std::string formatDay(int64_t day);  // YYYY-MM-DD
+
+    // firstDay is moved back to the start of its bucket, so every bucket is
+    // whole. std::nullopt on a database error.
+    std::optional<AnalyticsReport> report(int64_t firstDay, int64_t lastDay, AnalyticsBucket bucket);
+
+private:
+    TodoDatabase& database;
+};
+
+#endif // TODO_ANALYTICS_H
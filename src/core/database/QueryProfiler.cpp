@@ -0,0 +1,193 @@
+#include "QueryProfiler.h"
+#include <algorithm>
+#include <chrono>
+
+namespace {
+
+int64_t nowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace
+
+void LatencyHistogram::add(int64_t ns) {
+    uint64_t us = ns > 0 ? static_cast<uint64_t>(ns / 1000) : 0;
+    int bucket = 0;
+    while (us > 0 && bucket < kBuckets - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    buckets[bucket]++;
+    count++;
+    totalNs += ns;
+    maxNs = std::max(maxNs, ns);
+}
+
+double LatencyHistogram::percentileUs(double p) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            double upper = static_cast<double>(uint64_t(1) << i);
+            return std::min(upper, maxNs / 1000.0);
+        }
+    }
+    return maxNs / 1000.0;
+}
+
+QueryProfiler::QueryProfiler(sqlite3* db, int64_t slowThresholdUs)
+    : db(db), thresholdNs(slowThresholdUs * 1000) {
+    sqlite3_trace_v2(db, SQLITE_TRACE_STMT | SQLITE_TRACE_ROW | SQLITE_TRACE_PROFILE,
+                     &QueryProfiler::onTrace, this);
+}
+
+QueryProfiler::~QueryProfiler() {
+    sqlite3_trace_v2(db, 0, nullptr, nullptr);
+}
+
+int QueryProfiler::onTrace(unsigned type, void* context, void* statement, void* data) {
+    QueryProfiler* self = static_cast<QueryProfiler*>(context);
+    if (self->explaining) return 0;
+
+    sqlite3_stmt* stmt = static_cast<sqlite3_stmt*>(statement);
+    switch (type) {
+        case SQLITE_TRACE_STMT:
+            // Also fires for each trigger the statement runs; keep the first start
+            self->running.emplace(stmt, Running{nowNs(), 0});
+            break;
+        case SQLITE_TRACE_ROW:
+            if (stmt != self->rowStatement) {
+                auto it = self->running.find(stmt);
+                if (it == self->running.end()) break;
+                self->rowStatement = stmt;
+                self->rowTarget = &it->second;
+            }
+            self->rowTarget->rows++;
+            break;
+        case SQLITE_TRACE_PROFILE:
+            self->finish(stmt, *static_cast<sqlite3_int64*>(data));
+            break;
+    }
+    return 0;
+}
+
+void QueryProfiler::finish(sqlite3_stmt* stmt, int64_t sqliteNs) {
+    int64_t durationNs = sqliteNs;
+    uint64_t rows = 0;
+
+    // Started before profiling was enabled: fall back to SQLite's estimate
+    auto it = running.find(stmt);
+    if (it != running.end()) {
+        durationNs = nowNs() - it->second.startNs;
+        rows = it->second.rows;
+        running.erase(it);
+        if (rowStatement == stmt) rowStatement = nullptr;
+    }
+
+    const char* sql = sqlite3_sql(stmt);
+    if (!sql) return;
+
+    StatementProfile& profile = profiles[sql];
+    if (profile.sql.empty()) profile.sql = sql;
+
+    uint64_t fullScanSteps = sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_FULLSCAN_STEP, 1);
+    profile.latency.add(durationNs);
+    profile.rowsReturned += rows;
+    profile.fullScanSteps += fullScanSteps;
+    profile.sorts += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_SORT, 1);
+    profile.autoIndexes += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_AUTOINDEX, 1);
+    profile.vmSteps += sqlite3_stmt_status(stmt, SQLITE_STMTSTATUS_VM_STEP, 1);
+
+    if (durationNs < thresholdNs) return;
+
+    profile.slowRuns++;
+
+    SlowStatement entry;
+    char* expanded = sqlite3_expanded_sql(stmt);
+    entry.sql = expanded ? expanded : sql;
+    sqlite3_free(expanded);
+    entry.preparedSql = sql;
+    entry.durationNs = durationNs;
+    entry.rowsReturned = rows;
+    entry.fullScanSteps = fullScanSteps;
+    entry.at = std::time(nullptr);
+
+    slow.push_back(std::move(entry));
+    if (slow.size() > kMaxSlowStatements) slow.pop_front();
+}
+
+std::string QueryProfiler::explain(const std::string& sql) {
+    explaining = true;
+
+    sqlite3_stmt* stmt;
+    std::string query = "EXPLAIN QUERY PLAN " + sql;
+    if (sqlite3_prepare_v2(db, query.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        std::string plan = std::string("(no plan: ") + sqlite3_errmsg(db) + ")";
+        explaining = false;
+        return plan;
+    }
+
+    // Rows come parents first; indent each by its depth like the sqlite3 shell
+    std::unordered_map<int, int> depthOf;
+    std::string plan;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        int id = sqlite3_column_int(stmt, 0);
+        int parent = sqlite3_column_int(stmt, 1);
+        const char* detail = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+
+        auto parentDepth = depthOf.find(parent);
+        int depth = parentDepth == depthOf.end() ? 0 : parentDepth->second + 1;
+        depthOf[id] = depth;
+
+        plan.append(2 * depth, ' ');
+        plan += detail ? detail : "";
+        plan += '\n';
+    }
+    sqlite3_finalize(stmt);
+
+    explaining = false;
+    return plan;
+}
+
+void QueryProfiler::fillQueryPlans() {
+    for (auto& [sql, profile] : profiles) {
+        if (profile.queryPlan.empty() && (profile.slowRuns > 0 || profile.fullScanSteps > 0)) {
+            profile.queryPlan = explain(sql);
+        }
+    }
+
+    for (SlowStatement& entry : slow) {
+        if (!entry.queryPlan.empty()) continue;
+        auto profile = profiles.find(entry.preparedSql);
+        entry.queryPlan = profile != profiles.end() ? profile->second.queryPlan : explain(entry.preparedSql);
+    }
+}
+
+std::vector<StatementProfile> QueryProfiler::statements() {
+    fillQueryPlans();
+
+    std::vector<StatementProfile> result;
+    result.reserve(profiles.size());
+    for (const auto& [sql, profile] : profiles) {
+        result.push_back(profile);
+    }
+    std::sort(result.begin(), result.end(), [](const StatementProfile& a, const StatementProfile& b) {
+        return a.latency.totalNs > b.latency.totalNs;
+    });
+    return result;
+}
+
+std::vector<SlowStatement> QueryProfiler::slowStatements() {
+    fillQueryPlans();
+    return std::vector<SlowStatement>(slow.begin(), slow.end());
+}
+
+void QueryProfiler::reset() {
+    profiles.clear();
+    slow.clear();
+}
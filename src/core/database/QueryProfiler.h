@@ -0,0 +1,98 @@
+#ifndef QUERY_PROFILER_H
+#define QUERY_PROFILER_H
+
+#include <array>
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <sqlite3.h>
+
+// Latencies in power-of-two buckets: bucket 0 is under 1 us, bucket i
+// covers [2^(i-1), 2^i) us and the last one everything slower.
+struct LatencyHistogram {
+    static constexpr int kBuckets = 32;
+
+    std::array<uint64_t, kBuckets> buckets{};
+    uint64_t count = 0;
+    int64_t totalNs = 0;
+    int64_t maxNs = 0;
+
+    void add(int64_t ns);
+    double percentileUs(double p) const;  // Upper edge of the bucket, capped at the max
+};
+
+// Everything recorded for one SQL text. Runs of the same statement with
+// different bound values land in the same profile.
+struct StatementProfile {
+    std::string sql;               // As prepared, with ? placeholders
+    LatencyHistogram latency;
+    uint64_t rowsReturned = 0;
+    uint64_t fullScanSteps = 0;    // Rows visited by full table scans
+    uint64_t sorts = 0;            // Sorts without an index to read the order from
+    uint64_t autoIndexes = 0;      // Rows put in transient indexes SQLite built itself
+    uint64_t vmSteps = 0;
+    uint64_t slowRuns = 0;
+    std::string queryPlan;         // EXPLAIN QUERY PLAN, for slow or scanning statements
+};
+
+struct SlowStatement {
+    std::string sql;               // With the bound values
+    std::string preparedSql;       // Key of its StatementProfile
+    int64_t durationNs = 0;
+    uint64_t rowsReturned = 0;
+    uint64_t fullScanSteps = 0;
+    time_t at = 0;
+    std::string queryPlan;
+};
+
+// Per-statement profiling through sqlite3_trace_v2. Durations are measured
+// here with a steady clock (SQLite's own profile time only has millisecond
+// resolution) from the first step to completion, so they include whatever
+// the caller does between rows. Not thread-safe: read it from the thread
+// that uses the connection.
+class QueryProfiler {
+public:
+    QueryProfiler(sqlite3* db, int64_t slowThresholdUs);
+    ~QueryProfiler();  // Detaches from the connection
+
+    QueryProfiler(const QueryProfiler&) = delete;
+    QueryProfiler& operator=(const QueryProfiler&) = delete;
+
+    int64_t slowThresholdUs() const { return thresholdNs / 1000; }
+    void setSlowThresholdUs(int64_t us) { thresholdNs = us * 1000; }
+
+    // Query plans are looked up here rather than inside the trace callback,
+    // so these must not be called while a statement is being stepped
+    std::vector<StatementProfile> statements();   // Most total time first
+    std::vector<SlowStatement> slowStatements();  // Oldest first
+    void reset();
+
+    static constexpr size_t kMaxSlowStatements = 200;
+
+private:
+    struct Running {
+        int64_t startNs = 0;
+        uint64_t rows = 0;
+    };
+
+    sqlite3* db;
+    int64_t thresholdNs;
+    bool explaining = false;  // Our own EXPLAIN statements are not recorded
+
+    std::unordered_map<sqlite3_stmt*, Running> running;
+    // Rows arrive in long runs from one statement; skip the lookup for those
+    sqlite3_stmt* rowStatement = nullptr;
+    Running* rowTarget = nullptr;
+    std::unordered_map<std::string, StatementProfile> profiles;
+    std::deque<SlowStatement> slow;
+
+    static int onTrace(unsigned type, void* context, void* statement, void* data);
+    void finish(sqlite3_stmt* stmt, int64_t sqliteNs);
+    void fillQueryPlans();
+    std::string explain(const std::string& sql);
+};
+
+#endif // QUERY_PROFILER_H
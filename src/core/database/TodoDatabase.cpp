@@ -1,10 +1,82 @@
 #include "TodoDatabase.h"
+#include "../analytics/TodoAnalytics.h"
+#include "../metrics/Metrics.h"
+#include "../metrics/Trace.h"
+#include <algorithm>
 #include <iostream>
 #include <sstream>
+#include <chrono>
+#include <ctime>
+#include <cstdint>
+#include <cstdio>
+#include <random>
+#include <tuple>
+
+// Columns readTodo() reads, in its order
+#define TODO_COLUMNS \
+    "id, title, description, category, completed, created_at, updated_at, due_date, priority, parent_id," \
+    " manual_rank"
+
+// Local calendar day of a unix time in SQL, days since 1970-01-01; matches
+// TodoAnalytics::dayOf()
+#define LOCAL_DAY(time) "(CAST(strftime('%s', " time ", 'unixepoch', 'localtime') AS INTEGER) / 86400)"
+
+namespace {
+
+// 48-bit millisecond timestamp then 80 random bits (the UUIDv7 layout, minus
+// the version bits). New rows land at the right edge of idx_uuid and the
+// sync_log index instead of on random pages.
+void bindUuid(sqlite3_stmt* stmt, int index, uint64_t ms, uint64_t high, uint64_t low) {
+    unsigned char uuid[16];
+    for (int i = 0; i < 6; i++) uuid[i] = static_cast<unsigned char>(ms >> (40 - 8 * i));
+    for (int i = 0; i < 2; i++) uuid[6 + i] = static_cast<unsigned char>(high >> (8 * i));
+    for (int i = 0; i < 8; i++) uuid[8 + i] = static_cast<unsigned char>(low >> (8 * i));
+
+    sqlite3_bind_blob(stmt, index, uuid, sizeof(uuid), SQLITE_TRANSIENT);
+}
+
+// SplitMix64, for identities that must follow from a seed
+uint64_t nextSeeded(uint64_t& state) {
+    uint64_t z = (state += 0x9e3779b97f4a7c15);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111eb;
+    return z ^ (z >> 31);
+}
+
+void bindParentId(sqlite3_stmt* stmt, int index, std::optional<int> parentId) {
+    if (parentId) {
+        sqlite3_bind_int(stmt, index, *parentId);
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+// completed_day of a new row. Batch inserts work it out here: SQLite's
+// 'localtime' (LOCAL_DAY) costs a system call per row.
+void bindCompletedDay(sqlite3_stmt* stmt, int index, const Todo& todo) {
+    if (todo.isCompleted()) {
+        sqlite3_bind_int64(stmt, index, TodoAnalytics::dayOf(todo.getUpdatedAt()));
+    } else {
+        sqlite3_bind_null(stmt, index);
+    }
+}
+
+// Ranks closer than this are respaced by rebalanceManualOrder(). Halving a
+// gap of 1 gets here after about 20 drops into the same spot, far above
+// where doubles run out of precision.
+const double kMinManualRankGap = 1e-6;
+
+// Includes the visitor's time for the streaming calls
+Metrics::Histogram& callLatency(const char* operation) {
+    return Metrics::histogram("todo_db_call_seconds", "Latency of TodoDatabase calls", {{"op", operation}});
+}
+
+} // namespace
 
 TodoDatabase::TodoDatabase(const std::string& path)
     : db(nullptr), db_path(path) {
 
+    Trace::Span span("sqlite3_open", "db");
     int result = sqlite3_open(path.c_str(), &db);
 
     if (result != SQLITE_OK) {
@@ -18,6 +90,13 @@ TodoDatabase::~TodoDatabase() {
 }
 
 void TodoDatabase::close() {
+    queryProfiler.reset();
+
+    for (auto& [sql, stmt] : statementCache) {
+        sqlite3_finalize(stmt);
+    }
+    statementCache.clear();
+
     if (db) {
         sqlite3_close(db);
         db = nullptr;
@@ -25,6 +104,10 @@ void TodoDatabase::close() {
 }
 
 bool TodoDatabase::initialize() {
+    static Metrics::Histogram& latency = callLatency("initialize");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("TodoDatabase::initialize", "db");
+
     const char* sql = R"(
         CREATE TABLE IF NOT EXISTS todos (
             id INTEGER PRIMARY KEY AUTOINCREMENT,
@@ -38,13 +121,550 @@ bool TodoDatabase::initialize() {
             priority INTEGER DEFAULT 2,
             CHECK(priority >= 1 AND priority <= 3)
         );
-        
-        CREATE INDEX IF NOT EXISTS idx_category ON todos(category);
-        CREATE INDEX IF NOT EXISTS idx_completed ON todos(completed);
-        CREATE INDEX IF NOT EXISTS idx_due_date ON todos(due_date);
     )";
     
-    return executeSQL(sql);
+    if (!executeSQL(sql)) return false;
+
+    // List order keys as plain columns so keyset row-value comparisons can
+    // seek straight into an index (expressions only match the first column)
+    if (!ensureColumn("todos", "list_key_priority",
+                      "INTEGER GENERATED ALWAYS AS (-priority) VIRTUAL") ||
+        !ensureColumn("todos", "list_key_due",
+                      "INTEGER GENERATED ALWAYS AS (IFNULL(due_date, 9223372036854775807)) VIRTUAL") ||
+        !ensureColumn("todos", "list_key_created",
+                      "INTEGER GENERATED ALWAYS AS (-created_at) VIRTUAL")) {
+        return false;
+    }
+
+    if (!createTreeSchema()) return false;
+
+    // Manual (drag-and-drop) order among siblings; existing rows start out
+    // in list order. Not synced, and not a change to the todo.
+    if (!hasColumn("todos", "manual_rank")) {
+        if (!ensureColumn("todos", "manual_rank", "REAL") || !executeSQL(R"(
+                UPDATE todos SET manual_rank = ranked.n
+                FROM (SELECT id, ROW_NUMBER() OVER (
+                          PARTITION BY parent_id
+                          ORDER BY completed, list_key_priority, list_key_due, list_key_created, id) AS n
+                      FROM todos) AS ranked
+                WHERE todos.id = ranked.id;
+            )")) {
+            return false;
+        }
+    }
+
+    // When each todo was completed, and the local day that was on
+    if (!ensureColumn("todos", "completed_at", "INTEGER") ||
+        !ensureColumn("todos", "completed_day", "INTEGER")) {
+        return false;
+    }
+
+    return createIndexes() && createSyncSchema() && createStatsSchema() && createAnalyticsSchema();
+}
+
+bool TodoDatabase::createIndexes() {
+    Trace::Span span("createIndexes", "db");
+
+    // idx_category and idx_completed were prefixes of the list order indexes
+    // and only slowed down writes
+    return executeSQL(R"(
+        DROP INDEX IF EXISTS idx_category;
+        DROP INDEX IF EXISTS idx_completed;
+
+        CREATE INDEX IF NOT EXISTS idx_due_date ON todos(due_date);
+        CREATE INDEX IF NOT EXISTS idx_list_order
+            ON todos(completed, list_key_priority, list_key_due, list_key_created);
+        CREATE INDEX IF NOT EXISTS idx_category_list_order
+            ON todos(category, completed, list_key_priority, list_key_due, list_key_created);
+        CREATE INDEX IF NOT EXISTS idx_parent_list_order
+            ON todos(parent_id, completed, list_key_priority, list_key_due, list_key_created);
+        CREATE INDEX IF NOT EXISTS idx_manual_order ON todos(parent_id, manual_rank);
+    )");
+}
+
+bool TodoDatabase::beginBulkLoad() {
+    bulkLastRanks.emplace();
+
+    // The new rows are logged for sync in one pass at the end; the marker
+    // lets initialize() finish that if the load never gets there. Every
+    // trigger on INSERT goes: even one whose WHEN is false costs about a
+    // microsecond a row.
+    return executeSQL(R"(
+        INSERT OR REPLACE INTO sync_meta
+            SELECT 'bulk_load_after', IFNULL(MAX(id), 0) FROM todos;
+        DROP TRIGGER IF EXISTS sync_todo_insert;
+        DROP TRIGGER IF EXISTS sync_todo_insert_without_uuid;
+
+        -- createTodos() checks parents instead; the closure is rebuilt
+        DROP TRIGGER IF EXISTS tree_todo_parent;
+        DROP TRIGGER IF EXISTS tree_todo_insert;
+
+        -- Recounted once at the end instead of two upserts a row
+        DROP TRIGGER IF EXISTS stats_todo_insert;
+        DROP TRIGGER IF EXISTS stats_todo_update;
+        DROP TRIGGER IF EXISTS stats_todo_delete;
+        DROP TRIGGER IF EXISTS analytics_todo_insert;
+        DROP TRIGGER IF EXISTS analytics_todo_update;
+        DROP TRIGGER IF EXISTS analytics_todo_delete;
+
+        DROP INDEX IF EXISTS idx_due_date;
+        DROP INDEX IF EXISTS idx_list_order;
+        DROP INDEX IF EXISTS idx_category_list_order;
+        DROP INDEX IF EXISTS idx_parent_list_order;
+        DROP INDEX IF EXISTS idx_manual_order;
+        DROP INDEX IF EXISTS idx_uuid;
+    )");
+}
+
+bool TodoDatabase::createTreeSchema() {
+    Trace::Span span("createTreeSchema", "db");
+
+    // sync_todo_update predates parent_id; recreated with it by createSyncSchema()
+    if (!hasColumn("todos", "parent_id")) {
+        if (!ensureColumn("todos", "parent_id", "INTEGER") ||
+            !executeSQL("DROP TRIGGER IF EXISTS sync_todo_update;")) {
+            return false;
+        }
+    }
+
+    // No insert trigger: a new database, or a bulk load that dropped it.
+    // Either way the closure is rebuilt before the triggers come back.
+    bool rebuild = !hasTrigger("tree_todo_insert");
+
+    // Closure table: one row per (ancestor, descendant) pair at any depth,
+    // so subtree reads are one range scan of the primary key. No rows for a
+    // todo and itself, which keeps flat lists free. Triggers maintain it;
+    // moving a subtree rewrites only the pairs that cross the move.
+    if (!executeSQL(R"(
+        CREATE TABLE IF NOT EXISTS todo_tree (
+            ancestor INTEGER NOT NULL,
+            descendant INTEGER NOT NULL,
+            depth INTEGER NOT NULL,
+            PRIMARY KEY (ancestor, descendant)
+        ) WITHOUT ROWID;
+        CREATE INDEX IF NOT EXISTS idx_tree_descendant ON todo_tree(descendant, ancestor, depth);
+    )")) {
+        return false;
+    }
+
+    if (rebuild && !rebuildTree()) return false;
+
+    return executeSQL(R"(
+        CREATE TRIGGER IF NOT EXISTS tree_todo_parent BEFORE INSERT ON todos
+        WHEN NEW.parent_id IS NOT NULL AND NOT EXISTS (SELECT 1 FROM todos WHERE id = NEW.parent_id) BEGIN
+            SELECT RAISE(ABORT, 'parent todo does not exist');
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS tree_todo_insert AFTER INSERT ON todos
+        WHEN NEW.parent_id IS NOT NULL BEGIN
+            INSERT INTO todo_tree (ancestor, descendant, depth)
+                SELECT NEW.parent_id, NEW.id, 1
+                UNION ALL
+                SELECT ancestor, NEW.id, depth + 1 FROM todo_tree WHERE descendant = NEW.parent_id;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS tree_todo_move_check BEFORE UPDATE OF parent_id ON todos
+        WHEN NEW.parent_id IS NOT OLD.parent_id AND NEW.parent_id IS NOT NULL AND (
+            NEW.parent_id = NEW.id OR
+            NOT EXISTS (SELECT 1 FROM todos WHERE id = NEW.parent_id) OR
+            EXISTS (SELECT 1 FROM todo_tree WHERE ancestor = NEW.id AND descendant = NEW.parent_id)) BEGIN
+            SELECT RAISE(ABORT, 'parent todo does not exist or is inside the moved subtree');
+        END;
+
+        -- Detach the subtree (the todo and its descendants) from the old
+        -- ancestors, then attach it below the new parent and its ancestors
+        CREATE TRIGGER IF NOT EXISTS tree_todo_move AFTER UPDATE OF parent_id ON todos
+        WHEN NEW.parent_id IS NOT OLD.parent_id BEGIN
+            DELETE FROM todo_tree
+            WHERE ancestor IN (SELECT ancestor FROM todo_tree WHERE descendant = NEW.id)
+              AND descendant IN (SELECT NEW.id
+                                 UNION ALL
+                                 SELECT descendant FROM todo_tree WHERE ancestor = NEW.id);
+
+            INSERT INTO todo_tree (ancestor, descendant, depth)
+                SELECT above.ancestor, below.descendant, above.depth + below.depth + 1
+                FROM (SELECT NEW.parent_id AS ancestor, 0 AS depth
+                      UNION ALL
+                      SELECT ancestor, depth FROM todo_tree WHERE descendant = NEW.parent_id) AS above,
+                     (SELECT NEW.id AS descendant, 0 AS depth
+                      UNION ALL
+                      SELECT descendant, depth FROM todo_tree WHERE ancestor = NEW.id) AS below
+                WHERE NEW.parent_id IS NOT NULL;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS tree_todo_delete AFTER DELETE ON todos BEGIN
+            DELETE FROM todo_tree WHERE ancestor = OLD.id OR descendant = OLD.id;
+        END;
+    )");
+}
+
+bool TodoDatabase::endBulkLoad() {
+    bulkLastRanks.reset();
+
+    return createIndexes() && createTreeSchema() && createSyncSchema() && createStatsSchema() &&
+           createAnalyticsSchema();
+}
+
+bool TodoDatabase::rebuildTree() {
+    Trace::Span span("rebuildTree", "db");
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return false;
+
+    // Each todo's ancestors, walked up parent_id
+    bool ok = executeSQL(R"(
+        DELETE FROM todo_tree;
+        INSERT INTO todo_tree (ancestor, descendant, depth)
+            WITH RECURSIVE above (descendant, ancestor, depth) AS (
+                SELECT id, parent_id, 1 FROM todos WHERE parent_id IS NOT NULL
+                UNION ALL
+                SELECT above.descendant, todos.parent_id, above.depth + 1
+                FROM above JOIN todos ON todos.id = above.ancestor
+                WHERE todos.parent_id IS NOT NULL)
+            SELECT ancestor, descendant, depth FROM above;
+    )");
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
+bool TodoDatabase::createStatsSchema() {
+    Trace::Span span("createStatsSchema", "db");
+
+    // No triggers yet: a database from before the stats, or a bulk load
+    // that never finished. Either way the tables need a recount.
+    bool rebuild = !hasTrigger("stats_todo_insert");
+
+    // Counts the status bar and category filter read, kept exact by
+    // triggers so neither scans todos. A NULL category counts as ''.
+    // Overdue cannot be kept that way (the clock moves), so due_stats keeps
+    // open todos per UTC day of their due date.
+    if (!executeSQL(R"(
+        CREATE TABLE IF NOT EXISTS category_stats (
+            category TEXT PRIMARY KEY,
+            total INTEGER NOT NULL,
+            completed INTEGER NOT NULL
+        ) WITHOUT ROWID;
+
+        CREATE TABLE IF NOT EXISTS due_stats (
+            day INTEGER PRIMARY KEY,
+            open INTEGER NOT NULL
+        );
+
+        CREATE TRIGGER IF NOT EXISTS stats_todo_insert AFTER INSERT ON todos BEGIN
+            INSERT INTO category_stats VALUES (IFNULL(NEW.category, ''), 1, NEW.completed != 0)
+                ON CONFLICT (category) DO UPDATE
+                SET total = total + 1, completed = completed + excluded.completed;
+            INSERT INTO due_stats
+                SELECT NEW.due_date / 86400, 1 WHERE NEW.completed = 0 AND NEW.due_date IS NOT NULL
+                ON CONFLICT (day) DO UPDATE SET open = open + 1;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS stats_todo_delete AFTER DELETE ON todos BEGIN
+            UPDATE category_stats SET total = total - 1, completed = completed - (OLD.completed != 0)
+                WHERE category = IFNULL(OLD.category, '');
+            DELETE FROM category_stats WHERE category = IFNULL(OLD.category, '') AND total <= 0;
+            UPDATE due_stats SET open = open - 1
+                WHERE OLD.completed = 0 AND day = OLD.due_date / 86400;
+            DELETE FROM due_stats WHERE day = OLD.due_date / 86400 AND open <= 0;
+        END;
+
+        -- Out with the old contribution, in with the new
+        CREATE TRIGGER IF NOT EXISTS stats_todo_update AFTER UPDATE OF category, completed, due_date ON todos
+        WHEN OLD.category IS NOT NEW.category OR OLD.completed IS NOT NEW.completed
+          OR OLD.due_date IS NOT NEW.due_date BEGIN
+            UPDATE category_stats SET total = total - 1, completed = completed - (OLD.completed != 0)
+                WHERE category = IFNULL(OLD.category, '');
+            DELETE FROM category_stats WHERE category = IFNULL(OLD.category, '') AND total <= 0;
+            UPDATE due_stats SET open = open - 1
+                WHERE OLD.completed = 0 AND day = OLD.due_date / 86400;
+            DELETE FROM due_stats WHERE day = OLD.due_date / 86400 AND open <= 0;
+
+            INSERT INTO category_stats VALUES (IFNULL(NEW.category, ''), 1, NEW.completed != 0)
+                ON CONFLICT (category) DO UPDATE
+                SET total = total + 1, completed = completed + excluded.completed;
+            INSERT INTO due_stats
+                SELECT NEW.due_date / 86400, 1 WHERE NEW.completed = 0 AND NEW.due_date IS NOT NULL
+                ON CONFLICT (day) DO UPDATE SET open = open + 1;
+        END;
+    )")) {
+        return false;
+    }
+
+    return !rebuild || rebuildStats();
+}
+
+bool TodoDatabase::createAnalyticsSchema() {
+    Trace::Span span("createAnalyticsSchema", "db");
+
+    bool rebuild = !hasTrigger("analytics_todo_insert");
+
+    // completion_daily: todos completed per local day and category, with
+    // the sums behind average lead time and the late rate, so reports over
+    // any range read one row per day and category instead of todos.
+    // completed_at is the updated_at of the write that completed the todo,
+    // so replicas agree on it. completed_day is its local day where it was
+    // completed, kept on the row so taking a completion back neither calls
+    // localtime again nor misses its rollup row after a time zone change.
+    // Inserts set both, the triggers keep them. Rows mirror the todos as
+    // they are: reopening, recategorizing or deleting one moves or drops
+    // its completion.
+    if (!executeSQL(R"(
+        CREATE TABLE IF NOT EXISTS completion_daily (
+            day INTEGER NOT NULL,
+            category TEXT NOT NULL,
+            completed INTEGER NOT NULL,
+            lead_seconds INTEGER NOT NULL,  -- Sum of completed_at - created_at
+            with_due INTEGER NOT NULL,
+            late INTEGER NOT NULL,          -- Completed after the due date
+            PRIMARY KEY (day, category)
+        ) WITHOUT ROWID;
+
+        CREATE TRIGGER IF NOT EXISTS analytics_todo_insert AFTER INSERT ON todos
+        WHEN NEW.completed != 0 BEGIN
+            UPDATE todos SET completed_at = NEW.updated_at, completed_day = )" LOCAL_DAY("NEW.updated_at") R"(
+                WHERE NEW.completed_day IS NULL AND id = NEW.id;
+            INSERT INTO completion_daily
+                SELECT completed_day, IFNULL(category, ''), 1, MAX(completed_at - created_at, 0),
+                       due_date IS NOT NULL, IFNULL(completed_at > due_date, 0)
+                FROM todos WHERE id = NEW.id
+                ON CONFLICT (day, category) DO UPDATE
+                SET completed = completed + 1, lead_seconds = lead_seconds + excluded.lead_seconds,
+                    with_due = with_due + excluded.with_due, late = late + excluded.late;
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS analytics_todo_delete AFTER DELETE ON todos
+        WHEN OLD.completed_day IS NOT NULL BEGIN
+            UPDATE completion_daily
+                SET completed = completed - 1,
+                    lead_seconds = lead_seconds - MAX(OLD.completed_at - OLD.created_at, 0),
+                    with_due = with_due - (OLD.due_date IS NOT NULL),
+                    late = late - IFNULL(OLD.completed_at > OLD.due_date, 0)
+                WHERE day = OLD.completed_day AND category = IFNULL(OLD.category, '');
+            DELETE FROM completion_daily
+                WHERE day = OLD.completed_day AND category = IFNULL(OLD.category, '') AND completed <= 0;
+        END;
+
+        -- Out with the old completion, stamp a new one if completed flipped,
+        -- then add the row as it now is. One trigger, so the steps cannot
+        -- interleave with another trigger's view of the row.
+        CREATE TRIGGER IF NOT EXISTS analytics_todo_update
+        AFTER UPDATE OF completed, category, due_date, created_at ON todos
+        WHEN OLD.completed IS NOT NEW.completed OR OLD.category IS NOT NEW.category
+          OR OLD.due_date IS NOT NEW.due_date OR OLD.created_at IS NOT NEW.created_at BEGIN
+            UPDATE completion_daily
+                SET completed = completed - 1,
+                    lead_seconds = lead_seconds - MAX(OLD.completed_at - OLD.created_at, 0),
+                    with_due = with_due - (OLD.due_date IS NOT NULL),
+                    late = late - IFNULL(OLD.completed_at > OLD.due_date, 0)
+                WHERE OLD.completed_day IS NOT NULL
+                  AND day = OLD.completed_day AND category = IFNULL(OLD.category, '');
+            DELETE FROM completion_daily
+                WHERE OLD.completed_day IS NOT NULL
+                  AND day = OLD.completed_day AND category = IFNULL(OLD.category, '') AND completed <= 0;
+
+            UPDATE todos
+                SET completed_at = CASE WHEN NEW.completed != 0 THEN NEW.updated_at END,
+                    completed_day = CASE WHEN NEW.completed != 0 THEN )" LOCAL_DAY("NEW.updated_at") R"( END
+                WHERE (OLD.completed != 0) IS NOT (NEW.completed != 0) AND id = NEW.id;
+
+            INSERT INTO completion_daily
+                SELECT completed_day, IFNULL(category, ''), 1, MAX(completed_at - created_at, 0),
+                       due_date IS NOT NULL, IFNULL(completed_at > due_date, 0)
+                FROM todos WHERE id = NEW.id AND completed_day IS NOT NULL
+                ON CONFLICT (day, category) DO UPDATE
+                SET completed = completed + 1, lead_seconds = lead_seconds + excluded.lead_seconds,
+                    with_due = with_due + excluded.with_due, late = late + excluded.late;
+        END;
+    )")) {
+        return false;
+    }
+
+    return !rebuild || rebuildAnalytics();
+}
+
+bool TodoDatabase::hasTrigger(const std::string& name) {
+    if (!db) return false;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sqlite_master WHERE type = 'trigger' AND name = ?;",
+                           -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT trigger");
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, name.c_str(), -1, SQLITE_TRANSIENT);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+bool TodoDatabase::hasSyncMeta(const std::string& key) {
+    if (!db) return false;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, "SELECT 1 FROM sync_meta WHERE key = ?;", -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT sync meta");
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, key.c_str(), -1, SQLITE_TRANSIENT);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+bool TodoDatabase::createSyncSchema() {
+    Trace::Span span("createSyncSchema", "db");
+
+    bool backfill = !hasColumn("todos", "uuid");
+    if (!ensureColumn("todos", "uuid", "BLOB")) return false;
+
+    // Triggers from before local versions were stamped past the ones they
+    // replace; recreated below
+    if (hasTrigger("sync_todo_update") && !hasSyncMeta("next_stamp")) {
+        if (!executeSQL("DROP TRIGGER sync_todo_update; DROP TRIGGER IF EXISTS sync_todo_delete;")) return false;
+    }
+
+    // origin and origin_seq stay NULL for changes made here: they mean this
+    // device and seq. The update trigger must list every synced column.
+    // Triggers delete and reinsert rather than INSERT OR REPLACE: the outer
+    // statement's conflict clause (the sync upsert) would override theirs.
+    if (!executeSQL(R"(
+        CREATE UNIQUE INDEX IF NOT EXISTS idx_uuid ON todos(uuid);
+
+        CREATE TABLE IF NOT EXISTS sync_log (
+            seq INTEGER PRIMARY KEY AUTOINCREMENT,
+            uuid BLOB NOT NULL UNIQUE,
+            deleted INTEGER NOT NULL DEFAULT 0,
+            modified_at INTEGER NOT NULL,
+            origin TEXT,
+            origin_seq INTEGER
+        );
+
+        CREATE TABLE IF NOT EXISTS sync_meta (
+            key TEXT PRIMARY KEY,
+            value TEXT NOT NULL
+        );
+        INSERT OR IGNORE INTO sync_meta VALUES ('device_id', lower(hex(randomblob(8))));
+
+        CREATE TABLE IF NOT EXISTS sync_peers (
+            peer_id TEXT PRIMARY KEY,
+            sent_seq INTEGER NOT NULL DEFAULT 0,
+            synced_at INTEGER
+        );
+
+        -- Rows from TodoDatabase arrive with a fresh uuid (applySyncRecord
+        -- clears an old tombstone first); others get one here
+        CREATE TRIGGER IF NOT EXISTS sync_todo_insert AFTER INSERT ON todos
+        WHEN NEW.uuid IS NOT NULL BEGIN
+            INSERT INTO sync_log (uuid, modified_at) VALUES (NEW.uuid, NEW.updated_at);
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS sync_todo_insert_without_uuid AFTER INSERT ON todos
+        WHEN NEW.uuid IS NULL BEGIN
+            UPDATE todos SET uuid = randomblob(16) WHERE id = NEW.id;
+            INSERT INTO sync_log (uuid, modified_at)
+                SELECT uuid, updated_at FROM todos WHERE id = NEW.id;
+        END;
+
+        -- A local version always ranks after the one it replaces, even in
+        -- the same second or with a clock behind the other device's; else
+        -- the peer would keep the old one. next_stamp carries the stamp
+        -- across the delete of the old log row.
+        INSERT OR IGNORE INTO sync_meta VALUES ('next_stamp', '0');
+
+        CREATE TRIGGER IF NOT EXISTS sync_todo_update
+        AFTER UPDATE OF title, description, category, completed, created_at, updated_at,
+                        due_date, priority, parent_id ON todos
+        WHEN NEW.uuid IS NOT NULL BEGIN
+            UPDATE sync_meta
+                SET value = MAX(NEW.updated_at,
+                                IFNULL((SELECT modified_at + 1 FROM sync_log WHERE uuid = NEW.uuid), 0))
+                WHERE key = 'next_stamp';
+            DELETE FROM sync_log WHERE uuid = NEW.uuid;
+            INSERT INTO sync_log (uuid, modified_at)
+                SELECT NEW.uuid, CAST(value AS INTEGER) FROM sync_meta WHERE key = 'next_stamp';
+        END;
+
+        CREATE TRIGGER IF NOT EXISTS sync_todo_delete AFTER DELETE ON todos
+        WHEN OLD.uuid IS NOT NULL BEGIN
+            UPDATE sync_meta
+                SET value = MAX(OLD.updated_at, CAST(strftime('%s', 'now') AS INTEGER),
+                                IFNULL((SELECT modified_at + 1 FROM sync_log WHERE uuid = OLD.uuid), 0))
+                WHERE key = 'next_stamp';
+            DELETE FROM sync_log WHERE uuid = OLD.uuid;
+            INSERT INTO sync_log (uuid, deleted, modified_at)
+                SELECT OLD.uuid, 1, CAST(value AS INTEGER) FROM sync_meta WHERE key = 'next_stamp';
+        END;
+    )")) {
+        return false;
+    }
+
+    // Rows a bulk load inserted while the insert triggers were dropped
+    if (!executeSQL(R"(
+            UPDATE todos SET uuid = randomblob(16)
+                WHERE id > (SELECT CAST(value AS INTEGER) FROM sync_meta
+                            WHERE key = 'bulk_load_after')
+                  AND uuid IS NULL;
+            INSERT OR IGNORE INTO sync_log (uuid, modified_at)
+                SELECT uuid, updated_at FROM todos
+                WHERE id > (SELECT CAST(value AS INTEGER) FROM sync_meta
+                            WHERE key = 'bulk_load_after')
+                ORDER BY id;
+            DELETE FROM sync_meta WHERE key = 'bulk_load_after';
+        )")) {
+        return false;
+    }
+
+    if (!backfill) return true;
+
+    // Existing rows from before sync: give them identities and log them once
+    if (!beginTransaction()) return false;
+    if (!executeSQL(R"(
+            UPDATE todos SET uuid = randomblob(16) WHERE uuid IS NULL;
+            INSERT OR IGNORE INTO sync_log (uuid, modified_at)
+                SELECT uuid, updated_at FROM todos ORDER BY id;
+        )")) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
+bool TodoDatabase::hasColumn(const std::string& table, const std::string& column) {
+    if (!db) return false;
+
+    // table_xinfo (unlike table_info) also lists generated columns
+    std::string pragma = "PRAGMA table_xinfo(" + table + ");";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, pragma.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare table_xinfo");
+        return false;
+    }
+
+    bool exists = false;
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        const char* name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        if (name && column == name) {
+            exists = true;
+            break;
+        }
+    }
+    sqlite3_finalize(stmt);
+    return exists;
+}
+
+bool TodoDatabase::ensureColumn(const std::string& table, const std::string& column,
+                                const std::string& definition) {
+    if (!db) return false;
+    if (hasColumn(table, column)) return true;
+    return executeSQL("ALTER TABLE " + table + " ADD COLUMN " + column + " " + definition + ";");
 }
 
 bool TodoDatabase::executeSQL(const std::string& sql) {
@@ -62,19 +682,96 @@ bool TodoDatabase::executeSQL(const std::string& sql) {
     return true;
 }
 
+sqlite3_stmt* TodoDatabase::cachedStatement(const char* sql, const std::string& operation) {
+    if (!db) return nullptr;
+
+    auto it = statementCache.find(sql);
+    if (it != statementCache.end()) {
+        sqlite3_reset(it->second);
+        sqlite3_clear_bindings(it->second);
+        return it->second;
+    }
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v3(db, sql, -1, SQLITE_PREPARE_PERSISTENT, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare " + operation);
+        return nullptr;
+    }
+
+    statementCache.emplace(sql, stmt);
+    return stmt;
+}
+
+bool TodoDatabase::beginTransaction() {
+    return executeSQL("BEGIN IMMEDIATE;");
+}
+
+bool TodoDatabase::commitTransaction() {
+    static Metrics::Histogram& latency = callLatency("commit");
+    Metrics::ScopedTimer timer(latency);
+    return executeSQL("COMMIT;");
+}
+
+bool TodoDatabase::rollbackTransaction() {
+    return executeSQL("ROLLBACK;");
+}
+
 void TodoDatabase::handleError(const std::string& operation) {
+    static Metrics::Counter& errors = Metrics::counter("todo_db_errors_total", "Failed SQLite calls");
+    errors.add();
+
     if (db) {
         std::cerr << operation << " failed: " << sqlite3_errmsg(db) << std::endl;
     }
 }
 
+Todo TodoDatabase::readTodo(sqlite3_stmt* stmt) {
+    Todo todo;
+
+    todo.setId(sqlite3_column_int(stmt, 0));
+    todo.setTitle(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
+
+    if (sqlite3_column_text(stmt, 2)) {
+        todo.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
+    }
+
+    if (sqlite3_column_text(stmt, 3)) {
+        todo.setCategory(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
+    }
+
+    todo.setCompleted(sqlite3_column_int(stmt, 4) == 1);
+
+    if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) {
+        todo.setDueDate(sqlite3_column_int64(stmt, 7));
+    }
+
+    todo.setPriority(sqlite3_column_int(stmt, 8));
+
+    if (sqlite3_column_type(stmt, 9) != SQLITE_NULL) {
+        todo.setParentId(sqlite3_column_int(stmt, 9));
+    }
+
+    todo.setManualRank(sqlite3_column_double(stmt, 10));
+
+    // Setters above bump updated_at, so restore stored timestamps last
+    todo.setCreatedAt(sqlite3_column_int64(stmt, 5));
+    todo.setUpdatedAt(sqlite3_column_int64(stmt, 6));
+
+    return todo;
+}
+
 bool TodoDatabase::createTodo(Todo& todo) {
+    static Metrics::Histogram& latency = callLatency("create");
+    Metrics::ScopedTimer timer(latency);
     if (!db) return false;
 
     const char* sql = R"(
-        INSERT INTO todos (title, description, category, completed,
-                          created_at, updated_at, due_date, priority)
-        VALUES (?, ?, ?, ?, ?, ?, ?, ?);
+        INSERT INTO todos (title, description, category, completed, created_at, updated_at,
+                          due_date, priority, uuid, parent_id, manual_rank, completed_at, completed_day)
+        VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10,
+                (SELECT IFNULL(MAX(manual_rank), 0) + 1 FROM todos WHERE parent_id IS ?10),
+                CASE WHEN ?4 != 0 THEN ?6 END,
+                CASE WHEN ?4 != 0 THEN )" LOCAL_DAY("?6") R"( END);
     )";
 
     sqlite3_stmt* stmt;
@@ -99,6 +796,8 @@ bool TodoDatabase::createTodo(Todo& todo) {
     }
 
     sqlite3_bind_int(stmt, 8, todo.getPriority());
+    bindNewUuid(stmt, 9);
+    bindParentId(stmt, 10, todo.getParentId());
 
     int result = sqlite3_step(stmt);
 
@@ -114,11 +813,102 @@ bool TodoDatabase::createTodo(Todo& todo) {
     }
 }
 
+bool TodoDatabase::createTodos(std::vector<Todo>& todos) {
+    static Metrics::Histogram& latency = callLatency("create_batch");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+    if (todos.empty()) return true;
+
+    const char* sql = R"(
+        INSERT INTO todos (title, description, category, completed, created_at, updated_at,
+                          due_date, priority, uuid, parent_id, manual_rank, completed_at, completed_day)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CASE WHEN ?4 != 0 THEN ?6 END, ?12);
+    )";
+
+    // Join the caller's transaction if there is one
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) {
+        return false;
+    }
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare bulk INSERT");
+        if (ownsTransaction) rollbackTransaction();
+        return false;
+    }
+
+    // Each new row goes last among its siblings. Ranks are counted here
+    // rather than looked up per row: during a bulk load idx_manual_order is
+    // gone and every lookup would scan the table, so then they are counted
+    // across batches too.
+    std::unordered_map<int, double> batchRanks;
+    std::unordered_map<int, double>& lastRanks = bulkLastRanks ? *bulkLastRanks : batchRanks;
+    // A bulk load drops tree_todo_parent; its check is made here instead
+    bool checkParents = !hasTrigger("tree_todo_parent");
+
+    bool ok = true;
+    for (Todo& todo : todos) {
+        int parentKey = todo.getParentId().value_or(0);
+        auto rank = lastRanks.find(parentKey);
+        if (rank == lastRanks.end()) {
+            if (checkParents && todo.getParentId() && !todoExists(*todo.getParentId())) {
+                std::cerr << "Execute bulk INSERT failed: parent todo does not exist" << std::endl;
+                ok = false;
+                break;
+            }
+            rank = lastRanks.emplace(parentKey, lastManualRank(todo.getParentId())).first;
+        }
+        rank->second += 1;
+        todo.setManualRank(rank->second);
+
+        sqlite3_bind_text(stmt, 1, todo.getTitle().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, todo.getDescription().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, todo.getCategory().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, todo.isCompleted() ? 1 : 0);
+        sqlite3_bind_int64(stmt, 5, todo.getCreatedAt());
+        sqlite3_bind_int64(stmt, 6, todo.getUpdatedAt());
+
+        if (todo.getDueDate().has_value()) {
+            sqlite3_bind_int64(stmt, 7, todo.getDueDate().value());
+        } else {
+            sqlite3_bind_null(stmt, 7);
+        }
+
+        sqlite3_bind_int(stmt, 8, todo.getPriority());
+        bindNewUuid(stmt, 9);
+        bindParentId(stmt, 10, todo.getParentId());
+        sqlite3_bind_double(stmt, 11, todo.getManualRank());
+        bindCompletedDay(stmt, 12, todo);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            handleError("Execute bulk INSERT");
+            ok = false;
+            break;
+        }
+
+        todo.setId(sqlite3_last_insert_rowid(db));
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
 std::vector<Todo> TodoDatabase::getAllTodos() {
+    static Metrics::Histogram& latency = callLatency("get_all");
+    Metrics::ScopedTimer timer(latency);
     std::vector<Todo> todos;
     if (!db) return todos;
 
-    const char* sql = "SELECT * FROM todos ORDER BY created_at DESC;";
+    const char* sql = "SELECT " TODO_COLUMNS " FROM todos ORDER BY created_at DESC;";
     sqlite3_stmt* stmt;
 
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -127,30 +917,7 @@ std::vector<Todo> TodoDatabase::getAllTodos() {
     }
 
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Todo todo;
-        
-        todo.setId(sqlite3_column_int(stmt, 0));
-        todo.setTitle(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        
-        if (sqlite3_column_text(stmt, 2)) {
-            todo.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        }
-        
-        if (sqlite3_column_text(stmt, 3)) {
-            todo.setCategory(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
-        }
-        
-        todo.setCompleted(sqlite3_column_int(stmt, 4) == 1);
-
-        // created_at and updated_at are stored but not settable via current API
-
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) {
-            todo.setDueDate(sqlite3_column_int64(stmt, 7));
-        }
-        
-        todo.setPriority(sqlite3_column_int(stmt, 8));
-        
-        todos.push_back(todo);
+        todos.push_back(readTodo(stmt));
     }
     
     sqlite3_finalize(stmt);
@@ -158,10 +925,12 @@ std::vector<Todo> TodoDatabase::getAllTodos() {
 }
 
 std::vector<Todo> TodoDatabase::getTodosByCategory(const std::string& category) {
+    static Metrics::Histogram& latency = callLatency("get_by_category");
+    Metrics::ScopedTimer timer(latency);
     std::vector<Todo> todos;
     if (!db) return todos;
     
-    const char* sql = "SELECT * FROM todos WHERE category = ? ORDER BY created_at DESC;";
+    const char* sql = "SELECT " TODO_COLUMNS " FROM todos WHERE category = ? ORDER BY created_at DESC;";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -172,36 +941,77 @@ std::vector<Todo> TodoDatabase::getTodosByCategory(const std::string& category)
     sqlite3_bind_text(stmt, 1, category.c_str(), -1, SQLITE_TRANSIENT);
     
     while (sqlite3_step(stmt) == SQLITE_ROW) {
-        Todo todo;
-        todo.setId(sqlite3_column_int(stmt, 0));
-        todo.setTitle(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        
-        if (sqlite3_column_text(stmt, 2)) {
-            todo.setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        }
-        
-        if (sqlite3_column_text(stmt, 3)) {
-            todo.setCategory(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
-        }
-        
-        todo.setCompleted(sqlite3_column_int(stmt, 4) == 1);
-        
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) {
-            todo.setDueDate(sqlite3_column_int64(stmt, 7));
-        }
-        
-        todo.setPriority(sqlite3_column_int(stmt, 8));
-        todos.push_back(todo);
+        todos.push_back(readTodo(stmt));
     }
     
     sqlite3_finalize(stmt);
     return todos;
 }
 
+std::vector<Todo> TodoDatabase::getTodosDueBetween(time_t start, time_t end, int limit) {
+    static Metrics::Histogram& latency = callLatency("due_between");
+    Metrics::ScopedTimer timer(latency);
+    std::vector<Todo> todos;
+
+    // Cached: a calendar asks once per visible day
+    sqlite3_stmt* stmt = cachedStatement(
+        "SELECT " TODO_COLUMNS " FROM todos WHERE due_date >= ?1 AND due_date < ?2"
+        " ORDER BY due_date, id LIMIT ?3;",
+        "SELECT due between");
+    if (!stmt) return todos;
+
+    sqlite3_bind_int64(stmt, 1, start);
+    sqlite3_bind_int64(stmt, 2, end);
+    sqlite3_bind_int(stmt, 3, limit);
+
+    int result;
+    while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+        todos.push_back(readTodo(stmt));
+    }
+    sqlite3_reset(stmt);
+
+    if (result != SQLITE_DONE) handleError("Step SELECT due between");
+    return todos;
+}
+
+int TodoDatabase::countTodosDueBetween(time_t start, time_t end) {
+    static Metrics::Histogram& latency = callLatency("count_due_between");
+    Metrics::ScopedTimer timer(latency);
+
+    sqlite3_stmt* stmt = cachedStatement(
+        "SELECT COUNT(*) FROM todos WHERE due_date >= ?1 AND due_date < ?2;", "SELECT count due between");
+    if (!stmt) return 0;
+
+    sqlite3_bind_int64(stmt, 1, start);
+    sqlite3_bind_int64(stmt, 2, end);
+    int count = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : 0;
+    sqlite3_reset(stmt);
+    return count;
+}
+
+std::optional<std::pair<time_t, time_t>> TodoDatabase::getDueDateSpan() {
+    if (!db) return std::nullopt;
+
+    // Both ends of idx_due_date
+    sqlite3_stmt* stmt = cachedStatement(
+        "SELECT (SELECT MIN(due_date) FROM todos), (SELECT MAX(due_date) FROM todos);", "SELECT due span");
+    if (!stmt) return std::nullopt;
+
+    std::optional<std::pair<time_t, time_t>> span;
+    if (sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL) {
+        span = std::make_pair(static_cast<time_t>(sqlite3_column_int64(stmt, 0)),
+                              static_cast<time_t>(sqlite3_column_int64(stmt, 1)));
+    }
+    sqlite3_reset(stmt);
+    return span;
+}
+
 std::unique_ptr<Todo> TodoDatabase::getTodoById(int id) {
+    static Metrics::Histogram& latency = callLatency("get_by_id");
+    Metrics::ScopedTimer timer(latency);
     if (!db) return nullptr;
     
-    const char* sql = "SELECT * FROM todos WHERE id = ?;";
+    const char* sql = "SELECT " TODO_COLUMNS " FROM todos WHERE id = ?;";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -212,27 +1022,7 @@ std::unique_ptr<Todo> TodoDatabase::getTodoById(int id) {
     sqlite3_bind_int(stmt, 1, id);
     
     if (sqlite3_step(stmt) == SQLITE_ROW) {
-        auto todo = std::make_unique<Todo>();
-        
-        todo->setId(sqlite3_column_int(stmt, 0));
-        todo->setTitle(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1)));
-        
-        if (sqlite3_column_text(stmt, 2)) {
-            todo->setDescription(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 2)));
-        }
-        
-        if (sqlite3_column_text(stmt, 3)) {
-            todo->setCategory(reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3)));
-        }
-        
-        todo->setCompleted(sqlite3_column_int(stmt, 4) == 1);
-        
-        if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) {
-            todo->setDueDate(sqlite3_column_int64(stmt, 7));
-        }
-        
-        todo->setPriority(sqlite3_column_int(stmt, 8));
-        
+        auto todo = std::make_unique<Todo>(readTodo(stmt));
         sqlite3_finalize(stmt);
         return todo;
     }
@@ -242,13 +1032,18 @@ std::unique_ptr<Todo> TodoDatabase::getTodoById(int id) {
 }
 
 bool TodoDatabase::updateTodo(const Todo& todo) {
+    static Metrics::Histogram& latency = callLatency("update");
+    Metrics::ScopedTimer timer(latency);
     if (!db) return false;
     
     const char* sql = R"(
         UPDATE todos 
-        SET title = ?, description = ?, category = ?, completed = ?,
-            updated_at = ?, due_date = ?, priority = ?
-        WHERE id = ?;
+        SET title = ?1, description = ?2, category = ?3, completed = ?4,
+            updated_at = ?5, due_date = ?6, priority = ?7, parent_id = ?8,
+            manual_rank = CASE WHEN parent_id IS ?8 THEN manual_rank
+                               ELSE (SELECT IFNULL(MAX(manual_rank), 0) + 1 FROM todos
+                                     WHERE parent_id IS ?8) END
+        WHERE id = ?9;
     )";
     
     sqlite3_stmt* stmt;
@@ -271,18 +1066,28 @@ bool TodoDatabase::updateTodo(const Todo& todo) {
     }
     
     sqlite3_bind_int(stmt, 7, todo.getPriority());
-    sqlite3_bind_int(stmt, 8, todo.getId());
+    bindParentId(stmt, 8, todo.getParentId());
+    sqlite3_bind_int(stmt, 9, todo.getId());
     
     int result = sqlite3_step(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Execute UPDATE");
+    }
     sqlite3_finalize(stmt);
     
     return result == SQLITE_DONE;
 }
 
 bool TodoDatabase::deleteTodo(int id) {
+    static Metrics::Histogram& latency = callLatency("delete");
+    Metrics::ScopedTimer timer(latency);
     if (!db) return false;
     
-    const char* sql = "DELETE FROM todos WHERE id = ?;";
+    // Subtasks go with their parent
+    const char* sql = R"(
+        DELETE FROM todos
+        WHERE id = ?1 OR id IN (SELECT descendant FROM todo_tree WHERE ancestor = ?1);
+    )";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -298,11 +1103,848 @@ bool TodoDatabase::deleteTodo(int id) {
     return result == SQLITE_DONE;
 }
 
-std::vector<std::string> TodoDatabase::getAllCategories() {
+void TodoBulkChange::applyTo(Todo& todo) const {
+    if (completed) todo.setCompleted(*completed);
+    if (category) todo.setCategory(*category);
+    if (priority) todo.setPriority(*priority);
+}
+
+int TodoDatabase::updateTodos(const std::vector<int>& ids, const TodoBulkChange& change,
+                              std::vector<Todo>* before) {
+    static Metrics::Histogram& latency = callLatency("update_batch");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+    if (ids.empty() || change.empty()) return 0;
+
+    // Only the fields being set, and only on rows where one differs
+    std::string set = "updated_at = ?1";
+    std::string differs;
+    auto addField = [&](const char* column, const char* param) {
+        set += std::string(", ") + column + " = " + param;
+        if (!differs.empty()) differs += " OR ";
+        differs += std::string(column) + " IS NOT " + param;
+    };
+    if (change.completed) addField("completed", "?3");
+    if (change.category) addField("category", "?4");
+    if (change.priority) addField("priority", "?5");
+    std::string sql = "UPDATE todos SET " + set + " WHERE id = ?2 AND (" + differs + ");";
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return -1;
+
+    sqlite3_stmt* stmt;
+    sqlite3_stmt* select = nullptr;
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare bulk UPDATE");
+        if (ownsTransaction) rollbackTransaction();
+        return -1;
+    }
+    if (before && sqlite3_prepare_v2(db, "SELECT " TODO_COLUMNS " FROM todos WHERE id = ?;", -1,
+                                     &select, nullptr) != SQLITE_OK) {
+        handleError("Prepare bulk UPDATE SELECT");
+        sqlite3_finalize(stmt);
+        if (ownsTransaction) rollbackTransaction();
+        return -1;
+    }
+
+    sqlite3_bind_int64(stmt, 1, std::time(nullptr));
+    if (change.completed) sqlite3_bind_int(stmt, 3, *change.completed ? 1 : 0);
+    if (change.category) sqlite3_bind_text(stmt, 4, change.category->c_str(), -1, SQLITE_TRANSIENT);
+    if (change.priority) sqlite3_bind_int(stmt, 5, *change.priority);
+
+    // In rowid order, so consecutive updates land on the same table pages
+    std::vector<int> sorted(ids);
+    std::sort(sorted.begin(), sorted.end());
+
+    int written = 0;
+    bool ok = true;
+    for (int id : sorted) {
+        std::optional<Todo> old;
+        if (select) {
+            sqlite3_bind_int(select, 1, id);
+            if (sqlite3_step(select) == SQLITE_ROW) old = readTodo(select);
+            sqlite3_reset(select);
+        }
+
+        sqlite3_bind_int(stmt, 2, id);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            handleError("Execute bulk UPDATE");
+            ok = false;
+            break;
+        }
+        sqlite3_reset(stmt);
+
+        if (sqlite3_changes(db) > 0) {
+            written++;
+            if (old) before->push_back(std::move(*old));
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_finalize(select);
+
+    if (!ownsTransaction) return ok ? written : -1;
+    if (!ok) {
+        rollbackTransaction();
+        return -1;
+    }
+    return commitTransaction() ? written : -1;
+}
+
+int TodoDatabase::deleteTodos(const std::vector<int>& ids, std::vector<Todo>* before) {
+    static Metrics::Histogram& latency = callLatency("delete_batch");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+    if (ids.empty()) return 0;
+
+    // Same subtree delete as deleteTodo(). An id inside a subtree deleted
+    // earlier in the batch is already gone and matches nothing.
+    const char* sql = R"(
+        DELETE FROM todos
+        WHERE id = ?1 OR id IN (SELECT descendant FROM todo_tree WHERE ancestor = ?1);
+    )";
+    const char* selectSql = "SELECT " TODO_COLUMNS " FROM todos"
+                            " WHERE id = ?1 OR id IN (SELECT descendant FROM todo_tree WHERE ancestor = ?1);";
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return -1;
+
+    sqlite3_stmt* stmt;
+    sqlite3_stmt* select = nullptr;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare bulk DELETE");
+        if (ownsTransaction) rollbackTransaction();
+        return -1;
+    }
+    if (before && sqlite3_prepare_v2(db, selectSql, -1, &select, nullptr) != SQLITE_OK) {
+        handleError("Prepare bulk DELETE SELECT");
+        sqlite3_finalize(stmt);
+        if (ownsTransaction) rollbackTransaction();
+        return -1;
+    }
+
+    int deleted = 0;
+    bool ok = true;
+    for (int id : ids) {
+        if (select) {
+            sqlite3_bind_int(select, 1, id);
+            while (sqlite3_step(select) == SQLITE_ROW) {
+                before->push_back(readTodo(select));
+            }
+            sqlite3_reset(select);
+        }
+
+        sqlite3_bind_int(stmt, 1, id);
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            handleError("Execute bulk DELETE");
+            ok = false;
+            break;
+        }
+        sqlite3_reset(stmt);
+        deleted += sqlite3_changes(db);
+    }
+
+    sqlite3_finalize(stmt);
+    sqlite3_finalize(select);
+
+    if (!ownsTransaction) return ok ? deleted : -1;
+    if (!ok) {
+        rollbackTransaction();
+        return -1;
+    }
+    return commitTransaction() ? deleted : -1;
+}
+
+bool TodoDatabase::restoreTodos(const std::vector<Todo>& todos) {
+    static Metrics::Histogram& latency = callLatency("restore_batch");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+    if (todos.empty()) return true;
+
+    // The tree triggers need every parent in place first: order by depth
+    // within the batch (parents outside it already exist)
+    std::unordered_map<int, std::optional<int>> parents;
+    for (const Todo& todo : todos) parents[todo.getId()] = todo.getParentId();
+    auto depth = [&parents](const Todo& todo) {
+        int levels = 0;
+        for (auto parent = todo.getParentId(); parent && levels <= static_cast<int>(parents.size());
+             levels++) {
+            auto it = parents.find(*parent);
+            if (it == parents.end()) break;
+            parent = it->second;
+        }
+        return levels;
+    };
+    std::vector<std::pair<int, const Todo*>> ordered;
+    ordered.reserve(todos.size());
+    for (const Todo& todo : todos) ordered.emplace_back(depth(todo), &todo);
+    std::stable_sort(ordered.begin(), ordered.end(),
+                     [](const auto& a, const auto& b) { return a.first < b.first; });
+
+    const char* sql = R"(
+        INSERT INTO todos (id, title, description, category, completed, created_at, updated_at,
+                           due_date, priority, uuid, parent_id, manual_rank, completed_at, completed_day)
+        VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, CASE WHEN ?5 != 0 THEN ?7 END, ?13);
+    )";
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return false;
+
+    sqlite3_stmt* stmt;
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare restore INSERT");
+        if (ownsTransaction) rollbackTransaction();
+        return false;
+    }
+
+    bool ok = true;
+    for (const auto& [level, todo] : ordered) {
+        sqlite3_bind_int(stmt, 1, todo->getId());
+        sqlite3_bind_text(stmt, 2, todo->getTitle().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, todo->getDescription().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 4, todo->getCategory().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 5, todo->isCompleted() ? 1 : 0);
+        sqlite3_bind_int64(stmt, 6, todo->getCreatedAt());
+        sqlite3_bind_int64(stmt, 7, todo->getUpdatedAt());
+        if (todo->getDueDate().has_value()) {
+            sqlite3_bind_int64(stmt, 8, todo->getDueDate().value());
+        } else {
+            sqlite3_bind_null(stmt, 8);
+        }
+        sqlite3_bind_int(stmt, 9, todo->getPriority());
+        bindNewUuid(stmt, 10);
+        bindParentId(stmt, 11, todo->getParentId());
+        sqlite3_bind_double(stmt, 12, todo->getManualRank());
+        bindCompletedDay(stmt, 13, *todo);
+
+        if (sqlite3_step(stmt) != SQLITE_DONE) {
+            handleError("Execute restore INSERT");
+            ok = false;
+            break;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    sqlite3_finalize(stmt);
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
+TodoPageCursor TodoPageCursor::fromTodo(const Todo& todo) {
+    TodoPageCursor cursor;
+    cursor.completed = todo.isCompleted();
+    cursor.priority = todo.getPriority();
+    cursor.due_date = todo.getDueDate();
+    cursor.created_at = todo.getCreatedAt();
+    cursor.id = todo.getId();
+    cursor.manual_rank = todo.getManualRank();
+    return cursor;
+}
+
+std::vector<Todo> TodoDatabase::getTodosPage(const std::optional<TodoPageCursor>& after, int limit,
+                                             const std::optional<std::string>& category) {
+    static Metrics::Histogram& latency = callLatency("get_page");
+    Metrics::ScopedTimer timer(latency);
+    std::vector<Todo> todos;
+    if (!db) return todos;
+
+    // Same ordering as the list view, served by idx_list_order /
+    // idx_category_list_order without a temp B-tree sort
+    std::string sql = "SELECT " TODO_COLUMNS " FROM todos WHERE 1";
+    if (category) {
+        sql += " AND category = ?";
+    }
+    if (after) {
+        sql += " AND (completed, list_key_priority, list_key_due, list_key_created, id)"
+               " > (?, ?, ?, ?, ?)";
+    }
+    sql += " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id LIMIT ?;";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT page");
+        return todos;
+    }
+
+    int param = 1;
+    if (category) {
+        sqlite3_bind_text(stmt, param++, category->c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (after) {
+        sqlite3_bind_int(stmt, param++, after->completed ? 1 : 0);
+        sqlite3_bind_int(stmt, param++, -after->priority);
+        sqlite3_bind_int64(stmt, param++, after->due_date.value_or(INT64_MAX));
+        sqlite3_bind_int64(stmt, param++, -static_cast<sqlite3_int64>(after->created_at));
+        sqlite3_bind_int(stmt, param++, after->id);
+    }
+    sqlite3_bind_int(stmt, param, limit);
+
+    todos.reserve(limit);
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        todos.push_back(readTodo(stmt));
+    }
+
+    sqlite3_finalize(stmt);
+    return todos;
+}
+
+std::optional<TodoPageCursor> TodoDatabase::getPageCursorAt(int offset,
+                                                           const std::optional<std::string>& category) {
+    static Metrics::Histogram& latency = callLatency("get_page_cursor");
+    Metrics::ScopedTimer timer(latency);
+    if (!db || offset < 0) return std::nullopt;
+
+    // The offset is walked in idx_list_order / idx_category_list_order and
+    // only the key of the row it lands on is read
+    sqlite3_stmt* stmt = category
+        ? cachedStatement("SELECT completed, list_key_priority, list_key_due, list_key_created, id"
+                          " FROM todos WHERE category = ?1"
+                          " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id"
+                          " LIMIT 1 OFFSET ?2;", "SELECT page cursor")
+        : cachedStatement("SELECT completed, list_key_priority, list_key_due, list_key_created, id"
+                          " FROM todos"
+                          " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id"
+                          " LIMIT 1 OFFSET ?2;", "SELECT page cursor");
+    if (!stmt) return std::nullopt;
+
+    if (category) {
+        sqlite3_bind_text(stmt, 1, category->c_str(), -1, SQLITE_TRANSIENT);
+    }
+    sqlite3_bind_int(stmt, 2, offset);
+
+    std::optional<TodoPageCursor> cursor;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        cursor.emplace();
+        cursor->completed = sqlite3_column_int(stmt, 0) != 0;
+        cursor->priority = -sqlite3_column_int(stmt, 1);
+        sqlite3_int64 due = sqlite3_column_int64(stmt, 2);
+        if (due != INT64_MAX) cursor->due_date = static_cast<time_t>(due);
+        cursor->created_at = static_cast<time_t>(-sqlite3_column_int64(stmt, 3));
+        cursor->id = sqlite3_column_int(stmt, 4);
+    }
+    sqlite3_reset(stmt);
+    return cursor;
+}
+
+bool TodoDatabase::streamTodos(sqlite3_stmt* stmt, const std::function<bool(const Todo&)>& visit) {
+    int result;
+    while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+        if (!visit(readTodo(stmt))) {
+            result = SQLITE_DONE;
+            break;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Step SELECT");
+        return false;
+    }
+    return true;
+}
+
+bool TodoDatabase::forEachTodo(const std::function<bool(const Todo&)>& visit,
+                               const std::optional<std::string>& category) {
+    static Metrics::Histogram& latency = callLatency("for_each");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    std::string sql = "SELECT " TODO_COLUMNS " FROM todos";
+    if (category) {
+        sql += " WHERE category = ?";
+    }
+    sql += " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id;";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT stream");
+        return false;
+    }
+
+    if (category) {
+        sqlite3_bind_text(stmt, 1, category->c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    return streamTodos(stmt, visit);
+}
+
+bool TodoDatabase::searchTodos(const std::string& query,
+                               const std::function<bool(const Todo&)>& visit) {
+    static Metrics::Histogram& latency = callLatency("search");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    const char* sql = "SELECT " TODO_COLUMNS " FROM todos" R"(
+        WHERE title LIKE ?1 ESCAPE '\' OR description LIKE ?1 ESCAPE '\'
+        ORDER BY completed, list_key_priority, list_key_due, list_key_created, id;
+    )";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT search");
+        return false;
+    }
+
+    // Match the query literally: escape LIKE wildcards
+    std::string pattern = "%";
+    for (char c : query) {
+        if (c == '%' || c == '_' || c == '\\') pattern += '\\';
+        pattern += c;
+    }
+    pattern += '%';
+    sqlite3_bind_text(stmt, 1, pattern.c_str(), -1, SQLITE_TRANSIENT);
+
+    return streamTodos(stmt, visit);
+}
+
+std::vector<TodoNode> TodoDatabase::getChildrenPage(std::optional<int> parentId,
+                                                  const std::optional<TodoPageCursor>& after, int limit,
+                                                  const std::optional<std::string>& category,
+                                                  TodoOrder order) {
+    static Metrics::Histogram& latency = callLatency("get_children_page");
+    Metrics::ScopedTimer timer(latency);
+    std::vector<TodoNode> nodes;
+    if (!db) return nodes;
+
+    // Rollups are two range scans of todo_tree per row, from the primary key
+    // and then joined to each descendant; list order comes from
+    // idx_parent_list_order like getTodosPage(), manual order from
+    // idx_manual_order
+    std::string sql = "SELECT " TODO_COLUMNS ","
+                      " (SELECT COUNT(*) FROM todo_tree WHERE ancestor = todos.id),"
+                      " (SELECT COUNT(*) FROM todo_tree JOIN todos AS d ON d.id = todo_tree.descendant"
+                      "  WHERE todo_tree.ancestor = todos.id AND d.completed = 1)"
+                      " FROM todos WHERE ";
+    sql += parentId ? "parent_id = ?" : "parent_id IS NULL";
+    if (category && !parentId) {
+        sql += " AND category = ?";
+    }
+    if (order == TodoOrder::Manual) {
+        if (after) {
+            sql += " AND (manual_rank, id) > (?, ?)";
+        }
+        sql += " ORDER BY manual_rank, id LIMIT ?;";
+    } else {
+        if (after) {
+            sql += " AND (completed, list_key_priority, list_key_due, list_key_created, id)"
+                   " > (?, ?, ?, ?, ?)";
+        }
+        sql += " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id LIMIT ?;";
+    }
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT children");
+        return nodes;
+    }
+
+    int param = 1;
+    if (parentId) {
+        sqlite3_bind_int(stmt, param++, *parentId);
+    } else if (category) {
+        sqlite3_bind_text(stmt, param++, category->c_str(), -1, SQLITE_TRANSIENT);
+    }
+    if (after && order == TodoOrder::Manual) {
+        sqlite3_bind_double(stmt, param++, after->manual_rank);
+        sqlite3_bind_int(stmt, param++, after->id);
+    } else if (after) {
+        sqlite3_bind_int(stmt, param++, after->completed ? 1 : 0);
+        sqlite3_bind_int(stmt, param++, -after->priority);
+        sqlite3_bind_int64(stmt, param++, after->due_date.value_or(INT64_MAX));
+        sqlite3_bind_int64(stmt, param++, -static_cast<sqlite3_int64>(after->created_at));
+        sqlite3_bind_int(stmt, param++, after->id);
+    }
+    sqlite3_bind_int(stmt, param, limit);
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        TodoNode node;
+        node.todo = readTodo(stmt);
+        node.descendants = sqlite3_column_int(stmt, 11);
+        node.completedDescendants = sqlite3_column_int(stmt, 12);
+        nodes.push_back(std::move(node));
+    }
+
+    sqlite3_finalize(stmt);
+    return nodes;
+}
+
+bool TodoDatabase::forEachDescendant(int id, const std::function<bool(const Todo&)>& visit) {
+    static Metrics::Histogram& latency = callLatency("for_each_descendant");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    const char* sql = "SELECT " TODO_COLUMNS " FROM todo_tree JOIN todos ON todos.id = todo_tree.descendant"
+                      " WHERE todo_tree.ancestor = ? ORDER BY todo_tree.depth, todos.id;";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT descendants");
+        return false;
+    }
+
+    sqlite3_bind_int(stmt, 1, id);
+    return streamTodos(stmt, visit);
+}
+
+TodoSubtreeProgress TodoDatabase::getSubtreeProgress(int id) {
+    static Metrics::Histogram& latency = callLatency("get_subtree_progress");
+    Metrics::ScopedTimer timer(latency);
+    TodoSubtreeProgress progress;
+    if (!db) return progress;
+
+    const char* sql = R"(
+        SELECT COUNT(*), IFNULL(SUM(todos.completed), 0)
+        FROM todo_tree JOIN todos ON todos.id = todo_tree.descendant
+        WHERE todo_tree.ancestor = ?;
+    )";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT subtree progress");
+        return progress;
+    }
+
+    sqlite3_bind_int(stmt, 1, id);
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        progress.descendants = sqlite3_column_int(stmt, 0);
+        progress.completed = sqlite3_column_int(stmt, 1);
+    }
+
+    sqlite3_finalize(stmt);
+    return progress;
+}
+
+bool TodoDatabase::moveTodo(int id, std::optional<int> newParentId) {
+    static Metrics::Histogram& latency = callLatency("move");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    // The triggers check the parent and rewrite the closure rows of the
+    // subtree. A new parent puts it last among its new siblings.
+    const char* sql = R"(
+        UPDATE todos
+        SET manual_rank = CASE WHEN parent_id IS ?1 THEN manual_rank
+                               ELSE (SELECT IFNULL(MAX(manual_rank), 0) + 1 FROM todos
+                                     WHERE parent_id IS ?1) END,
+            parent_id = ?1, updated_at = ?2
+        WHERE id = ?3;
+    )";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare UPDATE parent");
+        return false;
+    }
+
+    bindParentId(stmt, 1, newParentId);
+    sqlite3_bind_int64(stmt, 2, std::time(nullptr));
+    sqlite3_bind_int(stmt, 3, id);
+
+    int result = sqlite3_step(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Execute UPDATE parent");
+    }
+    sqlite3_finalize(stmt);
+
+    return result == SQLITE_DONE && sqlite3_changes(db) > 0;
+}
+
+bool TodoDatabase::placeTodo(int id, std::optional<int> parentId, std::optional<int> beforeId) {
+    static Metrics::Histogram& latency = callLatency("place");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    // Ranks of the new neighbours: beforeId and the sibling just above it,
+    // or the last sibling. Both are seeks into idx_manual_order.
+    const char* beforeSql = R"(
+        SELECT b.manual_rank,
+               (SELECT MAX(manual_rank) FROM todos
+                WHERE parent_id IS ?1 AND manual_rank < b.manual_rank AND id <> ?2)
+        FROM todos b WHERE b.id = ?3 AND b.parent_id IS ?1;
+    )";
+    const char* lastSql = "SELECT MAX(manual_rank) FROM todos WHERE parent_id IS ?1 AND id <> ?2;";
+
+    std::optional<double> rank;
+    for (int attempt = 0; attempt < 2 && !rank; attempt++) {
+        sqlite3_stmt* stmt = cachedStatement(beforeId ? beforeSql : lastSql, "SELECT neighbour ranks");
+        if (!stmt) return false;
+
+        bindParentId(stmt, 1, parentId);
+        sqlite3_bind_int(stmt, 2, id);
+        if (beforeId) sqlite3_bind_int(stmt, 3, *beforeId);
+
+        if (sqlite3_step(stmt) != SQLITE_ROW) {
+            // beforeId is not a child of parentId
+            sqlite3_reset(stmt);
+            return false;
+        }
+
+        std::optional<double> above;
+        std::optional<double> below;
+        int aboveColumn = beforeId ? 1 : 0;
+        if (sqlite3_column_type(stmt, aboveColumn) != SQLITE_NULL) {
+            above = sqlite3_column_double(stmt, aboveColumn);
+        }
+        if (beforeId) below = sqlite3_column_double(stmt, 0);
+        sqlite3_reset(stmt);
+
+        if (above && below) {
+            double middle = *above + (*below - *above) / 2;
+            if (middle > *above && middle < *below) {
+                rank = middle;
+            } else if (respaceManualRanks(parentId) < 0) {
+                // Out of precision between the two; respace and look again
+                return false;
+            }
+        } else if (above) {
+            rank = *above + 1;
+        } else if (below) {
+            rank = *below - 1;
+        } else {
+            rank = 1;
+        }
+    }
+    if (!rank) return false;
+
+    // The only row written. Reordering is not a change to the todo, so it
+    // is neither timestamped nor synced: the common case sets manual_rank
+    // alone, since naming parent_id would fire sync_todo_update. Changing
+    // parent is a move and is both.
+    sqlite3_stmt* stmt = cachedStatement(
+        "UPDATE todos SET manual_rank = ?1 WHERE id = ?2 AND parent_id IS ?3;", "UPDATE manual rank");
+    if (!stmt) return false;
+
+    sqlite3_bind_double(stmt, 1, *rank);
+    sqlite3_bind_int(stmt, 2, id);
+    bindParentId(stmt, 3, parentId);
+
+    int result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Execute UPDATE manual rank");
+        return false;
+    }
+    if (sqlite3_changes(db) > 0) return true;
+
+    stmt = cachedStatement(
+        "UPDATE todos SET parent_id = ?1, manual_rank = ?2, updated_at = ?3 WHERE id = ?4;",
+        "UPDATE place todo");
+    if (!stmt) return false;
+
+    bindParentId(stmt, 1, parentId);
+    sqlite3_bind_double(stmt, 2, *rank);
+    sqlite3_bind_int64(stmt, 3, std::time(nullptr));
+    sqlite3_bind_int(stmt, 4, id);
+
+    result = sqlite3_step(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Execute UPDATE place todo");
+    }
+    sqlite3_reset(stmt);
+
+    return result == SQLITE_DONE && sqlite3_changes(db) > 0;
+}
+
+int TodoDatabase::rebalanceManualOrder(std::optional<int> parentId) {
+    static Metrics::Histogram& latency = callLatency("rebalance_manual_order");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+
+    // Smallest gap between neighbours, walking idx_manual_order once
+    const char* sql = R"(
+        SELECT MIN(gap) FROM (
+            SELECT manual_rank - LAG(manual_rank) OVER (ORDER BY manual_rank) AS gap
+            FROM todos WHERE parent_id IS ?);
+    )";
+
+    sqlite3_stmt* stmt = cachedStatement(sql, "SELECT manual rank gap");
+    if (!stmt) return -1;
+
+    bindParentId(stmt, 1, parentId);
+    bool crowded = sqlite3_step(stmt) == SQLITE_ROW && sqlite3_column_type(stmt, 0) != SQLITE_NULL &&
+                   sqlite3_column_double(stmt, 0) < kMinManualRankGap;
+    sqlite3_reset(stmt);
+
+    return crowded ? respaceManualRanks(parentId) : 0;
+}
+
+int TodoDatabase::respaceManualRanks(std::optional<int> parentId) {
+    // Whole numbers in the current order; one statement, so all or nothing
+    const char* sql = R"(
+        UPDATE todos SET manual_rank = ranked.n
+        FROM (SELECT id, ROW_NUMBER() OVER (ORDER BY manual_rank, id) AS n
+              FROM todos WHERE parent_id IS ?) AS ranked
+        WHERE todos.id = ranked.id;
+    )";
+
+    sqlite3_stmt* stmt = cachedStatement(sql, "UPDATE respace manual ranks");
+    if (!stmt) return -1;
+
+    bindParentId(stmt, 1, parentId);
+    int result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (result != SQLITE_DONE) {
+        handleError("Execute UPDATE respace manual ranks");
+        return -1;
+    }
+    return sqlite3_changes(db);
+}
+
+bool TodoDatabase::todoExists(int id) {
+    sqlite3_stmt* stmt = cachedStatement("SELECT 1 FROM todos WHERE id = ?;", "SELECT todo exists");
+    if (!stmt) return false;
+
+    sqlite3_bind_int(stmt, 1, id);
+    bool exists = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_reset(stmt);
+    return exists;
+}
+
+double TodoDatabase::lastManualRank(std::optional<int> parentId) {
+    sqlite3_stmt* stmt = cachedStatement(
+        "SELECT IFNULL(MAX(manual_rank), 0) FROM todos WHERE parent_id IS ?;", "SELECT last manual rank");
+    if (!stmt) return 0;
+
+    bindParentId(stmt, 1, parentId);
+    double rank = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_double(stmt, 0) : 0;
+    sqlite3_reset(stmt);
+    return rank;
+}
+
+void TodoDatabase::readRowView(sqlite3_stmt* stmt, TodoRowView& row) {
+    auto text = [stmt](int column, const char*& value, int& length) {
+        const unsigned char* data = sqlite3_column_text(stmt, column);
+        value = data ? reinterpret_cast<const char*>(data) : "";
+        length = data ? sqlite3_column_bytes(stmt, column) : 0;
+    };
+
+    row.id = sqlite3_column_int(stmt, 0);
+    text(1, row.title, row.titleLength);
+    text(2, row.description, row.descriptionLength);
+    text(3, row.category, row.categoryLength);
+    row.completed = sqlite3_column_int(stmt, 4) == 1;
+    row.created_at = sqlite3_column_int64(stmt, 5);
+    row.updated_at = sqlite3_column_int64(stmt, 6);
+    if (sqlite3_column_type(stmt, 7) != SQLITE_NULL) {
+        row.due_date = sqlite3_column_int64(stmt, 7);
+    } else {
+        row.due_date.reset();
+    }
+    row.priority = sqlite3_column_int(stmt, 8);
+    const void* uuid = sqlite3_column_blob(stmt, 9);
+    row.uuid = uuid ? static_cast<const char*>(uuid) : "";
+    row.uuidLength = uuid ? sqlite3_column_bytes(stmt, 9) : 0;
+}
+
+bool TodoDatabase::forEachTodoRow(const std::function<bool(const TodoRowView&)>& visit,
+                                  const std::optional<std::string>& category) {
+    static Metrics::Histogram& latency = callLatency("for_each_row");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    std::string sql = "SELECT id, title, description, category, completed, created_at,"
+                      " updated_at, due_date, priority, uuid FROM todos";
+    if (category) {
+        sql += " WHERE category = ?";
+    }
+    sql += " ORDER BY id;";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql.c_str(), -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT rows");
+        return false;
+    }
+
+    if (category) {
+        sqlite3_bind_text(stmt, 1, category->c_str(), -1, SQLITE_TRANSIENT);
+    }
+
+    int result;
+    TodoRowView row;
+    while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+        readRowView(stmt, row);
+        if (!visit(row)) {
+            result = SQLITE_DONE;
+            break;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Step SELECT rows");
+        return false;
+    }
+    return true;
+}
+
+int TodoDatabase::forEachTodoRowAfter(const std::optional<TodoPageCursor>& after, int limit,
+                                      const std::function<void(const TodoRowView&)>& visit) {
+    static Metrics::Histogram& latency = callLatency("for_each_row_after");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+
+    // idx_list_order from the cursor on, one slice per call
+    sqlite3_stmt* stmt = after
+        ? cachedStatement("SELECT id, title, description, category, completed, created_at,"
+                          " updated_at, due_date, priority, uuid FROM todos"
+                          " WHERE (completed, list_key_priority, list_key_due, list_key_created, id)"
+                          " > (?1, ?2, ?3, ?4, ?5)"
+                          " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id"
+                          " LIMIT ?6;", "SELECT rows after")
+        : cachedStatement("SELECT id, title, description, category, completed, created_at,"
+                          " updated_at, due_date, priority, uuid FROM todos"
+                          " ORDER BY completed, list_key_priority, list_key_due, list_key_created, id"
+                          " LIMIT ?6;", "SELECT rows after");
+    if (!stmt) return -1;
+
+    if (after) {
+        sqlite3_bind_int(stmt, 1, after->completed ? 1 : 0);
+        sqlite3_bind_int(stmt, 2, -after->priority);
+        sqlite3_bind_int64(stmt, 3, after->due_date.value_or(INT64_MAX));
+        sqlite3_bind_int64(stmt, 4, -static_cast<sqlite3_int64>(after->created_at));
+        sqlite3_bind_int(stmt, 5, after->id);
+    }
+    sqlite3_bind_int(stmt, 6, limit);
+
+    int visited = 0;
+    int result;
+    TodoRowView row;
+    while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+        readRowView(stmt, row);
+        visit(row);
+        visited++;
+    }
+
+    if (result != SQLITE_DONE) {
+        handleError("Step SELECT rows after");
+        visited = -1;
+    }
+    sqlite3_reset(stmt);
+    return visited;
+}
+
+std::vector<std::string> TodoDatabase::getAllCategories() {
+    static Metrics::Histogram& latency = callLatency("get_categories");
+    Metrics::ScopedTimer timer(latency);
     std::vector<std::string> categories;
     if (!db) return categories;
     
-    const char* sql = "SELECT DISTINCT category FROM todos ORDER BY category;";
+    const char* sql = "SELECT category FROM category_stats ORDER BY category;";
     sqlite3_stmt* stmt;
     
     if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
@@ -319,4 +1961,626 @@ std::vector<std::string> TodoDatabase::getAllCategories() {
     
     sqlite3_finalize(stmt);
     return categories;
-}
\ No newline at end of file
+}
+
+std::vector<CategoryCount> TodoDatabase::getCategoryCounts() {
+    static Metrics::Histogram& latency = callLatency("get_category_counts");
+    Metrics::ScopedTimer timer(latency);
+    std::vector<CategoryCount> counts;
+    if (!db) return counts;
+
+    // One row per category, kept by the stats triggers
+    const char* sql = "SELECT category, total, completed FROM category_stats ORDER BY category;";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT category counts");
+        return counts;
+    }
+
+    while (sqlite3_step(stmt) == SQLITE_ROW) {
+        CategoryCount count;
+        count.name = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+        count.total = sqlite3_column_int(stmt, 1);
+        count.completed = sqlite3_column_int(stmt, 2);
+        counts.push_back(count);
+    }
+
+    sqlite3_finalize(stmt);
+    return counts;
+}
+
+TodoCounts TodoDatabase::getTodoCounts() {
+    static Metrics::Histogram& latency = callLatency("get_counts");
+    Metrics::ScopedTimer timer(latency);
+    TodoCounts counts;
+    if (!db) return counts;
+
+    // Totals from category_stats. Overdue moves with the clock, so it is
+    // the open todos of every past day from due_stats plus those due
+    // earlier today, a short range of idx_due_date (the + keeps the planner
+    // off idx_list_order, which would walk every open todo).
+    const char* sql = R"(
+        SELECT IFNULL(SUM(total), 0),
+               IFNULL(SUM(completed), 0),
+               (SELECT IFNULL(SUM(open), 0) FROM due_stats WHERE day < ?1) +
+               (SELECT COUNT(*) FROM todos WHERE due_date >= ?1 * 86400 AND due_date < ?2 AND +completed = 0)
+        FROM category_stats;
+    )";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT counts");
+        return counts;
+    }
+
+    time_t now = std::time(nullptr);
+    sqlite3_bind_int64(stmt, 1, now / 86400);
+    sqlite3_bind_int64(stmt, 2, now);
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        counts.total = sqlite3_column_int(stmt, 0);
+        counts.completed = sqlite3_column_int(stmt, 1);
+        counts.overdue = sqlite3_column_int(stmt, 2);
+    }
+
+    sqlite3_finalize(stmt);
+
+    static Metrics::Gauge& rows = Metrics::gauge("todo_rows", "Todos in the database at the last count");
+    rows.set(counts.total);
+    return counts;
+}
+
+bool TodoDatabase::rebuildStats() {
+    static Metrics::Histogram& latency = callLatency("rebuild_stats");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("rebuildStats", "db");
+    if (!db) return false;
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return false;
+
+    bool ok = executeSQL(R"(
+        DELETE FROM category_stats;
+        -- Grouped by category itself, idx_category_list_order is read in
+        -- order with no sort; NULL and '' then meet in the upsert
+        INSERT INTO category_stats
+            SELECT IFNULL(category, ''), COUNT(*), SUM(completed != 0) FROM todos WHERE true
+            GROUP BY category
+            ON CONFLICT (category) DO UPDATE
+            SET total = total + excluded.total, completed = completed + excluded.completed;
+        DELETE FROM due_stats;
+        -- Most todos are open: one pass over the table beats walking
+        -- idx_list_order with a table lookup per row
+        INSERT INTO due_stats
+            SELECT due_date / 86400, COUNT(*) FROM todos NOT INDEXED
+            WHERE completed = 0 AND due_date IS NOT NULL GROUP BY 1;
+    )");
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
+int TodoDatabase::verifyStats() {
+    static Metrics::Histogram& latency = callLatency("verify_stats");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+
+    // Rows on either side of a recount that the other lacks
+    const char* sql = R"(
+        WITH category_counts AS (
+                 SELECT IFNULL(category, '') AS category, COUNT(*) AS total,
+                        SUM(completed != 0) AS completed
+                 FROM todos GROUP BY 1),
+             due_counts AS (
+                 SELECT due_date / 86400 AS day, COUNT(*) AS open FROM todos
+                 WHERE completed = 0 AND due_date IS NOT NULL GROUP BY 1)
+        SELECT (SELECT COUNT(*) FROM (SELECT * FROM category_counts
+                                      EXCEPT SELECT category, total, completed FROM category_stats)) +
+               (SELECT COUNT(*) FROM (SELECT category, total, completed FROM category_stats
+                                      EXCEPT SELECT * FROM category_counts)) +
+               (SELECT COUNT(*) FROM (SELECT * FROM due_counts EXCEPT SELECT day, open FROM due_stats)) +
+               (SELECT COUNT(*) FROM (SELECT day, open FROM due_stats EXCEPT SELECT * FROM due_counts));
+    )";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare verify stats");
+        return -1;
+    }
+
+    int mismatched = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return mismatched;
+}
+
+bool TodoDatabase::forEachCompletionDay(int64_t firstDay, int64_t lastDay,
+                                        const std::function<bool(const CompletionDay&)>& visit) {
+    static Metrics::Histogram& latency = callLatency("completion_days");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("forEachCompletionDay", "db");
+    if (!db) return false;
+
+    const char* sql = R"(
+        SELECT day, category, completed, lead_seconds, with_due, late FROM completion_daily
+        WHERE day BETWEEN ? AND ? ORDER BY day, category;
+    )";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT completion days");
+        return false;
+    }
+
+    sqlite3_bind_int64(stmt, 1, firstDay);
+    sqlite3_bind_int64(stmt, 2, lastDay);
+
+    CompletionDay row;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        row.day = sqlite3_column_int64(stmt, 0);
+        row.category = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 1));
+        row.completed = sqlite3_column_int(stmt, 2);
+        row.leadSeconds = sqlite3_column_int64(stmt, 3);
+        row.withDue = sqlite3_column_int(stmt, 4);
+        row.late = sqlite3_column_int(stmt, 5);
+        if (!visit(row)) {
+            rc = SQLITE_DONE;
+            break;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if (rc != SQLITE_DONE) {
+        handleError("Read completion days");
+        return false;
+    }
+    return true;
+}
+
+bool TodoDatabase::rebuildAnalytics() {
+    static Metrics::Histogram& latency = callLatency("rebuild_analytics");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("rebuildAnalytics", "db");
+    if (!db) return false;
+
+    bool ownsTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownsTransaction && !beginTransaction()) return false;
+
+    // Rows written without the triggers (older databases, bulk loads) are
+    // taken as completed at their last update
+    bool ok = executeSQL(R"(
+        UPDATE todos SET completed_at = updated_at, completed_day = )" LOCAL_DAY("updated_at") R"(
+            WHERE completed != 0 AND completed_day IS NULL;
+        -- A scan, as in rebuildStats()
+        UPDATE todos NOT INDEXED SET completed_at = NULL, completed_day = NULL
+            WHERE completed = 0 AND completed_day IS NOT NULL;
+        DELETE FROM completion_daily;
+        INSERT INTO completion_daily
+            SELECT completed_day, IFNULL(category, ''), COUNT(*), SUM(MAX(completed_at - created_at, 0)),
+                   SUM(due_date IS NOT NULL), SUM(IFNULL(completed_at > due_date, 0))
+            FROM todos WHERE completed_day IS NOT NULL GROUP BY 1, 2;
+    )");
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        rollbackTransaction();
+        return false;
+    }
+    return commitTransaction();
+}
+
+int TodoDatabase::verifyAnalytics() {
+    static Metrics::Histogram& latency = callLatency("verify_analytics");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return -1;
+
+    // Like verifyStats(), plus completion stamps out of step with completed
+    const char* sql = R"(
+        WITH counts AS (
+                 SELECT completed_day AS day, IFNULL(category, '') AS category, COUNT(*) AS completed,
+                        SUM(MAX(completed_at - created_at, 0)) AS lead_seconds,
+                        SUM(due_date IS NOT NULL) AS with_due,
+                        SUM(IFNULL(completed_at > due_date, 0)) AS late
+                 FROM todos WHERE completed_day IS NOT NULL GROUP BY 1, 2),
+             kept AS (
+                 SELECT day, category, completed, lead_seconds, with_due, late FROM completion_daily)
+        SELECT (SELECT COUNT(*) FROM (SELECT * FROM counts EXCEPT SELECT * FROM kept)) +
+               (SELECT COUNT(*) FROM (SELECT * FROM kept EXCEPT SELECT * FROM counts)) +
+               (SELECT COUNT(*) FROM todos
+                WHERE (completed != 0) != (completed_day IS NOT NULL)
+                   OR (completed_day IS NULL) != (completed_at IS NULL));
+    )";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare verify analytics");
+        return -1;
+    }
+
+    int mismatched = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_int(stmt, 0) : -1;
+    sqlite3_finalize(stmt);
+    return mismatched;
+}
+
+QueryProfiler* TodoDatabase::enableProfiling(int64_t slowThresholdUs) {
+    if (!db) return nullptr;
+
+    if (queryProfiler) {
+        queryProfiler->setSlowThresholdUs(slowThresholdUs);
+    } else {
+        queryProfiler = std::make_unique<QueryProfiler>(db, slowThresholdUs);
+    }
+    return queryProfiler.get();
+}
+
+void TodoDatabase::disableProfiling() {
+    queryProfiler.reset();
+}
+
+bool SyncRecord::isNewerThan(const SyncRecord& other) const {
+    return std::tie(modified_at, origin, origin_seq) >
+           std::tie(other.modified_at, other.origin, other.origin_seq);
+}
+
+std::string TodoDatabase::getDeviceId() {
+    std::string deviceId;
+    if (!db) return deviceId;
+
+    const char* sql = "SELECT value FROM sync_meta WHERE key = 'device_id';";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT device id");
+        return deviceId;
+    }
+
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        deviceId = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 0));
+    }
+
+    sqlite3_finalize(stmt);
+    return deviceId;
+}
+
+void TodoDatabase::bindNewUuid(sqlite3_stmt* stmt, int index) {
+    if (uuidSeed) {
+        uint64_t high = nextSeeded(*uuidSeed);
+        bindUuid(stmt, index, uuidClockMs++, high, nextSeeded(*uuidSeed));
+        return;
+    }
+
+    thread_local std::mt19937_64 random{std::random_device{}()};
+    uint64_t ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count();
+    uint64_t high = random();
+    bindUuid(stmt, index, ms, high, random());
+}
+
+bool TodoDatabase::seedIdentities(uint64_t seed, time_t now) {
+    if (!db) return false;
+
+    uuidSeed = seed;
+    uuidClockMs = static_cast<uint64_t>(now) * 1000;
+
+    char deviceId[17];
+    std::snprintf(deviceId, sizeof(deviceId), "%016llx",
+                  static_cast<unsigned long long>(nextSeeded(*uuidSeed)));
+
+    const char* sql = "UPDATE sync_meta SET value = ? WHERE key = 'device_id';";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare UPDATE device id");
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, deviceId, -1, SQLITE_TRANSIENT);
+    bool ok = sqlite3_step(stmt) == SQLITE_DONE;
+    if (!ok) handleError("Execute UPDATE device id");
+    sqlite3_finalize(stmt);
+    return ok;
+}
+
+bool TodoDatabase::resetDeviceId() {
+    // Local versions (NULL origin) now belong to the new id, including the
+    // ones that predate the copy; they differ only in the tie-break. The
+    // watermarks were the original's.
+    return executeSQL(R"(
+        BEGIN;
+        UPDATE sync_meta SET value = lower(hex(randomblob(8))) WHERE key = 'device_id';
+        DELETE FROM sync_peers;
+        COMMIT;
+    )");
+}
+
+int64_t TodoDatabase::getSyncWatermark(const std::string& peerId) {
+    if (!db) return 0;
+
+    const char* sql = "SELECT sent_seq FROM sync_peers WHERE peer_id = ?;";
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT watermark");
+        return 0;
+    }
+
+    sqlite3_bind_text(stmt, 1, peerId.c_str(), -1, SQLITE_TRANSIENT);
+
+    int64_t seq = 0;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        seq = sqlite3_column_int64(stmt, 0);
+    }
+
+    sqlite3_finalize(stmt);
+    return seq;
+}
+
+bool TodoDatabase::setSyncWatermark(const std::string& peerId, int64_t seq) {
+    if (!db) return false;
+
+    const char* sql = R"(
+        INSERT INTO sync_peers (peer_id, sent_seq, synced_at) VALUES (?1, ?2, ?3)
+        ON CONFLICT(peer_id) DO UPDATE SET sent_seq = MAX(sent_seq, ?2), synced_at = ?3;
+    )";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare UPDATE watermark");
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, peerId.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 2, seq);
+    sqlite3_bind_int64(stmt, 3, std::time(nullptr));
+
+    int result = sqlite3_step(stmt);
+    sqlite3_finalize(stmt);
+
+    return result == SQLITE_DONE;
+}
+
+bool TodoDatabase::forEachSyncChange(int64_t afterSeq, const std::string& skipOrigin,
+                                     const std::function<bool(const SyncRecord&)>& visit) {
+    static Metrics::Histogram& latency = callLatency("sync_changes");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    std::string deviceId = getDeviceId();
+    if (deviceId.empty()) return false;
+
+    // Todo columns first so readTodo() can read them
+    const char* sql = R"(
+        SELECT t.id, t.title, t.description, t.category, t.completed,
+               t.created_at, t.updated_at, t.due_date, t.priority, t.parent_id, t.manual_rank,
+               l.seq, l.uuid, l.deleted, l.modified_at,
+               IFNULL(l.origin, ?1), IFNULL(l.origin_seq, l.seq), p.uuid
+        FROM sync_log l LEFT JOIN todos t ON t.uuid = l.uuid
+                        LEFT JOIN todos p ON p.id = t.parent_id
+        WHERE l.seq > ?2 AND IFNULL(l.origin, ?1) <> ?3
+        ORDER BY l.seq;
+    )";
+
+    sqlite3_stmt* stmt;
+
+    if (sqlite3_prepare_v2(db, sql, -1, &stmt, nullptr) != SQLITE_OK) {
+        handleError("Prepare SELECT changes");
+        return false;
+    }
+
+    sqlite3_bind_text(stmt, 1, deviceId.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 2, afterSeq);
+    sqlite3_bind_text(stmt, 3, skipOrigin.c_str(), -1, SQLITE_TRANSIENT);
+
+    int result;
+    while ((result = sqlite3_step(stmt)) == SQLITE_ROW) {
+        SyncRecord record;
+        record.seq = sqlite3_column_int64(stmt, 11);
+        record.uuid.assign(static_cast<const char*>(sqlite3_column_blob(stmt, 12)),
+                           sqlite3_column_bytes(stmt, 12));
+        record.deleted = sqlite3_column_int(stmt, 13) != 0;
+        record.modified_at = sqlite3_column_int64(stmt, 14);
+        record.origin = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 15));
+        record.origin_seq = sqlite3_column_int64(stmt, 16);
+
+        if (!record.deleted) {
+            // A live entry without its row was deleted behind the triggers' back
+            if (sqlite3_column_type(stmt, 0) == SQLITE_NULL) continue;
+            record.todo = readTodo(stmt);
+            if (sqlite3_column_type(stmt, 17) != SQLITE_NULL) {
+                record.parentUuid.assign(static_cast<const char*>(sqlite3_column_blob(stmt, 17)),
+                                         sqlite3_column_bytes(stmt, 17));
+            }
+        }
+
+        if (!visit(record)) {
+            result = SQLITE_DONE;
+            break;
+        }
+    }
+
+    sqlite3_finalize(stmt);
+    if (result != SQLITE_DONE) {
+        handleError("Step SELECT changes");
+        return false;
+    }
+    return true;
+}
+
+std::optional<SyncRecord> TodoDatabase::getSyncVersion(const std::string& uuid) {
+    if (!db) return std::nullopt;
+
+    const char* sql = R"(
+        SELECT seq, deleted, modified_at,
+               IFNULL(origin, (SELECT value FROM sync_meta WHERE key = 'device_id')),
+               IFNULL(origin_seq, seq)
+        FROM sync_log WHERE uuid = ?;
+    )";
+
+    sqlite3_stmt* stmt = cachedStatement(sql, "SELECT version");
+    if (!stmt) return std::nullopt;
+
+    sqlite3_bind_blob(stmt, 1, uuid.data(), uuid.size(), SQLITE_TRANSIENT);
+
+    std::optional<SyncRecord> record;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        record.emplace();
+        record->uuid = uuid;
+        record->seq = sqlite3_column_int64(stmt, 0);
+        record->deleted = sqlite3_column_int(stmt, 1) != 0;
+        record->modified_at = sqlite3_column_int64(stmt, 2);
+        record->origin = reinterpret_cast<const char*>(sqlite3_column_text(stmt, 3));
+        record->origin_seq = sqlite3_column_int64(stmt, 4);
+    }
+
+    sqlite3_reset(stmt);
+    return record;
+}
+
+bool TodoDatabase::applySyncRecord(const SyncRecord& record) {
+    static Metrics::Histogram& latency = callLatency("sync_apply");
+    Metrics::ScopedTimer timer(latency);
+    if (!db) return false;
+
+    // Deleting a parent deletes its subtree here too, as deleteTodo() does
+    const char* rowSql = record.deleted
+        ? R"(
+            DELETE FROM todos
+            WHERE uuid = ?9 OR id IN (SELECT descendant FROM todo_tree
+                                      WHERE ancestor = (SELECT id FROM todos WHERE uuid = ?9));
+        )"
+        : R"(
+            INSERT INTO todos (title, description, category, completed, created_at, updated_at,
+                              due_date, priority, uuid, parent_id, manual_rank, completed_at, completed_day)
+            VALUES (?1, ?2, ?3, ?4, ?5, ?6, ?7, ?8, ?9, ?10,
+                    (SELECT IFNULL(MAX(manual_rank), 0) + 1 FROM todos WHERE parent_id IS ?10),
+                    CASE WHEN ?4 != 0 THEN ?6 END,
+                    CASE WHEN ?4 != 0 THEN )" LOCAL_DAY("?6") R"( END)
+            ON CONFLICT(uuid) DO UPDATE SET
+                title = excluded.title, description = excluded.description,
+                category = excluded.category, completed = excluded.completed,
+                created_at = excluded.created_at, updated_at = excluded.updated_at,
+                due_date = excluded.due_date, priority = excluded.priority,
+                manual_rank = CASE WHEN parent_id IS excluded.parent_id THEN manual_rank
+                                   ELSE excluded.manual_rank END,
+                parent_id = excluded.parent_id;
+        )";
+
+    // Parents travel as uuids. One not seen here yet leaves the todo at the
+    // top level until it arrives (TodoSync applies such records again).
+    // Ids start at 1; 0 is the top level. A plain int rather than an
+    // optional, which GCC at -O2 wrongly reports as maybe uninitialized.
+    int parentId = 0;
+    bool cycle = false;
+    if (!record.deleted && !record.parentUuid.empty()) {
+        const char* parentSql = R"(
+            SELECT p.id, EXISTS (SELECT 1 FROM todos t
+                                 WHERE t.uuid = ?2
+                                   AND (t.id = p.id OR EXISTS (SELECT 1 FROM todo_tree
+                                                               WHERE ancestor = t.id
+                                                                 AND descendant = p.id)))
+            FROM todos p WHERE p.uuid = ?1;
+        )";
+
+        sqlite3_stmt* stmt = cachedStatement(parentSql, "SELECT sync parent");
+        if (!stmt) return false;
+
+        sqlite3_bind_blob(stmt, 1, record.parentUuid.data(), record.parentUuid.size(), SQLITE_TRANSIENT);
+        sqlite3_bind_blob(stmt, 2, record.uuid.data(), record.uuid.size(), SQLITE_TRANSIENT);
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            parentId = sqlite3_column_int(stmt, 0);
+            cycle = sqlite3_column_int(stmt, 1) != 0;
+        }
+        sqlite3_reset(stmt);
+    }
+
+    // Concurrent moves on two devices can put each todo under the other.
+    // The move that would close the loop is dropped and the todo kept at
+    // the top level as a new local change, so both devices converge on it.
+    time_t updatedAt = record.todo.getUpdatedAt();
+    if (cycle) {
+        parentId = 0;
+        updatedAt = std::max({updatedAt + 1, record.modified_at + 1, std::time(nullptr)});
+    }
+
+    // A tombstone would block the insert trigger's log entry
+    sqlite3_stmt* stmt = cachedStatement("DELETE FROM sync_log WHERE uuid = ?;", "sync log clear");
+    if (!stmt) return false;
+
+    sqlite3_bind_blob(stmt, 1, record.uuid.data(), record.uuid.size(), SQLITE_TRANSIENT);
+    int result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (result != SQLITE_DONE) {
+        handleError("Execute sync log clear");
+        return false;
+    }
+
+    stmt = cachedStatement(rowSql, "sync write");
+    if (!stmt) return false;
+
+    if (!record.deleted) {
+        const Todo& todo = record.todo;
+        sqlite3_bind_text(stmt, 1, todo.getTitle().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 2, todo.getDescription().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_text(stmt, 3, todo.getCategory().c_str(), -1, SQLITE_TRANSIENT);
+        sqlite3_bind_int(stmt, 4, todo.isCompleted() ? 1 : 0);
+        sqlite3_bind_int64(stmt, 5, todo.getCreatedAt());
+        sqlite3_bind_int64(stmt, 6, updatedAt);
+
+        if (todo.getDueDate().has_value()) {
+            sqlite3_bind_int64(stmt, 7, todo.getDueDate().value());
+        } else {
+            sqlite3_bind_null(stmt, 7);
+        }
+
+        sqlite3_bind_int(stmt, 8, todo.getPriority());
+        if (parentId != 0) {
+            sqlite3_bind_int(stmt, 10, parentId);
+        } else {
+            sqlite3_bind_null(stmt, 10);
+        }
+    }
+    sqlite3_bind_blob(stmt, 9, record.uuid.data(), record.uuid.size(), SQLITE_TRANSIENT);
+
+    result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (result != SQLITE_DONE) {
+        handleError("Execute sync write");
+        return false;
+    }
+
+    // Leave the trigger's local log entry in place
+    if (cycle) return true;
+
+    // The triggers logged the write as a local change; stamp the remote
+    // version over it (and keep tombstones for rows never seen here)
+    const char* logSql = R"(
+        INSERT OR REPLACE INTO sync_log (uuid, deleted, modified_at, origin, origin_seq)
+        VALUES (?, ?, ?, ?, ?);
+    )";
+
+    stmt = cachedStatement(logSql, "sync log write");
+    if (!stmt) return false;
+
+    sqlite3_bind_blob(stmt, 1, record.uuid.data(), record.uuid.size(), SQLITE_TRANSIENT);
+    sqlite3_bind_int(stmt, 2, record.deleted ? 1 : 0);
+    sqlite3_bind_int64(stmt, 3, record.modified_at);
+    sqlite3_bind_text(stmt, 4, record.origin.c_str(), -1, SQLITE_TRANSIENT);
+    sqlite3_bind_int64(stmt, 5, record.origin_seq);
+
+    result = sqlite3_step(stmt);
+    sqlite3_reset(stmt);
+
+    if (result != SQLITE_DONE) {
+        handleError("Execute sync log write");
+        return false;
+    }
+    return true;
+}
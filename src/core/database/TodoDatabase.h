@@ -1,19 +1,146 @@
 #ifndef TODO_DATABASE_H
 #define TODO_DATABASE_H
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <memory>
+#include <optional>
+#include <functional>
+#include <unordered_map>
+#include <utility>
 #include <sqlite3.h>
 #include "../models/Todo.h"
+#include "../models/CategoryModel.h"
+#include "QueryProfiler.h"
+
+// Position of a row in list order (incomplete first, then priority,
+// due date and newest first). Pages continue strictly after this key.
+struct TodoPageCursor {
+    bool completed = false;
+    int priority = 2;
+    std::optional<time_t> due_date;
+    time_t created_at = 0;
+    int id = 0;
+    double manual_rank = 0;  // Key in TodoOrder::Manual, with id
+
+    static TodoPageCursor fromTodo(const Todo& todo);
+};
+
+// How the rows of one level are ordered
+enum class TodoOrder {
+    List,   // Incomplete first, then priority, due date and newest first
+    Manual  // Where the user dragged them (manual_rank)
+};
+
+// A todo with its subtree rolled up, for tree views
+struct TodoNode {
+    Todo todo;
+    int descendants = 0;           // At any depth
+    int completedDescendants = 0;
+};
+
+struct TodoSubtreeProgress {
+    int descendants = 0;
+    int completed = 0;
+};
+
+// Fields to set on every todo of a bulk update; unset ones are left alone
+struct TodoBulkChange {
+    std::optional<bool> completed;
+    std::optional<std::string> category;
+    std::optional<int> priority;
+
+    bool empty() const { return !completed && !category && !priority; }
+    void applyTo(Todo& todo) const;
+};
+
+struct TodoCounts {
+    int total = 0;
+    int completed = 0;
+    int overdue = 0;
+};
+
+// One row of completion_daily: what was completed in one category on one day
+struct CompletionDay {
+    int64_t day = 0;          // Days since 1970-01-01, local time
+    std::string category;     // Empty for none
+    int completed = 0;
+    int64_t leadSeconds = 0;  // Summed creation-to-completion times
+    int withDue = 0;
+    int late = 0;             // Completed after their due date
+};
+
+// One row as SQLite hands it out. The text pointers point into the
+// statement's own buffers and are only valid during the visit callback.
+struct TodoRowView {
+    int id = 0;
+    const char* title = "";
+    int titleLength = 0;
+    const char* description = "";
+    int descriptionLength = 0;
+    const char* category = "";
+    int categoryLength = 0;
+    bool completed = false;
+    time_t created_at = 0;
+    time_t updated_at = 0;
+    std::optional<time_t> due_date;
+    int priority = 2;
+    const char* uuid = "";  // 16 bytes, or none before sync was set up
+    int uuidLength = 0;
+};
+
+// One entry of the sync change log: the latest version of a todo, or a
+// tombstone once it is deleted. Versions order by (modified_at, origin,
+// origin_seq), so every replica picks the same winner.
+struct SyncRecord {
+    int64_t seq = 0;           // Local change order
+    std::string uuid;          // 16 random bytes; identity across databases, ids are local
+    bool deleted = false;
+    time_t modified_at = 0;    // updated_at or deletion time, past the version it replaced
+    std::string origin;        // Device id that made this version
+    int64_t origin_seq = 0;    // That device's seq for it
+    Todo todo;                 // Row contents unless deleted
+    std::string parentUuid;    // Empty for top-level todos; parent_id is local
+
+    bool isNewerThan(const SyncRecord& other) const;
+};
 
 class TodoDatabase {
 private:
     sqlite3* db;
     std::string db_path;
+    // Statements run once per row by the sync paths, finalized on close()
+    std::unordered_map<std::string, sqlite3_stmt*> statementCache;
+    std::unique_ptr<QueryProfiler> queryProfiler;
+    // Set by seedIdentities(); otherwise uuids are random and timed by the clock
+    std::optional<uint64_t> uuidSeed;
+    uint64_t uuidClockMs = 0;
+    // Between beginBulkLoad() and endBulkLoad(), the last manual rank given
+    // under each parent (0 for top level) by createTodos()
+    std::optional<std::unordered_map<int, double>> bulkLastRanks;
 
     bool executeSQL(const std::string& sql);
+    sqlite3_stmt* cachedStatement(const char* sql, const std::string& operation);  // Reset, unbound
     void handleError(const std::string& operation);
+    bool ensureColumn(const std::string& table, const std::string& column,
+                      const std::string& definition);
+    bool hasColumn(const std::string& table, const std::string& column);
+    bool createIndexes();
+    bool createSyncSchema();
+    bool createTreeSchema();
+    bool rebuildTree();
+    bool createStatsSchema();
+    bool createAnalyticsSchema();
+    bool hasTrigger(const std::string& name);
+    bool hasSyncMeta(const std::string& key);
+    void bindNewUuid(sqlite3_stmt* stmt, int index);
+    int respaceManualRanks(std::optional<int> parentId);
+    bool todoExists(int id);
+    double lastManualRank(std::optional<int> parentId);
+    Todo readTodo(sqlite3_stmt* stmt);
+    void readRowView(sqlite3_stmt* stmt, TodoRowView& row);
+    bool streamTodos(sqlite3_stmt* stmt, const std::function<bool(const Todo&)>& visit);
 
 public:
     TodoDatabase(const std::string& path);
@@ -25,15 +152,149 @@ public:
     
     bool initialize();
 
+    // Explicit transactions for batched writes
+    bool beginTransaction();
+    bool commitTransaction();
+    bool rollbackTransaction();
+    bool inTransaction() const { return db && !sqlite3_get_autocommit(db); }
+
+    // Large imports: drop the secondary indexes and the insert triggers,
+    // insert, then rebuild the indexes with a sort and recount what the
+    // triggers keep, once, instead of doing that work on every row. Reads
+    // fall back to table scans in between.
+    bool beginBulkLoad();
+    bool endBulkLoad();
+
     // CRUD operations
     bool createTodo(Todo& todo);  // Sets the ID from database
+    // Bulk insert with one reused statement. Opens its own transaction unless
+    // one is already active; sets every ID. All-or-nothing when it owns the
+    // transaction.
+    bool createTodos(std::vector<Todo>& todos);
     std::vector<Todo> getAllTodos();
     std::vector<Todo> getTodosByCategory(const std::string& category);
     std::unique_ptr<Todo> getTodoById(int id);
+
+    // Due dates, for calendars. Each is one range of idx_due_date.
+    // Todos due in [start, end) by due date, then id; limit < 0 for all
+    std::vector<Todo> getTodosDueBetween(time_t start, time_t end, int limit = -1);
+    int countTodosDueBetween(time_t start, time_t end);  // Index entries only
+    // Earliest and latest due date, std::nullopt when nothing has one
+    std::optional<std::pair<time_t, time_t>> getDueDateSpan();
     bool updateTodo(const Todo& todo);
-    bool deleteTodo(int id);
+    bool deleteTodo(int id);  // With all of its subtasks
+
+    // Multi-select actions: one transaction and one reused statement for any
+    // number of ids, all-or-nothing unless the caller's transaction is open.
+    // Rows the change would not alter are skipped, not timestamped. Return
+    // the rows written, -1 on error; when asked, before gets each written
+    // row as it was (deleteTodos: every row removed, subtasks included).
+    int updateTodos(const std::vector<int>& ids, const TodoBulkChange& change,
+                    std::vector<Todo>* before = nullptr);
+    int deleteTodos(const std::vector<int>& ids, std::vector<Todo>* before = nullptr);
+    // Undo of a delete: puts rows back exactly as read, ids and manual ranks
+    // included, parents ahead of their subtasks. They get new uuids, so they
+    // sync as new todos and the deletion already logged stands.
+    bool restoreTodos(const std::vector<Todo>& todos);
+
+    // Keyset paging in list order. Pass std::nullopt to start from the top.
+    std::vector<Todo> getTodosPage(const std::optional<TodoPageCursor>& after, int limit,
+                                   const std::optional<std::string>& category = std::nullopt);
+    // Cursor of the row offset rows into that order, found by walking the
+    // index, so a view can start a page far down without reading the pages
+    // above it. std::nullopt past the end.
+    std::optional<TodoPageCursor> getPageCursorAt(int offset,
+                                                  const std::optional<std::string>& category = std::nullopt);
+
+    // Subtasks. The hierarchy is kept in a closure table, so each of these
+    // is one indexed query whatever the depth.
+    // Children of parentId in list order, keyset paged like getTodosPage();
+    // std::nullopt lists top-level todos, the only level the category
+    // filter applies to (subtasks show under their parent regardless)
+    std::vector<TodoNode> getChildrenPage(std::optional<int> parentId,
+                                          const std::optional<TodoPageCursor>& after, int limit,
+                                          const std::optional<std::string>& category = std::nullopt,
+                                          TodoOrder order = TodoOrder::List);
+    // Every todo below id, nearest first
+    bool forEachDescendant(int id, const std::function<bool(const Todo&)>& visit);
+    TodoSubtreeProgress getSubtreeProgress(int id);
+    // Moves id and its subtree under newParentId (std::nullopt: top level).
+    // False if that parent does not exist or is inside the subtree.
+    bool moveTodo(int id, std::optional<int> newParentId);
+
+    // Manual order. Every todo has a fractional rank among its siblings: new
+    // ones and moved ones go last, and a drop takes the midpoint of its new
+    // neighbours, so reordering writes only the dropped row.
+    // Puts id under parentId just before sibling beforeId, or last.
+    bool placeTodo(int id, std::optional<int> parentId, std::optional<int> beforeId);
+    // Respaces one level to whole numbers once repeated drops into the same
+    // spot have narrowed a gap too far. One index scan when there is room.
+    // Returns the rows rewritten (0 if none needed it), -1 on error.
+    int rebalanceManualOrder(std::optional<int> parentId);
+
+    // Streams rows in list order one at a time instead of building a vector;
+    // return false from visit to stop early
+    bool forEachTodo(const std::function<bool(const Todo&)>& visit,
+                     const std::optional<std::string>& category = std::nullopt);
+    // Case-insensitive substring match on title and description, list order
+    bool searchTodos(const std::string& query, const std::function<bool(const Todo&)>& visit);
+    // Rows in id order without building Todo objects; for exporters
+    bool forEachTodoRow(const std::function<bool(const TodoRowView&)>& visit,
+                        const std::optional<std::string>& category = std::nullopt);
+    // Up to limit rows in list order after the cursor, as views; for scans
+    // done a slice at a time between other work. Returns the rows visited,
+    // -1 on error.
+    int forEachTodoRowAfter(const std::optional<TodoPageCursor>& after, int limit,
+                            const std::function<void(const TodoRowView&)>& visit);
 
     std::vector<std::string> getAllCategories();
+    // Read from the summary tables the stats triggers keep, category_stats
+    // and due_stats: a row per category (and per due day for overdue), so
+    // none of these scan todos
+    std::vector<CategoryCount> getCategoryCounts();  // Sorted by name
+    TodoCounts getTodoCounts();
+    // Recounts the summary tables from todos; initialize() does this when
+    // the triggers are new. verifyStats() returns the summary rows that
+    // disagree with a recount, 0 when exact, -1 on error.
+    bool rebuildStats();
+    int verifyStats();
+
+    // Completions per local day and category from completion_daily, which
+    // triggers keep as todos are completed, reopened, edited or deleted.
+    // Days are days since 1970-01-01 in local time, firstDay to lastDay
+    // inclusive, visited in day order. TodoAnalytics builds reports on it.
+    bool forEachCompletionDay(int64_t firstDay, int64_t lastDay,
+                              const std::function<bool(const CompletionDay&)>& visit);
+    // As rebuildStats() and verifyStats(), for the completion stamps and
+    // completion_daily
+    bool rebuildAnalytics();
+    int verifyAnalytics();
+
+    // Sync bookkeeping. Triggers keep sync_log current for every write, so
+    // these only read it or stamp versions received from another device.
+    std::string getDeviceId();
+    bool resetDeviceId();  // For a database file copied from another device
+    // Reproducible output for generators: the device id and the uuids of
+    // the rows this connection creates follow from seed, and uuid
+    // timestamps count up from now instead of reading the clock. Databases
+    // seeded alike are copies of each other as far as sync can tell.
+    bool seedIdentities(uint64_t seed, time_t now);
+    int64_t getSyncWatermark(const std::string& peerId);  // Last seq sent to peer
+    bool setSyncWatermark(const std::string& peerId, int64_t seq);
+    // Log entries after afterSeq in change order, without versions made by
+    // skipOrigin (that device has them or something newer)
+    bool forEachSyncChange(int64_t afterSeq, const std::string& skipOrigin,
+                           const std::function<bool(const SyncRecord&)>& visit);
+    std::optional<SyncRecord> getSyncVersion(const std::string& uuid);  // Without contents
+    // Writes a remote version (row or tombstone) and records it as the
+    // latest. The caller has checked it is newer.
+    bool applySyncRecord(const SyncRecord& record);
+
+    // Per-statement latency histograms, rows scanned and query plans of slow
+    // statements. Off by default; enabling again only changes the threshold.
+    QueryProfiler* enableProfiling(int64_t slowThresholdUs = 10000);
+    void disableProfiling();
+    QueryProfiler* profiler() const { return queryProfiler.get(); }
 
     bool isOpen() const { return db != nullptr; }
     void close();
@@ -0,0 +1,394 @@
+#include "TodoJournal.h"
+#include "../io/ByteCodec.h"
+#include <cstring>
+#include <map>
+#include <tuple>
+#include <unordered_map>
+
+namespace {
+
+// Entry data, varints throughout, timestamps zigzag encoded:
+//   Update: (id mask field...)...   each field in mask: before then after
+//   Create/Delete: row...
+//   row = id parent(0 top) rank(8 bytes) title description category
+//         completed created_at updated_at hasDue [due_date] priority
+enum Field : uint8_t {
+    kTitle = 1,
+    kDescription = 2,
+    kCategory = 4,
+    kCompleted = 8,
+    kDueDate = 16,
+    kPriority = 32,
+    kParent = 64
+};
+
+// Fields TodoDatabase::updateTodos() can set for many rows at once
+const uint8_t kBulkFields = kCategory | kCompleted | kPriority;
+
+uint8_t changedFields(const Todo& before, const Todo& after) {
+    uint8_t mask = 0;
+    if (before.getTitle() != after.getTitle()) mask |= kTitle;
+    if (before.getDescription() != after.getDescription()) mask |= kDescription;
+    if (before.getCategory() != after.getCategory()) mask |= kCategory;
+    if (before.isCompleted() != after.isCompleted()) mask |= kCompleted;
+    if (before.getDueDate() != after.getDueDate()) mask |= kDueDate;
+    if (before.getPriority() != after.getPriority()) mask |= kPriority;
+    if (before.getParentId() != after.getParentId()) mask |= kParent;
+    return mask;
+}
+
+void encodeFields(ByteEncoder& encoder, const Todo& todo, uint8_t mask) {
+    if (mask & kTitle) encoder.string(todo.getTitle());
+    if (mask & kDescription) encoder.string(todo.getDescription());
+    if (mask & kCategory) encoder.string(todo.getCategory());
+    if (mask & kCompleted) encoder.byte(todo.isCompleted() ? 1 : 0);
+    if (mask & kDueDate) {
+        encoder.byte(todo.getDueDate() ? 1 : 0);
+        if (todo.getDueDate()) encoder.signedVarint(*todo.getDueDate());
+    }
+    if (mask & kPriority) encoder.varint(todo.getPriority());
+    if (mask & kParent) encoder.varint(todo.getParentId().value_or(0));
+}
+
+// Sets the fields in mask on todo
+void decodeFields(ByteDecoder& decoder, Todo& todo, uint8_t mask) {
+    if (mask & kTitle) todo.setTitle(decoder.string());
+    if (mask & kDescription) todo.setDescription(decoder.string());
+    if (mask & kCategory) todo.setCategory(decoder.string());
+    if (mask & kCompleted) todo.setCompleted(decoder.byte() != 0);
+    if (mask & kDueDate) {
+        if (decoder.byte()) {
+            todo.setDueDate(decoder.signedVarint());
+        } else {
+            todo.clearDueDate();
+        }
+    }
+    if (mask & kPriority) todo.setPriority(static_cast<int>(decoder.varint()));
+    if (mask & kParent) {
+        int parent = static_cast<int>(decoder.varint());
+        todo.setParentId(parent ? std::optional<int>(parent) : std::nullopt);
+    }
+}
+
+void encodeDelta(ByteEncoder& encoder, const Todo& before, const Todo& after, uint8_t mask) {
+    encoder.varint(after.getId());
+    encoder.byte(mask);
+    for (uint8_t field = kTitle; field <= kParent; field <<= 1) {
+        if (!(mask & field)) continue;
+        encodeFields(encoder, before, field);
+        encodeFields(encoder, after, field);
+    }
+}
+
+void encodeRow(ByteEncoder& encoder, const Todo& todo) {
+    encoder.varint(todo.getId());
+    encoder.varint(todo.getParentId().value_or(0));
+    double rank = todo.getManualRank();
+    char rankBytes[sizeof rank];
+    std::memcpy(rankBytes, &rank, sizeof rank);
+    encoder.bytes(rankBytes, sizeof rank);
+    encoder.string(todo.getTitle());
+    encoder.string(todo.getDescription());
+    encoder.string(todo.getCategory());
+    encoder.byte(todo.isCompleted() ? 1 : 0);
+    encoder.signedVarint(todo.getCreatedAt());
+    encoder.signedVarint(todo.getUpdatedAt());
+    encoder.byte(todo.getDueDate() ? 1 : 0);
+    if (todo.getDueDate()) encoder.signedVarint(*todo.getDueDate());
+    encoder.varint(todo.getPriority());
+}
+
+bool decodeRows(const std::string& data, std::vector<Todo>& rows) {
+    ByteDecoder decoder(data.data(), data.size());
+    while (!decoder.atEnd() && !decoder.failed()) {
+        Todo todo;
+        todo.setId(static_cast<int>(decoder.varint()));
+        int parent = static_cast<int>(decoder.varint());
+        if (parent) todo.setParentId(parent);
+        double rank = 0;
+        char rankBytes[sizeof rank];
+        if (decoder.bytes(rankBytes, sizeof rank)) std::memcpy(&rank, rankBytes, sizeof rank);
+        todo.setManualRank(rank);
+        todo.setTitle(decoder.string());
+        todo.setDescription(decoder.string());
+        todo.setCategory(decoder.string());
+        todo.setCompleted(decoder.byte() != 0);
+        todo.setCreatedAt(decoder.signedVarint());
+        time_t updatedAt = decoder.signedVarint();
+        if (decoder.byte()) todo.setDueDate(decoder.signedVarint());
+        todo.setPriority(static_cast<int>(decoder.varint()));
+        todo.setUpdatedAt(updatedAt);  // Last: the setters above stamp it
+        rows.push_back(std::move(todo));
+    }
+    return !decoder.failed();
+}
+
+std::string countLabel(const char* verb, size_t count) {
+    if (count == 1) return std::string(verb) + " todo";
+    return std::string(verb) + " " + std::to_string(count) + " todos";
+}
+
+std::string changeLabel(const TodoBulkChange& change, size_t count) {
+    if (change.completed && !change.category && !change.priority) {
+        return countLabel(*change.completed ? "Complete" : "Reopen", count);
+    }
+    return countLabel("Change", count);
+}
+
+}
+
+TodoJournal::TodoJournal(TodoDatabase& database, size_t memoryCap)
+    : database(database), cap(memoryCap) {
+}
+
+bool TodoJournal::createTodo(Todo& todo) {
+    if (!database.createTodo(todo)) return false;
+
+    // As stored, with the rank the database gave it, so a redo restores it
+    auto stored = database.getTodoById(todo.getId());
+    if (!stored) return true;
+
+    Entry entry{Kind::Create, "Add todo", {}};
+    ByteEncoder encoder(entry.data);
+    encodeRow(encoder, *stored);
+    push(std::move(entry));
+    return true;
+}
+
+bool TodoJournal::updateTodo(const Todo& before, const Todo& after) {
+    if (!database.updateTodo(after)) return false;
+
+    uint8_t mask = changedFields(before, after);
+    if (mask == 0) return true;
+
+    const char* verb = mask == kCompleted ? (after.isCompleted() ? "Complete" : "Reopen")
+                     : mask == kParent ? "Move" : "Edit";
+    Entry entry{Kind::Update, countLabel(verb, 1), {}};
+    ByteEncoder encoder(entry.data);
+    encodeDelta(encoder, before, after, mask);
+    push(std::move(entry));
+    return true;
+}
+
+bool TodoJournal::moveTodo(int id, std::optional<int> newParentId) {
+    auto before = database.getTodoById(id);
+    if (!before || !database.moveTodo(id, newParentId)) return false;
+
+    Todo after = *before;
+    after.setParentId(newParentId);
+    uint8_t mask = changedFields(*before, after);
+    if (mask == 0) return true;
+
+    Entry entry{Kind::Update, "Move todo", {}};
+    ByteEncoder encoder(entry.data);
+    encodeDelta(encoder, *before, after, mask);
+    push(std::move(entry));
+    return true;
+}
+
+bool TodoJournal::placeTodo(int id, std::optional<int> parentId, std::optional<int> beforeId) {
+    auto before = database.getTodoById(id);
+    if (!before || !database.placeTodo(id, parentId, beforeId)) return false;
+
+    // Reordering among the same siblings is not a change to the todo and
+    // is not journaled; a new parent is a move
+    Todo after = *before;
+    after.setParentId(parentId);
+    uint8_t mask = changedFields(*before, after);
+    if (mask == 0) return true;
+
+    Entry entry{Kind::Update, "Move todo", {}};
+    ByteEncoder encoder(entry.data);
+    encodeDelta(encoder, *before, after, mask);
+    push(std::move(entry));
+    return true;
+}
+
+int TodoJournal::updateTodos(const std::vector<int>& ids, const TodoBulkChange& change,
+                             std::vector<Todo>* before) {
+    std::vector<Todo> rows;
+    int written = database.updateTodos(ids, change, &rows);
+    if (written <= 0) return written;
+
+    Entry entry{Kind::Update, changeLabel(change, rows.size()), {}};
+    ByteEncoder encoder(entry.data);
+    for (const Todo& row : rows) {
+        Todo after = row;
+        change.applyTo(after);
+        encodeDelta(encoder, row, after, changedFields(row, after));
+    }
+    push(std::move(entry));
+
+    if (before) *before = std::move(rows);
+    return written;
+}
+
+int TodoJournal::deleteTodos(const std::vector<int>& ids, std::vector<Todo>* before) {
+    std::vector<Todo> rows;
+    int deleted = database.deleteTodos(ids, &rows);
+    if (deleted <= 0) return deleted;
+
+    Entry entry{Kind::Delete, countLabel("Delete", ids.size()), {}};
+    ByteEncoder encoder(entry.data);
+    for (const Todo& row : rows) {
+        encodeRow(encoder, row);
+    }
+    push(std::move(entry));
+
+    if (before) *before = std::move(rows);
+    return deleted;
+}
+
+std::string TodoJournal::undoLabel() const {
+    return canUndo() ? entries[cursor - 1].label : std::string();
+}
+
+std::string TodoJournal::redoLabel() const {
+    return canRedo() ? entries[cursor].label : std::string();
+}
+
+bool TodoJournal::undo(std::vector<int>* touched) {
+    if (!canUndo() || !replay(entries[cursor - 1], false, touched)) return false;
+    cursor--;
+    return true;
+}
+
+bool TodoJournal::redo(std::vector<int>* touched) {
+    if (!canRedo() || !replay(entries[cursor], true, touched)) return false;
+    cursor++;
+    return true;
+}
+
+void TodoJournal::clear() {
+    entries.clear();
+    cursor = 0;
+    used = 0;
+}
+
+void TodoJournal::setMemoryCap(size_t bytes) {
+    cap = bytes;
+    evict();
+}
+
+void TodoJournal::push(Entry entry) {
+    // A new write ends the redo branch
+    while (entries.size() > cursor) {
+        used -= entries.back().bytes();
+        entries.pop_back();
+    }
+
+    entry.data.shrink_to_fit();
+    if (entry.bytes() > cap) {
+        // Too big to keep: older entries could no longer be undone in
+        // order past it, so history starts again after it
+        clear();
+        return;
+    }
+
+    used += entry.bytes();
+    entries.push_back(std::move(entry));
+    cursor = entries.size();
+    evict();
+}
+
+void TodoJournal::evict() {
+    while (used > cap && !entries.empty()) {
+        used -= entries.front().bytes();
+        entries.pop_front();
+        if (cursor > 0) cursor--;
+    }
+}
+
+bool TodoJournal::replay(const Entry& entry, bool forward, std::vector<int>* touched) {
+    bool ownsTransaction = !database.inTransaction();
+    if (ownsTransaction && !database.beginTransaction()) return false;
+
+    bool ok = false;
+    if (entry.kind == Kind::Update) {
+        ok = replayUpdate(entry, forward, touched);
+    } else {
+        std::vector<Todo> rows;
+        ok = decodeRows(entry.data, rows);
+
+        // Adding again and undoing a delete put the rows back; the others
+        // remove them, with whatever subtasks have been added since
+        bool restore = (entry.kind == Kind::Create) == forward;
+        if (ok && restore) {
+            ok = database.restoreTodos(rows);
+        } else if (ok) {
+            std::vector<int> ids;
+            ids.reserve(rows.size());
+            for (const Todo& row : rows) ids.push_back(row.getId());
+            ok = database.deleteTodos(ids) >= 0;
+        }
+        if (ok && touched) {
+            for (const Todo& row : rows) touched->push_back(row.getId());
+        }
+    }
+
+    if (!ownsTransaction) return ok;
+    if (!ok) {
+        database.rollbackTransaction();
+        return false;
+    }
+    return database.commitTransaction();
+}
+
+bool TodoJournal::replayUpdate(const Entry& entry, bool forward, std::vector<int>* touched) {
+    // Rows whose fields all fit updateTodos() are grouped by the values
+    // they go back (or forward) to, one bulk update per group; anything
+    // else is read and written back one row at a time
+    using Values = std::tuple<uint8_t, bool, std::string, int>;  // mask completed category priority
+    std::map<Values, std::vector<int>> groups;
+
+    ByteDecoder decoder(entry.data.data(), entry.data.size());
+    while (!decoder.atEnd()) {
+        int id = static_cast<int>(decoder.varint());
+        uint8_t mask = decoder.byte();
+        if (decoder.failed()) return false;
+
+        Todo values;
+        for (uint8_t field = kTitle; field <= kParent; field <<= 1) {
+            if (!(mask & field)) continue;
+            Todo skipped;
+            decodeFields(decoder, forward ? skipped : values, field);
+            decodeFields(decoder, forward ? values : skipped, field);
+        }
+        if (decoder.failed()) return false;
+        if (touched) touched->push_back(id);
+
+        if ((mask & ~kBulkFields) == 0) {
+            groups[Values{mask, values.isCompleted(), values.getCategory(), values.getPriority()}].push_back(id);
+            continue;
+        }
+
+        // Gone since: nothing to put back
+        auto todo = database.getTodoById(id);
+        if (!todo) continue;
+        Todo updated = *todo;
+        if (mask & kTitle) updated.setTitle(values.getTitle());
+        if (mask & kDescription) updated.setDescription(values.getDescription());
+        if (mask & kCategory) updated.setCategory(values.getCategory());
+        if (mask & kCompleted) updated.setCompleted(values.isCompleted());
+        if (mask & kDueDate) {
+            if (values.getDueDate()) {
+                updated.setDueDate(*values.getDueDate());
+            } else {
+                updated.clearDueDate();
+            }
+        }
+        if (mask & kPriority) updated.setPriority(values.getPriority());
+        if (mask & kParent) updated.setParentId(values.getParentId());
+        if (!database.updateTodo(updated)) return false;
+    }
+
+    for (const auto& [values, ids] : groups) {
+        const auto& [mask, completed, category, priority] = values;
+        TodoBulkChange change;
+        if (mask & kCompleted) change.completed = completed;
+        if (mask & kCategory) change.category = category;
+        if (mask & kPriority) change.priority = priority;
+        if (database.updateTodos(ids, change) < 0) return false;
+    }
+    return true;
+}
@@ -0,0 +1,80 @@
+#ifndef TODO_JOURNAL_H
+#define TODO_JOURNAL_H
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/TodoDatabase.h"
+
+// Undo and redo for writes made through it. Each write is one entry holding
+// packed deltas: an edit keeps only the fields it changed, before and after,
+// so completing 10k todos costs a few bytes a row; only deletes (and adds,
+// for redo) keep whole rows. Entries live in a ring bounded by bytes, the
+// oldest dropped first. Undo and redo replay an entry in one transaction,
+// grouping rows that share values into bulk updates.
+//
+// Writes that bypass the journal (sync, imports, the CLI) are not undone;
+// an undo rewrites only the fields its entry changed.
+class TodoJournal {
+public:
+    static constexpr size_t kDefaultMemoryCap = 8 << 20;
+
+    explicit TodoJournal(TodoDatabase& database, size_t memoryCap = kDefaultMemoryCap);
+
+    // The TodoDatabase writes, recorded when they succeed
+    bool createTodo(Todo& todo);
+    bool updateTodo(const Todo& before, const Todo& after);
+    bool moveTodo(int id, std::optional<int> newParentId);
+    bool placeTodo(int id, std::optional<int> parentId, std::optional<int> beforeId);
+    int updateTodos(const std::vector<int>& ids, const TodoBulkChange& change,
+                    std::vector<Todo>* before = nullptr);
+    int deleteTodos(const std::vector<int>& ids, std::vector<Todo>* before = nullptr);
+
+    bool canUndo() const { return cursor > 0; }
+    bool canRedo() const { return cursor < entries.size(); }
+    // What the next undo or redo does, "Delete 3 todos"; empty if nothing
+    std::string undoLabel() const;
+    std::string redoLabel() const;
+
+    // False if nothing to do or the replay failed (then rolled back and the
+    // entry kept). touched gets the ids written, when asked.
+    bool undo(std::vector<int>* touched = nullptr);
+    bool redo(std::vector<int>* touched = nullptr);
+
+    void clear();
+    void setMemoryCap(size_t bytes);
+    size_t memoryCap() const { return cap; }
+    size_t memoryUsed() const { return used; }
+    size_t entryCount() const { return entries.size(); }
+
+private:
+    enum class Kind : uint8_t {
+        Update,  // Field deltas per row
+        Create,  // Rows added: undo deletes them, redo puts them back
+        Delete   // Rows removed: undo puts them back, redo deletes them
+    };
+
+    struct Entry {
+        Kind kind;
+        std::string label;
+        std::string data;  // Packed rows, see TodoJournal.cpp
+
+        size_t bytes() const { return sizeof(Entry) + label.capacity() + data.capacity(); }
+    };
+
+    TodoDatabase& database;
+    std::deque<Entry> entries;  // Oldest first; [0, cursor) undo, the rest redo
+    size_t cursor = 0;
+    size_t used = 0;
+    size_t cap;
+
+    void push(Entry entry);
+    void evict();
+    bool replay(const Entry& entry, bool forward, std::vector<int>* touched);
+    bool replayUpdate(const Entry& entry, bool forward, std::vector<int>* touched);
+};
+
+#endif // TODO_JOURNAL_H
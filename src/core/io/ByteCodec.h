@@ -0,0 +1,99 @@
+#ifndef BYTE_CODEC_H
+#define BYTE_CODEC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+// Little-endian varints, zigzag signed varints and length-prefixed strings,
+// for the sync wire format and the undo journal. A decoder that runs out of
+// input or meets a malformed varint stops at the end and reports failed().
+class ByteEncoder {
+public:
+    explicit ByteEncoder(std::string& out) : out(out) {}
+
+    void byte(uint8_t value) { out.push_back(static_cast<char>(value)); }
+
+    void varint(uint64_t value) {
+        while (value >= 0x80) {
+            byte(static_cast<uint8_t>(value | 0x80));
+            value >>= 7;
+        }
+        byte(static_cast<uint8_t>(value));
+    }
+
+    void signedVarint(int64_t value) {
+        varint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+    }
+
+    void string(const std::string& value) {
+        varint(value.size());
+        out.append(value);
+    }
+
+    void bytes(const char* data, size_t length) { out.append(data, length); }
+
+private:
+    std::string& out;
+};
+
+class ByteDecoder {
+public:
+    ByteDecoder(const char* data, size_t length) : pos(data), end(data + length) {}
+
+    bool failed() const { return error; }
+    bool atEnd() const { return pos == end; }
+
+    uint8_t byte() {
+        if (pos == end) return fail();
+        return static_cast<uint8_t>(*pos++);
+    }
+
+    uint64_t varint() {
+        uint64_t value = 0;
+        for (int shift = 0; shift < 64; shift += 7) {
+            uint8_t b = byte();
+            if (error) return 0;
+            value |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if (!(b & 0x80)) return value;
+        }
+        return fail();
+    }
+
+    int64_t signedVarint() {
+        uint64_t value = varint();
+        return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+    }
+
+    std::string string() {
+        uint64_t length = varint();
+        if (error || length > static_cast<uint64_t>(end - pos)) {
+            fail();
+            return std::string();
+        }
+        std::string value(pos, length);
+        pos += length;
+        return value;
+    }
+
+    bool bytes(char* out, size_t length) {
+        if (static_cast<size_t>(end - pos) < length) return fail();
+        std::memcpy(out, pos, length);
+        pos += length;
+        return true;
+    }
+
+private:
+    uint8_t fail() {
+        error = true;
+        pos = end;
+        return 0;
+    }
+
+    const char* pos;
+    const char* end;
+    bool error = false;
+};
+
+#endif // BYTE_CODEC_H
@@ -0,0 +1,472 @@
+#include "TodoExporter.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+BufferedWriter::BufferedWriter(std::FILE* file, size_t capacity)
+    : file(file), buffer(std::max<size_t>(capacity, 256)) {
+}
+
+BufferedWriter::~BufferedWriter() {
+    flush();
+}
+
+void BufferedWriter::write(const char* data, size_t length) {
+    if (length > buffer.size() - used) {
+        flush();
+        // Larger than the whole buffer: hand it to stdio directly
+        if (length > buffer.size()) {
+            if (std::fwrite(data, 1, length, file) != length) error = true;
+            total += length;
+            return;
+        }
+    }
+    std::memcpy(buffer.data() + used, data, length);
+    used += length;
+}
+
+void BufferedWriter::write(const char* text) {
+    write(text, std::strlen(text));
+}
+
+void BufferedWriter::writeInt(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    write(digits, result.ptr - digits);
+}
+
+bool BufferedWriter::flush() {
+    if (used > 0) {
+        if (std::fwrite(buffer.data(), 1, used, file) != used) error = true;
+        total += used;
+        used = 0;
+    }
+    return !error;
+}
+
+namespace {
+
+// RFC 4180: quote only when the field needs it, doubling embedded quotes
+void writeCsvField(BufferedWriter& out, const char* data, size_t length) {
+    bool needsQuotes = false;
+    for (size_t i = 0; i < length; i++) {
+        char c = data[i];
+        if (c == ',' || c == '"' || c == '\n' || c == '\r') {
+            needsQuotes = true;
+            break;
+        }
+    }
+    if (!needsQuotes) {
+        out.write(data, length);
+        return;
+    }
+
+    out.put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; i++) {
+        if (data[i] != '"') continue;
+        out.write(data + runStart, i + 1 - runStart);
+        out.put('"');
+        runStart = i + 1;
+    }
+    out.write(data + runStart, length - runStart);
+    out.put('"');
+}
+
+// Length of the well-formed UTF-8 sequence starting at data, 0 if there is
+// none: no overlongs, surrogates or code points past U+10FFFF
+size_t utf8Sequence(const char* data, size_t remaining) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+    unsigned char lead = bytes[0];
+    size_t length;
+    unsigned char low = 0x80, high = 0xBF;  // Bounds on the second byte
+    if (lead < 0x80) return 1;
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        length = 2;
+    } else if (lead >= 0xE0 && lead <= 0xEF) {
+        length = 3;
+        if (lead == 0xE0) low = 0xA0;
+        if (lead == 0xED) high = 0x9F;
+    } else if (lead >= 0xF0 && lead <= 0xF4) {
+        length = 4;
+        if (lead == 0xF0) low = 0x90;
+        if (lead == 0xF4) high = 0x8F;
+    } else {
+        return 0;
+    }
+    if (remaining < length || bytes[1] < low || bytes[1] > high) return 0;
+    for (size_t i = 2; i < length; i++) {
+        if ((bytes[i] & 0xC0) != 0x80) return 0;
+    }
+    return length;
+}
+
+// JSON text must be UTF-8; each byte that starts no valid sequence is
+// written as U+FFFD instead
+void writeJsonText(BufferedWriter& out, const char* data, size_t length) {
+    static const char hex[] = "0123456789abcdef";
+
+    out.put('"');
+    size_t runStart = 0;
+    for (size_t i = 0; i < length; i++) {
+        unsigned char c = static_cast<unsigned char>(data[i]);
+        if (c >= 0x80) {
+            size_t sequence = utf8Sequence(data + i, length - i);
+            if (sequence > 0) {
+                i += sequence - 1;
+                continue;
+            }
+            out.write(data + runStart, i - runStart);
+            out.write("\xEF\xBF\xBD", 3);
+            runStart = i + 1;
+            continue;
+        }
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.write(data + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+            case '"': out.write("\\\"", 2); break;
+            case '\\': out.write("\\\\", 2); break;
+            case '\n': out.write("\\n", 2); break;
+            case '\r': out.write("\\r", 2); break;
+            case '\t': out.write("\\t", 2); break;
+            default: {
+                char escaped[6] = {'\\', 'u', '0', '0', hex[c >> 4], hex[c & 0xF]};
+                out.write(escaped, 6);
+            }
+        }
+    }
+    out.write(data + runStart, length - runStart);
+    out.put('"');
+}
+
+// RFC 5545 content lines: at most 75 octets, continued with CRLF + space.
+// Folds only between UTF-8 sequences, never inside one.
+class ICalLine {
+public:
+    explicit ICalLine(BufferedWriter& out) : out(out) {}
+
+    void begin(const char* name) {
+        lineLength = 0;
+        raw(name, std::strlen(name));
+        raw(":", 1);
+    }
+
+    void raw(const char* data, size_t length) {
+        for (size_t i = 0; i < length;) {
+            // Plain ASCII that still fits on the line goes out in one copy
+            size_t run = 0;
+            size_t room = lineLength < 75 ? 75 - lineLength : 0;
+            while (run < room && i + run < length &&
+                   static_cast<unsigned char>(data[i + run]) < 0x80) {
+                run++;
+            }
+            if (run > 0) {
+                out.write(data + i, run);
+                lineLength += run;
+                i += run;
+            } else {
+                octet(data[i++]);
+            }
+        }
+    }
+
+    // TEXT value: escape backslash, semicolon, comma and newlines. Other
+    // control characters but tab are not allowed in TEXT and are dropped;
+    // bytes that are not UTF-8 become U+FFFD, as in JSON.
+    void text(const char* data, size_t length) {
+        size_t runStart = 0;
+        for (size_t i = 0; i < length; i++) {
+            char c = data[i];
+            if (static_cast<unsigned char>(c) >= 0x80) {
+                size_t sequence = utf8Sequence(data + i, length - i);
+                if (sequence > 0) {
+                    i += sequence - 1;
+                    continue;
+                }
+                raw(data + runStart, i - runStart);
+                raw("\xEF\xBF\xBD", 3);
+                runStart = i + 1;
+                continue;
+            }
+            bool control = (static_cast<unsigned char>(c) < 0x20 && c != '\t') || c == 0x7F;
+            if (c != '\\' && c != ';' && c != ',' && !control) continue;
+
+            raw(data + runStart, i - runStart);
+            runStart = i + 1;
+            switch (c) {
+                case '\\': raw("\\\\", 2); break;
+                case ';': raw("\\;", 2); break;
+                case ',': raw("\\,", 2); break;
+                case '\n': raw("\\n", 2); break;
+                default: break;  // Dropped; for CR the line break is the LF
+            }
+        }
+        raw(data + runStart, length - runStart);
+    }
+
+    void end() {
+        out.write("\r\n", 2);
+    }
+
+private:
+    BufferedWriter& out;
+    size_t lineLength = 0;
+
+    void octet(char c) {
+        unsigned char byte = static_cast<unsigned char>(c);
+        if ((byte & 0xC0) != 0x80) {
+            size_t sequence = byte >= 0xF0 ? 4 : byte >= 0xE0 ? 3 : byte >= 0xC0 ? 2 : 1;
+            if (lineLength + sequence > 75) {
+                out.write("\r\n ", 3);
+                lineLength = 1;
+            }
+        }
+        out.put(c);
+        lineLength++;
+    }
+};
+
+// 20261018T142500Z. Civil date from days since the epoch (H. Hinnant's
+// algorithm), which avoids gmtime's locking and per-call setup.
+void formatUtcStamp(char (&stamp)[16], time_t time) {
+    int64_t days = time >= 0 ? time / 86400 : (time - 86399) / 86400;
+    int64_t seconds = time - days * 86400;
+
+    days += 719468;
+    int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+    int64_t dayOfEra = days - era * 146097;
+    int64_t yearOfEra = (dayOfEra - dayOfEra / 1460 + dayOfEra / 36524 - dayOfEra / 146096) / 365;
+    int64_t dayOfYear = dayOfEra - (365 * yearOfEra + yearOfEra / 4 - yearOfEra / 100);
+    int64_t mp = (5 * dayOfYear + 2) / 153;
+    int day = static_cast<int>(dayOfYear - (153 * mp + 2) / 5 + 1);
+    int month = static_cast<int>(mp < 10 ? mp + 3 : mp - 9);
+    int year = static_cast<int>(yearOfEra + era * 400 + (month <= 2 ? 1 : 0));
+
+    auto two = [&stamp](int offset, int value) {
+        stamp[offset] = static_cast<char>('0' + value / 10);
+        stamp[offset + 1] = static_cast<char>('0' + value % 10);
+    };
+    two(0, year / 100 % 100);
+    two(2, year % 100);
+    two(4, month);
+    two(6, day);
+    stamp[8] = 'T';
+    two(9, static_cast<int>(seconds / 3600));
+    two(11, static_cast<int>(seconds / 60 % 60));
+    two(13, static_cast<int>(seconds % 60));
+    stamp[15] = 'Z';
+}
+
+void writeCsvHeader(BufferedWriter& out) {
+    out.write("id,title,description,category,completed,priority,due_date,created_at,updated_at\n");
+}
+
+void writeCsvRow(BufferedWriter& out, const TodoRowView& row) {
+    out.writeInt(row.id);
+    out.put(',');
+    writeCsvField(out, row.title, row.titleLength);
+    out.put(',');
+    writeCsvField(out, row.description, row.descriptionLength);
+    out.put(',');
+    writeCsvField(out, row.category, row.categoryLength);
+    out.put(',');
+    out.put(row.completed ? '1' : '0');
+    out.put(',');
+    out.writeInt(row.priority);
+    out.put(',');
+    if (row.due_date) out.writeInt(*row.due_date);
+    out.put(',');
+    out.writeInt(row.created_at);
+    out.put(',');
+    out.writeInt(row.updated_at);
+    out.put('\n');
+}
+
+void writeJsonRow(BufferedWriter& out, const TodoRowView& row) {
+    out.write("{\"id\":");
+    out.writeInt(row.id);
+    out.write(",\"title\":");
+    writeJsonText(out, row.title, row.titleLength);
+    out.write(",\"description\":");
+    writeJsonText(out, row.description, row.descriptionLength);
+    out.write(",\"category\":");
+    writeJsonText(out, row.category, row.categoryLength);
+    out.write(row.completed ? ",\"completed\":true" : ",\"completed\":false");
+    out.write(",\"priority\":");
+    out.writeInt(row.priority);
+    out.write(",\"due_date\":");
+    if (row.due_date) {
+        out.writeInt(*row.due_date);
+    } else {
+        out.write("null");
+    }
+    out.write(",\"created_at\":");
+    out.writeInt(row.created_at);
+    out.write(",\"updated_at\":");
+    out.writeInt(row.updated_at);
+    out.write("}\n");
+}
+
+void writeICalHeader(BufferedWriter& out) {
+    out.write("BEGIN:VCALENDAR\r\nVERSION:2.0\r\nPRODID:-//TodoApp//Todo Export//EN\r\n");
+}
+
+void writeICalFooter(BufferedWriter& out) {
+    out.write("END:VCALENDAR\r\n");
+}
+
+void writeICalRow(BufferedWriter& out, const TodoRowView& row) {
+    ICalLine line(out);
+    char number[24];
+
+    out.write("BEGIN:VTODO\r\n");
+
+    // The sync uuid, so a todo keeps one UID across synced databases; ids
+    // are local to each
+    line.begin("UID");
+    if (row.uuidLength == 16) {
+        static const char hex[] = "0123456789abcdef";
+        char uid[36];
+        size_t length = 0;
+        for (int i = 0; i < 16; i++) {
+            if (i == 4 || i == 6 || i == 8 || i == 10) uid[length++] = '-';
+            unsigned char byte = static_cast<unsigned char>(row.uuid[i]);
+            uid[length++] = hex[byte >> 4];
+            uid[length++] = hex[byte & 0xF];
+        }
+        line.raw(uid, length);
+    } else {
+        line.raw("todo-", 5);
+        auto id = std::to_chars(number, number + sizeof(number), row.id);
+        line.raw(number, id.ptr - number);
+        line.raw("@todoapp", 8);
+    }
+    line.end();
+
+    char stamp[16];
+    formatUtcStamp(stamp, row.updated_at);
+    line.begin("DTSTAMP");
+    line.raw(stamp, sizeof(stamp));
+    line.end();
+
+    line.begin("LAST-MODIFIED");
+    line.raw(stamp, sizeof(stamp));
+    line.end();
+
+    formatUtcStamp(stamp, row.created_at);
+    line.begin("CREATED");
+    line.raw(stamp, sizeof(stamp));
+    line.end();
+
+    line.begin("SUMMARY");
+    line.text(row.title, row.titleLength);
+    line.end();
+
+    if (row.descriptionLength > 0) {
+        line.begin("DESCRIPTION");
+        line.text(row.description, row.descriptionLength);
+        line.end();
+    }
+
+    if (row.categoryLength > 0) {
+        line.begin("CATEGORIES");
+        line.text(row.category, row.categoryLength);
+        line.end();
+    }
+
+    // iCalendar priority: 1 is highest, 5 medium, 9 lowest
+    line.begin("PRIORITY");
+    line.raw(row.priority >= 3 ? "1" : row.priority == 2 ? "5" : "9", 1);
+    line.end();
+
+    if (row.due_date) {
+        formatUtcStamp(stamp, *row.due_date);
+        line.begin("DUE");
+        line.raw(stamp, sizeof(stamp));
+        line.end();
+    }
+
+    line.begin("STATUS");
+    if (row.completed) {
+        line.raw("COMPLETED", 9);
+    } else {
+        line.raw("NEEDS-ACTION", 12);
+    }
+    line.end();
+
+    out.write("END:VTODO\r\n");
+}
+
+std::string lowerExtension(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return "";
+    std::string extension = path.substr(dot + 1);
+    for (char& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+    return extension;
+}
+
+}
+
+TodoExporter::TodoExporter(TodoDatabase& database)
+    : database(database) {
+}
+
+std::optional<ExportFormat> TodoExporter::formatFromPath(const std::string& path) {
+    std::string extension = lowerExtension(path);
+    if (extension == "csv") return ExportFormat::Csv;
+    if (extension == "jsonl" || extension == "ndjson") return ExportFormat::JsonLines;
+    if (extension == "ics") return ExportFormat::ICalendar;
+    return std::nullopt;
+}
+
+ExportResult TodoExporter::exportToFile(const std::string& path, const ExportOptions& options) {
+    if (path == "-") {
+        return exportToStream(stdout, options);
+    }
+
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        return ExportResult();
+    }
+
+    ExportResult result = exportToStream(file, options);
+    if (std::fclose(file) != 0) result.ok = false;
+    return result;
+}
+
+ExportResult TodoExporter::exportToStream(std::FILE* file, const ExportOptions& options) {
+    ExportResult result;
+    BufferedWriter out(file, options.bufferBytes);
+
+    switch (options.format) {
+        case ExportFormat::Csv: writeCsvHeader(out); break;
+        case ExportFormat::ICalendar: writeICalHeader(out); break;
+        case ExportFormat::JsonLines: break;
+    }
+
+    bool read = database.forEachTodoRow([&](const TodoRowView& row) {
+        switch (options.format) {
+            case ExportFormat::Csv: writeCsvRow(out, row); break;
+            case ExportFormat::JsonLines: writeJsonRow(out, row); break;
+            case ExportFormat::ICalendar: writeICalRow(out, row); break;
+        }
+        result.rowsExported++;
+        return !out.failed();
+    }, options.category);
+
+    if (options.format == ExportFormat::ICalendar) {
+        writeICalFooter(out);
+    }
+
+    bool flushed = out.flush();
+    std::fflush(file);
+
+    result.bytesWritten = out.bytesWritten();
+    result.ok = read && flushed;
+    return result;
+}
@@ -0,0 +1,78 @@
+#ifndef TODO_EXPORTER_H
+#define TODO_EXPORTER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/TodoDatabase.h"
+
+enum class ExportFormat {
+    Csv,        // Header row; reads back with TodoImporter
+    JsonLines,  // Same object layout as writeTodoJson(), less parent_id (ids are local)
+    ICalendar   // RFC 5545 VCALENDAR of VTODO components
+};
+
+// Fixed-size output buffer over a FILE*. Everything the exporters write,
+// including numbers, goes through here without heap allocation.
+class BufferedWriter {
+public:
+    BufferedWriter(std::FILE* file, size_t capacity);
+    ~BufferedWriter();
+
+    BufferedWriter(const BufferedWriter&) = delete;
+    BufferedWriter& operator=(const BufferedWriter&) = delete;
+
+    void write(const char* data, size_t length);
+    void write(const char* text);
+    void put(char c) {
+        if (used == buffer.size()) flush();
+        buffer[used++] = c;
+    }
+    void writeInt(int64_t value);
+
+    bool flush();
+    bool failed() const { return error; }
+    size_t bytesWritten() const { return total + used; }
+
+private:
+    std::FILE* file;
+    std::vector<char> buffer;
+    size_t used = 0;
+    size_t total = 0;
+    bool error = false;
+};
+
+struct ExportOptions {
+    ExportFormat format = ExportFormat::Csv;
+    std::optional<std::string> category;  // std::nullopt exports everything
+    size_t bufferBytes = 64 * 1024;
+};
+
+struct ExportResult {
+    bool ok = false;
+    size_t rowsExported = 0;
+    size_t bytesWritten = 0;
+};
+
+// Streams rows from a SQLite cursor (TodoDatabase::forEachTodoRow) straight
+// into the writer, escaping text out of SQLite's buffers. Memory use is the
+// write buffer, whatever the table size.
+class TodoExporter {
+public:
+    explicit TodoExporter(TodoDatabase& database);
+
+    // "-" writes to stdout
+    ExportResult exportToFile(const std::string& path, const ExportOptions& options);
+    ExportResult exportToStream(std::FILE* file, const ExportOptions& options);
+
+    // By extension: .csv, .jsonl / .ndjson, .ics
+    static std::optional<ExportFormat> formatFromPath(const std::string& path);
+
+private:
+    TodoDatabase& database;
+};
+
+#endif // TODO_EXPORTER_H
@@ -0,0 +1,536 @@
+#include "TodoImporter.h"
+#include "TodoJson.h"
+#include <algorithm>
+#include <cctype>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+namespace {
+
+// Raw values of one input row, before validation
+struct RowFields {
+    std::optional<std::string> title;
+    std::optional<std::string> description;
+    std::optional<std::string> category;
+    std::optional<std::string> completed;
+    std::optional<std::string> priority;
+    std::optional<std::string> dueDate;
+    std::optional<std::string> createdAt;
+    std::optional<std::string> updatedAt;
+
+    std::optional<std::string>* field(const std::string& name) {
+        if (name == "title") return &title;
+        if (name == "description") return &description;
+        if (name == "category") return &category;
+        if (name == "completed") return &completed;
+        if (name == "priority") return &priority;
+        if (name == "due_date") return &dueDate;
+        if (name == "created_at") return &createdAt;
+        if (name == "updated_at") return &updatedAt;
+        return nullptr;
+    }
+};
+
+struct ParsedBatch {
+    std::vector<Todo> todos;
+    size_t rejected = 0;
+    std::vector<std::string> errors;
+    size_t bytesRead = 0;
+};
+
+// Hands parsed batches from the worker to the inserting thread. Bounded so a
+// fast parser can't run ahead of SQLite and buffer the whole file.
+class BatchQueue {
+public:
+    explicit BatchQueue(size_t capacity) : capacity(capacity) {}
+
+    // Returns false once the consumer has given up
+    bool push(ParsedBatch batch) {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return cancelled || batches.size() < capacity; });
+        if (cancelled) return false;
+        batches.push_back(std::move(batch));
+        changed.notify_all();
+        return true;
+    }
+
+    std::optional<ParsedBatch> pop() {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this]() { return finished || !batches.empty(); });
+        if (batches.empty()) return std::nullopt;
+        ParsedBatch batch = std::move(batches.front());
+        batches.pop_front();
+        changed.notify_all();
+        return batch;
+    }
+
+    void finish() {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+        changed.notify_all();
+    }
+
+    void cancel() {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        changed.notify_all();
+    }
+
+private:
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<ParsedBatch> batches;
+    size_t capacity;
+    bool finished = false;
+    bool cancelled = false;
+};
+
+std::string trim(const std::string& text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string::npos) return "";
+    size_t last = text.find_last_not_of(" \t\r\n");
+    return text.substr(first, last - first + 1);
+}
+
+std::string lower(std::string text) {
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return text;
+}
+
+// Turns RowFields into validated todos and collects batches
+class RowBuilder {
+public:
+    RowBuilder(const ImportOptions& options, BatchQueue& queue)
+        : options(options), queue(queue) {
+        batch.todos.reserve(options.batchSize);
+    }
+
+    void add(const RowFields& row, size_t line) {
+        Todo todo;
+        std::string error;
+        if (build(row, todo, error)) {
+            batch.todos.push_back(std::move(todo));
+        } else {
+            reject(line, error);
+            return;
+        }
+        if (batch.todos.size() >= options.batchSize) flush();
+    }
+
+    void reject(size_t line, const std::string& reason) {
+        batch.rejected++;
+        if (errorCount++ < options.maxErrors) {
+            batch.errors.push_back("line " + std::to_string(line) + ": " + reason);
+        }
+    }
+
+    // Bytes consumed so far, reported with the next batch
+    void setBytesRead(size_t bytes) { bytesRead = bytes; }
+
+    void flush() {
+        if (cancelled) return;
+        batch.bytesRead = bytesRead;
+        cancelled = !queue.push(std::move(batch));
+        batch = ParsedBatch();
+        batch.todos.reserve(options.batchSize);
+    }
+
+    bool isCancelled() const { return cancelled; }
+
+private:
+    const ImportOptions& options;
+    BatchQueue& queue;
+    ParsedBatch batch;
+    size_t errorCount = 0;
+    size_t bytesRead = 0;
+    bool cancelled = false;
+    std::unordered_map<std::string, time_t> dateCache;  // mktime is slow; dates repeat a lot
+
+    bool parseTime(const std::string& text, time_t& value) {
+        auto isDigit = [](char c) { return c >= '0' && c <= '9'; };
+        size_t digitsFrom = !text.empty() && text[0] == '-' ? 1 : 0;
+        if (text.size() > digitsFrom && std::all_of(text.begin() + digitsFrom, text.end(), isDigit)) {
+            value = static_cast<time_t>(std::strtoll(text.c_str(), nullptr, 10));
+            return true;
+        }
+
+        // YYYY-MM-DD at local midnight
+        if (text.size() != 10 || text[4] != '-' || text[7] != '-') return false;
+        auto cached = dateCache.find(text);
+        if (cached != dateCache.end()) {
+            value = cached->second;
+            return true;
+        }
+        for (size_t i : {0, 1, 2, 3, 5, 6, 8, 9}) {
+            if (!std::isdigit(static_cast<unsigned char>(text[i]))) return false;
+        }
+
+        std::tm tm = {};
+        tm.tm_year = std::atoi(text.substr(0, 4).c_str()) - 1900;
+        tm.tm_mon = std::atoi(text.substr(5, 2).c_str()) - 1;
+        tm.tm_mday = std::atoi(text.substr(8, 2).c_str());
+        tm.tm_isdst = -1;
+        if (tm.tm_mon < 0 || tm.tm_mon > 11 || tm.tm_mday < 1 || tm.tm_mday > 31) return false;
+
+        value = std::mktime(&tm);
+        if (value == -1) return false;
+        if (dateCache.size() < 100000) dateCache.emplace(text, value);
+        return true;
+    }
+
+    bool build(const RowFields& row, Todo& todo, std::string& error) {
+        std::string title = row.title ? trim(*row.title) : "";
+        if (title.empty()) {
+            error = "missing title";
+            return false;
+        }
+
+        int priority = 2;
+        if (row.priority) {
+            std::string text = lower(trim(*row.priority));
+            if (text == "1" || text == "low") priority = 1;
+            else if (text.empty() || text == "2" || text == "medium") priority = 2;
+            else if (text == "3" || text == "high") priority = 3;
+            else {
+                error = "invalid priority '" + *row.priority + "'";
+                return false;
+            }
+        }
+
+        bool completed = false;
+        if (row.completed) {
+            std::string text = lower(trim(*row.completed));
+            if (text == "1" || text == "true" || text == "yes" || text == "x") completed = true;
+            else if (!(text.empty() || text == "0" || text == "false" || text == "no")) {
+                error = "invalid completed '" + *row.completed + "'";
+                return false;
+            }
+        }
+
+        std::optional<time_t> due;
+        if (row.dueDate && !trim(*row.dueDate).empty()) {
+            time_t value;
+            if (!parseTime(trim(*row.dueDate), value)) {
+                error = "invalid due_date '" + *row.dueDate + "'";
+                return false;
+            }
+            due = value;
+        }
+
+        std::optional<time_t> created;
+        if (row.createdAt && !trim(*row.createdAt).empty()) {
+            time_t value;
+            if (!parseTime(trim(*row.createdAt), value)) {
+                error = "invalid created_at '" + *row.createdAt + "'";
+                return false;
+            }
+            created = value;
+        }
+
+        std::optional<time_t> updated;
+        if (row.updatedAt && !trim(*row.updatedAt).empty()) {
+            time_t value;
+            if (!parseTime(trim(*row.updatedAt), value)) {
+                error = "invalid updated_at '" + *row.updatedAt + "'";
+                return false;
+            }
+            updated = value;
+        }
+
+        std::string category = row.category ? trim(*row.category) : "";
+        todo = Todo(title, row.description.value_or(""), category.empty() ? "general" : category,
+                    priority);
+        todo.setCompleted(completed);
+        if (due) todo.setDueDate(*due);
+        // Setters above bump updated_at, so set the stored timestamps last.
+        // A completed todo's completed_at is its updated_at.
+        if (created) {
+            todo.setCreatedAt(*created);
+            todo.setUpdatedAt(*created);
+        }
+        if (updated) todo.setUpdatedAt(*updated);
+        return true;
+    }
+};
+
+// RFC 4180 state machine. State survives chunk boundaries, so quoted fields
+// may contain newlines and span reads.
+class CsvParser {
+public:
+    explicit CsvParser(RowBuilder& builder) : builder(builder) {}
+
+    void feed(const char* data, size_t size) {
+        for (size_t i = 0; i < size; i++) {
+            char c = data[i];
+            switch (state) {
+                case State::FieldStart:
+                    if (c == '"') {
+                        state = State::Quoted;
+                    } else if (c == ',') {
+                        endField();
+                    } else if (c == '\n') {
+                        endRecord();
+                    } else if (c != '\r') {
+                        field += c;
+                        state = State::Unquoted;
+                    }
+                    break;
+
+                case State::Unquoted: {
+                    // Copy the run up to the next delimiter in one go
+                    size_t end = i;
+                    while (end < size && data[end] != ',' && data[end] != '\n' && data[end] != '\r') {
+                        end++;
+                    }
+                    field.append(data + i, end - i);
+                    i = end;
+                    if (i == size) break;
+                    if (data[i] == ',') endField();
+                    else if (data[i] == '\n') endRecord();
+                    break;
+                }
+
+                case State::Quoted: {
+                    // Copy everything up to the closing quote in one go
+                    const char* quote = static_cast<const char*>(std::memchr(data + i, '"', size - i));
+                    size_t end = quote ? static_cast<size_t>(quote - data) : size;
+                    line += std::count(data + i, data + end, '\n');
+                    field.append(data + i, end - i);
+                    i = end;
+                    if (quote) state = State::QuoteInQuoted;
+                    break;
+                }
+
+                case State::QuoteInQuoted:
+                    if (c == '"') {
+                        field += '"';
+                        state = State::Quoted;
+                    } else if (c == ',') {
+                        endField();
+                    } else if (c == '\n') {
+                        endRecord();
+                    } else if (c != '\r') {
+                        // Stray quote inside a field: keep the text as-is
+                        field += c;
+                        state = State::Unquoted;
+                    }
+                    break;
+            }
+        }
+    }
+
+    void finish() {
+        // A quote never closed swallows the rest of the file into one field
+        if (state == State::Quoted) {
+            builder.reject(recordLine, "unterminated quoted field");
+            field.clear();
+            fields.clear();
+            state = State::FieldStart;
+            return;
+        }
+        if (!field.empty() || !fields.empty() || state != State::FieldStart) {
+            endRecord();
+        }
+    }
+
+private:
+    enum class State {
+        FieldStart,
+        Unquoted,
+        Quoted,
+        QuoteInQuoted
+    };
+
+    RowBuilder& builder;
+    State state = State::FieldStart;
+    std::string field;
+    std::vector<std::string> fields;
+    std::vector<std::string> header;
+    size_t line = 1;
+    size_t recordLine = 1;
+
+    void endField() {
+        fields.push_back(std::move(field));
+        field.clear();
+        state = State::FieldStart;
+    }
+
+    void endRecord() {
+        endField();
+        size_t startLine = recordLine;
+        line++;
+        recordLine = line;
+
+        // Blank lines are not records
+        if (fields.size() == 1 && fields[0].empty()) {
+            fields.clear();
+            return;
+        }
+
+        if (header.empty()) {
+            for (const auto& name : fields) header.push_back(lower(trim(name)));
+        } else {
+            RowFields row;
+            for (size_t i = 0; i < fields.size() && i < header.size(); i++) {
+                if (auto* target = row.field(header[i])) *target = std::move(fields[i]);
+            }
+            builder.add(row, startLine);
+        }
+        fields.clear();
+    }
+};
+
+void parseStream(std::istream& in, const ImportOptions& options, BatchQueue& queue) {
+    RowBuilder builder(options, queue);
+    CsvParser csv(builder);
+
+    std::vector<char> buffer(std::max<size_t>(options.chunkBytes, 4096));
+    std::string pendingLine;  // JSONL line cut by a chunk boundary
+    size_t bytesRead = 0;
+    size_t line = 1;
+
+    auto parseLine = [&](const char* begin, size_t length) {
+        std::string text(begin, length);
+        if (!pendingLine.empty()) {
+            text = pendingLine + text;
+            pendingLine.clear();
+        }
+        if (trim(text).empty()) return;
+
+        RowFields row;
+        std::string error;
+        bool ok = readJsonObject(text, [&row](const std::string& key, std::optional<std::string> value) {
+            if (auto* target = row.field(key)) *target = std::move(value);
+        }, error);
+        if (ok) {
+            builder.add(row, line);
+        } else {
+            builder.reject(line, error);
+        }
+    };
+
+    while (in) {
+        in.read(buffer.data(), buffer.size());
+        size_t count = static_cast<size_t>(in.gcount());
+        if (count == 0) break;
+        bytesRead += count;
+        builder.setBytesRead(bytesRead);
+
+        if (options.format == ImportFormat::Csv) {
+            csv.feed(buffer.data(), count);
+        } else {
+            const char* data = buffer.data();
+            const char* end = data + count;
+            while (data < end) {
+                const char* newline = static_cast<const char*>(std::memchr(data, '\n', end - data));
+                if (!newline) {
+                    pendingLine.append(data, end - data);
+                    break;
+                }
+                parseLine(data, newline - data);
+                line++;
+                data = newline + 1;
+            }
+        }
+
+        if (builder.isCancelled()) return;
+    }
+
+    if (options.format == ImportFormat::Csv) {
+        csv.finish();
+    } else if (!pendingLine.empty()) {
+        std::string last;
+        last.swap(pendingLine);
+        parseLine(last.data(), last.size());
+    }
+    builder.flush();
+}
+
+}
+
+TodoImporter::TodoImporter(TodoDatabase& database)
+    : database(database) {
+}
+
+std::optional<ImportFormat> TodoImporter::formatFromPath(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) return std::nullopt;
+
+    std::string extension = lower(path.substr(dot + 1));
+    if (extension == "csv") return ImportFormat::Csv;
+    if (extension == "jsonl" || extension == "ndjson") return ImportFormat::JsonLines;
+    return std::nullopt;
+}
+
+ImportResult TodoImporter::importFile(const std::string& path, const ImportOptions& options) {
+    std::ifstream in(path, std::ios::binary | std::ios::ate);
+    if (!in) {
+        ImportResult result;
+        result.errors.push_back("cannot open " + path);
+        return result;
+    }
+
+    size_t totalBytes = static_cast<size_t>(in.tellg());
+    in.seekg(0);
+    return importStream(in, options, totalBytes);
+}
+
+ImportResult TodoImporter::importStream(std::istream& in, const ImportOptions& options,
+                                        size_t totalBytes) {
+    ImportResult result;
+    ImportProgress progress;
+    progress.totalBytes = totalBytes;
+
+    if (options.deferIndexes && !database.beginBulkLoad()) {
+        result.errors.push_back("could not drop indexes for bulk load");
+        return result;
+    }
+
+    // Two batches in flight: one being parsed, one waiting for the insert
+    BatchQueue queue(2);
+    std::thread worker([&in, &options, &queue]() {
+        parseStream(in, options, queue);
+        queue.finish();
+    });
+
+    bool failed = false;
+    while (auto batch = queue.pop()) {
+        if (!batch->todos.empty() && !database.createTodos(batch->todos)) {
+            result.errors.push_back("database error after " + std::to_string(result.rowsImported) +
+                                    " rows; import stopped");
+            failed = true;
+            queue.cancel();
+            break;
+        }
+
+        result.rowsImported += batch->todos.size();
+        result.rowsRejected += batch->rejected;
+        for (auto& error : batch->errors) {
+            if (result.errors.size() < options.maxErrors) result.errors.push_back(std::move(error));
+        }
+
+        progress.bytesRead = batch->bytesRead;
+        progress.rowsImported = result.rowsImported;
+        progress.rowsRejected = result.rowsRejected;
+        if (options.onProgress) options.onProgress(progress);
+    }
+
+    worker.join();
+
+    if (options.deferIndexes && !database.endBulkLoad()) {
+        result.errors.push_back("could not rebuild indexes");
+        failed = true;
+    }
+
+    result.ok = !failed && !in.bad();
+    if (in.bad()) result.errors.push_back("read error");
+    return result;
+}
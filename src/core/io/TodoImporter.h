@@ -0,0 +1,67 @@
+#ifndef TODO_IMPORTER_H
+#define TODO_IMPORTER_H
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/TodoDatabase.h"
+
+enum class ImportFormat {
+    Csv,        // Header row names the columns; RFC 4180 quoting
+    JsonLines   // One object per line, same keys as writeTodoJson()
+};
+
+struct ImportProgress {
+    size_t bytesRead = 0;
+    size_t totalBytes = 0;    // 0 when unknown (pipes)
+    size_t rowsImported = 0;
+    size_t rowsRejected = 0;
+};
+
+struct ImportOptions {
+    ImportFormat format = ImportFormat::Csv;
+    size_t batchSize = 50000;        // Rows per transaction
+    size_t chunkBytes = 1 << 20;     // Read size
+    size_t maxErrors = 100;          // Messages kept; rejected rows are still counted
+    // Drop secondary indexes for the import and rebuild them at the end
+    // (TodoDatabase::beginBulkLoad). Much faster unless the file is small
+    // compared to the existing table.
+    bool deferIndexes = true;
+    // Called on the importing thread after every committed batch
+    std::function<void(const ImportProgress&)> onProgress;
+};
+
+struct ImportResult {
+    bool ok = false;
+    size_t rowsImported = 0;
+    size_t rowsRejected = 0;
+    std::vector<std::string> errors;  // "line N: reason"
+};
+
+// Streams CSV or JSON Lines into the database. A worker thread reads and
+// parses chunks into batches while the calling thread, which owns the
+// connection, inserts each batch in one transaction. Memory stays bounded by
+// a couple of batches whatever the file size.
+//
+// Columns/keys: title (required), description, category, completed,
+// priority (1-3 or low/medium/high), due_date, created_at and updated_at
+// (unix seconds or YYYY-MM-DD). Unknown columns and "id" are ignored. Invalid rows are
+// rejected and reported; batches committed before a database error stay.
+class TodoImporter {
+public:
+    explicit TodoImporter(TodoDatabase& database);
+
+    ImportResult importFile(const std::string& path, const ImportOptions& options);
+    ImportResult importStream(std::istream& in, const ImportOptions& options, size_t totalBytes = 0);
+
+    // By extension: .csv, .jsonl / .ndjson
+    static std::optional<ImportFormat> formatFromPath(const std::string& path);
+
+private:
+    TodoDatabase& database;
+};
+
+#endif // TODO_IMPORTER_H
@@ -0,0 +1,236 @@
+#include "TodoJson.h"
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+
+namespace {
+
+void appendUtf8(std::string& out, unsigned int codePoint) {
+    if (codePoint < 0x80) {
+        out += static_cast<char>(codePoint);
+    } else if (codePoint < 0x800) {
+        out += static_cast<char>(0xC0 | (codePoint >> 6));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else if (codePoint < 0x10000) {
+        out += static_cast<char>(0xE0 | (codePoint >> 12));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (codePoint >> 18));
+        out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (codePoint & 0x3F));
+    }
+}
+
+class JsonObjectReader {
+public:
+    bool parse(const std::string& text, const JsonFieldVisitor& visit, std::string& error) {
+        s = &text;
+        pos = 0;
+
+        skipSpace();
+        if (!consume('{')) return fail(error, "expected '{'");
+        skipSpace();
+        if (consume('}')) return atEnd(error);
+
+        while (true) {
+            std::string key;
+            skipSpace();
+            if (!parseString(key)) return fail(error, "expected a string key");
+            skipSpace();
+            if (!consume(':')) return fail(error, "expected ':'");
+            skipSpace();
+
+            std::optional<std::string> value;
+            if (!parseValue(value)) return fail(error, "invalid value for '" + key + "'");
+            visit(key, std::move(value));
+
+            skipSpace();
+            if (consume(',')) continue;
+            if (consume('}')) return atEnd(error);
+            return fail(error, "expected ',' or '}'");
+        }
+    }
+
+private:
+    const std::string* s = nullptr;
+    size_t pos = 0;
+
+    bool fail(std::string& error, const std::string& reason) {
+        error = reason + " at column " + std::to_string(pos + 1);
+        return false;
+    }
+
+    bool atEnd(std::string& error) {
+        skipSpace();
+        if (pos != s->size()) return fail(error, "trailing characters");
+        return true;
+    }
+
+    void skipSpace() {
+        while (pos < s->size() && std::isspace(static_cast<unsigned char>((*s)[pos]))) pos++;
+    }
+
+    bool consume(char c) {
+        if (pos < s->size() && (*s)[pos] == c) {
+            pos++;
+            return true;
+        }
+        return false;
+    }
+
+    bool parseHex4(unsigned int& value) {
+        if (pos + 4 > s->size()) return false;
+        value = 0;
+        for (int i = 0; i < 4; i++) {
+            char c = (*s)[pos++];
+            value <<= 4;
+            if (c >= '0' && c <= '9') value |= c - '0';
+            else if (c >= 'a' && c <= 'f') value |= c - 'a' + 10;
+            else if (c >= 'A' && c <= 'F') value |= c - 'A' + 10;
+            else return false;
+        }
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        if (!consume('"')) return false;
+        while (pos < s->size()) {
+            // Copy the plain run up to the next quote or escape
+            size_t end = s->find_first_of("\"\\", pos);
+            if (end == std::string::npos) return false;
+            out.append(*s, pos, end - pos);
+            pos = end;
+
+            if ((*s)[pos++] == '"') return true;
+            if (pos >= s->size()) return false;
+
+            char escape = (*s)[pos++];
+            switch (escape) {
+                case '"': out += '"'; break;
+                case '\\': out += '\\'; break;
+                case '/': out += '/'; break;
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': {
+                    unsigned int codePoint;
+                    if (!parseHex4(codePoint)) return false;
+                    if (codePoint >= 0xD800 && codePoint <= 0xDBFF) {
+                        unsigned int low;
+                        if (!consume('\\') || !consume('u') || !parseHex4(low) ||
+                            low < 0xDC00 || low > 0xDFFF) {
+                            return false;
+                        }
+                        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+                    }
+                    appendUtf8(out, codePoint);
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        return false;
+    }
+
+    bool parseValue(std::optional<std::string>& value) {
+        if (pos >= s->size()) return false;
+        char c = (*s)[pos];
+
+        if (c == '"') {
+            std::string text;
+            if (!parseString(text)) return false;
+            value = std::move(text);
+            return true;
+        }
+        if (s->compare(pos, 4, "null") == 0) {
+            pos += 4;
+            value.reset();
+            return true;
+        }
+        if (s->compare(pos, 4, "true") == 0) {
+            pos += 4;
+            value = "true";
+            return true;
+        }
+        if (s->compare(pos, 5, "false") == 0) {
+            pos += 5;
+            value = "false";
+            return true;
+        }
+        if (c == '-' || std::isdigit(static_cast<unsigned char>(c))) {
+            size_t start = pos;
+            while (pos < s->size() && (*s)[pos] != '\0' && std::strchr("+-.eE0123456789", (*s)[pos])) {
+                pos++;
+            }
+            value = s->substr(start, pos - start);
+            return true;
+        }
+        return false;  // Nested objects and arrays are not todo fields
+    }
+};
+
+} // namespace
+
+void writeJsonString(std::ostream& out, const std::string& text) {
+    out.put('"');
+
+    // Copy runs of plain characters in one write
+    size_t runStart = 0;
+    for (size_t i = 0; i < text.size(); i++) {
+        unsigned char c = static_cast<unsigned char>(text[i]);
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        out.write(text.data() + runStart, i - runStart);
+        runStart = i + 1;
+
+        switch (c) {
+            case '"': out << "\\\""; break;
+            case '\\': out << "\\\\"; break;
+            case '\n': out << "\\n"; break;
+            case '\r': out << "\\r"; break;
+            case '\t': out << "\\t"; break;
+            default: {
+                char escaped[8];
+                std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+                out << escaped;
+            }
+        }
+    }
+    out.write(text.data() + runStart, text.size() - runStart);
+
+    out.put('"');
+}
+
+void writeTodoJson(std::ostream& out, const Todo& todo) {
+    out << "{\"id\":" << todo.getId() << ",\"title\":";
+    writeJsonString(out, todo.getTitle());
+    out << ",\"description\":";
+    writeJsonString(out, todo.getDescription());
+    out << ",\"category\":";
+    writeJsonString(out, todo.getCategory());
+    out << ",\"completed\":" << (todo.isCompleted() ? "true" : "false")
+        << ",\"priority\":" << todo.getPriority() << ",\"due_date\":";
+    if (todo.getDueDate()) {
+        out << *todo.getDueDate();
+    } else {
+        out << "null";
+    }
+    out << ",\"parent_id\":";
+    if (todo.getParentId()) {
+        out << *todo.getParentId();
+    } else {
+        out << "null";
+    }
+    out << ",\"created_at\":" << todo.getCreatedAt()
+        << ",\"updated_at\":" << todo.getUpdatedAt() << "}";
+}
+
+bool readJsonObject(const std::string& text, const JsonFieldVisitor& visit, std::string& error) {
+    JsonObjectReader reader;
+    return reader.parse(text, visit, error);
+}
@@ -0,0 +1,29 @@
+#ifndef TODO_JSON_H
+#define TODO_JSON_H
+
+#include <functional>
+#include <optional>
+#include <ostream>
+#include <string>
+#include "../models/Todo.h"
+
+// Minimal JSON for the command-line tools, importers and the server. Each
+// todo is one object on one line, so a stream of them is valid JSON Lines.
+
+// Appends text as a quoted JSON string
+void writeJsonString(std::ostream& out, const std::string& text);
+
+// {"id":..,"title":..,"description":..,"category":..,"completed":..,
+//  "priority":..,"due_date":..|null,"parent_id":..|null,"created_at":..,
+//  "updated_at":..}
+void writeTodoJson(std::ostream& out, const Todo& todo);
+
+// Key and value of one member; numbers and booleans arrive as their source
+// text, null as std::nullopt
+using JsonFieldVisitor = std::function<void(const std::string&, std::optional<std::string>)>;
+
+// Parses one flat object (string, number, boolean and null values; nested
+// objects and arrays are rejected). On failure error says what and where.
+bool readJsonObject(const std::string& text, const JsonFieldVisitor& visit, std::string& error);
+
+#endif // TODO_JSON_H
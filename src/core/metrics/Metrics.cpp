@@ -0,0 +1,307 @@
+#include "Metrics.h"
+#include "../io/TodoJson.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <sstream>
+
+namespace Metrics {
+
+namespace {
+
+enum class Kind { Counter, Gauge, Histogram };
+
+struct Entry {
+    std::string labels;  // Rendered, {op="get"} or empty
+    Labels labelPairs;
+    Counter* counter = nullptr;
+    Gauge* gauge = nullptr;
+    Histogram* histogram = nullptr;
+};
+
+struct Family {
+    std::string help;
+    Kind kind;
+    std::vector<Entry> entries;
+};
+
+// Metrics are never freed, so references handed out stay valid for the
+// life of the process, including during static destruction
+struct Registry {
+    std::mutex mutex;
+    std::map<std::string, Family> families;  // By name, so dumps are sorted
+    std::deque<Counter> counters;
+    std::deque<Gauge> gauges;
+    std::deque<Histogram> histograms;
+};
+
+Registry& registry() {
+    static Registry* instance = new Registry();
+    return *instance;
+}
+
+std::string renderLabels(const Labels& labels) {
+    if (labels.empty()) return "";
+
+    std::string text = "{";
+    for (size_t i = 0; i < labels.size(); i++) {
+        if (i > 0) text += ',';
+        text += labels[i].first + "=\"";
+        for (char c : labels[i].second) {
+            if (c == '\\' || c == '"') text += '\\';
+            if (c == '\n') {
+                text += "\\n";
+                continue;
+            }
+            text += c;
+        }
+        text += '"';
+    }
+    return text + "}";
+}
+
+Entry& findOrAdd(const std::string& name, const std::string& help, Kind kind, const Labels& labels) {
+    Registry& r = registry();
+    std::string rendered = renderLabels(labels);
+
+    auto [it, added] = r.families.try_emplace(name, Family{help, kind, {}});
+    Family& family = it->second;
+    if (!added && family.kind != kind) {
+        // A programming error; hand out a detached metric rather than crash
+        std::cerr << "Metric " << name << " registered with two types" << std::endl;
+        static Entry detached;
+        static Counter counter;
+        static Gauge gauge;
+        static Histogram histogram;
+        detached = Entry{"", {}, &counter, &gauge, &histogram};
+        return detached;
+    }
+
+    for (Entry& entry : family.entries) {
+        if (entry.labels == rendered) return entry;
+    }
+
+    Entry entry;
+    entry.labels = rendered;
+    entry.labelPairs = labels;
+    switch (kind) {
+        case Kind::Counter: entry.counter = &r.counters.emplace_back(); break;
+        case Kind::Gauge: entry.gauge = &r.gauges.emplace_back(); break;
+        case Kind::Histogram: entry.histogram = &r.histograms.emplace_back(); break;
+    }
+    family.entries.push_back(entry);
+    return family.entries.back();
+}
+
+// Labels plus one more, for the quantile lines of a summary
+std::string withLabel(const std::string& labels, const std::string& extra) {
+    if (labels.empty()) return "{" + extra + "}";
+    return labels.substr(0, labels.size() - 1) + "," + extra + "}";
+}
+
+const double kQuantiles[] = {0.5, 0.9, 0.99, 0.999};
+
+}
+
+int Histogram::bucketIndex(uint64_t value) {
+    constexpr uint64_t kMaxValue = (uint64_t(1) << kMaxBits) - 1;
+    value = std::min(value, kMaxValue);
+    if (value < static_cast<uint64_t>(kSubBuckets)) return static_cast<int>(value);
+
+    int topBit = 63 - __builtin_clzll(value);
+    int octave = topBit - kSubBucketBits + 1;
+    int sub = static_cast<int>((value >> (topBit - kSubBucketBits)) & (kSubBuckets - 1));
+    return octave * kSubBuckets + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(int index) {
+    int octave = index / kSubBuckets;
+    uint64_t sub = index % kSubBuckets;
+    if (octave == 0) return sub + 1;
+    return (kSubBuckets + sub + 1) << (octave - 1);
+}
+
+void Histogram::recordNs(int64_t ns) {
+    if (ns < 0) ns = 0;
+    buckets_[bucketIndex(static_cast<uint64_t>(ns))].fetch_add(1, std::memory_order_relaxed);
+    sumNs_.fetch_add(ns, std::memory_order_relaxed);
+
+    int64_t max = maxNs_.load(std::memory_order_relaxed);
+    while (ns > max && !maxNs_.compare_exchange_weak(max, ns, std::memory_order_relaxed)) {
+    }
+}
+
+Histogram::Snapshot Histogram::snapshot() const {
+    // Not atomic as a whole: a record racing with this may be half counted
+    Snapshot snapshot;
+    snapshot.buckets.resize(kBuckets);
+    for (int i = 0; i < kBuckets; i++) {
+        snapshot.buckets[i] = buckets_[i].load(std::memory_order_relaxed);
+        snapshot.count += snapshot.buckets[i];
+    }
+    snapshot.sumNs = sumNs_.load(std::memory_order_relaxed);
+    snapshot.maxNs = maxNs_.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+int64_t Histogram::Snapshot::percentileNs(double p) const {
+    if (count == 0) return 0;
+
+    uint64_t rank = static_cast<uint64_t>(p * (count - 1)) + 1;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(static_cast<int64_t>(bucketUpperBound(static_cast<int>(i))), maxNs);
+        }
+    }
+    return maxNs;
+}
+
+Counter& counter(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    return *findOrAdd(name, help, Kind::Counter, labels).counter;
+}
+
+Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    return *findOrAdd(name, help, Kind::Gauge, labels).gauge;
+}
+
+Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels) {
+    std::lock_guard<std::mutex> lock(registry().mutex);
+    return *findOrAdd(name, help, Kind::Histogram, labels).histogram;
+}
+
+std::string prometheusText() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::ostringstream out;
+    out << std::setprecision(9);
+    for (const auto& [name, family] : r.families) {
+        const char* type = family.kind == Kind::Counter ? "counter"
+                         : family.kind == Kind::Gauge ? "gauge" : "summary";
+        out << "# HELP " << name << ' ' << family.help << '\n' << "# TYPE " << name << ' ' << type << '\n';
+
+        for (const Entry& entry : family.entries) {
+            if (entry.counter) {
+                out << name << entry.labels << ' ' << entry.counter->value() << '\n';
+            } else if (entry.gauge) {
+                out << name << entry.labels << ' ' << entry.gauge->value() << '\n';
+            } else {
+                Histogram::Snapshot snapshot = entry.histogram->snapshot();
+                for (double q : kQuantiles) {
+                    std::ostringstream quantile;
+                    quantile << "quantile=\"" << q << '"';
+                    out << name << withLabel(entry.labels, quantile.str()) << ' '
+                        << snapshot.percentileNs(q) / 1e9 << '\n';
+                }
+                out << name << "_sum" << entry.labels << ' ' << snapshot.sumNs / 1e9 << '\n';
+                out << name << "_count" << entry.labels << ' ' << snapshot.count << '\n';
+            }
+        }
+    }
+    return out.str();
+}
+
+std::string json() {
+    Registry& r = registry();
+    std::lock_guard<std::mutex> lock(r.mutex);
+
+    std::ostringstream out;
+    out << std::fixed << std::setprecision(3) << "{\"metrics\":[";
+    bool first = true;
+    for (const auto& [name, family] : r.families) {
+        for (const Entry& entry : family.entries) {
+            out << (first ? "\n" : ",\n") << "{\"name\":";
+            writeJsonString(out, name);
+            out << ",\"labels\":{";
+            for (size_t i = 0; i < entry.labelPairs.size(); i++) {
+                if (i > 0) out << ',';
+                writeJsonString(out, entry.labelPairs[i].first);
+                out << ':';
+                writeJsonString(out, entry.labelPairs[i].second);
+            }
+            out << '}';
+            first = false;
+
+            if (entry.counter) {
+                out << ",\"type\":\"counter\",\"value\":" << entry.counter->value() << '}';
+            } else if (entry.gauge) {
+                out << ",\"type\":\"gauge\",\"value\":" << entry.gauge->value() << '}';
+            } else {
+                Histogram::Snapshot snapshot = entry.histogram->snapshot();
+                out << ",\"type\":\"histogram\",\"count\":" << snapshot.count
+                    << ",\"sum_ms\":" << snapshot.sumNs / 1e6
+                    << ",\"p50_ms\":" << snapshot.percentileNs(0.5) / 1e6
+                    << ",\"p90_ms\":" << snapshot.percentileNs(0.9) / 1e6
+                    << ",\"p99_ms\":" << snapshot.percentileNs(0.99) / 1e6
+                    << ",\"p999_ms\":" << snapshot.percentileNs(0.999) / 1e6
+                    << ",\"max_ms\":" << snapshot.maxNs / 1e6 << '}';
+            }
+        }
+    }
+    out << "\n]}\n";
+    return out.str();
+}
+
+Dumper::Dumper(std::string path, std::chrono::milliseconds interval)
+    : path(std::move(path)), interval(interval) {
+    thread = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!wake.wait_for(lock, this->interval, [this]() { return stopping; })) {
+            lock.unlock();
+            dumpNow();
+            lock.lock();
+        }
+    });
+}
+
+Dumper::~Dumper() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wake.notify_all();
+    thread.join();
+    dumpNow();
+}
+
+bool Dumper::dumpNow() {
+    bool asJson = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    std::string text = asJson ? json() : prometheusText();
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        out << text;
+        if (!out) {
+            std::cerr << "Metrics dump to " << temporary << " failed" << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Metrics dump to " << path << " failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+std::unique_ptr<Dumper> dumperFromEnvironment() {
+    const char* path = std::getenv("TODO_METRICS");
+    if (!path || !*path) return nullptr;
+
+    double seconds = 10;
+    if (const char* interval = std::getenv("TODO_METRICS_INTERVAL")) {
+        seconds = std::max(0.1, std::atof(interval));
+    }
+    return std::make_unique<Dumper>(path, std::chrono::milliseconds(static_cast<int64_t>(seconds * 1000)));
+}
+
+}
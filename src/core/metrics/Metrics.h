@@ -0,0 +1,132 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Process-wide counters, gauges and latency histograms. Updates are relaxed
+// atomics with no locks or allocation, cheap enough to leave on everywhere;
+// only registering a metric and dumping take the registry lock. Look a
+// metric up once (a function-local static) and keep the reference.
+namespace Metrics {
+
+using Labels = std::vector<std::pair<std::string, std::string>>;
+
+class Counter {
+public:
+    void add(uint64_t n = 1) { value_.fetch_add(n, std::memory_order_relaxed); }
+    uint64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<uint64_t> value_{0};
+};
+
+class Gauge {
+public:
+    void set(int64_t v) { value_.store(v, std::memory_order_relaxed); }
+    void add(int64_t n) { value_.fetch_add(n, std::memory_order_relaxed); }
+    int64_t value() const { return value_.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> value_{0};
+};
+
+// Log-linear buckets in the HdrHistogram style: 16 per power of two, so any
+// recorded value is known to within 1/16 (6.25%), from 1 ns up to about
+// 18 minutes. Fixed size (about 5 KB), no allocation when recording.
+class Histogram {
+public:
+    static constexpr int kSubBucketBits = 4;
+    static constexpr int kSubBuckets = 1 << kSubBucketBits;
+    static constexpr int kMaxBits = 40;
+    static constexpr int kBuckets = (kMaxBits - kSubBucketBits + 1) * kSubBuckets;
+
+    void recordNs(int64_t ns);
+
+    struct Snapshot {
+        uint64_t count = 0;
+        int64_t sumNs = 0;
+        int64_t maxNs = 0;
+        std::vector<uint64_t> buckets;
+
+        int64_t percentileNs(double p) const;
+    };
+    Snapshot snapshot() const;
+
+    static int bucketIndex(uint64_t value);
+    static uint64_t bucketUpperBound(int index);  // Exclusive
+
+private:
+    std::array<std::atomic<uint64_t>, kBuckets> buckets_{};
+    std::atomic<int64_t> sumNs_{0};
+    std::atomic<int64_t> maxNs_{0};
+};
+
+// Returns the metric with this name and labels, creating it on first use.
+// Names follow Prometheus conventions (todo_db_calls_total, ..._seconds).
+Counter& counter(const std::string& name, const std::string& help, const Labels& labels = {});
+Gauge& gauge(const std::string& name, const std::string& help, const Labels& labels = {});
+Histogram& histogram(const std::string& name, const std::string& help, const Labels& labels = {});
+
+// Prometheus text exposition format; histograms are written as summaries
+// (p50/p90/p99/p99.9 in seconds, with _sum and _count)
+std::string prometheusText();
+std::string json();
+
+// Records the lifetime of the scope into a histogram
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~ScopedTimer() {
+        histogram.recordNs(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    Histogram& histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Rewrites a file with every metric on a background thread, and once more
+// on destruction. JSON when the path ends in .json, Prometheus text
+// otherwise; written to a temporary file and renamed, so readers never see
+// a partial dump.
+class Dumper {
+public:
+    Dumper(std::string path, std::chrono::milliseconds interval);
+    ~Dumper();
+
+    Dumper(const Dumper&) = delete;
+    Dumper& operator=(const Dumper&) = delete;
+
+    bool dumpNow();
+
+private:
+    std::string path;
+    std::chrono::milliseconds interval;
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread thread;
+};
+
+// TODO_METRICS=<path> starts a Dumper, every TODO_METRICS_INTERVAL seconds
+// (default 10); nullptr when it is not set
+std::unique_ptr<Dumper> dumperFromEnvironment();
+
+}
+
+#endif // METRICS_H
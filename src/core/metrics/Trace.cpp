@@ -0,0 +1,145 @@
+#include "Trace.h"
+#include "../io/TodoJson.h"
+#include <unistd.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <vector>
+
+namespace Trace {
+
+namespace {
+
+struct Event {
+    std::string name;
+    const char* category;
+    char phase;        // 'X' complete, 'i' instant
+    int64_t ts;
+    int64_t dur;
+    int tid;
+};
+
+struct Recorder {
+    std::string path;
+    std::mutex mutex;
+    std::vector<Event> events;
+
+    Recorder() {
+        const char* env = std::getenv("TODO_TRACE");
+        if (env && *env) {
+            path = env;
+            events.reserve(4096);
+        }
+    }
+
+    // Writes what was recorded when the process exits normally
+    ~Recorder() {
+        if (!path.empty()) flush();
+    }
+
+    bool flush();
+};
+
+// Initialized with the other statics, before main(): this is startUs()
+const int64_t processStartUs = nowUs();
+
+Recorder& recorder() {
+    static Recorder instance;
+    return instance;
+}
+
+// Small stable ids read better in the viewer than pthread ids
+int threadId() {
+    static std::atomic<int> next{1};
+    thread_local int id = next.fetch_add(1);
+    return id;
+}
+
+void record(Event event) {
+    Recorder& r = recorder();
+    std::lock_guard<std::mutex> lock(r.mutex);
+    r.events.push_back(std::move(event));
+}
+
+bool Recorder::flush() {
+    std::lock_guard<std::mutex> lock(mutex);
+
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        int pid = static_cast<int>(::getpid());
+
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n"
+            << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":" << pid
+            << ",\"tid\":1,\"args\":{\"name\":\"todo\"}}";
+        for (const Event& event : events) {
+            out << ",\n{\"name\":";
+            writeJsonString(out, event.name);
+            out << ",\"cat\":\"" << event.category << "\",\"ph\":\"" << event.phase
+                << "\",\"ts\":" << event.ts << ",\"pid\":" << pid << ",\"tid\":" << event.tid;
+            if (event.phase == 'X') {
+                out << ",\"dur\":" << event.dur;
+            } else {
+                out << ",\"s\":\"t\"";
+            }
+            out << '}';
+        }
+        out << "\n]}\n";
+
+        if (!out) {
+            std::cerr << "Trace write to " << temporary << " failed" << std::endl;
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), path.c_str()) != 0) {
+        std::cerr << "Trace write to " << path << " failed" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+}
+
+bool enabled() {
+    static const bool on = !recorder().path.empty();
+    return on;
+}
+
+int64_t nowUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int64_t startUs() {
+    return processStartUs;
+}
+
+Span::Span(const char* name, const char* category)
+    : name(name), category(category) {
+    if (enabled()) start = nowUs();
+}
+
+Span::~Span() {
+    if (start >= 0) complete(name, category, start, nowUs());
+}
+
+void complete(const std::string& name, const char* category, int64_t startUs, int64_t endUs) {
+    if (!enabled()) return;
+    record(Event{name, category, 'X', startUs, endUs - startUs, threadId()});
+}
+
+void instant(const std::string& name, const char* category) {
+    if (!enabled()) return;
+    record(Event{name, category, 'i', nowUs(), 0, threadId()});
+}
+
+bool flush() {
+    if (!enabled()) return false;
+    return recorder().flush();
+}
+
+}
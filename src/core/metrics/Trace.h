@@ -0,0 +1,45 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <cstdint>
+#include <string>
+
+// Phase tracing in Chrome trace-event format, for chrome://tracing or
+// ui.perfetto.dev. Off unless TODO_TRACE=<path> is set; then spans are
+// buffered in memory and written to that file by flush() and at exit.
+// A disabled Span costs one branch.
+namespace Trace {
+
+bool enabled();
+
+// Microseconds on the steady clock, the timebase of every event
+int64_t nowUs();
+// When the process started tracing (static initialization), for spans
+// that begin before main() gets to create one
+int64_t startUs();
+
+// A complete event from construction to destruction. Name and category
+// must outlive the span (string literals).
+class Span {
+public:
+    explicit Span(const char* name, const char* category = "app");
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+private:
+    const char* name;
+    const char* category;
+    int64_t start = -1;  // -1 when tracing is off
+};
+
+void complete(const std::string& name, const char* category, int64_t startUs, int64_t endUs);
+void instant(const std::string& name, const char* category = "app");
+
+// Rewrites the trace file with everything recorded so far
+bool flush();
+
+}
+
+#endif // TRACE_H
@@ -0,0 +1,73 @@
+#include "CategoryModel.h"
+#include "../database/TodoDatabase.h"
+#include <algorithm>
+
+namespace {
+bool nameLess(const CategoryCount& category, const std::string& name) {
+    return category.name < name;
+}
+}
+
+bool CategoryModel::load(TodoDatabase& db) {
+    if (!db.isOpen()) return false;
+
+    categories = db.getCategoryCounts();
+    total_todos = 0;
+    completed_todos = 0;
+    for (const auto& category : categories) {
+        total_todos += category.total;
+        completed_todos += category.completed;
+    }
+    return true;
+}
+
+void CategoryModel::todoCreated(const Todo& todo) {
+    adjust(todo.getCategory(), 1, todo.isCompleted() ? 1 : 0);
+}
+
+void CategoryModel::todoUpdated(const Todo& before, const Todo& after) {
+    todoDeleted(before);
+    todoCreated(after);
+}
+
+void CategoryModel::todoDeleted(const Todo& todo) {
+    adjust(todo.getCategory(), -1, todo.isCompleted() ? -1 : 0);
+}
+
+void CategoryModel::adjust(const std::string& name, int totalDelta, int completedDelta) {
+    total_todos += totalDelta;
+    completed_todos += completedDelta;
+
+    auto it = std::lower_bound(categories.begin(), categories.end(), name, nameLess);
+    if (it == categories.end() || it->name != name) {
+        if (totalDelta <= 0) return;
+        it = categories.insert(it, CategoryCount{name, 0, 0});
+    }
+
+    it->total += totalDelta;
+    it->completed += completedDelta;
+
+    if (it->total <= 0) {
+        categories.erase(it);
+    }
+}
+
+std::vector<std::string> CategoryModel::getNames() const {
+    std::vector<std::string> names;
+    names.reserve(categories.size());
+    for (const auto& category : categories) {
+        names.push_back(category.name);
+    }
+    return names;
+}
+
+int CategoryModel::indexOf(const std::string& name) const {
+    auto it = std::lower_bound(categories.begin(), categories.end(), name, nameLess);
+    if (it == categories.end() || it->name != name) return -1;
+    return static_cast<int>(it - categories.begin());
+}
+
+int CategoryModel::insertionPoint(const std::string& name) const {
+    auto it = std::lower_bound(categories.begin(), categories.end(), name, nameLess);
+    return static_cast<int>(it - categories.begin());
+}
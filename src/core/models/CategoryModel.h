@@ -0,0 +1,48 @@
+#ifndef CATEGORY_MODEL_H
+#define CATEGORY_MODEL_H
+
+#include <string>
+#include <vector>
+#include "Todo.h"
+
+class TodoDatabase;
+
+struct CategoryCount {
+    std::string name;
+    int total = 0;
+    int completed = 0;
+};
+
+// In-memory category list with per-category counts. Loaded once with a
+// single grouped query, then kept current by feeding it every todo write
+// instead of re-running SELECT DISTINCT. Sorted by name.
+class CategoryModel {
+private:
+    std::vector<CategoryCount> categories;
+    int total_todos = 0;
+    int completed_todos = 0;
+
+public:
+    bool load(TodoDatabase& db);
+
+    // Incremental updates, mirroring TodoDatabase writes
+    void todoCreated(const Todo& todo);
+    void todoUpdated(const Todo& before, const Todo& after);
+    void todoDeleted(const Todo& todo);
+
+    // Applies a count delta; adds or drops the category as needed
+    void adjust(const std::string& name, int totalDelta, int completedDelta);
+
+    const std::vector<CategoryCount>& getCategories() const { return categories; }
+    std::vector<std::string> getNames() const;
+    int size() const { return static_cast<int>(categories.size()); }
+    const CategoryCount& at(int index) const { return categories[index]; }
+
+    int indexOf(const std::string& name) const;         // -1 if absent
+    int insertionPoint(const std::string& name) const;  // Sorted position for a new name
+
+    int getTotalTodos() const { return total_todos; }
+    int getCompletedTodos() const { return completed_todos; }
+};
+
+#endif // CATEGORY_MODEL_H
@@ -4,7 +4,7 @@
 Todo::Todo()
     : id(0), title(""), description(""), category("general"), completed(false),
       priority(2), created_at(std::time(nullptr)), updated_at(std::time(nullptr)),
-      due_date(std::nullopt) {
+      due_date(std::nullopt), manual_rank(0) {
 }
 
 Todo::Todo(const std::string& title, const std::string& description, 
@@ -12,7 +12,7 @@ Todo::Todo(const std::string& title, const std::string& description,
     : id(0), title(title), description(description), category(category),
       completed(false), priority(priority), 
       created_at(std::time(nullptr)), updated_at(std::time(nullptr)),
-      due_date(std::nullopt) {
+      due_date(std::nullopt), manual_rank(0) {
 }
 
 void Todo::setTitle(const std::string& newTitle) {
@@ -52,6 +52,11 @@ void Todo::clearDueDate() {
     updateTimestamp();
 }
 
+void Todo::setParentId(std::optional<int> newParentId) {
+    parent_id = newParentId;
+    updateTimestamp();
+}
+
 void Todo::updateTimestamp() {
     updated_at = std::time(nullptr);
 }
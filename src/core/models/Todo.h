@@ -16,6 +16,8 @@ private:
     time_t updated_at;
     std::optional<time_t> due_date;  // Not all todos need a deadline
     int priority;  // 1=low, 2=medium, 3=high
+    std::optional<int> parent_id;  // Subtask of this todo; top level when empty
+    double manual_rank;            // Position among its siblings in manual order
 
 public:
     // Constructors
@@ -35,9 +37,15 @@ public:
     time_t getUpdatedAt() const { return updated_at; }
     std::optional<time_t> getDueDate() const { return due_date; }
     int getPriority() const { return priority; }
+    std::optional<int> getParentId() const { return parent_id; }
+    double getManualRank() const { return manual_rank; }
     
     // Setters
     void setId(int newId) { id = newId; }
+    void setCreatedAt(time_t time) { created_at = time; }
+    void setUpdatedAt(time_t time) { updated_at = time; }
+    // Kept by TodoDatabase, and not a change to the todo itself
+    void setManualRank(double rank) { manual_rank = rank; }
     void setTitle(const std::string& newTitle);
     void setDescription(const std::string& newDesc);
     void setCategory(const std::string& newCategory);
@@ -45,6 +53,7 @@ public:
     void setPriority(int newPriority);
     void setDueDate(time_t date);
     void clearDueDate();
+    void setParentId(std::optional<int> newParentId);
     
     // Utility methods
     void updateTimestamp();
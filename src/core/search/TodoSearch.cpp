@@ -0,0 +1,152 @@
+#include "TodoSearch.h"
+#include "../metrics/Trace.h"
+#include <cstring>
+#include <string_view>
+
+namespace {
+
+// LIKE folds ASCII only; other bytes compare as they are
+void appendFolded(std::string& out, const char* text, int length) {
+    for (int i = 0; i < length; i++) {
+        char c = text[i];
+        out += (c >= 'A' && c <= 'Z') ? static_cast<char>(c - 'A' + 'a') : c;
+    }
+}
+
+std::string fold(const std::string& text) {
+    std::string folded;
+    folded.reserve(text.size());
+    appendFolded(folded, text.data(), static_cast<int>(text.size()));
+    return folded;
+}
+
+// The needle never holds '\0', so it cannot match across the separator
+bool contains(std::string_view haystack, const std::string& needle) {
+    return haystack.find(needle) != std::string_view::npos;
+}
+
+} // namespace
+
+TodoSearch::TodoSearch(TodoDatabase& database, size_t textCap)
+    : database(database), textCap(textCap) {
+}
+
+size_t TodoSearch::memoryUsed() const {
+    return ids.capacity() * sizeof(int) + text.capacity() + textEnds.capacity() * sizeof(uint32_t);
+}
+
+bool TodoSearch::narrows(const std::string& query) const {
+    // Whatever contains the new query contains the old one, so only rows
+    // already matched can still match
+    if (folded.empty() || !narrowable || error) return false;
+    std::string next = fold(query);
+    return !next.empty() && next.find('\0') == std::string::npos && next.find(folded) != std::string::npos;
+}
+
+bool TodoSearch::setQuery(const std::string& query) {
+    Trace::Span span("TodoSearch::setQuery", "db");
+
+    if (!narrows(query)) {
+        current = query;
+        folded = fold(query);
+        reset();
+        return false;
+    }
+
+    std::string next = fold(query);
+    if (next == folded) {
+        current = query;
+        return true;
+    }
+
+    // Filter in place, text and all
+    size_t kept = 0;
+    size_t written = 0;
+    size_t start = 0;
+    for (size_t i = 0; i < ids.size(); i++) {
+        std::string_view row(text.data() + start, textEnds[i] - start);
+        start = textEnds[i];
+        if (!contains(row, next)) continue;
+
+        ids[kept] = ids[i];
+        std::memmove(&text[written], row.data(), row.size());
+        written += row.size();
+        textEnds[kept] = static_cast<uint32_t>(written);
+        kept++;
+    }
+    ids.resize(kept);
+    textEnds.resize(kept);
+    text.resize(written);
+
+    current = query;
+    folded = std::move(next);
+    return true;
+}
+
+void TodoSearch::reset() {
+    ids.clear();
+    text.clear();
+    textEnds.clear();
+    narrowable = true;
+    cursor.reset();
+    scanned = 0;
+    error = false;
+    // An empty query, or one LIKE could never see, matches nothing
+    done = folded.empty() || folded.find('\0') != std::string::npos;
+}
+
+void TodoSearch::restart() {
+    reset();
+}
+
+void TodoSearch::clear() {
+    current.clear();
+    folded.clear();
+    reset();
+    ids.shrink_to_fit();
+    text.shrink_to_fit();
+    textEnds.shrink_to_fit();
+}
+
+bool TodoSearch::step(int rows) {
+    if (done) return false;
+
+    int visited = database.forEachTodoRowAfter(cursor, rows, [this](const TodoRowView& row) {
+        scratch.clear();
+        appendFolded(scratch, row.title, row.titleLength);
+        scratch += '\0';
+        appendFolded(scratch, row.description, row.descriptionLength);
+
+        if (!cursor) cursor.emplace();
+        cursor->completed = row.completed;
+        cursor->priority = row.priority;
+        cursor->due_date = row.due_date;
+        cursor->created_at = row.created_at;
+        cursor->id = row.id;
+
+        if (!contains(scratch, folded)) return;
+        ids.push_back(row.id);
+        if (!narrowable) return;
+
+        if (text.size() + scratch.size() > textCap) {
+            // Too much to keep: the next query scans again instead
+            narrowable = false;
+            text.clear();
+            text.shrink_to_fit();
+            textEnds.clear();
+            textEnds.shrink_to_fit();
+            return;
+        }
+        text += scratch;
+        textEnds.push_back(static_cast<uint32_t>(text.size()));
+    });
+
+    if (visited < 0) {
+        error = true;
+        done = true;
+        return false;
+    }
+    scanned += static_cast<size_t>(visited);
+    if (visited < rows) done = true;
+    return !done;
+}
@@ -0,0 +1,71 @@
+#ifndef TODO_SEARCH_H
+#define TODO_SEARCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "../database/TodoDatabase.h"
+
+// Search as you type over lists too large to scan on every keystroke. A
+// query is answered by scanning todos in list order a slice at a time, so
+// the caller can go back to its event loop between slices and drop the
+// query the moment the text changes; nothing is left running.
+//
+// Matches keep their folded text. When the next query contains the
+// previous one, the rows matched so far are filtered in memory and the scan
+// goes on from where it had got to, rather than starting again.
+//
+// Matching is that of TodoDatabase::searchTodos(), LIKE's: a literal,
+// ASCII case-insensitive substring of the title or the description.
+class TodoSearch {
+public:
+    static constexpr int kDefaultSliceRows = 500;
+    static constexpr size_t kDefaultTextCap = 32 << 20;  // Folded text kept for narrowing
+
+    explicit TodoSearch(TodoDatabase& database, size_t textCap = kDefaultTextCap);
+
+    // Starts query. Returns true when it narrowed the current matches
+    // instead of starting over. An empty query matches nothing.
+    bool setQuery(const std::string& query);
+    // Whether setQuery(query) would narrow rather than rescan
+    bool narrows(const std::string& query) const;
+
+    // Scans up to rows more todos. False once the scan has reached the end
+    // (or failed); matches() then holds every match.
+    bool step(int rows = kDefaultSliceRows);
+    // The current query again from the top; call after writes
+    void restart();
+    void clear();
+
+    const std::string& query() const { return current; }
+    bool finished() const { return done; }
+    bool failed() const { return error; }
+    const std::vector<int>& matches() const { return ids; }  // List order
+    size_t scannedRows() const { return scanned; }
+    size_t memoryUsed() const;
+
+private:
+    TodoDatabase& database;
+    size_t textCap;
+
+    std::string current;  // As given
+    std::string folded;   // ASCII lowercase
+    std::vector<int> ids;
+    // Folded "title\0description" of every match, back to back, while under
+    // the cap; past it the text is dropped and the next query rescans
+    std::string text;
+    std::vector<uint32_t> textEnds;
+    bool narrowable = true;
+    std::string scratch;  // The row being tested
+
+    std::optional<TodoPageCursor> cursor;  // Last row scanned
+    size_t scanned = 0;
+    bool done = true;
+    bool error = false;
+
+    void reset();
+};
+
+#endif // TODO_SEARCH_H
@@ -0,0 +1,280 @@
+#include "TodoSync.h"
+#include "../io/ByteCodec.h"
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+
+// Wire format, little-endian varints throughout:
+//   "TDS2" sender lastSeq originCount origin... recordCount record...
+//   record = flags uuid modified_at originIndex originSeq
+//            [title description category priority created_at updated_at [due_date]
+//             [parentUuid]]
+// Strings are a length and bytes; timestamps are zigzag encoded. TDS1 is
+// the same without parents and is still accepted.
+const char kMagic[] = "TDS2";
+const char kMagicWithoutParents[] = "TDS1";
+
+enum RecordFlags : uint8_t {
+    kDeleted = 1,
+    kCompleted = 2,
+    kHasDue = 4,
+    kOddUuid = 8,  // Not the usual 16 bytes, sent with a length
+    kHasParent = 16
+};
+
+const size_t kUuidBytes = 16;
+
+void encodeRecord(ByteEncoder& encoder, const SyncRecord& record, uint64_t originIndex) {
+    const Todo& todo = record.todo;
+    bool packedUuid = record.uuid.size() == kUuidBytes;
+
+    uint8_t flags = 0;
+    if (record.deleted) flags |= kDeleted;
+    if (!record.deleted && todo.isCompleted()) flags |= kCompleted;
+    if (!record.deleted && todo.getDueDate()) flags |= kHasDue;
+    if (!packedUuid) flags |= kOddUuid;
+    if (!record.deleted && !record.parentUuid.empty()) flags |= kHasParent;
+    encoder.byte(flags);
+
+    if (packedUuid) {
+        encoder.bytes(record.uuid.data(), kUuidBytes);
+    } else {
+        encoder.string(record.uuid);
+    }
+
+    encoder.signedVarint(record.modified_at);
+    encoder.varint(originIndex);
+    encoder.varint(static_cast<uint64_t>(record.origin_seq));
+
+    if (record.deleted) return;
+
+    encoder.string(todo.getTitle());
+    encoder.string(todo.getDescription());
+    encoder.string(todo.getCategory());
+    encoder.byte(static_cast<uint8_t>(todo.getPriority()));
+    encoder.signedVarint(todo.getCreatedAt());
+    // Usually equal to modified_at, so the difference is one byte
+    encoder.signedVarint(todo.getUpdatedAt() - record.modified_at);
+    if (todo.getDueDate()) {
+        encoder.signedVarint(*todo.getDueDate());
+    }
+    if (flags & kHasParent) {
+        encoder.string(record.parentUuid);
+    }
+}
+
+bool decodeRecord(ByteDecoder& decoder, const std::vector<std::string>& origins, SyncRecord& record) {
+    uint8_t flags = decoder.byte();
+
+    if (flags & kOddUuid) {
+        record.uuid = decoder.string();
+    } else {
+        record.uuid.resize(kUuidBytes);
+        if (!decoder.bytes(record.uuid.data(), kUuidBytes)) return false;
+    }
+
+    record.deleted = flags & kDeleted;
+    record.modified_at = decoder.signedVarint();
+    uint64_t originIndex = decoder.varint();
+    record.origin_seq = static_cast<int64_t>(decoder.varint());
+    if (decoder.failed() || originIndex >= origins.size() || record.uuid.empty()) return false;
+    record.origin = origins[originIndex];
+
+    if (record.deleted) return true;
+
+    Todo todo;
+    todo.setTitle(decoder.string());
+    todo.setDescription(decoder.string());
+    todo.setCategory(decoder.string());
+    uint8_t priority = decoder.byte();
+    if (priority < 1 || priority > 3) return false;
+    todo.setPriority(priority);
+    todo.setCompleted(flags & kCompleted);
+    time_t createdAt = decoder.signedVarint();
+    time_t updatedAt = record.modified_at + decoder.signedVarint();
+    if (flags & kHasDue) {
+        todo.setDueDate(decoder.signedVarint());
+    }
+    if (flags & kHasParent) {
+        record.parentUuid = decoder.string();
+        if (record.parentUuid.empty()) return false;
+    }
+    // Setters above bump updated_at, so restore the timestamps last
+    todo.setCreatedAt(createdAt);
+    todo.setUpdatedAt(updatedAt);
+    if (decoder.failed()) return false;
+
+    record.todo = todo;
+    return true;
+}
+
+} // namespace
+
+TodoSync::TodoSync(TodoDatabase& database)
+    : database(database) {
+}
+
+std::optional<SyncBatch> TodoSync::collect(const std::string& peerId) {
+    int64_t watermark = database.getSyncWatermark(peerId);
+    std::string sender = database.getDeviceId();
+    if (sender.empty()) return std::nullopt;
+
+    // Records are encoded as they stream out of the log; origin ids are
+    // collected on the way and written into the header at the end
+    std::string body;
+    ByteEncoder bodyEncoder(body);
+    std::vector<std::string> origins;
+    std::unordered_map<std::string, uint64_t> originIndex;
+
+    SyncBatch batch;
+    batch.lastSeq = watermark;
+
+    bool ok = database.forEachSyncChange(watermark, peerId, [&](const SyncRecord& record) {
+        auto [it, inserted] = originIndex.emplace(record.origin, origins.size());
+        if (inserted) origins.push_back(record.origin);
+
+        encodeRecord(bodyEncoder, record, it->second);
+        batch.changes++;
+        batch.lastSeq = record.seq;
+        return true;
+    });
+    if (!ok) return std::nullopt;
+
+    ByteEncoder encoder(batch.payload);
+    batch.payload.append(kMagic, 4);
+    encoder.string(sender);
+    encoder.varint(static_cast<uint64_t>(batch.lastSeq));
+    encoder.varint(origins.size());
+    for (const std::string& origin : origins) {
+        encoder.string(origin);
+    }
+    encoder.varint(batch.changes);
+    batch.payload.append(body);
+
+    return batch;
+}
+
+SyncApplyResult TodoSync::apply(const std::string& payload) {
+    SyncApplyResult result;
+
+    if (payload.size() < 4 ||
+        (payload.compare(0, 4, kMagic) != 0 && payload.compare(0, 4, kMagicWithoutParents) != 0)) {
+        std::cerr << "Sync apply failed: not a sync batch" << std::endl;
+        return result;
+    }
+
+    ByteDecoder decoder(payload.data() + 4, payload.size() - 4);
+    std::string sender = decoder.string();
+    decoder.varint();  // Sender's lastSeq, for its own acknowledge()
+    uint64_t originCount = decoder.varint();
+    std::vector<std::string> origins;
+    for (uint64_t i = 0; i < originCount && !decoder.failed(); i++) {
+        origins.push_back(decoder.string());
+    }
+    uint64_t count = decoder.varint();
+
+    if (decoder.failed() || sender.empty()) {
+        std::cerr << "Sync apply failed: truncated header" << std::endl;
+        return result;
+    }
+
+    // Local changes after this were never sent to the sender
+    int64_t watermark = database.getSyncWatermark(sender);
+
+    if (!database.beginTransaction()) return result;
+
+    // Subtasks whose parent was not here when they were applied; the parent
+    // may come later in the same batch (its log entry is newer)
+    std::vector<SyncRecord> orphans;
+
+    for (uint64_t i = 0; i < count; i++) {
+        SyncRecord remote;
+        if (!decodeRecord(decoder, origins, remote)) {
+            std::cerr << "Sync apply failed: malformed record " << i << std::endl;
+            database.rollbackTransaction();
+            return SyncApplyResult();
+        }
+
+        std::optional<SyncRecord> local = database.getSyncVersion(remote.uuid);
+        if (local && local->seq > watermark && local->origin != remote.origin) {
+            result.conflicts++;
+        }
+
+        if (local && !remote.isNewerThan(*local)) {
+            result.stale++;
+            continue;
+        }
+
+        bool parentMissing = !remote.parentUuid.empty() && !database.getSyncVersion(remote.parentUuid);
+
+        if (!database.applySyncRecord(remote)) {
+            database.rollbackTransaction();
+            return SyncApplyResult();
+        }
+        result.applied++;
+
+        if (parentMissing) {
+            orphans.push_back(std::move(remote));
+        }
+    }
+
+    for (const SyncRecord& orphan : orphans) {
+        if (database.getSyncVersion(orphan.parentUuid) && !database.applySyncRecord(orphan)) {
+            database.rollbackTransaction();
+            return SyncApplyResult();
+        }
+    }
+
+    if (!decoder.atEnd()) {
+        std::cerr << "Sync apply failed: trailing bytes" << std::endl;
+        database.rollbackTransaction();
+        return SyncApplyResult();
+    }
+
+    result.ok = database.commitTransaction();
+    return result;
+}
+
+bool TodoSync::acknowledge(const std::string& peerId, int64_t lastSeq) {
+    return database.setSyncWatermark(peerId, lastSeq);
+}
+
+SyncReport TodoSync::syncDatabases(TodoDatabase& first, TodoDatabase& second) {
+    SyncReport report;
+
+    std::string firstId = first.getDeviceId();
+    std::string secondId = second.getDeviceId();
+    if (firstId.empty() || secondId.empty()) return report;
+
+    // A copied database file carries the same device id; versions made on
+    // either side after the copy would collide
+    if (firstId == secondId) {
+        if (!second.resetDeviceId()) return report;
+        secondId = second.getDeviceId();
+        report.deviceIdReset = true;
+    }
+
+    TodoSync firstSync(first);
+    TodoSync secondSync(second);
+
+    auto exchange = [&report](TodoSync& from, const std::string& toId, TodoSync& to,
+                              size_t& changes, size_t& bytes) {
+        std::optional<SyncBatch> batch = from.collect(toId);
+        if (!batch) return false;
+
+        SyncApplyResult applied = to.apply(batch->payload);
+        if (!applied.ok) return false;
+
+        changes = batch->changes;
+        bytes = batch->payload.size();
+        report.applied += applied.applied;
+        report.conflicts += applied.conflicts;
+        return from.acknowledge(toId, batch->lastSeq);
+    };
+
+    report.ok = exchange(firstSync, secondId, secondSync, report.sentChanges, report.sentBytes) &&
+                exchange(secondSync, firstId, firstSync, report.receivedChanges, report.receivedBytes);
+    return report;
+}
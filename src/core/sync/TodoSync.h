@@ -0,0 +1,61 @@
+#ifndef TODO_SYNC_H
+#define TODO_SYNC_H
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include "../database/TodoDatabase.h"
+
+// Changes one side has not sent to a peer yet, encoded for transfer
+struct SyncBatch {
+    std::string payload;
+    size_t changes = 0;
+    int64_t lastSeq = 0;  // Acknowledge once the peer has applied the batch
+};
+
+struct SyncApplyResult {
+    bool ok = false;
+    size_t applied = 0;    // New here, or newer than the local version
+    size_t stale = 0;      // Local version already as new or newer
+    size_t conflicts = 0;  // Both sides changed the todo since their last sync
+};
+
+struct SyncReport {
+    bool ok = false;
+    bool deviceIdReset = false;  // The second database was a copy of the first
+    size_t sentChanges = 0;      // First to second
+    size_t sentBytes = 0;
+    size_t receivedChanges = 0;  // Second to first
+    size_t receivedBytes = 0;
+    size_t applied = 0;
+    size_t conflicts = 0;
+};
+
+// Delta sync between todo databases. Each side's sync_log (kept by triggers)
+// holds the latest version of every todo and tombstones for deletes; a
+// watermark per peer marks how far that log has been sent. Conflicts are
+// last writer wins on the version stamp, ties broken by device id and then
+// by that device's change order. A local write is stamped with its
+// updated_at, or one second past the version it replaces when that is not
+// later, so an edit always beats what it was made on even with a clock
+// behind; once every version has been exchanged, both sides hold the same
+// rows. Between truly concurrent edits the later wall clock wins.
+class TodoSync {
+public:
+    explicit TodoSync(TodoDatabase& database);
+
+    std::optional<SyncBatch> collect(const std::string& peerId);
+    // Applies a batch from collect() on another database in one transaction
+    SyncApplyResult apply(const std::string& payload);
+    bool acknowledge(const std::string& peerId, int64_t lastSeq);
+
+    // Both directions between two open databases, the way two devices would
+    // exchange batches over a connection
+    static SyncReport syncDatabases(TodoDatabase& first, TodoDatabase& second);
+
+private:
+    TodoDatabase& database;
+};
+
+#endif // TODO_SYNC_H
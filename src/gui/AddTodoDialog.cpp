@@ -5,89 +5,11 @@
 #include <QLabel>
 #include <QMessageBox>
 
-AddTodoDialog::AddTodoDialog(TodoDatabase* database, QWidget *parent)
+AddTodoDialog::AddTodoDialog(const CategoryModel& categories, QWidget *parent)
     : QDialog(parent) {
 
     setWindowTitle("New Todo");
     setMinimumWidth(500);
-    setStyleSheet(R"(
-        QDialog {
-            background-color: #FFFFFF;
-        }
-        QLineEdit, QTextEdit {
-            border: 1px solid #D1D1D1;
-            padding: 8px;
-            border-radius: 6px;
-            background-color: #FFFFFF;
-            font-size: 14px;
-        }
-        QLineEdit::placeholder, QTextEdit::placeholder {
-            color: #AAAAAA;
-        }
-        QLineEdit:focus, QTextEdit:focus {
-            border-color: #000000;
-            border-width: 2px;
-            outline: none;
-        }
-        QComboBox {
-            border: 1px solid #D1D1D1;
-            padding: 8px 12px;
-            padding-right: 32px;
-            background-color: #FFFFFF;
-            border-radius: 6px;
-        }
-        QComboBox:focus {
-            border-color: #000000;
-            border-width: 2px;
-            outline: none;
-        }
-        QComboBox::drop-down {
-            subcontrol-origin: padding;
-            subcontrol-position: center right;
-            width: 20px;
-            border: none;
-            background: transparent;
-        }
-        QDateEdit {
-            border: 1px solid #D1D1D1;
-            padding: 8px 12px;
-            padding-right: 32px;
-            background-color: #FFFFFF;
-            border-radius: 6px;
-        }
-        QDateEdit:disabled {
-            background-color: #F5F5F5;
-            color: #AAAAAA;
-            border-color: #E5E5E5;
-        }
-        QDateEdit:focus {
-            border-color: #000000;
-            border-width: 2px;
-            outline: none;
-        }
-        QDateEdit::drop-down {
-            subcontrol-origin: padding;
-            subcontrol-position: center right;
-            width: 20px;
-            border: none;
-            background: transparent;
-        }
-        QLabel {
-            color: #000000;
-            font-weight: 500;
-        }
-        QPushButton {
-            border: 1px solid #D1D1D1;
-            padding: 10px 20px;
-            border-radius: 6px;
-            background-color: #FFFFFF;
-            font-weight: 500;
-        }
-        QPushButton:hover {
-            background-color: #F5F5F5;
-            border-color: #000000;
-        }
-    )");
     
     QVBoxLayout* mainLayout = new QVBoxLayout(this);
     mainLayout->setSpacing(20);
@@ -109,13 +31,7 @@ AddTodoDialog::AddTodoDialog(TodoDatabase* database, QWidget *parent)
 
     // Error label (hidden by default, shown inline with title)
     errorLabel = new QLabel(this);
-    errorLabel->setStyleSheet(R"(
-        QLabel {
-            color: #FF3B30;
-            font-size: 12px;
-            padding: 4px 0px;
-        }
-    )");
+    errorLabel->setObjectName("errorLabel");
     errorLabel->setWordWrap(true);
     errorLabel->hide();
     titleLayout->addWidget(errorLabel);
@@ -135,11 +51,10 @@ AddTodoDialog::AddTodoDialog(TodoDatabase* database, QWidget *parent)
     // Add empty option first
     categoryInput->addItem("None", "");
 
-    // Populate with existing categories from database
-    auto categories = database->getAllCategories();
-    for (const auto& cat : categories) {
-        if (!cat.empty()) {
-            categoryInput->addItem(QString::fromStdString(cat));
+    // Populate from the shared in-memory category list (no database query)
+    for (const auto& cat : categories.getCategories()) {
+        if (!cat.name.empty()) {
+            categoryInput->addItem(QString::fromStdString(cat.name));
         }
     }
 
@@ -176,42 +91,11 @@ AddTodoDialog::AddTodoDialog(TodoDatabase* database, QWidget *parent)
 
     cancelButton = new QPushButton("Cancel", this);
     cancelButton->setFixedSize(70, 32);
-    cancelButton->setStyleSheet(R"(
-        QPushButton {
-            border: 1px solid #D1D1D1;
-            padding: 6px 12px;
-            border-radius: 6px;
-            background-color: #FFFFFF;
-            color: #000000;
-            font-weight: 500;
-            font-size: 13px;
-        }
-        QPushButton:hover {
-            background-color: #F0F0F0;
-            border-color: #8A8A8A;
-        }
-        QPushButton:pressed {
-            background-color: #E5E5E5;
-        }
-    )");
+    cancelButton->setObjectName("cancelButton");
 
     saveButton = new QPushButton("Save", this);
     saveButton->setFixedSize(70, 32);
-    saveButton->setStyleSheet(R"(
-        QPushButton {
-            background-color: #000000;
-            color: #FFFFFF;
-            border: none;
-            padding: 6px 12px;
-            font-size: 13px;
-        }
-        QPushButton:hover {
-            background-color: #2A2A2A;
-        }
-        QPushButton:pressed {
-            background-color: #000000;
-        }
-    )");
+    saveButton->setObjectName("saveButton");
 
     buttonLayout->addWidget(cancelButton);
     buttonLayout->addStretch();
@@ -10,7 +10,7 @@
 #include <QCheckBox>
 #include <QLabel>
 #include "models/Todo.h"
-#include "database/TodoDatabase.h"
+#include "models/CategoryModel.h"
 
 class AddTodoDialog : public QDialog {
     Q_OBJECT
@@ -38,7 +38,7 @@ private slots:
     void onDueDateToggled(bool checked);
 
 public:
-    AddTodoDialog(TodoDatabase* database, QWidget *parent = nullptr);
+    AddTodoDialog(const CategoryModel& categories, QWidget *parent = nullptr);
     Todo getTodo() const { return todo; }
 };
 
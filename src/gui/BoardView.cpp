@@ -0,0 +1,553 @@
+#include "BoardView.h"
+#include "CategoryListModel.h"
+#include "Theme.h"
+#include "TodoListModel.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
+#include <QApplication>
+#include <QDateTime>
+#include <QKeyEvent>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <QWheelEvent>
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+#include <unordered_set>
+
+namespace {
+
+const int CardGap = 6;
+const int CardPadding = 8;
+const int TrackWidth = 8;   // Scroll track at the right of each column
+const int EdgeMargin = 32;  // Held this close to an edge, a card scrolls the board
+
+} // namespace
+
+BoardView::BoardView(TodoDatabase* database, const CategoryListModel* categories, QWidget* parent)
+    : QAbstractScrollArea(parent), database(database), categories(categories) {
+    setFrameShape(QFrame::NoFrame);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setFocusPolicy(Qt::StrongFocus);
+
+    prefetchTimer.setSingleShot(true);
+    prefetchTimer.setInterval(0);
+    connect(&prefetchTimer, &QTimer::timeout, this, &BoardView::prefetch);
+
+    edgeScrollTimer.setInterval(30);
+    connect(&edgeScrollTimer, &QTimer::timeout, this, &BoardView::onEdgeScroll);
+}
+
+int BoardView::columnWidth() const {
+    return fontMetrics().averageCharWidth() * 32 + 2 * CardPadding;
+}
+
+int BoardView::headerHeight() const {
+    return fontMetrics().height() + 20;
+}
+
+int BoardView::cardPitch() const {
+    return 2 * fontMetrics().height() + 2 * CardPadding + 4 + CardGap;
+}
+
+int BoardView::bodyHeight() const {
+    return std::max(0, viewport()->height() - headerHeight());
+}
+
+int BoardView::maxScroll(const Column& column) const {
+    return std::max(0, column.total * cardPitch() + CardGap - bodyHeight());
+}
+
+int BoardView::residentPageCount() const {
+    int count = 0;
+    for (const Column& column : columns) count += static_cast<int>(column.pages.size());
+    return count;
+}
+
+void BoardView::reload() {
+    // Columns are matched by name, so each keeps its position across writes
+    std::unordered_map<std::string, int> scrolls;
+    for (const Column& column : columns) {
+        if (column.scroll > 0) scrolls.emplace(column.category, column.scroll);
+    }
+
+    columns.clear();
+    const std::vector<CategoryCount>& counts = categories->categories().getCategories();
+    columns.reserve(counts.size());
+    for (const CategoryCount& count : counts) {
+        Column column;
+        column.category = count.name;
+        column.total = count.total;
+        auto it = scrolls.find(count.name);
+        if (it != scrolls.end()) column.scroll = std::min(it->second, maxScroll(column));
+        columns.push_back(std::move(column));
+    }
+
+    press.reset();
+    trackColumn = -1;
+    updateScrollRange();
+    viewport()->update();
+}
+
+void BoardView::updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after) {
+    // A category gained or emptied changes the columns themselves
+    const std::vector<CategoryCount>& counts = categories->categories().getCategories();
+    bool sameColumns = counts.size() == columns.size() &&
+        std::equal(counts.begin(), counts.end(), columns.begin(),
+                   [](const CategoryCount& count, const Column& column) { return count.name == column.category; });
+    if (!sameColumns) {
+        reload();
+        return;
+    }
+
+    std::unordered_set<std::string> moved;
+    std::unordered_map<int, const Todo*> byId;
+    for (size_t i = 0; i < after.size(); i++) {
+        if (before[i].getCategory() != after[i].getCategory()) {
+            moved.insert(before[i].getCategory());
+            moved.insert(after[i].getCategory());
+        } else if (TodoListModel::listKeyChanged(before[i], after[i])) {
+            moved.insert(after[i].getCategory());
+        }
+        byId.emplace(after[i].getId(), &after[i]);
+    }
+
+    for (size_t i = 0; i < columns.size(); i++) {
+        Column& column = columns[i];
+        column.total = counts[i].total;
+        if (moved.count(column.category)) {
+            column.pages.clear();
+            column.pageEnds.clear();
+            column.scroll = std::min(column.scroll, maxScroll(column));
+            continue;
+        }
+        for (auto& [index, cards] : column.pages) {
+            for (Todo& todo : cards) {
+                auto it = byId.find(todo.getId());
+                if (it != byId.end()) todo = *it->second;
+            }
+        }
+    }
+
+    press.reset();
+    viewport()->update();
+}
+
+void BoardView::updateScrollRange() {
+    int width = columnCount() * columnWidth();
+    horizontalScrollBar()->setRange(0, std::max(0, width - viewport()->width()));
+    horizontalScrollBar()->setSingleStep(std::max(1, columnWidth() / 4));
+    horizontalScrollBar()->setPageStep(viewport()->width());
+}
+
+void BoardView::setColumnScroll(int index, int scroll) {
+    Column& column = columns[index];
+    scroll = std::clamp(scroll, 0, maxScroll(column));
+    if (scroll == column.scroll) return;
+    column.scroll = scroll;
+    viewport()->update(columnRect(index));
+}
+
+bool BoardView::visibleColumns(int& first, int& last) const {
+    if (columns.empty()) return false;
+    int width = columnWidth();
+    int scroll = horizontalScrollBar()->value();
+    first = std::min(columnCount() - 1, scroll / width);
+    last = std::min(columnCount() - 1, (scroll + viewport()->width() - 1) / width);
+    return true;
+}
+
+int BoardView::columnAt(int x) const {
+    if (x < 0) return -1;
+    int index = (x + horizontalScrollBar()->value()) / columnWidth();
+    return index < columnCount() ? index : -1;
+}
+
+QRect BoardView::columnRect(int index) const {
+    int width = columnWidth();
+    return QRect(index * width - horizontalScrollBar()->value(), 0, width, viewport()->height());
+}
+
+QRect BoardView::trackRect(int index) const {
+    QRect column = columnRect(index);
+    return QRect(column.right() - TrackWidth, headerHeight(), TrackWidth, bodyHeight());
+}
+
+std::vector<Todo> BoardView::loadPage(const Column& column, int index) {
+    static Metrics::Histogram& latency = Metrics::histogram(
+        "todo_gui_board_page_load_seconds", "BoardView, one page of cards in one column");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("boardLoadPage", "refresh");
+
+    // A page continues from the end of the one above. When that page was
+    // never read, the cursor comes from the index at its offset instead of
+    // from paging down to it.
+    std::optional<TodoPageCursor> after;
+    if (index > 0) {
+        auto end = column.pageEnds.find(index - 1);
+        if (end != column.pageEnds.end()) {
+            after = end->second;
+        } else {
+            after = database->getPageCursorAt(index * PageSize - 1, column.category);
+            if (!after) return {};
+        }
+    }
+    return database->getTodosPage(after, PageSize, column.category);
+}
+
+const std::vector<Todo>* BoardView::page(Column& column, int index) {
+    auto it = column.pages.find(index);
+    if (it != column.pages.end()) return &it->second;
+
+    std::vector<Todo> rows = loadPage(column, index);
+    if (!rows.empty()) column.pageEnds[index] = TodoPageCursor::fromTodo(rows.back());
+    return &column.pages.emplace(index, std::move(rows)).first->second;
+}
+
+void BoardView::schedulePrefetch() {
+    if (!prefetchTimer.isActive()) prefetchTimer.start();
+}
+
+void BoardView::prefetch() {
+    int first, last;
+    if (!visibleColumns(first, last)) return;
+
+    // The page past each visible edge in the visible columns, then what the
+    // neighbouring columns would show; one page per idle turn
+    int pitch = cardPitch();
+    auto wanted = [&](int index, int pageIndex) {
+        Column& column = columns[index];
+        if (pageIndex < 0 || pageIndex * PageSize >= column.total) return false;
+        if (column.pages.count(pageIndex)) return false;
+        page(column, pageIndex);
+        return true;
+    };
+
+    bool loaded = false;
+    for (int index = first; index <= last && !loaded; index++) {
+        const Column& column = columns[index];
+        int firstPage = column.scroll / pitch / PageSize;
+        int lastPage = (column.scroll + bodyHeight()) / pitch / PageSize;
+        loaded = wanted(index, lastPage + 1) || wanted(index, firstPage - 1);
+    }
+    for (int distance = 1; distance <= PrefetchColumns && !loaded; distance++) {
+        for (int index : {last + distance, first - distance}) {
+            if (loaded || index < 0 || index >= columnCount()) continue;
+            loaded = wanted(index, columns[index].scroll / pitch / PageSize);
+        }
+    }
+
+    evictPages(first, last);
+    if (loaded) schedulePrefetch();
+}
+
+void BoardView::evictPages(int firstColumn, int lastColumn) {
+    if (residentPageCount() <= MaxResidentPages) return;
+
+    // Columns well off screen go entirely; the rest keep the pages around
+    // what they show. Cursors stay, so coming back is one query a page.
+    int pitch = cardPitch();
+    for (int index = 0; index < columnCount(); index++) {
+        Column& column = columns[index];
+        if (column.pages.empty()) continue;
+        if (index < firstColumn - PrefetchColumns || index > lastColumn + PrefetchColumns) {
+            column.pages.clear();
+            continue;
+        }
+        int keepFirst = column.scroll / pitch / PageSize - 1;
+        int keepLast = (column.scroll + bodyHeight()) / pitch / PageSize + 1;
+        for (auto it = column.pages.begin(); it != column.pages.end();) {
+            it = (it->first < keepFirst || it->first > keepLast) ? column.pages.erase(it) : std::next(it);
+        }
+    }
+}
+
+const Todo* BoardView::cardAt(const QPoint& pos, int* columnIndex, QRect* rect) {
+    int index = columnAt(pos.x());
+    if (index < 0 || pos.y() < headerHeight() || trackRect(index).contains(pos)) return nullptr;
+
+    Column& column = columns[index];
+    int pitch = cardPitch();
+    int y = pos.y() - headerHeight() + column.scroll - CardGap;
+    int row = y / pitch;
+    if (y < 0 || row >= column.total || y - row * pitch >= pitch - CardGap) return nullptr;
+
+    const std::vector<Todo>* rows = page(column, row / PageSize);
+    if (!rows || row % PageSize >= static_cast<int>(rows->size())) return nullptr;
+
+    if (columnIndex) *columnIndex = index;
+    if (rect) {
+        QRect area = columnRect(index);
+        *rect = QRect(area.left() + CardGap, headerHeight() + CardGap + row * pitch - column.scroll,
+                      area.width() - 2 * CardGap - TrackWidth, pitch - CardGap);
+    }
+    return &(*rows)[row % PageSize];
+}
+
+void BoardView::paintCard(QPainter& painter, const QRect& rect, const Todo& todo) const {
+    const Theme::Colors& colors = Theme::colors();
+    painter.setPen(colors.subtleBorder);
+    painter.setBrush(colors.window);
+    painter.drawRoundedRect(rect.adjusted(0, 0, -1, -1), 6, 6);
+    painter.setBrush(Qt::NoBrush);
+
+    QColor bar = todo.getPriority() == 3 ? colors.danger
+               : todo.getPriority() == 2 ? colors.accent : colors.inactiveBar;
+    painter.fillRect(QRect(rect.left() + 4, rect.top() + CardPadding, 3, rect.height() - 2 * CardPadding),
+                     todo.isCompleted() ? colors.inactiveBar : bar);
+
+    QFont title = font();
+    title.setStrikeOut(todo.isCompleted());
+    int line = fontMetrics().height();
+    QRect text = rect.adjusted(CardPadding + 6, CardPadding, -CardPadding, -CardPadding);
+    painter.setFont(title);
+    painter.setPen(todo.isCompleted() ? colors.completedText : colors.text);
+    painter.drawText(QRect(text.left(), text.top(), text.width(), line), Qt::AlignLeft | Qt::AlignVCenter,
+                     painter.fontMetrics().elidedText(QString::fromStdString(todo.getTitle()),
+                                                      Qt::ElideRight, text.width()));
+
+    // Due date, red once passed
+    if (auto due = todo.getDueDate()) {
+        bool overdue = !todo.isCompleted() && *due < std::time(nullptr);
+        painter.setFont(font());
+        painter.setPen(overdue ? colors.danger : colors.metaText);
+        painter.drawText(QRect(text.left(), text.top() + line + 4, text.width(), line),
+                         Qt::AlignLeft | Qt::AlignVCenter,
+                         QDateTime::fromSecsSinceEpoch(*due).toString("d MMM yyyy"));
+    }
+}
+
+void BoardView::paintEvent(QPaintEvent*) {
+    static Metrics::Histogram& latency = Metrics::histogram(
+        "todo_gui_board_paint_seconds", "BoardView::paintEvent, visible columns");
+    Metrics::ScopedTimer timer(latency);
+
+    QPainter painter(viewport());
+    painter.setRenderHint(QPainter::Antialiasing);
+    const Theme::Colors& colors = Theme::colors();
+    painter.fillRect(viewport()->rect(), colors.window);
+
+    int first, last;
+    if (!visibleColumns(first, last)) {
+        painter.setPen(colors.mutedText);
+        painter.drawText(viewport()->rect(), Qt::AlignCenter, "No todos");
+        return;
+    }
+
+    int pitch = cardPitch();
+    int header = headerHeight();
+    int body = bodyHeight();
+    int target = press && press->dragging ? columnAt(pointer.x()) : -1;
+
+    QFont bold = font();
+    bold.setBold(true);
+
+    for (int index = first; index <= last; index++) {
+        Column& column = columns[index];
+        column.scroll = std::min(column.scroll, maxScroll(column));
+        QRect area = columnRect(index);
+
+        if (index == target && target != press->column) painter.fillRect(area, colors.hover);
+        painter.setPen(colors.divider);
+        painter.drawLine(area.topRight(), area.bottomRight());
+        painter.drawLine(area.left(), header - 1, area.right(), header - 1);
+
+        // Name and count
+        QRect title = QRect(area.left() + 10, 0, area.width() - 20, header);
+        QString count = QString::number(column.total);
+        int countWidth = fontMetrics().horizontalAdvance(count);
+        painter.setFont(bold);
+        painter.setPen(colors.text);
+        QString name = column.category.empty() ? QString("No category") : QString::fromStdString(column.category);
+        painter.drawText(title.adjusted(0, 0, -countWidth - 8, 0), Qt::AlignLeft | Qt::AlignVCenter,
+                         painter.fontMetrics().elidedText(name, Qt::ElideRight, title.width() - countWidth - 8));
+        painter.setFont(font());
+        painter.setPen(colors.mutedText);
+        painter.drawText(title, Qt::AlignRight | Qt::AlignVCenter, count);
+
+        // Only the rows inside the body are read, a page at a time
+        painter.save();
+        painter.setClipRect(QRect(area.left(), header, area.width(), body));
+        int firstRow = column.scroll / pitch;
+        int lastRow = std::min(column.total - 1, (column.scroll + body) / pitch);
+        for (int row = firstRow; row <= lastRow; row++) {
+            const std::vector<Todo>* rows = page(column, row / PageSize);
+            if (!rows || row % PageSize >= static_cast<int>(rows->size())) break;  // Counts ahead of rows
+            const Todo& todo = (*rows)[row % PageSize];
+            if (press && press->dragging && todo.getId() == press->todo.getId()) continue;
+
+            QRect card(area.left() + CardGap, header + CardGap + row * pitch - column.scroll,
+                       area.width() - 2 * CardGap - TrackWidth, pitch - CardGap);
+            paintCard(painter, card, todo);
+        }
+
+        // Where the column is scrolled to, when it does not fit
+        int length = column.total * pitch + CardGap;
+        if (length > body && body > 0) {
+            QRect track = trackRect(index);
+            int thumb = std::max(24, static_cast<int>(static_cast<int64_t>(body) * body / length));
+            int top = track.top() + static_cast<int>(static_cast<int64_t>(body - thumb) * column.scroll /
+                                                     std::max(1, maxScroll(column)));
+            painter.setPen(Qt::NoPen);
+            painter.setBrush(colors.inactiveBar);
+            painter.drawRoundedRect(QRect(track.left() + 2, top, TrackWidth - 4, thumb), 2, 2);
+            painter.setBrush(Qt::NoBrush);
+        }
+        painter.restore();
+    }
+
+    // The card being dragged follows the pointer
+    if (press && press->dragging) {
+        QRect card(pointer - press->grab, QSize(columnWidth() - 2 * CardGap - TrackWidth, pitch - CardGap));
+        painter.setOpacity(0.85);
+        paintCard(painter, card, press->todo);
+        painter.setOpacity(1);
+    }
+
+    schedulePrefetch();
+}
+
+void BoardView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+    updateScrollRange();
+}
+
+void BoardView::scrollContentsBy(int, int) {
+    viewport()->update();
+}
+
+void BoardView::wheelEvent(QWheelEvent* event) {
+    // Sideways or with Shift across the columns, otherwise down the one under the pointer
+    QPoint delta = event->angleDelta();
+    int index = columnAt(static_cast<int>(event->position().x()));
+    if (delta.x() != 0 || (event->modifiers() & Qt::ShiftModifier) || index < 0) {
+        QAbstractScrollArea::wheelEvent(event);
+        return;
+    }
+    setColumnScroll(index, columns[index].scroll - delta.y() * cardPitch() / 40);
+    event->accept();
+}
+
+void BoardView::scrollFromTrack(int y) {
+    // The track stands for the whole column, top to bottom
+    Column& column = columns[trackColumn];
+    int body = std::max(1, bodyHeight());
+    double fraction = std::clamp(static_cast<double>(y - headerHeight()) / body, 0.0, 1.0);
+    setColumnScroll(trackColumn, static_cast<int>(fraction * maxScroll(column)));
+}
+
+void BoardView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() != Qt::LeftButton) {
+        QAbstractScrollArea::mousePressEvent(event);
+        return;
+    }
+
+    QPoint pos = event->position().toPoint();
+    int index = columnAt(pos.x());
+    if (index >= 0 && trackRect(index).contains(pos)) {
+        trackColumn = index;
+        scrollFromTrack(pos.y());
+        return;
+    }
+
+    int column = -1;
+    QRect rect;
+    if (const Todo* todo = cardAt(pos, &column, &rect)) {
+        press = Press{column, *todo, pos, pos - rect.topLeft(), false};
+        emit todoClicked(todo->getId());
+    }
+}
+
+void BoardView::mouseMoveEvent(QMouseEvent* event) {
+    QPoint pos = event->position().toPoint();
+    if (trackColumn >= 0) {
+        scrollFromTrack(pos.y());
+        return;
+    }
+    if (!press) return;
+
+    if (!press->dragging && (pos - press->origin).manhattanLength() < QApplication::startDragDistance()) return;
+    press->dragging = true;
+    pointer = pos;
+
+    // Near an edge the board or the column under the card keeps scrolling
+    QRect inner = viewport()->rect().adjusted(EdgeMargin, headerHeight() + EdgeMargin, -EdgeMargin, -EdgeMargin);
+    if (!inner.contains(pos)) {
+        if (!edgeScrollTimer.isActive()) edgeScrollTimer.start();
+    } else {
+        edgeScrollTimer.stop();
+    }
+    viewport()->update();
+}
+
+void BoardView::onEdgeScroll() {
+    if (!press || !press->dragging) {
+        edgeScrollTimer.stop();
+        return;
+    }
+
+    int step = cardPitch() / 3;
+    QRect area = viewport()->rect();
+    if (pointer.x() < EdgeMargin) {
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - step);
+    } else if (pointer.x() > area.width() - EdgeMargin) {
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() + step);
+    }
+
+    int index = columnAt(pointer.x());
+    if (index >= 0) {
+        if (pointer.y() < headerHeight() + EdgeMargin) {
+            setColumnScroll(index, columns[index].scroll - step);
+        } else if (pointer.y() > area.height() - EdgeMargin) {
+            setColumnScroll(index, columns[index].scroll + step);
+        }
+    }
+    viewport()->update();
+}
+
+void BoardView::mouseReleaseEvent(QMouseEvent* event) {
+    trackColumn = -1;
+    edgeScrollTimer.stop();
+    if (!press) {
+        QAbstractScrollArea::mouseReleaseEvent(event);
+        return;
+    }
+
+    // Only a drop on another column changes anything
+    Press released = *press;
+    press.reset();
+    viewport()->update();
+
+    int target = columnAt(event->position().toPoint().x());
+    if (released.dragging && target >= 0 && target != released.column) {
+        emit moveRequested(released.todo.getId(), QString::fromStdString(columns[target].category));
+    }
+}
+
+void BoardView::mouseDoubleClickEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        if (const Todo* todo = cardAt(event->position().toPoint())) emit todoDoubleClicked(todo->getId());
+    }
+    QAbstractScrollArea::mouseDoubleClickEvent(event);
+}
+
+void BoardView::keyPressEvent(QKeyEvent* event) {
+    if (event->key() == Qt::Key_Escape && press) {
+        press.reset();
+        edgeScrollTimer.stop();
+        viewport()->update();
+        return;
+    }
+    // Left and right move a column, Home back to the first
+    if (event->key() == Qt::Key_Left || event->key() == Qt::Key_Right) {
+        int step = event->key() == Qt::Key_Left ? -columnWidth() : columnWidth();
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() + step);
+        return;
+    }
+    if (event->key() == Qt::Key_Home) {
+        horizontalScrollBar()->setValue(0);
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
@@ -0,0 +1,115 @@
+#ifndef BOARDVIEW_H
+#define BOARDVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QTimer>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "database/TodoDatabase.h"
+#include "models/Todo.h"
+
+class CategoryListModel;
+
+// Kanban board: one column per category, cards in list order. Columns come
+// from the shared category counts, so laying out hundreds of them costs no
+// query; only columns on screen load anything. Each column scrolls on its
+// own and pages its cards with getTodosPage() filtered to its category,
+// holding just the pages around what is shown. A jump down the scroll
+// track starts with getPageCursorAt() instead of reading every page above.
+//
+// Dropping a card on another column does not touch the data: it asks for
+// the change with moveRequested() and the owner writes it and reloads.
+class BoardView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    static constexpr int PageSize = 50;
+    static constexpr int PrefetchColumns = 1;    // Loaded on each side of the visible columns
+    static constexpr int MaxResidentPages = 48;  // Across all columns
+
+    BoardView(TodoDatabase* database, const CategoryListModel* categories, QWidget* parent = nullptr);
+
+    // Takes the columns from the category counts again and drops every
+    // loaded page, keeping each column's position; call after writes.
+    // Nothing is queried until the next paint.
+    void reload();
+    // After a bulk write: only the columns whose cards moved, in or out or
+    // within, drop their pages; cards elsewhere are rewritten where they are
+    void updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after);
+
+    int columnCount() const { return static_cast<int>(columns.size()); }
+    int residentPageCount() const;
+
+signals:
+    void todoClicked(int todoId);
+    void todoDoubleClicked(int todoId);
+    // A card dropped on the column of another category
+    void moveRequested(int todoId, const QString& category);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent* event) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseMoveEvent(QMouseEvent* event) override;
+    void mouseReleaseEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    struct Column {
+        std::string category;
+        int total = 0;   // From the category counts
+        int scroll = 0;  // Pixels down the column
+        std::unordered_map<int, std::vector<Todo>> pages;  // By page index
+        // Last row of every page read so far, kept when the page is dropped
+        std::unordered_map<int, TodoPageCursor> pageEnds;
+    };
+
+    // A card picked up by the mouse; a drag once it has moved far enough
+    struct Press {
+        int column = -1;
+        Todo todo;
+        QPoint origin;     // Where the button went down
+        QPoint grab;       // Offset of that point inside the card
+        bool dragging = false;
+    };
+
+    TodoDatabase* database;
+    const CategoryListModel* categories;
+    std::vector<Column> columns;
+    std::optional<Press> press;
+    QPoint pointer;          // Last mouse position while dragging
+    int trackColumn = -1;    // Column whose scroll track is being dragged
+    QTimer prefetchTimer;
+    QTimer edgeScrollTimer;  // Scrolls while a card is held near an edge
+
+    int columnWidth() const;
+    int headerHeight() const;
+    int cardPitch() const;   // Card height plus the gap below it
+    int bodyHeight() const;
+    int maxScroll(const Column& column) const;
+    void setColumnScroll(int index, int scroll);
+    void updateScrollRange();
+
+    bool visibleColumns(int& first, int& last) const;
+    int columnAt(int x) const;  // -1 if none
+    QRect columnRect(int index) const;
+    QRect trackRect(int index) const;
+    const Todo* cardAt(const QPoint& pos, int* column = nullptr, QRect* rect = nullptr);
+
+    const std::vector<Todo>* page(Column& column, int index);
+    std::vector<Todo> loadPage(const Column& column, int index);
+    void schedulePrefetch();
+    void prefetch();
+    void evictPages(int firstColumn, int lastColumn);
+
+    void paintCard(QPainter& painter, const QRect& rect, const Todo& todo) const;
+    void scrollFromTrack(int y);
+    void onEdgeScroll();
+};
+
+#endif // BOARDVIEW_H
@@ -0,0 +1,424 @@
+#include "CalendarView.h"
+#include "Theme.h"
+#include "analytics/TodoAnalytics.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
+#include <QDate>
+#include <QKeyEvent>
+#include <QLocale>
+#include <QMouseEvent>
+#include <QPainter>
+#include <QScrollBar>
+#include <algorithm>
+#include <ctime>
+#include <iterator>
+
+namespace {
+
+const int DayLabelHeight = 24;
+const int WeeksOfMargin = 52;  // Scrollable past the first and last due date
+
+// Days count from 1970-01-01, Julian day 2440588
+QDate toDate(int64_t day) {
+    return QDate::fromJulianDay(day + 2440588);
+}
+
+int64_t mondayOf(int64_t day) {
+    return TodoAnalytics::bucketStart(day, AnalyticsBucket::Week);
+}
+
+} // namespace
+
+// Title and weekday names above the scrolling weeks
+class CalendarHeader : public QWidget {
+public:
+    explicit CalendarHeader(QWidget* parent) : QWidget(parent) {}
+
+    void setTitle(const QString& text) {
+        if (text == title) return;
+        title = text;
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent*) override {
+        QPainter painter(this);
+        const Theme::Colors& colors = Theme::colors();
+        painter.fillRect(rect(), colors.window);
+
+        int half = height() / 2;
+        QFont bold = font();
+        bold.setBold(true);
+        painter.setFont(bold);
+        painter.setPen(colors.text);
+        painter.drawText(QRect(8, 0, width() - 16, half), Qt::AlignLeft | Qt::AlignVCenter, title);
+
+        painter.setFont(font());
+        painter.setPen(colors.mutedText);
+        for (int column = 0; column < 7; column++) {
+            int left = column * width() / 7;
+            int right = (column + 1) * width() / 7;
+            painter.drawText(QRect(left + 6, half, right - left - 12, half), Qt::AlignLeft | Qt::AlignVCenter,
+                             QLocale().dayName(column + 1, QLocale::ShortFormat));
+        }
+        painter.setPen(colors.divider);
+        painter.drawLine(0, height() - 1, width(), height() - 1);
+    }
+
+private:
+    QString title;
+};
+
+CalendarView::CalendarView(TodoDatabase* database, QWidget* parent)
+    : QAbstractScrollArea(parent), database(database) {
+    setFrameShape(QFrame::NoFrame);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setFocusPolicy(Qt::StrongFocus);
+
+    header = new CalendarHeader(this);
+    setViewportMargins(0, 2 * lineHeight() + 8, 0, 0);
+
+    prefetchTimer.setSingleShot(true);
+    prefetchTimer.setInterval(0);
+    connect(&prefetchTimer, &QTimer::timeout, this, &CalendarView::prefetch);
+}
+
+int CalendarView::lineHeight() const {
+    return fontMetrics().height() + 4;
+}
+
+int CalendarView::rowHeight() const {
+    int height = viewport()->height();
+    if (viewMode == Mode::Week) return std::max(height, DayLabelHeight + 4 * lineHeight());
+    return std::max(height / 6, DayLabelHeight + 3 * lineHeight());
+}
+
+int CalendarView::rowsPerDay() const {
+    return std::max(1, (rowHeight() - DayLabelHeight - 4) / lineHeight());
+}
+
+void CalendarView::setMode(Mode mode) {
+    if (mode == viewMode) return;
+
+    int64_t day = firstVisibleDay();
+    viewMode = mode;
+    updateScrollRange();
+    scrollToDay(day);
+}
+
+int64_t CalendarView::firstVisibleDay() const {
+    if (weekCount == 0) return TodoAnalytics::today();
+    return firstWeek + 7 * (verticalScrollBar()->value() / rowHeight());
+}
+
+int64_t CalendarView::dayAtMiddle() const {
+    int middle = verticalScrollBar()->value() + viewport()->height() / 2;
+    return firstWeek + 7 * (middle / rowHeight()) + 3;
+}
+
+void CalendarView::scrollToDay(int64_t day) {
+    if (!rangeKnown) updateScrollRange();
+    int row = static_cast<int>((mondayOf(day) - firstWeek) / 7);
+    verticalScrollBar()->setValue(row * rowHeight());
+    viewport()->update();
+    updateHeader();
+}
+
+void CalendarView::reload() {
+    weeks.clear();
+    if (!rangeKnown) return;
+
+    // A new due date may lie outside the range; keep the same spot in view
+    int64_t day = firstVisibleDay();
+    int offset = verticalScrollBar()->value() % rowHeight();
+    updateScrollRange();
+    verticalScrollBar()->setValue(static_cast<int>((mondayOf(day) - firstWeek) / 7) * rowHeight() + offset);
+    viewport()->update();
+}
+
+void CalendarView::updateTodos(const std::vector<Todo>& todos) {
+    std::unordered_map<int, const Todo*> byId;
+    for (const Todo& todo : todos) byId.emplace(todo.getId(), &todo);
+
+    for (auto& [monday, loaded] : weeks) {
+        for (Day& day : loaded.days) {
+            for (Todo& todo : day.todos) {
+                auto it = byId.find(todo.getId());
+                if (it != byId.end()) todo = *it->second;
+            }
+        }
+    }
+    viewport()->update();
+}
+
+void CalendarView::updateScrollRange() {
+    // Every dated todo plus a year either side, and always today
+    int64_t today = TodoAnalytics::today();
+    int64_t first = today;
+    int64_t last = today;
+    if (auto span = database->getDueDateSpan()) {
+        first = std::min(first, TodoAnalytics::dayOf(span->first));
+        last = std::max(last, TodoAnalytics::dayOf(span->second));
+    }
+
+    firstWeek = mondayOf(first) - 7 * WeeksOfMargin;
+    weekCount = static_cast<int>((mondayOf(last) - firstWeek) / 7) + 1 + WeeksOfMargin;
+    rangeKnown = true;
+
+    int height = rowHeight();
+    verticalScrollBar()->setRange(0, std::max(0, weekCount * height - viewport()->height()));
+    verticalScrollBar()->setSingleStep(std::max(1, height / 4));
+    verticalScrollBar()->setPageStep(viewport()->height());
+}
+
+void CalendarView::updateHeader() {
+    QDate middle = toDate(dayAtMiddle());
+    if (viewMode == Mode::Month) {
+        header->setTitle(middle.toString("MMMM yyyy"));
+    } else {
+        header->setTitle(QString("Week of %1").arg(toDate(firstVisibleDay()).toString("d MMMM yyyy")));
+    }
+}
+
+CalendarView::Week CalendarView::loadWeek(int64_t monday, int perDay) {
+    static Metrics::Histogram& latency = Metrics::histogram(
+        "todo_gui_calendar_week_load_seconds", "CalendarView, the due todos of one week");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("calendarLoadWeek", "refresh");
+
+    Week loaded;
+    loaded.perDay = perDay;
+    time_t start = TodoAnalytics::startOfDay(monday);
+    for (int i = 0; i < 7; i++) {
+        // Day by day rather than one query for the week, so a crowded day
+        // costs its cap and not its size
+        time_t end = TodoAnalytics::startOfDay(monday + i + 1);
+        Day& day = loaded.days[i];
+        day.todos = database->getTodosDueBetween(start, end, perDay);
+        day.total = static_cast<int>(day.todos.size());
+        if (day.total == perDay) day.total = database->countTodosDueBetween(start, end);
+        start = end;
+    }
+    return loaded;
+}
+
+const CalendarView::Week& CalendarView::week(int64_t monday) {
+    int perDay = rowsPerDay();
+    auto it = weeks.find(monday);
+    if (it == weeks.end() || it->second.perDay < perDay) {
+        it = weeks.insert_or_assign(monday, loadWeek(monday, perDay)).first;
+    }
+    return it->second;
+}
+
+bool CalendarView::visibleWeeks(int64_t& firstMonday, int64_t& lastMonday) const {
+    if (weekCount == 0) return false;
+    int height = rowHeight();
+    int scroll = verticalScrollBar()->value();
+    int lastRow = std::min(weekCount - 1, (scroll + viewport()->height() - 1) / height);
+    firstMonday = firstWeek + 7 * (scroll / height);
+    lastMonday = firstWeek + 7 * lastRow;
+    return true;
+}
+
+void CalendarView::schedulePrefetch() {
+    if (!prefetchTimer.isActive()) prefetchTimer.start();
+}
+
+void CalendarView::prefetch() {
+    int64_t firstMonday, lastMonday;
+    if (!visibleWeeks(firstMonday, lastMonday)) return;
+
+    // Nearest weeks first, alternating below and above, a batch per turn
+    int perDay = rowsPerDay();
+    int loaded = 0;
+    for (int distance = 1; distance <= PrefetchWeeks && loaded < PrefetchBatch; distance++) {
+        for (int64_t monday : {lastMonday + 7 * distance, firstMonday - 7 * distance}) {
+            if (monday < firstWeek || monday >= firstWeek + 7 * weekCount) continue;
+            auto it = weeks.find(monday);
+            if (it != weeks.end() && it->second.perDay >= perDay) continue;
+            weeks.insert_or_assign(monday, loadWeek(monday, perDay));
+            loaded++;
+        }
+    }
+
+    // Farthest from the window go first once over the cap
+    int64_t keepFirst = firstMonday - 7 * PrefetchWeeks;
+    int64_t keepLast = lastMonday + 7 * PrefetchWeeks;
+    if (static_cast<int>(weeks.size()) > MaxCachedWeeks) {
+        for (auto it = weeks.begin(); it != weeks.end();) {
+            it = (it->first < keepFirst || it->first > keepLast) ? weeks.erase(it) : std::next(it);
+        }
+    }
+
+    if (loaded == PrefetchBatch) schedulePrefetch();
+}
+
+QRect CalendarView::cellRect(int column, int top) const {
+    int width = viewport()->width();
+    int left = column * width / 7;
+    int right = (column + 1) * width / 7;
+    return QRect(left, top, right - left, rowHeight());
+}
+
+void CalendarView::paintEvent(QPaintEvent*) {
+    static Metrics::Histogram& latency = Metrics::histogram(
+        "todo_gui_calendar_paint_seconds", "CalendarView::paintEvent, visible weeks");
+    Metrics::ScopedTimer timer(latency);
+
+    if (!rangeKnown) updateScrollRange();
+
+    QPainter painter(viewport());
+    const Theme::Colors& colors = Theme::colors();
+    painter.fillRect(viewport()->rect(), colors.window);
+
+    int64_t firstMonday, lastMonday;
+    if (!visibleWeeks(firstMonday, lastMonday)) return;
+
+    int height = rowHeight();
+    int line = lineHeight();
+    int scroll = verticalScrollBar()->value();
+    int64_t today = TodoAnalytics::today();
+    time_t now = std::time(nullptr);
+    int focusMonth = toDate(dayAtMiddle()).month();
+
+    QFont normal = font();
+    QFont bold = font();
+    bold.setBold(true);
+    QFont struck = font();
+    struck.setStrikeOut(true);
+
+    for (int64_t monday = firstMonday; monday <= lastMonday; monday += 7) {
+        const Week& days = week(monday);
+        int top = static_cast<int>((monday - firstWeek) / 7) * height - scroll;
+
+        for (int column = 0; column < 7; column++) {
+            int64_t dayNumber = monday + column;
+            const Day& day = days.days[column];
+            QRect cell = cellRect(column, top);
+            QDate date = toDate(dayNumber);
+
+            if (dayNumber == today) painter.fillRect(cell, colors.hover);
+            painter.setPen(colors.divider);
+            painter.drawLine(cell.topRight(), cell.bottomRight());
+            painter.drawLine(cell.bottomLeft(), cell.bottomRight());
+
+            // Day number, with the month on the 1st and throughout week mode
+            bool otherMonth = viewMode == Mode::Month && date.month() != focusMonth;
+            QString label = viewMode == Mode::Week || date.day() == 1 ? date.toString("d MMM")
+                                                                       : QString::number(date.day());
+            painter.setFont(dayNumber == today ? bold : normal);
+            painter.setPen(dayNumber == today ? colors.accent : otherMonth ? colors.completedText : colors.mutedText);
+            painter.drawText(cell.adjusted(6, 4, -6, 0).topLeft() + QPoint(0, fontMetrics().ascent()), label);
+
+            // One line per todo; the last line says how many more when they do not fit
+            int capacity = rowsPerDay();
+            int shown = std::min(static_cast<int>(day.todos.size()), capacity);
+            if (day.total > shown) shown = std::max(0, capacity - 1);
+
+            for (int i = 0; i < shown; i++) {
+                const Todo& todo = day.todos[i];
+                QRect item(cell.left() + 4, cell.top() + DayLabelHeight + i * line, cell.width() - 8, line - 2);
+
+                QColor bar = todo.getPriority() == 3 ? colors.danger
+                           : todo.getPriority() == 2 ? colors.accent : colors.inactiveBar;
+                painter.fillRect(QRect(item.left(), item.top() + 2, 3, item.height() - 4),
+                                 todo.isCompleted() ? colors.inactiveBar : bar);
+
+                bool overdue = !todo.isCompleted() && todo.getDueDate() && *todo.getDueDate() < now;
+                painter.setFont(todo.isCompleted() ? struck : normal);
+                painter.setPen(todo.isCompleted() ? colors.completedText : overdue ? colors.danger : colors.text);
+                QRect text = item.adjusted(8, 0, 0, 0);
+                painter.drawText(text, Qt::AlignLeft | Qt::AlignVCenter,
+                                 painter.fontMetrics().elidedText(QString::fromStdString(todo.getTitle()),
+                                                                  Qt::ElideRight, text.width()));
+            }
+
+            if (day.total > shown) {
+                QRect more(cell.left() + 12, cell.top() + DayLabelHeight + shown * line, cell.width() - 16, line - 2);
+                painter.setFont(normal);
+                painter.setPen(colors.mutedText);
+                painter.drawText(more, Qt::AlignLeft | Qt::AlignVCenter, QString("+%1 more").arg(day.total - shown));
+            }
+        }
+    }
+
+    schedulePrefetch();
+}
+
+void CalendarView::resizeEvent(QResizeEvent* event) {
+    QAbstractScrollArea::resizeEvent(event);
+
+    QRect area = contentsRect();
+    header->setGeometry(area.left(), area.top(), area.width(), viewportMargins().top());
+
+    // Rows follow the height; keep the same week on top
+    if (rangeKnown) {
+        int64_t day = firstVisibleDay();
+        updateScrollRange();
+        scrollToDay(day);
+    }
+}
+
+void CalendarView::showEvent(QShowEvent* event) {
+    QAbstractScrollArea::showEvent(event);
+    if (!rangeKnown) {
+        updateScrollRange();
+        // Today's week second from the top, so the week before shows too
+        scrollToDay(TodoAnalytics::today() - (viewMode == Mode::Month ? 7 : 0));
+    }
+}
+
+void CalendarView::scrollContentsBy(int, int) {
+    viewport()->update();
+    updateHeader();
+}
+
+int CalendarView::todoAt(const QPoint& pos) {
+    if (weekCount == 0) return 0;
+
+    int height = rowHeight();
+    int y = pos.y() + verticalScrollBar()->value();
+    int row = y / height;
+    int column = std::clamp(pos.x() * 7 / std::max(1, viewport()->width()), 0, 6);
+    if (row < 0 || row >= weekCount) return 0;
+
+    const Day& day = week(firstWeek + 7 * row).days[column];
+    int line = (y - row * height - DayLabelHeight) / lineHeight();
+    int capacity = rowsPerDay();
+    int shown = std::min(static_cast<int>(day.todos.size()), capacity);
+    if (day.total > shown) shown = std::max(0, capacity - 1);
+
+    if (y - row * height < DayLabelHeight || line >= shown) return 0;
+    return day.todos[line].getId();
+}
+
+void CalendarView::mousePressEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        int id = todoAt(event->position().toPoint());
+        if (id > 0) emit todoClicked(id);
+    }
+    QAbstractScrollArea::mousePressEvent(event);
+}
+
+void CalendarView::mouseDoubleClickEvent(QMouseEvent* event) {
+    if (event->button() == Qt::LeftButton) {
+        int id = todoAt(event->position().toPoint());
+        if (id > 0) emit todoDoubleClicked(id);
+    }
+    QAbstractScrollArea::mouseDoubleClickEvent(event);
+}
+
+void CalendarView::keyPressEvent(QKeyEvent* event) {
+    if (event->key() == Qt::Key_Home) {
+        scrollToDay(TodoAnalytics::today() - (viewMode == Mode::Month ? 7 : 0));
+        return;
+    }
+    // Up and down move a week, page keys a screen
+    if (event->key() == Qt::Key_Up || event->key() == Qt::Key_Down) {
+        int step = event->key() == Qt::Key_Up ? -rowHeight() : rowHeight();
+        verticalScrollBar()->setValue(verticalScrollBar()->value() + step);
+        return;
+    }
+    QAbstractScrollArea::keyPressEvent(event);
+}
@@ -0,0 +1,106 @@
+#ifndef CALENDARVIEW_H
+#define CALENDARVIEW_H
+
+#include <QAbstractScrollArea>
+#include <QTimer>
+#include <array>
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+#include "database/TodoDatabase.h"
+#include "models/Todo.h"
+
+class CalendarHeader;
+
+// Month or week calendar of due dates. Weeks are the rows of one scroll
+// area spanning every dated todo with a year of margin, so the wheel moves
+// through years without paging. Only weeks on screen are queried, one
+// getTodosDueBetween() per day capped at what fits in a cell, plus a count
+// once a cell is full. The weeks around them are prefetched a few at a time
+// when idle and those further away dropped, so memory follows the window
+// rather than the data.
+//
+// Days are local calendar days since 1970-01-01, as in TodoAnalytics.
+class CalendarView : public QAbstractScrollArea {
+    Q_OBJECT
+
+public:
+    enum class Mode {
+        Month,  // Six weeks fill the view
+        Week    // One week fills it
+    };
+
+    static constexpr int PrefetchWeeks = 6;     // Kept loaded on each side of the visible weeks
+    static constexpr int PrefetchBatch = 4;     // Weeks loaded per idle turn
+    static constexpr int MaxCachedWeeks = 64;
+
+    explicit CalendarView(TodoDatabase* database, QWidget* parent = nullptr);
+
+    void setMode(Mode mode);
+    Mode mode() const { return viewMode; }
+
+    // Scrolls so the week holding day is the first one shown
+    void scrollToDay(int64_t day);
+    int64_t firstVisibleDay() const;
+
+    // Drops every loaded week; call after writes. Nothing is queried
+    // again until the next paint, so this is cheap while hidden.
+    void reload();
+    // Writes todos into the weeks loaded; for bulk writes, which never
+    // change a due date
+    void updateTodos(const std::vector<Todo>& todos);
+
+    int loadedWeekCount() const { return static_cast<int>(weeks.size()); }
+
+signals:
+    void todoClicked(int todoId);
+    void todoDoubleClicked(int todoId);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    void resizeEvent(QResizeEvent* event) override;
+    void showEvent(QShowEvent* event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void mousePressEvent(QMouseEvent* event) override;
+    void mouseDoubleClickEvent(QMouseEvent* event) override;
+    void keyPressEvent(QKeyEvent* event) override;
+
+private:
+    struct Day {
+        int total = 0;            // Due that day; may exceed todos
+        std::vector<Todo> todos;  // The first ones by due time
+    };
+
+    struct Week {
+        std::array<Day, 7> days;  // Monday first
+        int perDay = 0;           // Rows queried per day
+    };
+
+    TodoDatabase* database;
+    CalendarHeader* header;
+    Mode viewMode = Mode::Month;
+    int64_t firstWeek = 0;  // Monday of the top row of the scroll range
+    int weekCount = 0;
+    bool rangeKnown = false;
+
+    std::unordered_map<int64_t, Week> weeks;  // By Monday
+    QTimer prefetchTimer;
+
+    int rowHeight() const;
+    int lineHeight() const;
+    int rowsPerDay() const;
+    int64_t dayAtMiddle() const;
+    void updateScrollRange();
+    void updateHeader();
+
+    const Week& week(int64_t monday);
+    Week loadWeek(int64_t monday, int perDay);
+    bool visibleWeeks(int64_t& firstMonday, int64_t& lastMonday) const;
+    void schedulePrefetch();
+    void prefetch();
+
+    QRect cellRect(int column, int top) const;
+    int todoAt(const QPoint& pos);
+};
+
+#endif // CALENDARVIEW_H
@@ -0,0 +1,120 @@
+#include "CategoryListModel.h"
+#include "database/TodoDatabase.h"
+
+CategoryListModel::CategoryListModel(QObject* parent)
+    : QAbstractListModel(parent) {
+}
+
+void CategoryListModel::load(TodoDatabase& db) {
+    beginResetModel();
+    model.load(db);
+    endResetModel();
+}
+
+void CategoryListModel::todoCreated(const Todo& todo) {
+    adjust(todo.getCategory(), 1, todo.isCompleted() ? 1 : 0);
+}
+
+void CategoryListModel::todoUpdated(const Todo& before, const Todo& after) {
+    if (before.getCategory() == after.getCategory()) {
+        int completedDelta = (after.isCompleted() ? 1 : 0) - (before.isCompleted() ? 1 : 0);
+        if (completedDelta != 0) {
+            adjust(after.getCategory(), 0, completedDelta);
+        }
+        return;
+    }
+
+    todoDeleted(before);
+    todoCreated(after);
+}
+
+void CategoryListModel::todoDeleted(const Todo& todo) {
+    adjust(todo.getCategory(), -1, todo.isCompleted() ? -1 : 0);
+}
+
+void CategoryListModel::todosUpdated(const std::vector<Todo>& before, const std::vector<Todo>& after) {
+    Deltas deltas;
+    for (const Todo& todo : before) {
+        auto& delta = deltas[todo.getCategory()];
+        delta.first--;
+        delta.second -= todo.isCompleted() ? 1 : 0;
+    }
+    for (const Todo& todo : after) {
+        auto& delta = deltas[todo.getCategory()];
+        delta.first++;
+        delta.second += todo.isCompleted() ? 1 : 0;
+    }
+    adjustAll(deltas);
+}
+
+void CategoryListModel::todosDeleted(const std::vector<Todo>& todos) {
+    Deltas deltas;
+    for (const Todo& todo : todos) {
+        auto& delta = deltas[todo.getCategory()];
+        delta.first--;
+        delta.second -= todo.isCompleted() ? 1 : 0;
+    }
+    adjustAll(deltas);
+}
+
+void CategoryListModel::adjustAll(const Deltas& deltas) {
+    for (const auto& [name, delta] : deltas) {
+        if (delta.first != 0 || delta.second != 0) {
+            adjust(name, delta.first, delta.second);
+        }
+    }
+}
+
+void CategoryListModel::adjust(const std::string& name, int totalDelta, int completedDelta) {
+    int index = model.indexOf(name);
+
+    if (index < 0) {
+        if (totalDelta <= 0) return;
+        int row = model.insertionPoint(name) + 1;
+        beginInsertRows(QModelIndex(), row, row);
+        model.adjust(name, totalDelta, completedDelta);
+        endInsertRows();
+    } else if (model.at(index).total + totalDelta <= 0) {
+        int row = index + 1;
+        beginRemoveRows(QModelIndex(), row, row);
+        model.adjust(name, totalDelta, completedDelta);
+        endRemoveRows();
+    } else {
+        model.adjust(name, totalDelta, completedDelta);
+        emit dataChanged(this->index(index + 1), this->index(index + 1));
+    }
+
+    // The "All" row carries the overall counts
+    emit dataChanged(this->index(0), this->index(0), {TotalRole, CompletedRole});
+}
+
+int CategoryListModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) return 0;
+    return model.size() + 1;
+}
+
+QVariant CategoryListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid() || index.row() >= rowCount()) return QVariant();
+
+    if (isAllRow(index.row())) {
+        switch (role) {
+        case Qt::DisplayRole: return QString("All");
+        case CategoryRole: return QString();
+        case TotalRole: return model.getTotalTodos();
+        case CompletedRole: return model.getCompletedTodos();
+        }
+        return QVariant();
+    }
+
+    const CategoryCount& category = model.at(index.row() - 1);
+    switch (role) {
+    case Qt::DisplayRole:
+    case CategoryRole:
+        return QString::fromStdString(category.name);
+    case TotalRole:
+        return category.total;
+    case CompletedRole:
+        return category.completed;
+    }
+    return QVariant();
+}
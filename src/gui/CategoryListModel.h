@@ -0,0 +1,55 @@
+#ifndef CATEGORYLISTMODEL_H
+#define CATEGORYLISTMODEL_H
+
+#include <QAbstractListModel>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "models/CategoryModel.h"
+#include "models/Todo.h"
+
+class TodoDatabase;
+
+// Qt face of the shared CategoryModel: row 0 is "All", then one row per
+// category. All todo writes go through here so views get precise row
+// inserts/removals/changes instead of a full rebuild.
+class CategoryListModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        CategoryRole = Qt::UserRole,  // Category name, empty for "All"
+        TotalRole,
+        CompletedRole
+    };
+
+    explicit CategoryListModel(QObject* parent = nullptr);
+
+    void load(TodoDatabase& db);
+
+    void todoCreated(const Todo& todo);
+    void todoUpdated(const Todo& before, const Todo& after);
+    void todoDeleted(const Todo& todo);
+
+    // Bulk actions: counts are summed first, then each category changes once
+    void todosUpdated(const std::vector<Todo>& before, const std::vector<Todo>& after);
+    void todosDeleted(const std::vector<Todo>& todos);
+
+    const CategoryModel& categories() const { return model; }
+    bool isAllRow(int row) const { return row == 0; }
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+private:
+    CategoryModel model;
+
+    // Total and completed deltas by category
+    using Deltas = std::map<std::string, std::pair<int, int>>;
+
+    void adjust(const std::string& name, int totalDelta, int completedDelta);
+    void adjustAll(const Deltas& deltas);
+};
+
+#endif // CATEGORYLISTMODEL_H
@@ -10,7 +10,7 @@
 #include <QCheckBox>
 #include <QLabel>
 #include "models/Todo.h"
-#include "database/TodoDatabase.h"
+#include "models/CategoryModel.h"
 
 class EditTodoDialog : public QDialog {
     Q_OBJECT
@@ -38,7 +38,7 @@ private slots:
     void onDueDateToggled(bool checked);
 
 public:
-    EditTodoDialog(const Todo& existingTodo, TodoDatabase* database, QWidget *parent = nullptr);
+    EditTodoDialog(const Todo& existingTodo, const CategoryModel& categories, QWidget *parent = nullptr);
     Todo getTodo() const { return todo; }
 };
 
@@ -7,12 +7,35 @@
 #include <QGraphicsDropShadowEffect>
 #include <QShortcut>
 #include <QTimer>
+#include <QScrollBar>
+#include <QElapsedTimer>
+#include <QSignalBlocker>
+#include <QKeyEvent>
+#include <algorithm>
 #include <iostream>
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
 
-MainWindow::MainWindow(QWidget *parent)
+namespace {
+
+Metrics::Histogram& dialogOpenLatency(const char* dialog) {
+    return Metrics::histogram("todo_gui_dialog_open_seconds",
+                              "From the request to the dialog's first event loop turn", {{"dialog", dialog}});
+}
+
+// Records once the dialog's exec() loop is running, i.e. it has been built and shown
+void recordWhenOpen(QDialog& dialog, Metrics::Histogram& histogram, const QElapsedTimer& timer) {
+    QTimer::singleShot(0, &dialog, [&histogram, timer]() {
+        histogram.recordNs(timer.nsecsElapsed());
+    });
+}
+
+}
+
+MainWindow::MainWindow(const std::string& databasePath, QWidget *parent)
     : QMainWindow(parent) {
 
-    db = std::make_unique<TodoDatabase>("todos.db");
+    db = std::make_unique<TodoDatabase>(databasePath);
 
     if (!db->isOpen()) {
         QMessageBox::critical(this, "Error", "Failed to open database!");
@@ -24,9 +47,19 @@ MainWindow::MainWindow(QWidget *parent)
         return;
     }
 
-    setupUI();
+    // Cheap enough to leave on, so the panel already has the startup queries
+    db->enableProfiling();
+    journal = std::make_unique<TodoJournal>(*db);
+
+    {
+        Trace::Span span("setupUI", "startup");
+        setupUI();
+    }
     connectSignals();
-    loadTodos();
+    {
+        Trace::Span span("loadTodos", "startup");
+        loadTodos();
+    }
 }
 
 MainWindow::~MainWindow() {
@@ -36,53 +69,6 @@ void MainWindow::setupUI() {
     setWindowTitle("Todo");
     resize(700, 800);
 
-    setStyleSheet(R"(
-        QMainWindow {
-            background-color: #FFFFFF;
-        }
-        QWidget {
-            font-family: -apple-system, 'Helvetica Neue', sans-serif;
-            font-size: 14px;
-            color: #000000;
-        }
-        QListWidget {
-            background-color: #FFFFFF;
-            border: none;
-            outline: none;
-        }
-        QListWidget::item {
-            border-bottom: 1px solid #F0F0F0;
-            padding: 0px;
-            background-color: #FFFFFF;
-            color: #000000;
-        }
-        QListWidget::item:selected {
-            background-color: #F8F8F8;
-            color: #000000;
-        }
-        QListWidget::item:hover {
-            background-color: #F8F8F8;
-            color: #000000;
-        }
-        QListWidget::item:selected:hover {
-            background-color: #F0F0F0;
-            color: #000000;
-        }
-        QPushButton {
-            background-color: #000000;
-            color: #FFFFFF;
-            border: none;
-            font-weight: 500;
-            font-size: 24px;
-        }
-        QPushButton:hover {
-            background-color: #2A2A2A;
-        }
-        QPushButton:pressed {
-            background-color: #000000;
-        }
-    )");
-    
     centralWidget = new QWidget(this);
     setCentralWidget(centralWidget);
 
@@ -92,131 +78,158 @@ void MainWindow::setupUI() {
 
     // Top bar
     QWidget* topBarWidget = new QWidget(this);
-    topBarWidget->setStyleSheet("background-color: #FFFFFF; border-bottom: 1px solid #E5E5E5;");
+    topBarWidget->setObjectName("topBar");
     topBar = new QHBoxLayout(topBarWidget);
     topBar->setContentsMargins(20, 16, 20, 16);
 
+    // Shared category list: filter combobox, filter menu and both dialogs
+    categoryModel = new CategoryListModel(this);
+
     categoryFilter = new QComboBox(this);
-    categoryFilter->setStyleSheet(R"(
-        QComboBox {
-            border: none;
-            background: transparent;
-            font-size: 20px;
-            font-weight: 600;
-            color: #000000;
-            padding: 0;
-        }
-        QComboBox::drop-down {
-            border: none;
-            width: 0;
-        }
-        QComboBox::down-arrow {
-            width: 0;
-            height: 0;
-        }
-        QComboBox QAbstractItemView {
-            border: 1px solid #E5E5E5;
-            background-color: #FFFFFF;
-            selection-background-color: #F5F5F5;
-            selection-color: #000000;
-            outline: none;
-            font-size: 14px;
-            font-weight: normal;
-            padding: 4px;
-        }
-        QComboBox QAbstractItemView::item {
-            padding: 8px 12px;
-            border-radius: 4px;
-        }
-        )");
-    categoryFilter->addItem("All");
+    categoryFilter->setObjectName("categoryFilter");
+    categoryFilter->setModel(categoryModel);
     categoryFilter->setFocusPolicy(Qt::NoFocus);
     
     QPushButton* filterButton = new QPushButton("⋮", this);
     filterButton->setFixedSize(36, 36);
-    filterButton->setStyleSheet(R"(
-        QPushButton {
-            background-color: transparent;
-            color: #000000;
-            border: 1px solid #D1D1D1;
-            border-radius: 18px;
-            font-size: 20px;
-            font-weight: bold;
-        }
-        QPushButton:hover {
-            background-color: #F0F0F0;
-            border-color: #8A8A8A;
-        }
-        QPushButton:pressed {
-            background-color: #E5E5E5;
-            border-color: #000000;
-        }
-    )");
+    filterButton->setObjectName("filterButton");
     connect(filterButton, &QPushButton::clicked, this, [this, filterButton]() {
         QMenu menu(this);
-        menu.setStyleSheet(R"(
-            QMenu {
-                background-color: #FFFFFF;
-                border: 1px solid #D1D1D1;
-                border-radius: 6px;
-                padding: 4px;
-            }
-            QMenu::item {
-                padding: 8px 16px;
-                border-radius: 4px;
-            }
-            QMenu::item:selected {
-                background-color: #F5F5F5;
-            }
-        )");
-        
+
         QAction* allAction = menu.addAction("All");
         connect(allAction, &QAction::triggered, this, [this]() {
             categoryFilter->setCurrentIndex(0);
         });
         
-        auto categories = db->getAllCategories();
+        const auto& categories = categoryModel->categories().getCategories();
         if (!categories.empty()) {
             menu.addSeparator();
-            for (const auto& cat : categories) {
-                QAction* action = menu.addAction(QString::fromStdString(cat));
-                connect(action, &QAction::triggered, this, [this, cat]() {
-                    for (int i = 0; i < categoryFilter->count(); i++) {
-                        if (categoryFilter->itemText(i) == QString::fromStdString(cat)) {
-                            categoryFilter->setCurrentIndex(i);
-                            break;
-                        }
-                    }
+            for (int i = 0; i < static_cast<int>(categories.size()); i++) {
+                QString label = QString("%1  %2")
+                    .arg(QString::fromStdString(categories[i].name))
+                    .arg(categories[i].total);
+                QAction* action = menu.addAction(label);
+                connect(action, &QAction::triggered, this, [this, i]() {
+                    categoryFilter->setCurrentIndex(i + 1);  // Row 0 is "All"
                 });
             }
         }
+
+        menu.addSeparator();
+        QAction* listOrder = menu.addAction("Smart order");
+        QAction* manualOrder = menu.addAction("Manual order");
+        listOrder->setCheckable(true);
+        manualOrder->setCheckable(true);
+        listOrder->setChecked(todoModel->getOrder() == TodoOrder::List);
+        manualOrder->setChecked(todoModel->getOrder() == TodoOrder::Manual);
+        connect(listOrder, &QAction::triggered, this, [this]() { setTodoOrder(TodoOrder::List); });
+        connect(manualOrder, &QAction::triggered, this, [this]() { setTodoOrder(TodoOrder::Manual); });
+
+        menu.addSeparator();
+        QAction* listView = menu.addAction("List");
+        QAction* monthView = menu.addAction("Month");
+        QAction* weekView = menu.addAction("Week");
+        QAction* boardView = menu.addAction("Board");
+        listView->setCheckable(true);
+        monthView->setCheckable(true);
+        weekView->setCheckable(true);
+        boardView->setCheckable(true);
+        listView->setChecked(viewMode == ViewMode::List);
+        monthView->setChecked(viewMode == ViewMode::Month);
+        weekView->setChecked(viewMode == ViewMode::Week);
+        boardView->setChecked(viewMode == ViewMode::Board);
+        connect(listView, &QAction::triggered, this, [this]() { setViewMode(ViewMode::List); });
+        connect(monthView, &QAction::triggered, this, [this]() { setViewMode(ViewMode::Month); });
+        connect(weekView, &QAction::triggered, this, [this]() { setViewMode(ViewMode::Week); });
+        connect(boardView, &QAction::triggered, this, [this]() { setViewMode(ViewMode::Board); });
+
+        menu.addSeparator();
+        QAction* undoAction = menu.addAction(journal->canUndo()
+            ? QString("Undo %1").arg(QString::fromStdString(journal->undoLabel())) : QString("Undo"));
+        QAction* redoAction = menu.addAction(journal->canRedo()
+            ? QString("Redo %1").arg(QString::fromStdString(journal->redoLabel())) : QString("Redo"));
+        undoAction->setShortcut(QKeySequence::Undo);
+        redoAction->setShortcut(QKeySequence::Redo);
+        undoAction->setEnabled(journal->canUndo());
+        redoAction->setEnabled(journal->canRedo());
+        connect(undoAction, &QAction::triggered, this, &MainWindow::onUndo);
+        connect(redoAction, &QAction::triggered, this, &MainWindow::onRedo);
+
+        menu.addSeparator();
+        QAction* statsAction = menu.addAction("Statistics…");
+        connect(statsAction, &QAction::triggered, this, &MainWindow::onShowStats);
         
         QPoint pos = filterButton->mapToGlobal(QPoint(0, filterButton->height() + 4));
         menu.exec(pos);
     });
 
+    // Search as you type; results replace the current view until cleared
+    searchField = new QLineEdit(this);
+    searchField->setObjectName("searchField");
+    searchField->setPlaceholderText("Search");
+    searchField->setClearButtonEnabled(true);
+    searchField->setFixedWidth(220);
+    searchField->installEventFilter(this);
+
     topBar->addWidget(categoryFilter);
     topBar->addStretch();
+    topBar->addWidget(searchField);
     topBar->addWidget(filterButton);
 
     mainLayout->addWidget(topBarWidget);
 
-    // Todo list
-    todoList = new QListWidget(this);
-    TodoItemDelegate* delegate = new TodoItemDelegate(this);
-    todoList->setItemDelegate(delegate);
-    connect(delegate, &TodoItemDelegate::checkboxClicked, this, &MainWindow::onCheckboxClicked);
-
-    mainLayout->addWidget(todoList);
+    // Todo list, a tree of subtasks loaded as nodes are expanded
+    todoList = new QTreeView(this);
+    todoModel = new TodoListModel(db.get(), this);
+    todoList->setModel(todoModel);
+    todoList->setUniformRowHeights(true);
+    todoList->setHeaderHidden(true);
+    todoList->setIndentation(20);
+    todoList->setContextMenuPolicy(Qt::CustomContextMenu);
+    todoList->setDropIndicatorShown(true);
+    todoList->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    todoDelegate = new TodoItemDelegate(this);
+    todoList->setItemDelegate(todoDelegate);
+    connect(todoDelegate, &TodoItemDelegate::checkboxClicked, this, &MainWindow::onCheckboxClicked);
+
+    // Calendar of due dates, queried only while shown
+    calendarView = new CalendarView(db.get(), this);
+
+    // Board of categories, laid out from the shared category counts
+    boardView = new BoardView(db.get(), categoryModel, this);
+
+    // Search results, painted like list rows
+    searchList = new QListView(this);
+    searchModel = new TodoSearchModel(db.get(), this);
+    searchList->setModel(searchModel);
+    searchList->setUniformItemSizes(true);
+    searchList->setItemDelegate(todoDelegate);
+
+    views = new QStackedWidget(this);
+    views->addWidget(todoList);
+    views->addWidget(calendarView);
+    views->addWidget(boardView);
+    views->addWidget(searchList);
+
+    // Detail pane, built once and rebound on every click
+    inspector = new TodoInspector(this);
+
+    QHBoxLayout* contentLayout = new QHBoxLayout();
+    contentLayout->setContentsMargins(0, 0, 0, 0);
+    contentLayout->setSpacing(0);
+    contentLayout->addWidget(views, 1);
+    contentLayout->addWidget(inspector);
+
+    mainLayout->addLayout(contentLayout);
 
     // Bottom status bar
     QWidget* bottomBar = new QWidget(this);
-    bottomBar->setStyleSheet("background-color: #FFFFFF;");
+    bottomBar->setObjectName("bottomBar");
     QHBoxLayout* bottomLayout = new QHBoxLayout(bottomBar);
     bottomLayout->setContentsMargins(20, 16, 20, 16);
 
     statusLabel = new QLabel("0 items", this);
-    statusLabel->setStyleSheet("color: #999999; font-size: 13px;");
+    statusLabel->setObjectName("statusLabel");
     statusLabel->setAlignment(Qt::AlignCenter);
 
     bottomLayout->addWidget(statusLabel);
@@ -226,23 +239,7 @@ void MainWindow::setupUI() {
     // Floating add button
     addButton = new QPushButton("+", centralWidget);
     addButton->setFixedSize(56, 56);
-    addButton->setStyleSheet(R"(
-        QPushButton {
-            background-color: #000000;
-            color: #FFFFFF;
-            border: none;
-            border-radius: 28px;
-            font-size: 28px;
-            font-weight: 300;
-            padding-bottom: 2px;
-        }
-        QPushButton:hover {
-            background-color: #2A2A2A;
-        }
-        QPushButton:pressed {
-            background-color: #000000;
-        }
-    )");
+    addButton->setObjectName("addButton");
 
     QGraphicsDropShadowEffect* shadow = new QGraphicsDropShadowEffect();
     shadow->setBlurRadius(12);
@@ -251,6 +248,43 @@ void MainWindow::setupUI() {
     shadow->setColor(QColor(0, 0, 0, 38));
     addButton->setGraphicsEffect(shadow);
     addButton->raise();
+
+    // Query profiler, docked at the bottom and hidden until F12
+    profilerDock = new QDockWidget("Query profiler", this);
+    profilerDock->setObjectName("profilerDock");
+    profilerDock->setWidget(new QueryProfilerPanel(db.get(), profilerDock));
+    addDockWidget(Qt::BottomDockWidgetArea, profilerDock);
+    profilerDock->hide();
+
+    // Text fields in dialogs keep their own undo: they take the key first
+    QShortcut* undoShortcut = new QShortcut(QKeySequence::Undo, this);
+    QShortcut* redoShortcut = new QShortcut(QKeySequence::Redo, this);
+    connect(undoShortcut, &QShortcut::activated, this, &MainWindow::onUndo);
+    connect(redoShortcut, &QShortcut::activated, this, &MainWindow::onRedo);
+
+    // Delete on the list acts on the selection; the inspector keeps Backspace
+    QShortcut* deleteSelection = new QShortcut(QKeySequence(Qt::Key_Delete), todoList);
+    deleteSelection->setContext(Qt::WidgetShortcut);
+    connect(deleteSelection, &QShortcut::activated, this, [this]() {
+        std::vector<int> ids = selectedTodoIds();
+        if (!ids.empty()) deleteTodos(ids);
+    });
+
+    // Respacing crowded manual ranks waits until dragging has stopped
+    rebalanceTimer = new QTimer(this);
+    rebalanceTimer->setSingleShot(true);
+    rebalanceTimer->setInterval(2000);
+
+    QShortcut* findShortcut = new QShortcut(QKeySequence::Find, this);
+    connect(findShortcut, &QShortcut::activated, this, [this]() {
+        searchField->setFocus();
+        searchField->selectAll();
+    });
+
+    QShortcut* profilerShortcut = new QShortcut(QKeySequence(Qt::Key_F12), this);
+    connect(profilerShortcut, &QShortcut::activated, this, [this]() {
+        profilerDock->setVisible(!profilerDock->isVisible());
+    });
 }
 
 void MainWindow::resizeEvent(QResizeEvent* event) {
@@ -261,125 +295,112 @@ void MainWindow::resizeEvent(QResizeEvent* event) {
         int y = centralWidget->height() - addButton->height() - 20;
         addButton->move(x, y);
     }
+
+    if (todoModel) {
+        updateVisibleRows();
+    }
 }
 
 void MainWindow::connectSignals() {
     connect(addButton, &QPushButton::clicked, this, &MainWindow::onAddTodo);
-    connect(todoList, &QListWidget::itemClicked, this, &MainWindow::onTodoClicked);
+    connect(todoList, &QTreeView::clicked, this, &MainWindow::onTodoClicked);
+    connect(todoList, &QTreeView::customContextMenuRequested, this, &MainWindow::onTodoContextMenu);
+    connect(todoList, &QTreeView::expanded, this, &MainWindow::onTodoExpanded);
+    connect(todoList, &QTreeView::collapsed, this, &MainWindow::onTodoCollapsed);
+    connect(todoModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::onTodoRowsInserted);
+    connect(todoModel, &TodoListModel::moveRequested, this, &MainWindow::onTodoMoveRequested);
+    connect(rebalanceTimer, &QTimer::timeout, this, &MainWindow::onRebalanceTimeout);
+    connect(calendarView, &CalendarView::todoClicked, this, [this](int todoId) {
+        QElapsedTimer clickTimer;
+        clickTimer.start();
+        showInInspector(todoId, clickTimer);
+    });
+    connect(calendarView, &CalendarView::todoDoubleClicked, this, &MainWindow::onInspectorEdit);
+    connect(boardView, &BoardView::todoClicked, this, [this](int todoId) {
+        QElapsedTimer clickTimer;
+        clickTimer.start();
+        showInInspector(todoId, clickTimer);
+    });
+    connect(boardView, &BoardView::todoDoubleClicked, this, &MainWindow::onInspectorEdit);
+    connect(boardView, &BoardView::moveRequested, this, &MainWindow::onBoardMoveRequested);
+    connect(searchField, &QLineEdit::textChanged, this, &MainWindow::onSearchTextChanged);
+    connect(searchModel, &TodoSearchModel::progress, this, &MainWindow::onSearchProgress);
+    connect(searchList, &QListView::clicked, this, &MainWindow::onTodoClicked);
+    connect(searchList, &QListView::doubleClicked, this, [this](const QModelIndex& index) {
+        onInspectorEdit(index.data(TodoListModel::TodoIdRole).toInt());
+    });
+    connect(inspector, &TodoInspector::editRequested, this, &MainWindow::onInspectorEdit);
+    connect(inspector, &TodoInspector::toggleRequested, this, &MainWindow::onInspectorToggle);
+    connect(inspector, &TodoInspector::deleteRequested, this, &MainWindow::onInspectorDelete);
+    connect(inspector, &TodoInspector::closeRequested, inspector, &TodoInspector::clear);
+    connect(inspector, &TodoInspector::presented, this, &MainWindow::onInspectorPresented);
     connect(categoryFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), 
             this, &MainWindow::onCategoryFilterChanged);
-}
-
-void MainWindow::loadTodos() {
-    refreshTodoList();
 
-    auto categories = db->getAllCategories();
-    categoryFilter->clear();
-    categoryFilter->addItem("All");
-    for (const auto& cat : categories) {
-        categoryFilter->addItem(QString::fromStdString(cat));
-    }
+    // Keep the model's hydrated window following the viewport
+    connect(todoList->verticalScrollBar(), &QScrollBar::valueChanged,
+            this, &MainWindow::updateVisibleRows);
+    connect(todoModel, &QAbstractItemModel::rowsInserted, this, &MainWindow::updateVisibleRows);
+    connect(todoModel, &QAbstractItemModel::modelReset, this, &MainWindow::updateVisibleRows);
 }
 
-void MainWindow::refreshTodoList() {
-    todoList->clear();
-
-    std::vector<Todo> todos;
-    QString currentFilter = categoryFilter->currentText();
+void MainWindow::updateVisibleRows() {
+    int rows = todoModel->rowCount();
+    if (rows == 0) return;
 
-    if (currentFilter == "All") {
-        todos = db->getAllTodos();
-    } else {
-        todos = db->getTodosByCategory(currentFilter.toStdString());
-    }
+    // Pages are top-level rows; a subtask stands for its top-level ancestor
+    auto topLevel = [](QModelIndex index) {
+        while (index.parent().isValid()) index = index.parent();
+        return index;
+    };
+    QModelIndex first = topLevel(todoList->indexAt(QPoint(0, 0)));
+    QModelIndex last = topLevel(todoList->indexAt(QPoint(0, todoList->viewport()->height() - 1)));
 
-    // Sort: incomplete first, then priority, then due date
-    std::sort(todos.begin(), todos.end(), [](const Todo& a, const Todo& b) {
-        if (a.isCompleted() != b.isCompleted()) return !a.isCompleted();
-        if (a.getPriority() != b.getPriority()) return a.getPriority() > b.getPriority();
-        
-        bool aDue = a.getDueDate().has_value();
-        bool bDue = b.getDueDate().has_value();
-        if (aDue != bDue) return aDue;
-        if (aDue && bDue) return a.getDueDate().value() < b.getDueDate().value();
-        
-        return false;
-    });
-
-    for (const auto& todo : todos) {
-        QString itemText;
-
-        if (todo.getPriority() == 3 && !todo.isCompleted()) {
-            itemText += "● ";
-        } else {
-            itemText += "  ";
-        }
-
-        itemText += QString::fromStdString(todo.getTitle());
-        itemText += "\n";
-
-        QString metadata = "";
-
-        if (currentFilter == "All" && !todo.getCategory().empty()) {
-            metadata += QString::fromStdString(todo.getCategory());
-        }
+    todoModel->setVisibleRows(first.isValid() ? first.row() : 0,
+                              last.isValid() ? last.row() : rows - 1);
+}
 
-        if (todo.isOverdue() && !todo.isCompleted()) {
-            if (!metadata.isEmpty()) metadata += " • ";
-            metadata += "overdue";
-        } else if (todo.getDueDate().has_value() && !todo.isCompleted()) {
-            int days = todo.daysUntilDue();
-            if (days == 0) {
-                if (!metadata.isEmpty()) metadata += " • ";
-                metadata += "due today";
-            } else if (days == 1) {
-                if (!metadata.isEmpty()) metadata += " • ";
-                metadata += "due tomorrow";
-            } else if (days > 0 && days <= 7) {
-                if (!metadata.isEmpty()) metadata += " • ";
-                metadata += QString("due in %1d").arg(days);
-            }
-        }
-        
-        itemText += metadata;
+void MainWindow::loadTodos() {
+    // Full category query; later writes update the model in place, except
+    // undo and redo (afterReplay())
+    {
+        Trace::Span span("CategoryListModel::load", "refresh");
+        categoryModel->load(*db);
+    }
+    categoryFilter->setCurrentIndex(0);
 
-        QListWidgetItem* item = new QListWidgetItem(itemText);
+    refreshTodoList();
+}
 
-        if (todo.isCompleted()) {
-            QFont font = item->font();
-            font.setStrikeOut(true);
-            item->setFont(font);
-            item->setForeground(QColor("#E0E0E0"));
-        }
-        else if (todo.isOverdue()) {
-            QFont font = item->font();
-            font.setBold(true);
-            item->setFont(font);
-        }
-        else if (todo.getPriority() == 3) {
-            QFont font = item->font();
-            font.setBold(true);
-            item->setFont(font);
-        }
+void MainWindow::refreshTodoList() {
+    static Metrics::Histogram& latency = Metrics::histogram(
+        "todo_gui_refresh_seconds", "MainWindow::refreshTodoList, model reset and status bar");
+    Metrics::ScopedTimer timer(latency);
+    Trace::Span span("refreshTodoList", "refresh");
 
-        item->setData(Qt::UserRole, todo.getId());
+    // Order (incomplete first, then priority, then due date) comes from
+    // the keyset-paged query; the model fetches pages as the view scrolls
+    int filterRow = categoryFilter->currentIndex();
 
-        todoList->addItem(item);
+    if (filterRow <= 0) {
+        todoModel->setCategoryFilter(std::nullopt);
+    } else {
+        QString category = categoryFilter->itemData(filterRow, CategoryListModel::CategoryRole).toString();
+        todoModel->setCategoryFilter(category.toStdString());
     }
 
+    calendarView->reload();
+    boardView->reload();
+    searchModel->restart();
     updateStatusBar();
 }
 
 void MainWindow::updateStatusBar() {
-    auto todos = db->getAllTodos();
-    int total = todos.size();
-    int completed = 0;
-    int overdue = 0;
-    
-    for (const auto& todo : todos) {
-        if (todo.isCompleted()) completed++;
-        if (todo.isOverdue() && !todo.isCompleted()) overdue++;
-    }
+    Trace::Span span("updateStatusBar", "refresh");
+    TodoCounts counts = db->getTodoCounts();
+    int total = counts.total;
+    int completed = counts.completed;
+    int overdue = counts.overdue;
     
     QString status;
     if (total == 0) {
@@ -398,305 +419,512 @@ void MainWindow::updateStatusBar() {
         status += QString(" · %1 overdue").arg(overdue);
     }
     
-    statusLabel->setText(status);
+    // While searching the label counts matches instead (onSearchProgress())
+    if (!searchModel->isActive()) statusLabel->setText(status);
+
+    // Every write ends up here; an open stats window follows along
+    if (statsDialog && statsDialog->isVisible()) statsDialog->refresh();
+}
+
+void MainWindow::onShowStats() {
+    // Kept after closing, so it reopens on the range last picked
+    if (!statsDialog) statsDialog = new StatsDialog(db.get(), this);
+    statsDialog->refresh();
+    statsDialog->show();
+    statsDialog->raise();
+    statsDialog->activateWindow();
 }
 
 void MainWindow::onAddTodo() {
-    AddTodoDialog dialog(db.get(), this);
+    addTodo(std::nullopt);
+}
+
+void MainWindow::addTodo(std::optional<int> parentId) {
+    static Metrics::Histogram& openLatency = dialogOpenLatency("add");
+    QElapsedTimer openTimer;
+    openTimer.start();
+
+    AddTodoDialog dialog(categoryModel->categories(), this);
+    recordWhenOpen(dialog, openLatency, openTimer);
     
     if (dialog.exec() == QDialog::Accepted) {
         Todo newTodo = dialog.getTodo();
+        newTodo.setParentId(parentId);
         
-        if (db->createTodo(newTodo)) {
+        if (journal->createTodo(newTodo)) {
             std::cout << "Created todo: " << newTodo.getTitle() << std::endl;
-            loadTodos();
+            categoryModel->todoCreated(newTodo);
+            if (parentId) expandedTodos.insert(*parentId);
+            refreshTodoList();
         } else {
             QMessageBox::warning(this, "Error", "Failed to create todo!");
         }
     }
 }
 
-void MainWindow::onTodoClicked(QListWidgetItem* item) {
-    // Don't open dialog if checkbox was clicked
+void MainWindow::onTodoClicked(const QModelIndex& index) {
+    QElapsedTimer clickTimer;
+    clickTimer.start();
+
+    // Don't open the inspector if checkbox was clicked
     if (checkboxWasClicked) {
         return;
     }
 
-    int todoId = item->data(Qt::UserRole).toInt();
+    showInInspector(index.data(TodoListModel::TodoIdRole).toInt(), clickTimer);
+}
+
+void MainWindow::showInInspector(int todoId, const QElapsedTimer& clickTimer) {
     auto todo = db->getTodoById(todoId);
+    if (!todo) return;
+
+    inspector->showTodo(*todo, clickTimer);
+}
+
+void MainWindow::onInspectorPresented(qint64 latencyUs) {
+    static Metrics::Histogram& presentLatency = Metrics::histogram(
+        "todo_gui_inspector_present_seconds", "From a row click to the inspector's first paint");
+    presentLatency.recordNs(latencyUs * 1000);
+}
+
+void MainWindow::syncInspector(int todoId) {
+    if (inspector->currentTodoId() != todoId) return;
+
+    auto todo = db->getTodoById(todoId);
+    if (todo) {
+        inspector->setTodo(*todo);
+    } else {
+        inspector->clear();
+    }
+}
+
+void MainWindow::onInspectorEdit(int todoId) {
+    static Metrics::Histogram& openLatency = dialogOpenLatency("edit");
+    QElapsedTimer openTimer;
+    openTimer.start();
 
+    auto todo = db->getTodoById(todoId);
     if (!todo) return;
-    
-    // Create custom dialog
-    QDialog dialog(this);
-    dialog.setWindowTitle(" ");
-    dialog.setMinimumWidth(400);
-    dialog.setStyleSheet(R"(
-        QDialog {
-            background-color: #FFFFFF;
-        }
-        QLabel {
-            color: #000000;
-        }
-        QPushButton {
-            border: 1px solid #E5E5E5;
-            padding: 12px 24px;
-            border-radius: 8px;
-            background-color: #FFFFFF;
-            font-weight: 500;
-            font-size: 14px;
-            color: #000000;
-        }
-        QPushButton:hover {
-            background-color: #FAFAFA;
-            border-color: #000000;
+
+    EditTodoDialog editDialog(*todo, categoryModel->categories(), this);
+    recordWhenOpen(editDialog, openLatency, openTimer);
+    if (editDialog.exec() == QDialog::Accepted) {
+        Todo updatedTodo = editDialog.getTodo();
+        if (journal->updateTodo(*todo, updatedTodo)) {
+            categoryModel->todoUpdated(*todo, updatedTodo);
+            todoDelegate->invalidateTodo(updatedTodo.getId());
+            refreshTodoList();
+            syncInspector(todoId);
+        } else {
+            QMessageBox::warning(this, "Error", "Failed to update todo!");
         }
-    )");
-    
-    QVBoxLayout* layout = new QVBoxLayout(&dialog);
-    layout->setContentsMargins(24, 24, 24, 24);
-    layout->setSpacing(16);
-    
-    // Title
-    QLabel* titleLabel = new QLabel(QString::fromStdString(todo->getTitle()), &dialog);
-    titleLabel->setStyleSheet("font-size: 24pt; font-weight: bold; color: #000000;");
-    titleLabel->setWordWrap(true);
-    layout->addWidget(titleLabel);
+    }
+}
 
-    layout->addSpacing(12);
+void MainWindow::onInspectorToggle(int todoId) {
+    auto todo = db->getTodoById(todoId);
+    if (!todo) return;
 
-    // Category (if exists)
-    if (!todo->getCategory().empty()) {
-        QLabel* catLabelHeader = new QLabel("CATEGORY", &dialog);
-        catLabelHeader->setStyleSheet("color: #999999; font-size: 10px; font-weight: 600; letter-spacing: 1.2px;");
-        layout->addWidget(catLabelHeader);
+    Todo before = *todo;
+    todo->setCompleted(!todo->isCompleted());
+    if (journal->updateTodo(before, *todo)) {
+        categoryModel->todoUpdated(before, *todo);
+    }
+    todoDelegate->invalidateTodo(todoId);
+    refreshTodoList();
+    syncInspector(todoId);
+}
 
-        QLabel* catValue = new QLabel(QString::fromStdString(todo->getCategory()), &dialog);
-        catValue->setStyleSheet("color: #000000; font-size: 14px; margin-top: 2px;");
-        layout->addWidget(catValue);
+void MainWindow::onInspectorDelete(int todoId) {
+    QMessageBox msgBox(this);
+    msgBox.setWindowTitle("Delete Todo");
+    msgBox.setText("Are you sure you want to delete this todo");
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::No);
+    msgBox.setIcon(QMessageBox::Warning);
+
+    TodoSubtreeProgress subtree = db->getSubtreeProgress(todoId);
+    if (subtree.descendants > 0) {
+        msgBox.setInformativeText(QString("Its %1 subtasks will be deleted too.").arg(subtree.descendants));
+    }
 
-        layout->addSpacing(12);
+    if (msgBox.exec() == QMessageBox::Yes) {
+        // The subtree goes with it; count every row out
+        std::vector<Todo> removed;
+        if (journal->deleteTodos({todoId}, &removed) > 0) {
+            categoryModel->todosDeleted(removed);
+            for (const Todo& deleted : removed) {
+                todoDelegate->invalidateTodo(deleted.getId());
+            }
+        }
+        todoDelegate->invalidateTodo(todoId);
+        refreshTodoList();
+        inspector->clear();
     }
+}
 
-    // Priority
-    QLabel* priorityLabelHeader = new QLabel("PRIORITY", &dialog);
-    priorityLabelHeader->setStyleSheet("color: #999999; font-size: 10px; font-weight: 600; letter-spacing: 1.2px;");
-    layout->addWidget(priorityLabelHeader);
+void MainWindow::onCategoryFilterChanged(int index) {
+    Q_UNUSED(index);
+    refreshTodoList();
+}
 
-    QHBoxLayout* priorityLayout = new QHBoxLayout();
-    priorityLayout->setSpacing(4);
-    priorityLayout->setContentsMargins(0, 2, 0, 0);
+void MainWindow::onDeleteTodo() {
+    // Handled in onTodoClicked
+}
 
-    int priority = todo->getPriority();
-    for (int i = 1; i <= 3; i++) {
-        QLabel* bar = new QLabel(&dialog);
-        bar->setFixedSize(30, 6);
-        QString color = (i <= priority) ? "#000000" : "#E5E5E5";
-        bar->setStyleSheet("background-color: " + color + "; border-radius: 3px;");
-        priorityLayout->addWidget(bar);
-    }
-    priorityLayout->addStretch();
+void MainWindow::onCheckboxClicked(const QModelIndex& index) {
+    // Set flag to prevent dialog from opening
+    checkboxWasClicked = true;
 
-    layout->addLayout(priorityLayout);
-    layout->addSpacing(12);
+    // Get the todo ID from the clicked row
+    if (!index.isValid()) return;
 
-    // Due date (if exists)
-    if (todo->getDueDate().has_value()) {
-        QLabel* dueLabelHeader = new QLabel("DUE DATE", &dialog);
-        dueLabelHeader->setStyleSheet("color: #999999; font-size: 10px; font-weight: 600; letter-spacing: 1.2px;");
-        layout->addWidget(dueLabelHeader);
+    int todoId = index.data(TodoListModel::TodoIdRole).toInt();
+    auto todo = db->getTodoById(todoId);
 
-        QDateTime dt = QDateTime::fromSecsSinceEpoch(todo->getDueDate().value());
-        QLabel* dueValue = new QLabel(dt.toString("dd.MM.yyyy"), &dialog);
-        dueValue->setStyleSheet("color: #000000; font-size: 14px; margin-top: 2px;");
-        layout->addWidget(dueValue);
+    if (!todo) return;
 
-        layout->addSpacing(12);
+    // Toggle completion status
+    Todo before = *todo;
+    todo->setCompleted(!todo->isCompleted());
+    if (journal->updateTodo(before, *todo)) {
+        categoryModel->todoUpdated(before, *todo);
     }
+    todoDelegate->invalidateTodo(todoId);
+    syncInspector(todoId);
 
-    // Description (if exists)
-    if (!todo->getDescription().empty()) {
-        QLabel* descLabelHeader = new QLabel("DESCRIPTION", &dialog);
-        descLabelHeader->setStyleSheet("color: #999999; font-size: 10px; font-weight: 600; letter-spacing: 1.2px;");
-        layout->addWidget(descLabelHeader);
+    // Defer refresh to avoid crash during event handling
+    QTimer::singleShot(0, this, [this]() {
+        refreshTodoList();
+        // Reset flag after refresh
+        checkboxWasClicked = false;
+    });
+}
+void MainWindow::onTodoContextMenu(const QPoint& pos) {
+    QModelIndex index = todoList->indexAt(pos);
+    if (!index.isValid()) return;
 
-        QLabel* descValue = new QLabel(QString::fromStdString(todo->getDescription()), &dialog);
-        descValue->setStyleSheet("color: #000000; font-size: 14px; line-height: 1.5; margin-top: 2px;");
-        descValue->setWordWrap(true);
-        layout->addWidget(descValue);
+    int todoId = index.data(TodoListModel::TodoIdRole).toInt();
+    bool isSubtask = index.parent().isValid();
 
-        layout->addSpacing(12);
+    // Right-clicking inside a multiple selection acts on all of it
+    std::vector<int> selected = selectedTodoIds();
+    if (selected.size() > 1 && todoList->selectionModel()->isSelected(index)) {
+        showBulkMenu(selected, todoList->viewport()->mapToGlobal(pos));
+        return;
     }
-    
-    layout->addSpacing(8);
-    
-    // Buttons - all on one row
-    QHBoxLayout* buttonLayout = new QHBoxLayout();
-    buttonLayout->setSpacing(8);
-
-    QPushButton* editBtn = new QPushButton("Edit", &dialog);
-    editBtn->setFixedSize(70, 32);
-    editBtn->setStyleSheet(R"(
-        QPushButton {
-            border: 1px solid #D1D1D1;
-            background-color: #FFFFFF;
-            color: #000000;
-            padding: 6px 12px;
-            border-radius: 6px;
-            font-weight: 500;
-            font-size: 13px;
-        }
-        QPushButton:hover {
-            background-color: #F0F0F0;
-            border-color: #8A8A8A;
-        }
-    )");
-
-    QPushButton* toggleBtn = new QPushButton(
-        todo->isCompleted() ? "Incomplete" : "Complete",
-        &dialog
-    );
-    toggleBtn->setFixedSize(90, 32);
-    toggleBtn->setStyleSheet(R"(
-        QPushButton {
-            border: 1px solid #D1D1D1;
-            background-color: #FFFFFF;
-            color: #000000;
-            padding: 6px 12px;
-            border-radius: 6px;
-            font-weight: 500;
-            font-size: 13px;
-        }
-        QPushButton:hover {
-            background-color: #F0F0F0;
-            border-color: #8A8A8A;
-        }
-    )");
-
-    QPushButton* deleteBtn = new QPushButton("Delete", &dialog);
-    deleteBtn->setFixedSize(70, 32);
-    deleteBtn->setStyleSheet(R"(
-        QPushButton {
-            background-color: #FF3B30;
-            color: #FFFFFF;
-            border: none;
-            padding: 6px 12px;
-            border-radius: 6px;
-            font-weight: 500;
-            font-size: 13px;
-        }
-        QPushButton:hover {
-            background-color: #D32F28;
-        }
-    )");
-
-    QPushButton* cancelBtn = new QPushButton("Done", &dialog);
-    cancelBtn->setFixedSize(70, 32);
-    cancelBtn->setStyleSheet(R"(
-        QPushButton {
-            border: 1px solid #D1D1D1;
-            background-color: #FFFFFF;
-            color: #000000;
-            padding: 6px 12px;
-            border-radius: 6px;
-            font-weight: 500;
-            font-size: 13px;
+
+    QMenu menu(this);
+    QAction* addSubtask = menu.addAction("Add subtask…");
+    QAction* moveToTop = isSubtask ? menu.addAction("Move to top level") : nullptr;
+
+    QAction* chosen = menu.exec(todoList->viewport()->mapToGlobal(pos));
+    if (!chosen) return;
+
+    if (chosen == addSubtask) {
+        addTodo(todoId);
+    } else if (chosen == moveToTop) {
+        if (journal->moveTodo(todoId, std::nullopt)) {
+            todoDelegate->invalidateTodo(todoId);
+            refreshTodoList();
+            syncInspector(todoId);
         }
-        QPushButton:hover {
-            background-color: #F0F0F0;
-            border-color: #8A8A8A;
+    }
+}
+
+void MainWindow::onTodoExpanded(const QModelIndex& index) {
+    expandedTodos.insert(index.data(TodoListModel::TodoIdRole).toInt());
+}
+
+void MainWindow::onTodoCollapsed(const QModelIndex& index) {
+    expandedTodos.erase(index.data(TodoListModel::TodoIdRole).toInt());
+    // Collapsed subtrees cost nothing until opened again
+    todoModel->releaseChildren(index);
+}
+
+void MainWindow::onTodoRowsInserted(const QModelIndex& parent, int first, int last) {
+    // A refresh resets the model and the view forgets what was open; expanding
+    // fetches that node's children, which come back through here in turn
+    if (expandedTodos.empty()) return;
+
+    for (int row = first; row <= last; row++) {
+        QModelIndex index = todoModel->index(row, 0, parent);
+        if (expandedTodos.count(index.data(TodoListModel::TodoIdRole).toInt())) {
+            todoList->expand(index);
         }
-    )");
+    }
+}
+
+void MainWindow::setTodoOrder(TodoOrder order) {
+    todoModel->setOrder(order);
+    todoList->setDragDropMode(order == TodoOrder::Manual ? QAbstractItemView::InternalMove
+                                                         : QAbstractItemView::NoDragDrop);
+}
 
-    buttonLayout->addWidget(editBtn);
-    buttonLayout->addWidget(toggleBtn);
-    buttonLayout->addWidget(deleteBtn);
-    buttonLayout->addStretch();
-    buttonLayout->addWidget(cancelBtn);
+void MainWindow::setViewMode(ViewMode mode) {
+    viewMode = mode;
+    if (mode == ViewMode::Month || mode == ViewMode::Week) {
+        calendarView->setMode(mode == ViewMode::Week ? CalendarView::Mode::Week : CalendarView::Mode::Month);
+    }
 
-    layout->addLayout(buttonLayout);
+    // Picking a view ends a search
+    if (!searchField->text().isEmpty()) {
+        searchField->clear();
+        return;
+    }
+    showCurrentView();
+}
 
-    // Keyboard shortcuts - set shortcuts with proper context
-    // On Mac, the "Delete" key is actually Backspace
-    QShortcut* deleteShortcut = new QShortcut(QKeySequence(Qt::Key_Backspace), &dialog);
-    QShortcut* escapeShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), &dialog);
+void MainWindow::showCurrentView() {
+    QWidget* view = viewMode == ViewMode::List  ? static_cast<QWidget*>(todoList)
+                  : viewMode == ViewMode::Board ? static_cast<QWidget*>(boardView)
+                                                : static_cast<QWidget*>(calendarView);
+    views->setCurrentWidget(view);
+    if (viewMode != ViewMode::List) view->setFocus();
+}
 
-    connect(deleteShortcut, &QShortcut::activated, deleteBtn, &QPushButton::click);
-    connect(escapeShortcut, &QShortcut::activated, cancelBtn, &QPushButton::click);
+void MainWindow::onSearchTextChanged(const QString& text) {
+    QString query = text.trimmed();
+    searchModel->setQueryText(query);
+    if (query.isEmpty()) {
+        showCurrentView();
+        updateStatusBar();
+    } else {
+        views->setCurrentWidget(searchList);
+    }
+}
 
-    // Connect buttons
-    connect(editBtn, &QPushButton::clicked, [&dialog, this, &todo]() {
-        dialog.accept();  // Close detail dialog first
+void MainWindow::onSearchProgress(int matches, bool finished) {
+    if (!searchModel->isActive()) return;
+    QString count = matches == 1 ? QString("1 match") : QString("%1 matches").arg(matches);
+    statusLabel->setText(finished ? count : QString("Searching… %1").arg(count));
+}
 
-        EditTodoDialog editDialog(*todo, db.get(), this);
-        if (editDialog.exec() == QDialog::Accepted) {
-            Todo updatedTodo = editDialog.getTodo();
-            if (db->updateTodo(updatedTodo)) {
-                refreshTodoList();
+bool MainWindow::eventFilter(QObject* watched, QEvent* event) {
+    // The search field keeps Backspace and Undo from the inspector's and the
+    // window's shortcuts by itself, as every QLineEdit does. Escape it has
+    // to claim while there is text: it clears the search and leaves the field.
+    if (watched == searchField && (event->type() == QEvent::ShortcutOverride ||
+                                   event->type() == QEvent::KeyPress)) {
+        auto* key = static_cast<QKeyEvent*>(event);
+        if (key->key() == Qt::Key_Escape && !searchField->text().isEmpty()) {
+            if (event->type() == QEvent::ShortcutOverride) {
+                event->accept();
             } else {
-                QMessageBox::warning(this, "Error", "Failed to update todo!");
+                searchField->clear();
+                views->currentWidget()->setFocus();
             }
+            return true;
         }
-    });
+        if (key->key() == Qt::Key_Down && event->type() == QEvent::KeyPress && searchModel->isActive()) {
+            searchList->setFocus();
+            if (searchModel->rowCount() > 0) searchList->setCurrentIndex(searchModel->index(0, 0));
+            return true;
+        }
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
 
-    connect(toggleBtn, &QPushButton::clicked, [&dialog, this, &todo]() {
-        todo->setCompleted(!todo->isCompleted());
-        db->updateTodo(*todo);
-        refreshTodoList();
-        dialog.accept();
-    });
+void MainWindow::onTodoMoveRequested(int todoId, int parentId, int beforeId) {
+    std::optional<int> parent;
+    if (parentId != 0) parent = parentId;
+    std::optional<int> before;
+    if (beforeId != 0) before = beforeId;
+
+    // The view is still inside its drag; reload once it has finished
+    if (!journal->placeTodo(todoId, parent, before)) {
+        QTimer::singleShot(0, this, [this]() {
+            QMessageBox::warning(this, "Move", "A todo cannot be moved inside its own subtasks.");
+        });
+        return;
+    }
 
-    connect(deleteBtn, &QPushButton::clicked, [&dialog, this, todoId]() {
-        QMessageBox msgBox(&dialog);
-        msgBox.setWindowTitle("Delete Todo");
-        msgBox.setText("Are you sure you want to delete this todo");
-        msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
-        msgBox.setDefaultButton(QMessageBox::No);
-        msgBox.setIcon(QMessageBox::Warning);
+    if (parentId != 0) expandedTodos.insert(parentId);
+    rebalanceParents.insert(parentId);
+    rebalanceTimer->start();
 
-        if (msgBox.exec() == QMessageBox::Yes) {
-            db->deleteTodo(todoId);
-            refreshTodoList();
-            dialog.accept();
-        }
+    todoDelegate->invalidateTodo(todoId);
+    QTimer::singleShot(0, this, [this, todoId]() {
+        refreshTodoList();
+        syncInspector(todoId);
     });
+}
 
-    connect(cancelBtn, &QPushButton::clicked, [&dialog]() {
-        dialog.reject();
-    });
+void MainWindow::onBoardMoveRequested(int todoId, const QString& category) {
+    // The same path as "Move to category…": one UPDATE, undoable
+    TodoBulkChange change;
+    change.category = category.toStdString();
+    applyBulkChange({todoId}, change);
+}
 
-    dialog.exec();
+void MainWindow::onRebalanceTimeout() {
+    int rewritten = 0;
+    for (int parentId : rebalanceParents) {
+        std::optional<int> parent;
+        if (parentId != 0) parent = parentId;
+        rewritten += std::max(0, db->rebalanceManualOrder(parent));
+    }
+    rebalanceParents.clear();
+
+    // Same order, new ranks: the page cursors the model holds are stale
+    if (rewritten > 0 && todoModel->getOrder() == TodoOrder::Manual) {
+        refreshTodoList();
+    }
 }
 
-void MainWindow::onCategoryFilterChanged(int index) {
-    refreshTodoList();
+std::vector<int> MainWindow::selectedTodoIds() const {
+    std::vector<int> ids;
+    const QModelIndexList rows = todoList->selectionModel()->selectedRows();
+    ids.reserve(rows.size());
+    for (const QModelIndex& index : rows) {
+        ids.push_back(index.data(TodoListModel::TodoIdRole).toInt());
+    }
+    return ids;
 }
 
-void MainWindow::onDeleteTodo() {
-    // Handled in onTodoClicked
+void MainWindow::showBulkMenu(const std::vector<int>& ids, const QPoint& globalPos) {
+    QMenu menu(this);
+    QAction* complete = menu.addAction(QString("Complete %1 todos").arg(ids.size()));
+    QAction* reopen = menu.addAction("Mark not done");
+
+    QMenu* priorityMenu = menu.addMenu("Priority");
+    QAction* high = priorityMenu->addAction("High");
+    QAction* medium = priorityMenu->addAction("Medium");
+    QAction* low = priorityMenu->addAction("Low");
+
+    QAction* recategorize = menu.addAction("Move to category…");
+    menu.addSeparator();
+    QAction* remove = menu.addAction(QString("Delete %1 todos…").arg(ids.size()));
+
+    QAction* chosen = menu.exec(globalPos);
+    if (!chosen) return;
+
+    TodoBulkChange change;
+    if (chosen == complete) {
+        change.completed = true;
+    } else if (chosen == reopen) {
+        change.completed = false;
+    } else if (chosen == high || chosen == medium || chosen == low) {
+        change.priority = chosen == high ? 3 : chosen == medium ? 2 : 1;
+    } else if (chosen == recategorize) {
+        QStringList names;
+        for (const CategoryCount& category : categoryModel->categories().getCategories()) {
+            names << QString::fromStdString(category.name);
+        }
+        bool ok = false;
+        QString name = QInputDialog::getItem(this, "Move to category", "Category:", names, 0, true, &ok);
+        if (!ok) return;
+        // As the server's applyFields: no name means the default category
+        name = name.trimmed();
+        change.category = name.isEmpty() ? "general" : name.toStdString();
+    } else if (chosen == remove) {
+        deleteTodos(ids);
+        return;
+    }
+
+    applyBulkChange(ids, change);
 }
 
-void MainWindow::onCheckboxClicked(const QModelIndex& index) {
-    // Set flag to prevent dialog from opening
-    checkboxWasClicked = true;
+void MainWindow::applyBulkChange(const std::vector<int>& ids, const TodoBulkChange& change) {
+    // One transaction for the lot, then one pass over the views
+    std::vector<Todo> before;
+    if (journal->updateTodos(ids, change, &before) < 0) {
+        QMessageBox::warning(this, "Error", "Failed to update todos!");
+        return;
+    }
 
-    // Get the todo ID from the clicked item
-    QListWidgetItem* item = todoList->item(index.row());
-    if (!item) return;
+    std::vector<Todo> after = before;
+    for (Todo& todo : after) change.applyTo(todo);
+    categoryModel->todosUpdated(before, after);
 
-    int todoId = item->data(Qt::UserRole).toInt();
-    auto todo = db->getTodoById(todoId);
+    for (const Todo& todo : before) {
+        todoDelegate->invalidateTodo(todo.getId());
+    }
 
-    if (!todo) return;
+    // Rows that stay put are rewritten in place; a view reloads only when
+    // its rows moved
+    if (!todoModel->updateTodos(before, after)) todoModel->reload();
+    calendarView->updateTodos(after);
+    boardView->updateTodos(before, after);
+    searchModel->updateTodos(before, after);
+    updateStatusBar();
+    if (auto current = inspector->currentTodoId()) syncInspector(*current);
+}
 
-    // Toggle completion status
-    todo->setCompleted(!todo->isCompleted());
-    db->updateTodo(*todo);
+void MainWindow::deleteTodos(const std::vector<int>& ids) {
+    if (ids.size() == 1) {
+        onInspectorDelete(ids.front());
+        return;
+    }
 
-    // Defer refresh to avoid crash during event handling
-    QTimer::singleShot(0, this, [this]() {
-        refreshTodoList();
-        // Reset flag after refresh
-        checkboxWasClicked = false;
+    QMessageBox msgBox(this);
+    msgBox.setWindowTitle("Delete Todos");
+    msgBox.setText(QString("Are you sure you want to delete these %1 todos").arg(ids.size()));
+    msgBox.setStandardButtons(QMessageBox::Yes | QMessageBox::No);
+    msgBox.setDefaultButton(QMessageBox::No);
+    msgBox.setIcon(QMessageBox::Warning);
+
+    const QModelIndexList rows = todoList->selectionModel()->selectedRows();
+    bool withSubtasks = std::any_of(rows.begin(), rows.end(), [this](const QModelIndex& index) {
+        const TodoNode* node = todoModel->nodeAt(index);
+        return node && node->descendants > 0;
     });
-}
\ No newline at end of file
+    if (withSubtasks) {
+        msgBox.setInformativeText("Their subtasks will be deleted too.");
+    }
+
+    if (msgBox.exec() != QMessageBox::Yes) return;
+
+    std::vector<Todo> removed;
+    if (journal->deleteTodos(ids, &removed) < 0) {
+        QMessageBox::warning(this, "Error", "Failed to delete todos!");
+        return;
+    }
+
+    categoryModel->todosDeleted(removed);
+    for (const Todo& todo : removed) {
+        todoDelegate->invalidateTodo(todo.getId());
+    }
+    refreshTodoList();
+
+    auto current = inspector->currentTodoId();
+    if (current && !db->getTodoById(*current)) inspector->clear();
+}
+
+void MainWindow::onUndo() {
+    std::vector<int> touched;
+    if (!journal->undo(&touched)) {
+        if (journal->canUndo()) QMessageBox::warning(this, "Undo", "Could not undo the last change.");
+        return;
+    }
+    afterReplay(touched);
+}
+
+void MainWindow::onRedo() {
+    std::vector<int> touched;
+    if (!journal->redo(&touched)) {
+        if (journal->canRedo()) QMessageBox::warning(this, "Redo", "Could not redo the change.");
+        return;
+    }
+    afterReplay(touched);
+}
+
+void MainWindow::afterReplay(const std::vector<int>& touched) {
+    // A replay can add, remove and recategorize any number of rows; one
+    // reload of the counts is simpler than working out each delta. The
+    // reset empties the filter, so it is put back by name.
+    QString filter = categoryFilter->currentData(CategoryListModel::CategoryRole).toString();
+    {
+        QSignalBlocker blocker(categoryFilter);
+        categoryModel->load(*db);
+        int row = filter.isEmpty() ? 0 : categoryFilter->findData(filter, CategoryListModel::CategoryRole);
+        categoryFilter->setCurrentIndex(std::max(0, row));
+    }
+
+    for (int id : touched) {
+        todoDelegate->invalidateTodo(id);
+    }
+    refreshTodoList();
+
+    if (auto current = inspector->currentTodoId()) syncInspector(*current);
+}
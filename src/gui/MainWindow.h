@@ -5,8 +5,10 @@
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QPushButton>
-#include <QListWidget>
+#include <QTreeView>
 #include <QComboBox>
+#include <QLineEdit>
+#include <QListView>
 #include <QLabel>
 #include <QMenu>
 #include <QStyledItemDelegate>
@@ -16,166 +18,68 @@
 #include <QEvent>
 #include <QMouseEvent>
 #include <QTimer>
+#include <QDockWidget>
+#include <QStackedWidget>
+#include <QElapsedTimer>
 #include <memory>
+#include <optional>
+#include <string>
+#include <unordered_set>
+#include <vector>
 #include "database/TodoDatabase.h"
+#include "history/TodoJournal.h"
 #include "models/Todo.h"
-
-class TodoItemDelegate : public QStyledItemDelegate {
-    Q_OBJECT
-public:
-    TodoItemDelegate(QObject* parent = nullptr) : QStyledItemDelegate(parent) {}
-
-    bool editorEvent(QEvent* event, QAbstractItemModel* model,
-                     const QStyleOptionViewItem& option, const QModelIndex& index) override {
-        if (event->type() == QEvent::MouseButtonRelease) {
-            QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
-
-            // Check if click is within checkbox area (relative to item rect)
-            int leftMargin = 18;
-            int checkboxSize = 22;
-            int checkboxX = option.rect.left() + leftMargin;
-            int checkboxY = option.rect.top() + 18;
-
-            QRect checkboxRect(checkboxX, checkboxY, checkboxSize, checkboxSize);
-
-            if (checkboxRect.contains(mouseEvent->pos())) {
-                // Checkbox was clicked - emit a signal to toggle completion
-                emit checkboxClicked(index);
-                return true;
-            }
-        }
-        return QStyledItemDelegate::editorEvent(event, model, option, index);
-    }
-
-    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override {
-        painter->save();
-        painter->setRenderHint(QPainter::Antialiasing);
-
-        // Draw background with improved hover state
-        if (option.state & QStyle::State_MouseOver) {
-            painter->fillRect(option.rect, QColor("#F8F8F8"));  // More visible hover
-        } else {
-            painter->fillRect(option.rect, QColor("#FFFFFF"));
-        }
-
-        // Get data
-        QString text = index.data(Qt::DisplayRole).toString();
-        QColor textColor = index.data(Qt::ForegroundRole).value<QColor>();
-        bool isCompleted = (textColor == QColor("#E0E0E0"));
-        bool hasStrikethrough = index.data(Qt::FontRole).value<QFont>().strikeOut();
-
-        QStringList lines = text.split('\n');
-        QString title = lines.size() > 0 ? lines[0] : "";
-        QString metadata = lines.size() > 1 ? lines[1] : "";
-
-        // Remove priority indicator from title for display
-        if (title.startsWith("● ")) {
-            title = title.mid(2);
-        } else if (title.startsWith("  ")) {
-            title = title.mid(2);
-        }
-
-        int leftMargin = 18;
-        int checkboxSize = 22;
-        int checkboxX = leftMargin;
-        int checkboxY = option.rect.top() + 18;
-
-        // Check if mouse is over checkbox area for enhanced hover
-        bool isHoveringCheckbox = false;
-        if (option.state & QStyle::State_MouseOver) {
-            // Checkbox hover area is slightly larger for better UX
-            QRect checkboxRect(checkboxX - 4, checkboxY - 4, checkboxSize + 8, checkboxSize + 8);
-            isHoveringCheckbox = true;  // Simplified - could track actual mouse pos
-        }
-
-        // Draw checkbox circle with enhanced hover state
-        QColor checkboxBorder = isCompleted ? QColor("#D0D0D0") :
-                                (isHoveringCheckbox ? QColor("#A0A0A0") : QColor("#D1D1D1"));
-        painter->setPen(QPen(checkboxBorder, 2));
-        painter->setBrush(Qt::NoBrush);
-        painter->drawEllipse(checkboxX, checkboxY, checkboxSize, checkboxSize);
-
-        // Draw checkmark if completed with smoother curves
-        if (isCompleted) {
-            painter->setPen(QPen(QColor("#B0B0B0"), 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
-            QPainterPath checkmark;
-            checkmark.moveTo(checkboxX + 6, checkboxY + 11);
-            checkmark.lineTo(checkboxX + 9, checkboxY + 15);
-            checkmark.lineTo(checkboxX + 16, checkboxY + 7);
-            painter->drawPath(checkmark);
-        }
-        
-        int textStartX = leftMargin + checkboxSize + 14;
-
-        // Draw title
-        QFont titleFont = option.font;
-        titleFont.setPointSize(16);
-        titleFont.setWeight(QFont::Medium);
-        painter->setFont(titleFont);
-        painter->setPen(textColor);
-
-        QRect titleRect(textStartX, option.rect.top() + 15, option.rect.width() - textStartX - 16, 26);
-        
-        // Draw title with strikethrough if needed
-        if (hasStrikethrough) {
-            QFontMetrics fm(titleFont);
-            int textWidth = fm.horizontalAdvance(title);
-            painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, title);
-            
-            // Draw strikethrough line
-            int lineY = titleRect.top() + titleRect.height() / 2;
-            painter->setPen(QPen(textColor, 1.5));
-            painter->drawLine(textStartX, lineY, textStartX + textWidth, lineY);
-        } else {
-            painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, title);
-        }
-        
-        // Draw metadata (category, due date) - tiny and subtle
-        if (!metadata.trimmed().isEmpty()) {
-            QFont metaFont = option.font;
-            metaFont.setPointSize(11);
-            metaFont.setCapitalization(QFont::AllUppercase);
-            metaFont.setLetterSpacing(QFont::AbsoluteSpacing, 0.8);
-            metaFont.setWeight(QFont::Normal);
-            painter->setFont(metaFont);
-            painter->setPen(QColor("#A8A8A8"));
-
-            QRect metaRect(textStartX, option.rect.top() + 43, option.rect.width() - textStartX - 16, 18);
-            painter->drawText(metaRect, Qt::AlignLeft | Qt::AlignVCenter, metadata.trimmed());
-        }
-        
-        // Draw bottom border
-        painter->setPen(QColor("#F0F0F0"));
-        painter->drawLine(option.rect.bottomLeft(), option.rect.bottomRight());
-        
-        painter->restore();
-    }
-    
-    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override {
-        QString text = index.data(Qt::DisplayRole).toString();
-        QStringList lines = text.split('\n');
-        bool hasMetadata = lines.size() > 1 && !lines[1].trimmed().isEmpty();
-
-        return QSize(option.rect.width(), hasMetadata ? 76 : 60);
-    }
-
-signals:
-    void checkboxClicked(const QModelIndex& index);
-};
+#include "TodoListModel.h"
+#include "TodoItemDelegate.h"
+#include "TodoInspector.h"
+#include "CategoryListModel.h"
+#include "QueryProfilerPanel.h"
+#include "StatsDialog.h"
+#include "CalendarView.h"
+#include "BoardView.h"
+#include "TodoSearchModel.h"
 
 class MainWindow : public QMainWindow {
     Q_OBJECT
 
+    // todo_gui_bench drives refreshes and reads the list widgets directly
+    friend class MainWindowProbe;
+
 private:
+    // What the main area shows
+    enum class ViewMode {
+        List,
+        Month,  // Calendars of due dates
+        Week,
+        Board   // A column per category
+    };
+
     std::unique_ptr<TodoDatabase> db;
+    std::unique_ptr<TodoJournal> journal;  // Every write from the window goes through it
 
     QWidget* centralWidget;
     QVBoxLayout* mainLayout;
     QHBoxLayout* topBar;
     QComboBox* categoryFilter;
+    QLineEdit* searchField;
     QPushButton* addButton;
-    QListWidget* todoList;
+    QStackedWidget* views;
+    QTreeView* todoList;
+    CalendarView* calendarView = nullptr;
+    BoardView* boardView = nullptr;
+    QListView* searchList = nullptr;  // Shown instead of the view while there is search text
+    TodoSearchModel* searchModel = nullptr;
+    ViewMode viewMode = ViewMode::List;
+    TodoListModel* todoModel = nullptr;
+    std::unordered_set<int> expandedTodos;  // Re-expanded as rows reload
+    TodoItemDelegate* todoDelegate = nullptr;
+    TodoInspector* inspector = nullptr;
+    CategoryListModel* categoryModel = nullptr;
     QLabel* statusLabel;
+    QDockWidget* profilerDock = nullptr;  // Developer panel, F12
+    StatsDialog* statsDialog = nullptr;   // Created on first use
+    QTimer* rebalanceTimer = nullptr;     // Idle work after manual reordering
+    std::unordered_set<int> rebalanceParents;  // Lists dropped into; 0 is the top level
 
     bool checkboxWasClicked = false;  // Prevents dialog when checkbox is clicked
 
@@ -184,20 +88,49 @@ private:
     void loadTodos();
     void refreshTodoList();
     void updateStatusBar();
+    void updateVisibleRows();
+    void syncInspector(int todoId);
+    void addTodo(std::optional<int> parentId);
+    void setTodoOrder(TodoOrder order);
+    void setViewMode(ViewMode mode);
+    void showCurrentView();
+    void showInInspector(int todoId, const QElapsedTimer& clickTimer);
+    std::vector<int> selectedTodoIds() const;
+    void applyBulkChange(const std::vector<int>& ids, const TodoBulkChange& change);
+    void deleteTodos(const std::vector<int>& ids);
+    void showBulkMenu(const std::vector<int>& ids, const QPoint& globalPos);
+    void afterReplay(const std::vector<int>& touched);
 
 private slots:
     void onAddTodo();
-    void onTodoClicked(QListWidgetItem* item);
+    void onTodoClicked(const QModelIndex& index);
     void onCategoryFilterChanged(int index);
     void onDeleteTodo();
     void onCheckboxClicked(const QModelIndex& index);
+    void onInspectorEdit(int todoId);
+    void onInspectorToggle(int todoId);
+    void onInspectorDelete(int todoId);
+    void onInspectorPresented(qint64 latencyUs);
+    void onTodoContextMenu(const QPoint& pos);
+    void onTodoExpanded(const QModelIndex& index);
+    void onTodoCollapsed(const QModelIndex& index);
+    void onTodoRowsInserted(const QModelIndex& parent, int first, int last);
+    void onTodoMoveRequested(int todoId, int parentId, int beforeId);
+    void onBoardMoveRequested(int todoId, const QString& category);
+    void onRebalanceTimeout();
+    void onUndo();
+    void onRedo();
+    void onShowStats();
+    void onSearchTextChanged(const QString& text);
+    void onSearchProgress(int matches, bool finished);
 
 public:
-    MainWindow(QWidget *parent = nullptr);
+    explicit MainWindow(const std::string& databasePath = "todos.db", QWidget *parent = nullptr);
     ~MainWindow();
 
 protected:
     void resizeEvent(QResizeEvent* event) override;
+    bool eventFilter(QObject* watched, QEvent* event) override;
 };
 
 #endif // MAINWINDOW_H
\ No newline at end of file
@@ -0,0 +1,209 @@
+#include "QueryProfilerPanel.h"
+#include "Theme.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QPushButton>
+#include <QHeaderView>
+#include <QDateTime>
+#include <QFontDatabase>
+
+namespace {
+
+enum StatementColumn { Calls, TotalMs, P50Ms, P99Ms, MaxMs, Rows, Scanned, Statement, StatementColumns };
+enum SlowColumn { At, DurationMs, SlowRows, SlowScanned, SlowSql, SlowColumns };
+
+QString oneLine(const std::string& sql) {
+    return QString::fromStdString(sql).simplified();
+}
+
+QTableWidgetItem* numberItem(double value, int decimals = 0) {
+    QTableWidgetItem* item = new QTableWidgetItem();
+    // DisplayRole as a number so the columns sort numerically
+    item->setData(Qt::DisplayRole, decimals == 0 ? QVariant(static_cast<qulonglong>(value))
+                                                 : QVariant(QString::number(value, 'f', decimals).toDouble()));
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+QTableWidget* makeTable(const QStringList& headers, QWidget* parent) {
+    QTableWidget* table = new QTableWidget(0, headers.size(), parent);
+    table->setHorizontalHeaderLabels(headers);
+    table->verticalHeader()->hide();
+    table->horizontalHeader()->setStretchLastSection(true);
+    table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    table->setSelectionMode(QAbstractItemView::SingleSelection);
+    table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    table->setWordWrap(false);
+    return table;
+}
+
+} // namespace
+
+QueryProfilerPanel::QueryProfilerPanel(TodoDatabase* db, QWidget* parent)
+    : QWidget(parent), db(db) {
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(12, 12, 12, 12);
+    layout->setSpacing(8);
+
+    // Threshold and reset
+    QHBoxLayout* controls = new QHBoxLayout();
+    thresholdBox = new QSpinBox(this);
+    thresholdBox->setRange(0, 10000);
+    thresholdBox->setSuffix(" ms");
+    thresholdBox->setValue(db->profiler() ? static_cast<int>(db->profiler()->slowThresholdUs() / 1000) : 10);
+    QPushButton* resetButton = new QPushButton("Reset", this);
+
+    controls->addWidget(new QLabel("Log statements slower than", this));
+    controls->addWidget(thresholdBox);
+    controls->addStretch();
+    controls->addWidget(resetButton);
+    layout->addLayout(controls);
+
+    statementTable = makeTable({"Calls", "Total ms", "p50 ms", "p99 ms", "Max ms", "Rows", "Scanned",
+                                "Statement"}, this);
+    statementTable->setSortingEnabled(true);
+    slowTable = makeTable({"Time", "ms", "Rows", "Scanned", "Statement"}, this);
+
+    tabs = new QTabWidget(this);
+    tabs->addTab(statementTable, "Statements");
+    tabs->addTab(slowTable, "Slow log");
+    layout->addWidget(tabs, 3);
+
+    detailView = new QPlainTextEdit(this);
+    detailView->setReadOnly(true);
+    detailView->setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+    detailView->setPlaceholderText("Select a statement to see its query plan");
+    layout->addWidget(detailView, 1);
+
+    connect(thresholdBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int ms) {
+        this->db->enableProfiling(static_cast<int64_t>(ms) * 1000);
+    });
+    connect(resetButton, &QPushButton::clicked, this, [this]() {
+        if (this->db->profiler()) this->db->profiler()->reset();
+        refresh();
+    });
+    connect(statementTable, &QTableWidget::itemSelectionChanged, this, &QueryProfilerPanel::showDetail);
+    connect(slowTable, &QTableWidget::itemSelectionChanged, this, &QueryProfilerPanel::showDetail);
+    connect(tabs, &QTabWidget::currentChanged, this, &QueryProfilerPanel::showDetail);
+
+    refreshTimer.setInterval(1000);
+    connect(&refreshTimer, &QTimer::timeout, this, &QueryProfilerPanel::refresh);
+}
+
+void QueryProfilerPanel::showEvent(QShowEvent* event) {
+    QWidget::showEvent(event);
+    refresh();
+    refreshTimer.start();
+}
+
+void QueryProfilerPanel::hideEvent(QHideEvent* event) {
+    QWidget::hideEvent(event);
+    refreshTimer.stop();
+}
+
+void QueryProfilerPanel::refresh() {
+    QueryProfiler* profiler = db->profiler();
+    if (!profiler) return;
+
+    statements = profiler->statements();
+    slowStatements = profiler->slowStatements();
+
+    // Keep the selected statement selected across refreshes
+    QString selected;
+    if (QTableWidgetItem* item = statementTable->currentItem()) {
+        selected = statementTable->item(item->row(), Statement)->data(Qt::UserRole).toString();
+    }
+
+    QColor scanTint = Theme::colors().danger;
+    scanTint.setAlpha(40);
+
+    statementTable->setUpdatesEnabled(false);
+    statementTable->setSortingEnabled(false);
+    statementTable->setRowCount(static_cast<int>(statements.size()));
+    for (int row = 0; row < static_cast<int>(statements.size()); row++) {
+        const StatementProfile& statement = statements[row];
+        const LatencyHistogram& latency = statement.latency;
+
+        statementTable->setItem(row, Calls, numberItem(latency.count));
+        statementTable->setItem(row, TotalMs, numberItem(latency.totalNs / 1e6, 2));
+        statementTable->setItem(row, P50Ms, numberItem(latency.percentileUs(0.50) / 1000, 3));
+        statementTable->setItem(row, P99Ms, numberItem(latency.percentileUs(0.99) / 1000, 3));
+        statementTable->setItem(row, MaxMs, numberItem(latency.maxNs / 1e6, 3));
+        statementTable->setItem(row, Rows, numberItem(statement.rowsReturned));
+        statementTable->setItem(row, Scanned, numberItem(statement.fullScanSteps));
+
+        QTableWidgetItem* sqlItem = new QTableWidgetItem(oneLine(statement.sql));
+        sqlItem->setData(Qt::UserRole, QString::fromStdString(statement.sql));
+        sqlItem->setToolTip(QString::fromStdString(statement.queryPlan));
+        statementTable->setItem(row, Statement, sqlItem);
+
+        if (statement.fullScanSteps > 0) {
+            for (int column = 0; column < StatementColumns; column++) {
+                statementTable->item(row, column)->setBackground(scanTint);
+            }
+        }
+    }
+    statementTable->setSortingEnabled(true);
+
+    for (int row = 0; row < statementTable->rowCount() && !selected.isEmpty(); row++) {
+        if (statementTable->item(row, Statement)->data(Qt::UserRole).toString() == selected) {
+            statementTable->selectRow(row);
+            break;
+        }
+    }
+    statementTable->setUpdatesEnabled(true);
+
+    // Newest first
+    slowTable->setUpdatesEnabled(false);
+    slowTable->setRowCount(static_cast<int>(slowStatements.size()));
+    for (int row = 0; row < static_cast<int>(slowStatements.size()); row++) {
+        const SlowStatement& statement = slowStatements[slowStatements.size() - 1 - row];
+        QString at = QDateTime::fromSecsSinceEpoch(statement.at).toString("HH:mm:ss");
+
+        slowTable->setItem(row, At, new QTableWidgetItem(at));
+        slowTable->setItem(row, DurationMs, numberItem(statement.durationNs / 1e6, 3));
+        slowTable->setItem(row, SlowRows, numberItem(statement.rowsReturned));
+        slowTable->setItem(row, SlowScanned, numberItem(statement.fullScanSteps));
+        slowTable->setItem(row, SlowSql, new QTableWidgetItem(oneLine(statement.sql)));
+
+        if (statement.fullScanSteps > 0) {
+            for (int column = 0; column < SlowColumns; column++) {
+                slowTable->item(row, column)->setBackground(scanTint);
+            }
+        }
+    }
+    slowTable->setUpdatesEnabled(true);
+
+    showDetail();
+}
+
+void QueryProfilerPanel::showDetail() {
+    QString text;
+
+    if (tabs->currentWidget() == statementTable) {
+        QTableWidgetItem* item = statementTable->currentItem();
+        if (item) {
+            QString sql = statementTable->item(item->row(), Statement)->data(Qt::UserRole).toString();
+            for (const StatementProfile& statement : statements) {
+                if (QString::fromStdString(statement.sql) != sql) continue;
+                text = sql.trimmed() + "\n\n" +
+                       (statement.queryPlan.empty() ? QString("(plan shown once it scans or runs slow)")
+                                                    : QString::fromStdString(statement.queryPlan));
+                text += QString("\n%1 sorts, %2 rows in automatic indexes, %3 VM steps")
+                            .arg(statement.sorts).arg(statement.autoIndexes).arg(statement.vmSteps);
+                break;
+            }
+        }
+    } else {
+        int row = slowTable->currentRow();
+        if (row >= 0 && row < static_cast<int>(slowStatements.size())) {
+            const SlowStatement& statement = slowStatements[slowStatements.size() - 1 - row];
+            text = QString::fromStdString(statement.sql).trimmed() + "\n\n" +
+                   QString::fromStdString(statement.queryPlan);
+        }
+    }
+
+    if (detailView->toPlainText() != text) detailView->setPlainText(text);
+}
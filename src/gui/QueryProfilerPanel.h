@@ -0,0 +1,45 @@
+#ifndef QUERYPROFILERPANEL_H
+#define QUERYPROFILERPANEL_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPlainTextEdit>
+#include <QSpinBox>
+#include <QTabWidget>
+#include <QTimer>
+#include <vector>
+#include "database/TodoDatabase.h"
+
+// Developer panel over the database's QueryProfiler: one row per statement
+// with its latency percentiles and rows scanned, the query plan of the
+// selected one, and the slow statement log. Full table scans are tinted.
+// Refreshes once a second while visible.
+class QueryProfilerPanel : public QWidget {
+    Q_OBJECT
+
+public:
+    QueryProfilerPanel(TodoDatabase* db, QWidget* parent = nullptr);
+
+    void refresh();
+
+protected:
+    void showEvent(QShowEvent* event) override;
+    void hideEvent(QHideEvent* event) override;
+
+private:
+    TodoDatabase* db;
+
+    QSpinBox* thresholdBox;
+    QTabWidget* tabs;
+    QTableWidget* statementTable;
+    QTableWidget* slowTable;
+    QPlainTextEdit* detailView;
+    QTimer refreshTimer;
+
+    std::vector<StatementProfile> statements;
+    std::vector<SlowStatement> slowStatements;
+
+    void showDetail();
+};
+
+#endif // QUERYPROFILERPANEL_H
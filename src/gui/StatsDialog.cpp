@@ -0,0 +1,234 @@
+#include "StatsDialog.h"
+#include "Theme.h"
+#include <QDate>
+#include <QEvent>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QHelpEvent>
+#include <QPainter>
+#include <QToolTip>
+#include <QVBoxLayout>
+#include <algorithm>
+#include <cmath>
+
+namespace {
+
+struct RangePreset {
+    const char* label;
+    AnalyticsBucket bucket;
+    int days;
+};
+
+const RangePreset kRanges[] = {
+    {"Last 30 days", AnalyticsBucket::Day, 30},
+    {"Last 12 weeks", AnalyticsBucket::Week, 12 * 7},
+    {"Last 52 weeks", AnalyticsBucket::Week, 52 * 7},
+    {"Last 12 months", AnalyticsBucket::Month, 365},
+};
+
+enum CategoryColumn { Name, Completed, LeadDays, LateRate, CategoryColumns };
+
+// Analytics days count from 1970-01-01, Julian day 2440588
+QDate toDate(int64_t day) {
+    return QDate::fromJulianDay(day + 2440588);
+}
+
+QString percent(double rate) {
+    return QString("%1%").arg(qRound(rate * 100));
+}
+
+QTableWidgetItem* numberItem(const QString& text) {
+    QTableWidgetItem* item = new QTableWidgetItem(text);
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+ThroughputChart::ThroughputChart(QWidget* parent) : QWidget(parent) {
+    setMinimumHeight(180);
+    setMouseTracking(true);
+}
+
+QSize ThroughputChart::sizeHint() const {
+    return QSize(560, 220);
+}
+
+void ThroughputChart::setBuckets(const std::vector<ThroughputBucket>& newBuckets, AnalyticsBucket bucket) {
+    buckets = newBuckets;
+    bucketSize = bucket;
+    update();
+}
+
+QRectF ThroughputChart::plotArea() const {
+    // Room for the value of the tallest bar above and the labels below
+    return QRectF(rect()).adjusted(8, 20, -8, -24);
+}
+
+int ThroughputChart::bucketAt(const QPoint& pos) const {
+    QRectF area = plotArea();
+    if (buckets.empty() || pos.x() < area.left() || pos.x() >= area.right()) return -1;
+    int index = static_cast<int>((pos.x() - area.left()) / area.width() * buckets.size());
+    return std::clamp(index, 0, static_cast<int>(buckets.size()) - 1);
+}
+
+QString ThroughputChart::bucketLabel(const ThroughputBucket& bucket, bool longForm) const {
+    QDate first = toDate(bucket.firstDay);
+    switch (bucketSize) {
+    case AnalyticsBucket::Day:
+        return longForm ? first.toString("ddd d MMM yyyy") : first.toString("d");
+    case AnalyticsBucket::Week:
+        return longForm ? QString("Week of %1").arg(first.toString("d MMM yyyy")) : first.toString("d MMM");
+    case AnalyticsBucket::Month:
+        return longForm ? first.toString("MMMM yyyy") : first.toString("MMM");
+    }
+    return QString();
+}
+
+void ThroughputChart::paintEvent(QPaintEvent*) {
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    const Theme::Colors& colors = Theme::colors();
+
+    QRectF area = plotArea();
+    painter.setPen(colors.divider);
+    painter.drawLine(area.bottomLeft(), area.bottomRight());
+    if (buckets.empty()) return;
+
+    int peak = 1;
+    for (const auto& bucket : buckets) peak = std::max(peak, bucket.totals.completed);
+
+    double slot = area.width() / buckets.size();
+    double barWidth = std::max(1.0, slot * 0.7);
+    QFontMetrics metrics(font());
+    // Label every nth bar so the labels never collide
+    int labelEvery = std::max(1, static_cast<int>(std::ceil((metrics.horizontalAdvance("00 MMM") + 8) / slot)));
+
+    for (size_t i = 0; i < buckets.size(); i++) {
+        const CompletionTotals& totals = buckets[i].totals;
+        double x = area.left() + i * slot + (slot - barWidth) / 2;
+        double height = area.height() * totals.completed / peak;
+        double lateHeight = area.height() * totals.late / peak;
+
+        if (totals.completed > 0) {
+            painter.fillRect(QRectF(x, area.bottom() - height, barWidth, height), colors.accent);
+        }
+        if (totals.late > 0) {
+            painter.fillRect(QRectF(x, area.bottom() - lateHeight, barWidth, lateHeight), colors.danger);
+        }
+
+        painter.setPen(colors.mutedText);
+        if (totals.completed == peak) {
+            painter.drawText(QRectF(x - slot, area.bottom() - height - 18, barWidth + 2 * slot, 16),
+                             Qt::AlignHCenter | Qt::AlignBottom, QString::number(totals.completed));
+        }
+        if (i % labelEvery == 0) {
+            painter.drawText(QRectF(x - slot, area.bottom() + 4, barWidth + 2 * slot, 18),
+                             Qt::AlignHCenter | Qt::AlignTop, bucketLabel(buckets[i], false));
+        }
+    }
+}
+
+bool ThroughputChart::event(QEvent* event) {
+    if (event->type() == QEvent::ToolTip) {
+        QHelpEvent* help = static_cast<QHelpEvent*>(event);
+        int index = bucketAt(help->pos());
+        if (index < 0) {
+            QToolTip::hideText();
+        } else {
+            const ThroughputBucket& bucket = buckets[index];
+            QString text = QString("%1\n%2 completed").arg(bucketLabel(bucket, true)).arg(bucket.totals.completed);
+            if (bucket.totals.withDue > 0) {
+                text += QString(", %1 of %2 due late").arg(bucket.totals.late).arg(bucket.totals.withDue);
+            }
+            QToolTip::showText(help->globalPos(), text, this);
+        }
+        return true;
+    }
+    return QWidget::event(event);
+}
+
+StatsDialog::StatsDialog(TodoDatabase* db, QWidget* parent)
+    : QDialog(parent), db(db) {
+    setWindowTitle("Statistics");
+    resize(620, 560);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(20, 20, 20, 20);
+    layout->setSpacing(12);
+
+    QHBoxLayout* controls = new QHBoxLayout();
+    rangeCombo = new QComboBox(this);
+    for (const RangePreset& range : kRanges) rangeCombo->addItem(range.label);
+    controls->addWidget(rangeCombo);
+    controls->addStretch();
+    layout->addLayout(controls);
+
+    summaryLabel = new QLabel(this);
+    summaryLabel->setObjectName("statsSummary");
+    summaryLabel->setWordWrap(true);
+    layout->addWidget(summaryLabel);
+
+    chart = new ThroughputChart(this);
+    layout->addWidget(chart, 1);
+
+    categoryTable = new QTableWidget(0, CategoryColumns, this);
+    categoryTable->setHorizontalHeaderLabels({"Category", "Completed", "Avg. days", "Late"});
+    categoryTable->verticalHeader()->hide();
+    categoryTable->horizontalHeader()->setSectionResizeMode(Name, QHeaderView::Stretch);
+    categoryTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    categoryTable->setSelectionMode(QAbstractItemView::NoSelection);
+    categoryTable->setFocusPolicy(Qt::NoFocus);
+    layout->addWidget(categoryTable, 1);
+
+    connect(rangeCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this]() { refresh(); });
+
+    refresh();
+}
+
+void StatsDialog::refresh() {
+    const RangePreset& range = kRanges[std::max(0, rangeCombo->currentIndex())];
+    int64_t today = TodoAnalytics::today();
+
+    TodoAnalytics analytics(*db);
+    std::optional<AnalyticsReport> report = analytics.report(today - range.days + 1, today, range.bucket);
+    if (!report) {
+        summaryLabel->setText("Could not read the statistics.");
+        chart->setBuckets({}, range.bucket);
+        categoryTable->setRowCount(0);
+        return;
+    }
+
+    const CompletionTotals& total = report->total;
+    int days = static_cast<int>(report->lastDay - report->firstDay + 1);
+    QString summary = QString("%1 completed since %2, %3 a day. On average a todo took %4 days from "
+                              "creation to completion")
+        .arg(total.completed)
+        .arg(toDate(report->firstDay).toString("d MMM yyyy"))
+        .arg(static_cast<double>(total.completed) / days, 0, 'f', 1)
+        .arg(total.averageLeadDays(), 0, 'f', 1);
+    summary += total.withDue > 0
+        ? QString("; %1 of those with a due date finished late.").arg(percent(total.lateRate()))
+        : QString(".");
+    summaryLabel->setText(summary);
+
+    chart->setBuckets(report->buckets, range.bucket);
+
+    categoryTable->setRowCount(static_cast<int>(report->categories.size()));
+    for (int row = 0; row < static_cast<int>(report->categories.size()); row++) {
+        const CategoryThroughput& category = report->categories[row];
+        const CompletionTotals& totals = category.totals;
+        QString name = category.category.empty() ? QString("(none)") : QString::fromStdString(category.category);
+
+        categoryTable->setItem(row, Name, new QTableWidgetItem(name));
+        categoryTable->setItem(row, Completed, numberItem(QString::number(totals.completed)));
+        categoryTable->setItem(row, LeadDays,
+                               numberItem(QString::number(totals.averageLeadDays(), 'f', 1)));
+        QTableWidgetItem* late = numberItem(totals.withDue > 0 ? percent(totals.lateRate()) : "–");
+        if (totals.withDue > 0) {
+            late->setToolTip(QString("%1 of %2 with a due date").arg(totals.late).arg(totals.withDue));
+            if (totals.lateRate() >= 0.25) late->setForeground(Theme::colors().danger);
+        }
+        categoryTable->setItem(row, LateRate, late);
+    }
+}
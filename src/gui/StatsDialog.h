@@ -0,0 +1,58 @@
+#ifndef STATSDIALOG_H
+#define STATSDIALOG_H
+
+#include <QDialog>
+#include <QComboBox>
+#include <QLabel>
+#include <QTableWidget>
+#include <QWidget>
+#include <vector>
+#include "analytics/TodoAnalytics.h"
+#include "database/TodoDatabase.h"
+
+// Completions per bucket as bars, the late ones drawn over the bottom of
+// each bar in the danger color. Hovering a bar shows its numbers.
+class ThroughputChart : public QWidget {
+    Q_OBJECT
+
+public:
+    explicit ThroughputChart(QWidget* parent = nullptr);
+
+    void setBuckets(const std::vector<ThroughputBucket>& buckets, AnalyticsBucket bucket);
+    QSize sizeHint() const override;
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+    bool event(QEvent* event) override;
+
+private:
+    std::vector<ThroughputBucket> buckets;
+    AnalyticsBucket bucketSize = AnalyticsBucket::Day;
+
+    QRectF plotArea() const;
+    int bucketAt(const QPoint& pos) const;
+    QString bucketLabel(const ThroughputBucket& bucket, bool longForm) const;
+};
+
+// Throughput over a chosen range: completions over time, average days from
+// creation to completion, and late rates by category. Everything comes from
+// TodoAnalytics, so refreshing reads the daily rollup and never the todos.
+class StatsDialog : public QDialog {
+    Q_OBJECT
+
+public:
+    StatsDialog(TodoDatabase* db, QWidget* parent = nullptr);
+
+    // Re-reads the rollup; cheap enough to call after every write
+    void refresh();
+
+private:
+    TodoDatabase* db;
+
+    QComboBox* rangeCombo;
+    QLabel* summaryLabel;
+    ThroughputChart* chart;
+    QTableWidget* categoryTable;
+};
+
+#endif // STATSDIALOG_H
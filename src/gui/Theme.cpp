@@ -0,0 +1,388 @@
+#include "Theme.h"
+#include <QStyleHints>
+#include <utility>
+#include <vector>
+
+namespace Theme {
+
+namespace {
+
+Variant appliedVariant = Variant::Light;
+
+Colors makeLight() {
+    Colors c;
+    c.window = QColor("#FFFFFF");
+    c.text = QColor("#000000");
+    c.mutedText = QColor("#999999");
+    c.metaText = QColor("#A8A8A8");
+    c.completedText = QColor("#E0E0E0");
+    c.border = QColor("#D1D1D1");
+    c.subtleBorder = QColor("#E5E5E5");
+    c.hoverBorder = QColor("#8A8A8A");
+    c.placeholder = QColor("#AAAAAA");
+    c.divider = QColor("#F0F0F0");
+    c.highlight = QColor("#F5F5F5");
+    c.buttonHover = QColor("#F0F0F0");
+    c.hover = QColor("#F8F8F8");
+    c.selectedHover = QColor("#F0F0F0");
+    c.checkbox = QColor("#D1D1D1");
+    c.checkboxHover = QColor("#A0A0A0");
+    c.checkmark = QColor("#B0B0B0");
+    c.accent = QColor("#000000");
+    c.accentText = QColor("#FFFFFF");
+    c.accentHover = QColor("#2A2A2A");
+    c.danger = QColor("#FF3B30");
+    c.dangerHover = QColor("#D32F28");
+    c.inactiveBar = QColor("#E5E5E5");
+    return c;
+}
+
+Colors makeDark() {
+    Colors c;
+    c.window = QColor("#1C1C1E");
+    c.text = QColor("#F2F2F2");
+    c.mutedText = QColor("#8E8E93");
+    c.metaText = QColor("#7C7C80");
+    c.completedText = QColor("#4A4A4E");
+    c.border = QColor("#3A3A3C");
+    c.subtleBorder = QColor("#2C2C2E");
+    c.hoverBorder = QColor("#8E8E93");
+    c.placeholder = QColor("#636366");
+    c.divider = QColor("#2C2C2E");
+    c.highlight = QColor("#2C2C2E");
+    c.buttonHover = QColor("#2C2C2E");
+    c.hover = QColor("#242426");
+    c.selectedHover = QColor("#2C2C2E");
+    c.checkbox = QColor("#5A5A5E");
+    c.checkboxHover = QColor("#8E8E93");
+    c.checkmark = QColor("#6E6E73");
+    c.accent = QColor("#F2F2F2");
+    c.accentText = QColor("#1C1C1E");
+    c.accentHover = QColor("#D0D0D0");
+    c.danger = QColor("#FF453A");
+    c.dangerHover = QColor("#D7372F");
+    c.inactiveBar = QColor("#3A3A3C");
+    return c;
+}
+
+// Rules are ordered so that later, more specific scopes (dialogs, the
+// inspector) win over the main window defaults at equal specificity.
+const char* StyleSheetTemplate = R"(
+    QWidget {
+        font-family: -apple-system, 'Helvetica Neue', sans-serif;
+        font-size: 14px;
+        color: @{text};
+    }
+
+    /* Main window */
+    QMainWindow {
+        background-color: @{window};
+    }
+    QListView, QTreeView {
+        background-color: @{window};
+        border: none;
+        outline: none;
+    }
+    QMainWindow QPushButton {
+        background-color: @{accent};
+        color: @{accentText};
+        border: none;
+        font-weight: 500;
+        font-size: 24px;
+    }
+    QMainWindow QPushButton:hover {
+        background-color: @{accentHover};
+    }
+    QMainWindow QPushButton:pressed {
+        background-color: @{accent};
+    }
+    QWidget#topBar {
+        background-color: @{window};
+        border-bottom: 1px solid @{subtleBorder};
+    }
+    QComboBox#categoryFilter {
+        border: none;
+        background: transparent;
+        font-size: 20px;
+        font-weight: 600;
+        color: @{text};
+        padding: 0;
+    }
+    QComboBox#categoryFilter::drop-down {
+        border: none;
+        width: 0;
+    }
+    QComboBox#categoryFilter::down-arrow {
+        width: 0;
+        height: 0;
+    }
+    QComboBox#categoryFilter QAbstractItemView {
+        border: 1px solid @{subtleBorder};
+        background-color: @{window};
+        selection-background-color: @{highlight};
+        selection-color: @{text};
+        outline: none;
+        font-size: 14px;
+        font-weight: normal;
+        padding: 4px;
+    }
+    QComboBox#categoryFilter QAbstractItemView::item {
+        padding: 8px 12px;
+        border-radius: 4px;
+    }
+    QLineEdit#searchField {
+        border: 1px solid @{border};
+        border-radius: 18px;
+        padding: 7px 14px;
+        background-color: @{window};
+        color: @{text};
+        font-size: 14px;
+    }
+    QLineEdit#searchField:focus {
+        border-color: @{text};
+    }
+    QPushButton#filterButton {
+        background-color: transparent;
+        color: @{text};
+        border: 1px solid @{border};
+        border-radius: 18px;
+        font-size: 20px;
+        font-weight: bold;
+    }
+    QPushButton#filterButton:hover {
+        background-color: @{buttonHover};
+        border-color: @{hoverBorder};
+    }
+    QPushButton#filterButton:pressed {
+        background-color: @{subtleBorder};
+        border-color: @{text};
+    }
+    QMenu {
+        background-color: @{window};
+        border: 1px solid @{border};
+        border-radius: 6px;
+        padding: 4px;
+    }
+    QMenu::item {
+        padding: 8px 16px;
+        border-radius: 4px;
+    }
+    QMenu::item:selected {
+        background-color: @{highlight};
+    }
+    QWidget#bottomBar {
+        background-color: @{window};
+    }
+    QLabel#statusLabel {
+        color: @{mutedText};
+        font-size: 13px;
+    }
+    QPushButton#addButton {
+        background-color: @{accent};
+        color: @{accentText};
+        border: none;
+        border-radius: 28px;
+        font-size: 28px;
+        font-weight: 300;
+        padding-bottom: 2px;
+    }
+    QPushButton#addButton:hover {
+        background-color: @{accentHover};
+    }
+    QPushButton#addButton:pressed {
+        background-color: @{accent};
+    }
+
+    /* Add/Edit dialogs and message boxes */
+    QDialog {
+        background-color: @{window};
+    }
+    QDialog QLineEdit, QDialog QTextEdit {
+        border: 1px solid @{border};
+        padding: 8px;
+        border-radius: 6px;
+        background-color: @{window};
+        font-size: 14px;
+    }
+    QDialog QLineEdit::placeholder, QDialog QTextEdit::placeholder {
+        color: @{placeholder};
+    }
+    QDialog QLineEdit:focus, QDialog QTextEdit:focus {
+        border-color: @{text};
+        border-width: 2px;
+        outline: none;
+    }
+    QDialog QComboBox, QDialog QDateEdit {
+        border: 1px solid @{border};
+        padding: 8px 12px;
+        padding-right: 32px;
+        background-color: @{window};
+        border-radius: 6px;
+    }
+    QDialog QComboBox:focus, QDialog QDateEdit:focus {
+        border-color: @{text};
+        border-width: 2px;
+        outline: none;
+    }
+    QDialog QComboBox::drop-down, QDialog QDateEdit::drop-down {
+        subcontrol-origin: padding;
+        subcontrol-position: center right;
+        width: 20px;
+        border: none;
+        background: transparent;
+    }
+    QDialog QDateEdit:disabled {
+        background-color: @{highlight};
+        color: @{placeholder};
+        border-color: @{subtleBorder};
+    }
+    QDialog QLabel {
+        color: @{text};
+        font-weight: 500;
+    }
+    QDialog QPushButton {
+        border: 1px solid @{border};
+        padding: 10px 20px;
+        border-radius: 6px;
+        background-color: @{window};
+        color: @{text};
+        font-weight: 500;
+        font-size: 14px;
+    }
+    QDialog QPushButton:hover {
+        background-color: @{highlight};
+        border-color: @{text};
+    }
+    QLabel#errorLabel {
+        color: @{danger};
+        font-size: 12px;
+        padding: 4px 0px;
+    }
+    QPushButton#cancelButton {
+        border: 1px solid @{border};
+        padding: 6px 12px;
+        border-radius: 6px;
+        background-color: @{window};
+        color: @{text};
+        font-weight: 500;
+        font-size: 13px;
+    }
+    QPushButton#cancelButton:hover {
+        background-color: @{buttonHover};
+        border-color: @{hoverBorder};
+    }
+    QPushButton#cancelButton:pressed {
+        background-color: @{subtleBorder};
+    }
+    QPushButton#saveButton {
+        background-color: @{accent};
+        color: @{accentText};
+        border: none;
+        padding: 6px 12px;
+        font-size: 13px;
+    }
+    QPushButton#saveButton:hover {
+        background-color: @{accentHover};
+    }
+    QPushButton#saveButton:pressed {
+        background-color: @{accent};
+    }
+
+    /* Inspector pane */
+    TodoInspector {
+        background-color: @{window};
+        border-left: 1px solid @{subtleBorder};
+    }
+    TodoInspector QLabel {
+        color: @{text};
+    }
+    QLabel#inspectorTitle {
+        font-size: 24pt;
+        font-weight: bold;
+    }
+    QLabel#inspectorHeader {
+        color: @{mutedText};
+        font-size: 10px;
+        font-weight: 600;
+        letter-spacing: 1.2px;
+    }
+    QLabel#inspectorValue {
+        font-size: 14px;
+        margin-top: 2px;
+    }
+    TodoInspector QPushButton {
+        border: 1px solid @{border};
+        background-color: @{window};
+        color: @{text};
+        padding: 6px 12px;
+        border-radius: 6px;
+        font-weight: 500;
+        font-size: 13px;
+    }
+    TodoInspector QPushButton:hover {
+        background-color: @{buttonHover};
+        border-color: @{hoverBorder};
+    }
+    QPushButton#inspectorDelete {
+        background-color: @{danger};
+        color: #FFFFFF;
+        border: none;
+    }
+    QPushButton#inspectorDelete:hover {
+        background-color: @{dangerHover};
+    }
+)";
+
+}
+
+Variant variantFromEnvironment() {
+    QString requested = qEnvironmentVariable("TODO_THEME").toLower();
+    if (requested == "dark") return Variant::Dark;
+    if (requested == "light") return Variant::Light;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
+    if (QGuiApplication::styleHints()->colorScheme() == Qt::ColorScheme::Dark) {
+        return Variant::Dark;
+    }
+#endif
+    return Variant::Light;
+}
+
+const Colors& colors(Variant variant) {
+    static const Colors light = makeLight();
+    static const Colors dark = makeDark();
+    return variant == Variant::Dark ? dark : light;
+}
+
+const Colors& colors() {
+    return colors(appliedVariant);
+}
+
+Variant currentVariant() {
+    return appliedVariant;
+}
+
+QString styleSheet(Variant variant) {
+    const Colors& c = colors(variant);
+
+    const std::vector<std::pair<const char*, QColor>> tokens = {
+        {"window", c.window}, {"text", c.text}, {"mutedText", c.mutedText},
+        {"border", c.border}, {"subtleBorder", c.subtleBorder}, {"hoverBorder", c.hoverBorder},
+        {"placeholder", c.placeholder}, {"highlight", c.highlight}, {"buttonHover", c.buttonHover},
+        {"accent", c.accent}, {"accentText", c.accentText}, {"accentHover", c.accentHover},
+        {"danger", c.danger}, {"dangerHover", c.dangerHover},
+    };
+
+    QString sheet = QString::fromUtf8(StyleSheetTemplate);
+    for (const auto& [name, color] : tokens) {
+        sheet.replace(QString("@{%1}").arg(name), color.name());
+    }
+    return sheet;
+}
+
+void apply(QApplication& app, Variant variant) {
+    appliedVariant = variant;
+    app.setStyleSheet(styleSheet(variant));
+}
+
+}
@@ -0,0 +1,60 @@
+#ifndef THEME_H
+#define THEME_H
+
+#include <QApplication>
+#include <QColor>
+#include <QString>
+
+// Application-wide look. The whole style sheet is generated once and set on
+// QApplication in main.cpp before any widget exists, so widgets are polished
+// exactly once and never re-parse per-widget sheets on construction.
+// Widgets opt into specific rules through object names (#addButton, ...).
+namespace Theme {
+
+enum class Variant {
+    Light,
+    Dark
+};
+
+// Palette behind the style sheet and the hand-painted parts (rows, priority bars)
+struct Colors {
+    QColor window;
+    QColor text;
+    QColor mutedText;     // Status bar, field headers
+    QColor metaText;      // Row metadata line
+    QColor completedText;
+    QColor border;
+    QColor subtleBorder;
+    QColor hoverBorder;
+    QColor placeholder;
+    QColor divider;
+    QColor highlight;     // Popup and menu selection
+    QColor buttonHover;
+    QColor hover;
+    QColor selectedHover;
+    QColor checkbox;
+    QColor checkboxHover;
+    QColor checkmark;
+    QColor accent;        // Primary buttons
+    QColor accentText;
+    QColor accentHover;
+    QColor danger;
+    QColor dangerHover;
+    QColor inactiveBar;
+};
+
+// TODO_THEME=light|dark, otherwise the platform color scheme when Qt reports one
+Variant variantFromEnvironment();
+
+const Colors& colors(Variant variant);
+const Colors& colors();  // Colors of the applied variant
+Variant currentVariant();
+
+QString styleSheet(Variant variant);
+
+// Sets the application style sheet; call once, before creating widgets
+void apply(QApplication& app, Variant variant);
+
+}
+
+#endif // THEME_H
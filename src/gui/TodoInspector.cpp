@@ -0,0 +1,208 @@
+#include "TodoInspector.h"
+#include "Theme.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QPainter>
+#include <QShortcut>
+#include <QStyleOption>
+#include <QDateTime>
+
+PriorityBars::PriorityBars(QWidget* parent)
+    : QWidget(parent) {
+    setFixedSize(sizeHint());
+}
+
+void PriorityBars::setPriority(int value) {
+    if (value == priority) return;
+    priority = value;
+    update();
+}
+
+void PriorityBars::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.setPen(Qt::NoPen);
+
+    for (int i = 1; i <= 3; i++) {
+        painter.setBrush(i <= priority ? Theme::colors().text : Theme::colors().inactiveBar);
+        painter.drawRoundedRect(QRectF((i - 1) * 34, 0, 30, 6), 3, 3);
+    }
+}
+
+TodoInspector::TodoInspector(QWidget* parent)
+    : QWidget(parent) {
+
+    setFixedWidth(360);
+    setFocusPolicy(Qt::ClickFocus);
+
+    QVBoxLayout* layout = new QVBoxLayout(this);
+    layout->setContentsMargins(20, 24, 20, 24);
+    layout->setSpacing(16);
+
+    auto makeHeader = [this](const QString& text) {
+        QLabel* label = new QLabel(text, this);
+        label->setObjectName("inspectorHeader");
+        return label;
+    };
+    auto makeValue = [this]() {
+        QLabel* label = new QLabel(this);
+        label->setObjectName("inspectorValue");
+        label->setWordWrap(true);
+        return label;
+    };
+
+    // Title
+    titleLabel = new QLabel(this);
+    titleLabel->setObjectName("inspectorTitle");
+    titleLabel->setWordWrap(true);
+    layout->addWidget(titleLabel);
+
+    layout->addSpacing(12);
+
+    // Category
+    categoryHeader = makeHeader("CATEGORY");
+    categoryValue = makeValue();
+    layout->addWidget(categoryHeader);
+    layout->addWidget(categoryValue);
+
+    // Priority
+    layout->addWidget(makeHeader("PRIORITY"));
+    priorityBars = new PriorityBars(this);
+    layout->addWidget(priorityBars);
+
+    // Due date
+    dueHeader = makeHeader("DUE DATE");
+    dueValue = makeValue();
+    layout->addWidget(dueHeader);
+    layout->addWidget(dueValue);
+
+    // Description
+    descriptionHeader = makeHeader("DESCRIPTION");
+    descriptionValue = makeValue();
+    layout->addWidget(descriptionHeader);
+    layout->addWidget(descriptionValue);
+
+    layout->addStretch();
+
+    // Buttons - all on one row
+    QHBoxLayout* buttonLayout = new QHBoxLayout();
+    buttonLayout->setSpacing(6);
+
+    editButton = new QPushButton("Edit", this);
+    editButton->setFixedSize(70, 32);
+    toggleButton = new QPushButton("Complete", this);
+    toggleButton->setFixedSize(90, 32);
+    deleteButton = new QPushButton("Delete", this);
+    deleteButton->setObjectName("inspectorDelete");
+    deleteButton->setFixedSize(70, 32);
+    doneButton = new QPushButton("Done", this);
+    doneButton->setFixedSize(70, 32);
+
+    buttonLayout->addWidget(editButton);
+    buttonLayout->addWidget(toggleButton);
+    buttonLayout->addWidget(deleteButton);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(doneButton);
+
+    layout->addLayout(buttonLayout);
+
+    // Keyboard shortcuts only fire while focus is in the pane, so Backspace
+    // in the search field or a dialog never deletes the todo shown here
+    // On Mac, the "Delete" key is actually Backspace
+    QShortcut* deleteShortcut = new QShortcut(QKeySequence(Qt::Key_Backspace), this);
+    QShortcut* escapeShortcut = new QShortcut(QKeySequence(Qt::Key_Escape), this);
+    deleteShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    escapeShortcut->setContext(Qt::WidgetWithChildrenShortcut);
+    connect(deleteShortcut, &QShortcut::activated, deleteButton, &QPushButton::click);
+    connect(escapeShortcut, &QShortcut::activated, doneButton, &QPushButton::click);
+
+    connect(editButton, &QPushButton::clicked, this, [this]() {
+        if (current) emit editRequested(current->getId());
+    });
+    connect(toggleButton, &QPushButton::clicked, this, [this]() {
+        if (current) emit toggleRequested(current->getId());
+    });
+    connect(deleteButton, &QPushButton::clicked, this, [this]() {
+        if (current) emit deleteRequested(current->getId());
+    });
+    connect(doneButton, &QPushButton::clicked, this, &TodoInspector::closeRequested);
+
+    hide();
+}
+
+std::optional<int> TodoInspector::currentTodoId() const {
+    if (!current) return std::nullopt;
+    return current->getId();
+}
+
+void TodoInspector::showTodo(const Todo& todo, const QElapsedTimer& clickTimer) {
+    presentTimer = clickTimer;
+    presentPending = true;
+
+    setTodo(todo);
+    show();
+    update();
+}
+
+void TodoInspector::setTodo(const Todo& todo) {
+    const Todo* previous = current ? &*current : nullptr;
+
+    if (!previous || previous->getTitle() != todo.getTitle()) {
+        titleLabel->setText(QString::fromStdString(todo.getTitle()));
+    }
+
+    if (!previous || previous->getCategory() != todo.getCategory()) {
+        bool hasCategory = !todo.getCategory().empty();
+        categoryValue->setText(QString::fromStdString(todo.getCategory()));
+        categoryHeader->setVisible(hasCategory);
+        categoryValue->setVisible(hasCategory);
+    }
+
+    priorityBars->setPriority(todo.getPriority());
+
+    if (!previous || previous->getDueDate() != todo.getDueDate()) {
+        bool hasDue = todo.getDueDate().has_value();
+        if (hasDue) {
+            QDateTime dt = QDateTime::fromSecsSinceEpoch(todo.getDueDate().value());
+            dueValue->setText(dt.toString("dd.MM.yyyy"));
+        }
+        dueHeader->setVisible(hasDue);
+        dueValue->setVisible(hasDue);
+    }
+
+    if (!previous || previous->getDescription() != todo.getDescription()) {
+        bool hasDescription = !todo.getDescription().empty();
+        descriptionValue->setText(QString::fromStdString(todo.getDescription()));
+        descriptionHeader->setVisible(hasDescription);
+        descriptionValue->setVisible(hasDescription);
+    }
+
+    if (!previous || previous->isCompleted() != todo.isCompleted()) {
+        toggleButton->setText(todo.isCompleted() ? "Incomplete" : "Complete");
+    }
+
+    current = todo;
+}
+
+void TodoInspector::clear() {
+    current.reset();
+    presentPending = false;
+    hide();
+}
+
+void TodoInspector::paintEvent(QPaintEvent* event) {
+    Q_UNUSED(event);
+
+    // Plain QWidget subclasses only draw style sheet backgrounds on request
+    QStyleOption option;
+    option.initFrom(this);
+    QPainter painter(this);
+    style()->drawPrimitive(QStyle::PE_Widget, &option, &painter, this);
+
+    if (presentPending) {
+        presentPending = false;
+        lastLatencyUs = presentTimer.nsecsElapsed() / 1000;
+        emit presented(lastLatencyUs);
+    }
+}
@@ -0,0 +1,76 @@
+#ifndef TODOINSPECTOR_H
+#define TODOINSPECTOR_H
+
+#include <QWidget>
+#include <QLabel>
+#include <QPushButton>
+#include <QElapsedTimer>
+#include <optional>
+#include "models/Todo.h"
+
+// Three-segment priority meter painted directly, so rebinding a new
+// priority is a repaint instead of three style sheet changes.
+class PriorityBars : public QWidget {
+    Q_OBJECT
+public:
+    PriorityBars(QWidget* parent = nullptr);
+    void setPriority(int value);
+    QSize sizeHint() const override { return QSize(3 * 30 + 2 * 4, 6); }
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    int priority = 2;
+};
+
+// Detail pane next to the list. Built once; clicking another todo rebinds it
+// and only the fields whose values differ from the previous todo are touched.
+class TodoInspector : public QWidget {
+    Q_OBJECT
+
+public:
+    TodoInspector(QWidget* parent = nullptr);
+
+    // Rebinds and shows the pane; clickTimer was started when the row was clicked
+    void showTodo(const Todo& todo, const QElapsedTimer& clickTimer);
+    void setTodo(const Todo& todo);
+    void clear();
+
+    std::optional<int> currentTodoId() const;
+    qint64 lastPresentLatencyUs() const { return lastLatencyUs; }
+
+signals:
+    void editRequested(int todoId);
+    void toggleRequested(int todoId);
+    void deleteRequested(int todoId);
+    void closeRequested();
+    // First paint after showTodo(), with the time since the click
+    void presented(qint64 latencyUs);
+
+protected:
+    void paintEvent(QPaintEvent* event) override;
+
+private:
+    std::optional<Todo> current;
+
+    QLabel* titleLabel;
+    QLabel* categoryHeader;
+    QLabel* categoryValue;
+    PriorityBars* priorityBars;
+    QLabel* dueHeader;
+    QLabel* dueValue;
+    QLabel* descriptionHeader;
+    QLabel* descriptionValue;
+
+    QPushButton* editButton;
+    QPushButton* toggleButton;
+    QPushButton* deleteButton;
+    QPushButton* doneButton;
+
+    QElapsedTimer presentTimer;
+    bool presentPending = false;
+    qint64 lastLatencyUs = 0;
+};
+
+#endif // TODOINSPECTOR_H
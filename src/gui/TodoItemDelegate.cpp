@@ -0,0 +1,272 @@
+#include "TodoItemDelegate.h"
+#include "TodoListModel.h"
+#include "Theme.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
+#include <QTimer>
+#include <QFontMetrics>
+#include <algorithm>
+
+namespace {
+const int LeftMargin = 18;
+const int CheckboxSize = 22;
+
+bool isCompletedColor(const QColor& color) {
+    return color == Theme::colors().completedText;
+}
+}
+
+size_t qHash(const TodoRowKey& key, size_t seed) {
+    return qHashMulti(seed, key.todoId, key.contentHash, key.width, key.height,
+                      key.devicePixelRatio);
+}
+
+TodoItemDelegate::TodoItemDelegate(QObject* parent)
+    : QStyledItemDelegate(parent), cache(DefaultCacheLimitKB) {
+}
+
+int TodoItemDelegate::contentOffset(const QModelIndex& index) {
+    QStringList lines = index.data(Qt::DisplayRole).toString().split('\n');
+    bool hasMetadata = lines.size() > 1 && !lines[1].trimmed().isEmpty();
+    return hasMetadata ? 0 : 8;
+}
+
+bool TodoItemDelegate::editorEvent(QEvent* event, QAbstractItemModel* model,
+                                   const QStyleOptionViewItem& option, const QModelIndex& index) {
+    if (event->type() == QEvent::MouseButtonRelease) {
+        QMouseEvent* mouseEvent = static_cast<QMouseEvent*>(event);
+
+        // Check if click is within checkbox area (relative to item rect)
+        int checkboxX = option.rect.left() + LeftMargin;
+        int checkboxY = option.rect.top() + 18 + contentOffset(index);
+
+        QRect checkboxRect(checkboxX, checkboxY, CheckboxSize, CheckboxSize);
+
+        if (checkboxRect.contains(mouseEvent->position().toPoint())) {
+            // Checkbox was clicked - emit a signal to toggle completion
+            emit checkboxClicked(index);
+            return true;
+        }
+    }
+    return QStyledItemDelegate::editorEvent(event, model, option, index);
+}
+
+TodoRowKey TodoItemDelegate::rowKey(const QStyleOptionViewItem& option, const QModelIndex& index,
+                                    qreal dpr) const {
+    TodoRowKey key;
+    key.todoId = index.data(TodoListModel::TodoIdRole).toInt();
+    key.width = option.rect.width();
+    key.height = option.rect.height();
+    key.devicePixelRatio = dpr;
+
+    QFont font = index.data(Qt::FontRole).value<QFont>();
+    QColor color = index.data(Qt::ForegroundRole).value<QColor>();
+    key.contentHash = qHashMulti(0, index.data(Qt::DisplayRole).toString(), color.rgba(),
+                                 font.strikeOut(), font.bold());
+    return key;
+}
+
+void TodoItemDelegate::paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    static Metrics::Histogram& paintLatency = Metrics::histogram(
+        "todo_gui_row_paint_seconds", "TodoItemDelegate::paint, one list row");
+    static Metrics::Counter& cacheHits = Metrics::counter(
+        "todo_gui_row_cache_total", "Row paints by body pixmap cache result", {{"result", "hit"}});
+    static Metrics::Counter& cacheMisses = Metrics::counter(
+        "todo_gui_row_cache_total", "Row paints by body pixmap cache result", {{"result", "miss"}});
+    Metrics::ScopedTimer timer(paintLatency);
+
+    // The startup trace runs from main() to the end of the paint pass that
+    // draws the first row, and is written out then
+    static bool firstRow = true;
+    if (firstRow) {
+        firstRow = false;
+        Trace::instant("first row paint", "startup");
+        QTimer::singleShot(0, []() {
+            Trace::complete("startup", "startup", Trace::startUs(), Trace::nowUs());
+            Trace::flush();
+        });
+    }
+
+    bool hovered = option.state & QStyle::State_MouseOver;
+    bool selected = option.state & QStyle::State_Selected;
+
+    // Overlay: row background for hover/selection, never cached
+    const Theme::Colors& colors = Theme::colors();
+    QColor background = colors.window;
+    if (selected && hovered) {
+        background = colors.selectedHover;
+    } else if (selected || hovered) {
+        background = colors.hover;
+    }
+    painter->fillRect(option.rect, background);
+
+    qreal dpr = painter->device() ? painter->device()->devicePixelRatioF() : 1.0;
+    TodoRowKey key = rowKey(option, index, dpr);
+
+    QPixmap* body = cache.object(key);
+    if (body) {
+        hits++;
+        cacheHits.add();
+    } else {
+        misses++;
+        cacheMisses.add();
+
+        QPixmap pixmap(option.rect.size() * dpr);
+        pixmap.setDevicePixelRatio(dpr);
+        pixmap.fill(Qt::transparent);
+
+        QPainter bodyPainter(&pixmap);
+        paintBody(&bodyPainter, option, index, QRect(QPoint(0, 0), option.rect.size()));
+        bodyPainter.end();
+
+        int costKB = std::max(1, static_cast<int>(pixmap.width() * pixmap.height() * 4 / 1024));
+        body = new QPixmap(pixmap);
+        if (cache.insert(key, body, costKB)) {
+            rememberKey(key);
+        } else {
+            // Larger than the whole cache: draw it once and let it go
+            painter->drawPixmap(option.rect.topLeft(), pixmap);
+            return;
+        }
+    }
+
+    painter->drawPixmap(option.rect.topLeft(), *body);
+
+    // Overlay: darker checkbox ring while hovering an open todo
+    bool isCompleted = isCompletedColor(index.data(Qt::ForegroundRole).value<QColor>());
+    if (hovered && !isCompleted) {
+        painter->save();
+        painter->setRenderHint(QPainter::Antialiasing);
+        painter->setPen(QPen(colors.checkboxHover, 2));
+        painter->setBrush(Qt::NoBrush);
+        painter->drawEllipse(option.rect.left() + LeftMargin,
+                             option.rect.top() + 18 + contentOffset(index),
+                             CheckboxSize, CheckboxSize);
+        painter->restore();
+    }
+}
+
+void TodoItemDelegate::paintBody(QPainter* painter, const QStyleOptionViewItem& option,
+                                 const QModelIndex& index, const QRect& rect) const {
+    painter->setRenderHint(QPainter::Antialiasing);
+    const Theme::Colors& colors = Theme::colors();
+
+    // Get data
+    QString text = index.data(Qt::DisplayRole).toString();
+    QColor textColor = index.data(Qt::ForegroundRole).value<QColor>();
+    if (!textColor.isValid()) {
+        textColor = colors.text;
+    }
+    bool isCompleted = isCompletedColor(textColor);
+    bool hasStrikethrough = index.data(Qt::FontRole).value<QFont>().strikeOut();
+
+    QStringList lines = text.split('\n');
+    QString title = lines.size() > 0 ? lines[0] : "";
+    QString metadata = lines.size() > 1 ? lines[1] : "";
+
+    // Remove priority indicator from title for display
+    if (title.startsWith("● ")) {
+        title = title.mid(2);
+    } else if (title.startsWith("  ")) {
+        title = title.mid(2);
+    }
+
+    int offset = contentOffset(index);
+    int checkboxX = rect.left() + LeftMargin;
+    int checkboxY = rect.top() + 18 + offset;
+
+    // Draw checkbox circle (the hover ring is an overlay in paint())
+    painter->setPen(QPen(colors.checkbox, 2));
+    painter->setBrush(Qt::NoBrush);
+    painter->drawEllipse(checkboxX, checkboxY, CheckboxSize, CheckboxSize);
+
+    // Draw checkmark if completed with smoother curves
+    if (isCompleted) {
+        painter->setPen(QPen(colors.checkmark, 2, Qt::SolidLine, Qt::RoundCap, Qt::RoundJoin));
+        QPainterPath checkmark;
+        checkmark.moveTo(checkboxX + 6, checkboxY + 11);
+        checkmark.lineTo(checkboxX + 9, checkboxY + 15);
+        checkmark.lineTo(checkboxX + 16, checkboxY + 7);
+        painter->drawPath(checkmark);
+    }
+
+    int textStartX = rect.left() + LeftMargin + CheckboxSize + 14;
+
+    // Draw title
+    QFont titleFont = option.font;
+    titleFont.setPointSize(16);
+    titleFont.setWeight(QFont::Medium);
+    painter->setFont(titleFont);
+    painter->setPen(textColor);
+
+    QRect titleRect(textStartX, rect.top() + 15 + offset, rect.width() - textStartX - 16, 26);
+
+    // Draw title with strikethrough if needed
+    if (hasStrikethrough) {
+        QFontMetrics fm(titleFont);
+        int textWidth = fm.horizontalAdvance(title);
+        painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, title);
+
+        // Draw strikethrough line
+        int lineY = titleRect.top() + titleRect.height() / 2;
+        painter->setPen(QPen(textColor, 1.5));
+        painter->drawLine(textStartX, lineY, textStartX + textWidth, lineY);
+    } else {
+        painter->drawText(titleRect, Qt::AlignLeft | Qt::AlignVCenter, title);
+    }
+
+    // Draw metadata (category, due date) - tiny and subtle
+    if (!metadata.trimmed().isEmpty()) {
+        QFont metaFont = option.font;
+        metaFont.setPointSize(11);
+        metaFont.setCapitalization(QFont::AllUppercase);
+        metaFont.setLetterSpacing(QFont::AbsoluteSpacing, 0.8);
+        metaFont.setWeight(QFont::Normal);
+        painter->setFont(metaFont);
+        painter->setPen(colors.metaText);
+
+        QRect metaRect(textStartX, rect.top() + 43, rect.width() - textStartX - 16, 18);
+        painter->drawText(metaRect, Qt::AlignLeft | Qt::AlignVCenter, metadata.trimmed());
+    }
+
+    // Draw bottom border
+    painter->setPen(colors.divider);
+    painter->drawLine(rect.bottomLeft(), rect.bottomRight());
+}
+
+QSize TodoItemDelegate::sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const {
+    Q_UNUSED(index);
+    return QSize(option.rect.width(), RowHeight);
+}
+
+void TodoItemDelegate::rememberKey(const TodoRowKey& key) const {
+    // Forget keys the LRU already dropped so the index stays as small as the cache
+    auto forgotten = [this](const TodoRowKey& k) { return !cache.contains(k); };
+
+    std::vector<TodoRowKey>& keys = keysByTodo[key.todoId];
+    keys.erase(std::remove_if(keys.begin(), keys.end(), forgotten), keys.end());
+    keys.push_back(key);
+
+    if (keysByTodo.size() > static_cast<size_t>(cache.count()) * 2 + 64) {
+        for (auto it = keysByTodo.begin(); it != keysByTodo.end();) {
+            it->second.erase(std::remove_if(it->second.begin(), it->second.end(), forgotten),
+                             it->second.end());
+            it = it->second.empty() ? keysByTodo.erase(it) : std::next(it);
+        }
+    }
+}
+
+void TodoItemDelegate::invalidateTodo(int todoId) {
+    auto it = keysByTodo.find(todoId);
+    if (it == keysByTodo.end()) return;
+
+    for (const TodoRowKey& key : it->second) {
+        cache.remove(key);
+    }
+    keysByTodo.erase(it);
+}
+
+void TodoItemDelegate::clearCache() {
+    cache.clear();
+    keysByTodo.clear();
+}
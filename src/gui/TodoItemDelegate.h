@@ -0,0 +1,76 @@
+#ifndef TODOITEMDELEGATE_H
+#define TODOITEMDELEGATE_H
+
+#include <QStyledItemDelegate>
+#include <QPainter>
+#include <QPainterPath>
+#include <QPixmap>
+#include <QCache>
+#include <QHash>
+#include <QEvent>
+#include <QMouseEvent>
+#include <unordered_map>
+#include <vector>
+
+// Identifies one rendered row body. Hover and selection are not part of the
+// key: they are painted as overlays on top of the cached pixmap.
+struct TodoRowKey {
+    int todoId = 0;
+    size_t contentHash = 0;  // Display text, colors and font flags
+    int width = 0;
+    int height = 0;
+    qreal devicePixelRatio = 1.0;
+
+    bool operator==(const TodoRowKey& other) const {
+        return todoId == other.todoId && contentHash == other.contentHash &&
+               width == other.width && height == other.height &&
+               devicePixelRatio == other.devicePixelRatio;
+    }
+};
+
+size_t qHash(const TodoRowKey& key, size_t seed = 0);
+
+class TodoItemDelegate : public QStyledItemDelegate {
+    Q_OBJECT
+public:
+    // Every row has the same height so the view can use uniform item sizes
+    // and never has to hydrate off-screen rows just to lay them out
+    static constexpr int RowHeight = 76;
+
+    // Upper bound for cached row bodies, in kilobytes of pixmap memory
+    static constexpr int DefaultCacheLimitKB = 8 * 1024;
+
+    TodoItemDelegate(QObject* parent = nullptr);
+
+    // Rows without metadata center their title, shifting the checkbox down
+    static int contentOffset(const QModelIndex& index);
+
+    bool editorEvent(QEvent* event, QAbstractItemModel* model,
+                     const QStyleOptionViewItem& option, const QModelIndex& index) override;
+    void paint(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+    QSize sizeHint(const QStyleOptionViewItem& option, const QModelIndex& index) const override;
+
+    // Drops every cached body for a todo; call whenever that todo is written
+    void invalidateTodo(int todoId);
+    void clearCache();
+    void setCacheLimit(int kilobytes) { cache.setMaxCost(kilobytes); }
+
+    int cacheHits() const { return hits; }
+    int cacheMisses() const { return misses; }
+
+signals:
+    void checkboxClicked(const QModelIndex& index);
+
+private:
+    mutable QCache<TodoRowKey, QPixmap> cache;
+    mutable std::unordered_map<int, std::vector<TodoRowKey>> keysByTodo;
+    mutable int hits = 0;
+    mutable int misses = 0;
+
+    void rememberKey(const TodoRowKey& key) const;
+    TodoRowKey rowKey(const QStyleOptionViewItem& option, const QModelIndex& index, qreal dpr) const;
+    void paintBody(QPainter* painter, const QStyleOptionViewItem& option, const QModelIndex& index,
+                   const QRect& rect) const;
+};
+
+#endif // TODOITEMDELEGATE_H
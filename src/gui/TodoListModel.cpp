@@ -0,0 +1,455 @@
+#include "TodoListModel.h"
+#include "Theme.h"
+#include "metrics/Trace.h"
+#include <QColor>
+#include <QFont>
+#include <QMimeData>
+#include <algorithm>
+#include <cstdlib>
+
+TodoListModel::TodoListModel(TodoDatabase* database, QObject* parent)
+    : QAbstractItemModel(parent), database(database) {
+}
+
+void TodoListModel::setCategoryFilter(const std::optional<std::string>& category) {
+    categoryFilter = category;
+    reload();
+}
+
+void TodoListModel::setOrder(TodoOrder newOrder) {
+    if (order == newOrder) return;
+    order = newOrder;
+    reload();
+}
+
+void TodoListModel::reload() {
+    Trace::Span span("TodoListModel::reload", "refresh");
+    beginResetModel();
+    pageEnds.clear();
+    pages.clear();
+    fetchedRows = 0;
+    reachedEnd = false;
+    windowFirstPage = 0;
+    windowLastPage = 0;
+    children.clear();
+    endResetModel();
+}
+
+bool TodoListModel::listKeyChanged(const Todo& before, const Todo& after) {
+    // Bulk writes never touch the due date or creation time
+    return before.isCompleted() != after.isCompleted() || before.getPriority() != after.getPriority();
+}
+
+bool TodoListModel::updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after) {
+    Trace::Span span("TodoListModel::updateTodos", "refresh");
+
+    // A row that moves shifts every page cursor past it, loaded or not
+    for (size_t i = 0; i < before.size(); i++) {
+        if (order == TodoOrder::List && listKeyChanged(before[i], after[i])) return false;
+        if (categoryFilter && !before[i].getParentId() &&
+            (before[i].getCategory() == *categoryFilter) != (after[i].getCategory() == *categoryFilter)) {
+            return false;
+        }
+    }
+
+    // Every loaded row by id, with the index the view knows it by
+    std::unordered_map<int, std::pair<TodoNode*, QModelIndex>> loaded;
+    for (auto& [pageIndex, rows] : pages) {
+        for (size_t i = 0; i < rows.size(); i++) {
+            int row = pageIndex * PageSize + static_cast<int>(i);
+            loaded.emplace(rows[i].todo.getId(), std::make_pair(&rows[i], createIndex(row, 0, quintptr(0))));
+        }
+    }
+    for (auto& [parentId, list] : children) {
+        for (size_t i = 0; i < list.rows.size(); i++) {
+            QModelIndex index = createIndex(static_cast<int>(i), 0, quintptr(parentId));
+            loaded.emplace(list.rows[i].todo.getId(), std::make_pair(&list.rows[i], index));
+        }
+    }
+
+    std::vector<QModelIndex> changed;
+    for (size_t i = 0; i < after.size(); i++) {
+        auto it = loaded.find(after[i].getId());
+        if (it != loaded.end()) {
+            it->second.first->todo = after[i];
+            changed.push_back(it->second.second);
+        }
+        if (before[i].isCompleted() == after[i].isCompleted()) continue;
+
+        // Up the tree, through ancestors not loaded too; a page read later
+        // comes from the database and is right already
+        int delta = after[i].isCompleted() ? 1 : -1;
+        std::optional<int> parentId = after[i].getParentId();
+        while (parentId) {
+            auto parent = loaded.find(*parentId);
+            if (parent != loaded.end()) {
+                parent->second.first->completedDescendants += delta;
+                changed.push_back(parent->second.second);
+                parentId = parent->second.first->todo.getParentId();
+            } else {
+                auto todo = database->getTodoById(*parentId);
+                parentId = todo ? todo->getParentId() : std::nullopt;
+            }
+        }
+    }
+
+    for (const QModelIndex& index : changed) {
+        emit dataChanged(index, index);
+    }
+    return true;
+}
+
+QModelIndex TodoListModel::index(int row, int column, const QModelIndex& parent) const {
+    if (column != 0 || row < 0 || row >= rowCount(parent)) return QModelIndex();
+    if (!parent.isValid()) return createIndex(row, 0, quintptr(0));
+
+    const TodoNode* parentNode = nodeAt(parent);
+    if (!parentNode) return QModelIndex();
+    return createIndex(row, 0, quintptr(parentNode->todo.getId()));
+}
+
+QModelIndex TodoListModel::parent(const QModelIndex& child) const {
+    if (!child.isValid() || child.internalId() == 0) return QModelIndex();
+
+    auto it = children.find(static_cast<int>(child.internalId()));
+    if (it == children.end()) return QModelIndex();
+    return createIndex(it->second.parentRow, 0, quintptr(it->second.grandParentId));
+}
+
+int TodoListModel::rowCount(const QModelIndex& parent) const {
+    if (!parent.isValid()) return fetchedRows;
+
+    const TodoNode* node = nodeAt(parent);
+    if (!node) return 0;
+    auto it = children.find(node->todo.getId());
+    return it == children.end() ? 0 : static_cast<int>(it->second.rows.size());
+}
+
+int TodoListModel::columnCount(const QModelIndex&) const {
+    return 1;
+}
+
+bool TodoListModel::hasChildren(const QModelIndex& parent) const {
+    if (!parent.isValid()) return true;
+    const TodoNode* node = nodeAt(parent);
+    return node && node->descendants > 0;
+}
+
+bool TodoListModel::canFetchMore(const QModelIndex& parent) const {
+    if (!parent.isValid()) return !reachedEnd;
+
+    const TodoNode* node = nodeAt(parent);
+    if (!node || node->descendants == 0) return false;
+    auto it = children.find(node->todo.getId());
+    return it == children.end() || !it->second.reachedEnd;
+}
+
+void TodoListModel::fetchMore(const QModelIndex& parent) {
+    Trace::Span span("TodoListModel::fetchMore", "refresh");
+
+    if (parent.isValid()) {
+        const TodoNode* node = nodeAt(parent);
+        if (!node) return;
+        int parentId = node->todo.getId();
+
+        auto [it, added] = children.try_emplace(parentId);
+        ChildList& list = it->second;
+        if (added) {
+            list.grandParentId = static_cast<int>(parent.internalId());
+            list.parentRow = parent.row();
+        }
+        if (list.reachedEnd) return;
+
+        std::optional<TodoPageCursor> after;
+        if (!list.rows.empty()) {
+            after = TodoPageCursor::fromTodo(list.rows.back().todo);
+        }
+        std::vector<TodoNode> nodes = database->getChildrenPage(parentId, after, PageSize, std::nullopt, order);
+
+        if (nodes.size() < static_cast<size_t>(PageSize)) {
+            list.reachedEnd = true;
+        }
+        if (nodes.empty()) return;
+
+        int first = static_cast<int>(list.rows.size());
+        beginInsertRows(parent, first, first + static_cast<int>(nodes.size()) - 1);
+        for (TodoNode& child : nodes) {
+            list.rows.push_back(std::move(child));
+        }
+        endInsertRows();
+        return;
+    }
+
+    if (reachedEnd) return;
+
+    int pageIndex = static_cast<int>(pageEnds.size());
+    std::vector<TodoNode> nodes = queryPage(pageIndex);
+
+    if (nodes.size() < static_cast<size_t>(PageSize)) {
+        reachedEnd = true;
+    }
+    if (nodes.empty()) return;
+
+    int count = static_cast<int>(nodes.size());
+    beginInsertRows(QModelIndex(), fetchedRows, fetchedRows + count - 1);
+    pageEnds.push_back(TodoPageCursor::fromTodo(nodes.back().todo));
+    pages[pageIndex] = std::move(nodes);
+    fetchedRows += count;
+    endInsertRows();
+
+    evictPages(windowFirstPage - PrefetchPages, std::max(windowLastPage, pageIndex) + PrefetchPages,
+               pageIndex);
+}
+
+Qt::ItemFlags TodoListModel::flags(const QModelIndex& index) const {
+    Qt::ItemFlags flags = QAbstractItemModel::flags(index);
+    if (order != TodoOrder::Manual) return flags;
+
+    // Anywhere is a drop target: on a row makes a subtask, between rows or
+    // on the blank area below them a sibling
+    if (index.isValid()) flags |= Qt::ItemIsDragEnabled;
+    return flags | Qt::ItemIsDropEnabled;
+}
+
+Qt::DropActions TodoListModel::supportedDropActions() const {
+    return Qt::MoveAction;
+}
+
+QStringList TodoListModel::mimeTypes() const {
+    return {"application/x-todo-id"};
+}
+
+QMimeData* TodoListModel::mimeData(const QModelIndexList& indexes) const {
+    if (indexes.isEmpty()) return nullptr;
+    const TodoNode* node = nodeAt(indexes.first());
+    if (!node) return nullptr;
+
+    auto* data = new QMimeData();
+    data->setData("application/x-todo-id", QByteArray::number(node->todo.getId()));
+    return data;
+}
+
+bool TodoListModel::dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int,
+                                 const QModelIndex& parent) {
+    if (order != TodoOrder::Manual || action != Qt::MoveAction ||
+        !data->hasFormat("application/x-todo-id")) {
+        return false;
+    }
+
+    bool ok = false;
+    int todoId = data->data("application/x-todo-id").toInt(&ok);
+    if (!ok) return false;
+
+    int parentId = 0;
+    if (parent.isValid()) {
+        const TodoNode* node = nodeAt(parent);
+        if (!node) return false;
+        parentId = node->todo.getId();
+    }
+
+    // row is -1 for a drop onto parent itself, which appends. Below the
+    // loaded rows of a list that has more to fetch it means the same.
+    int beforeId = 0;
+    if (row >= 0 && row < rowCount(parent)) {
+        const TodoNode* before = nodeAt(index(row, 0, parent));
+        if (!before) return false;
+        beforeId = before->todo.getId();
+    }
+    if (beforeId == todoId) return false;
+
+    emit moveRequested(todoId, parentId, beforeId);
+
+    // Rows are not moved here; the reload that follows shows the result.
+    // Returning false also keeps the view from removing the dragged row.
+    return false;
+}
+
+void TodoListModel::setVisibleRows(int first, int last) {
+    if (fetchedRows == 0) return;
+
+    first = std::clamp(first, 0, fetchedRows - 1);
+    last = std::clamp(last, first, fetchedRows - 1);
+
+    windowFirstPage = first / PageSize;
+    windowLastPage = last / PageSize;
+
+    int keepFirst = std::max(0, windowFirstPage - PrefetchPages);
+    int keepLast = std::min(static_cast<int>(pageEnds.size()) - 1, windowLastPage + PrefetchPages);
+
+    evictPages(keepFirst, keepLast);
+    for (int i = keepFirst; i <= keepLast; i++) {
+        page(i);
+    }
+}
+
+void TodoListModel::releaseChildren(const QModelIndex& parent) {
+    const TodoNode* node = nodeAt(parent);
+    if (!node) return;
+
+    auto it = children.find(node->todo.getId());
+    if (it == children.end()) return;
+
+    // Deepest first, so every removal still has a valid parent index
+    for (int row = 0; row < static_cast<int>(it->second.rows.size()); row++) {
+        if (children.count(it->second.rows[row].todo.getId())) {
+            releaseChildren(index(row, 0, parent));
+        }
+    }
+
+    int count = static_cast<int>(it->second.rows.size());
+    if (count > 0) {
+        beginRemoveRows(parent, 0, count - 1);
+        children.erase(it);
+        endRemoveRows();
+    } else {
+        children.erase(it);
+    }
+}
+
+const Todo* TodoListModel::todoAt(int row) const {
+    const TodoNode* node = topLevelNode(row);
+    return node ? &node->todo : nullptr;
+}
+
+const TodoNode* TodoListModel::topLevelNode(int row) const {
+    if (row < 0 || row >= fetchedRows) return nullptr;
+
+    const std::vector<TodoNode>* rows = page(row / PageSize);
+    size_t offset = static_cast<size_t>(row % PageSize);
+    if (!rows || offset >= rows->size()) return nullptr;
+
+    return &(*rows)[offset];
+}
+
+const TodoNode* TodoListModel::nodeAt(const QModelIndex& index) const {
+    if (!index.isValid()) return nullptr;
+    if (index.internalId() == 0) return topLevelNode(index.row());
+
+    auto it = children.find(static_cast<int>(index.internalId()));
+    if (it == children.end() || index.row() >= static_cast<int>(it->second.rows.size())) return nullptr;
+    return &it->second.rows[index.row()];
+}
+
+const std::vector<TodoNode>* TodoListModel::page(int pageIndex) const {
+    auto it = pages.find(pageIndex);
+    if (it != pages.end()) return &it->second;
+    if (pageIndex < 0 || pageIndex >= static_cast<int>(pageEnds.size())) return nullptr;
+
+    // Rehydrate an evicted page from the cursor that ends the previous one
+    pages[pageIndex] = queryPage(pageIndex);
+
+    if (static_cast<int>(pages.size()) > MaxResidentPages) {
+        evictPages(std::min(pageIndex, windowFirstPage - PrefetchPages),
+                   std::max(pageIndex, windowLastPage + PrefetchPages), pageIndex);
+    }
+
+    return &pages[pageIndex];
+}
+
+std::vector<TodoNode> TodoListModel::queryPage(int pageIndex) const {
+    std::optional<TodoPageCursor> after;
+    if (pageIndex > 0) {
+        after = pageEnds[pageIndex - 1];
+    }
+    return database->getChildrenPage(std::nullopt, after, PageSize, categoryFilter, order);
+}
+
+void TodoListModel::evictPages(int keepFirst, int keepLast, int pinnedPage) const {
+    for (auto it = pages.begin(); it != pages.end();) {
+        if (it->first < keepFirst || it->first > keepLast) {
+            it = pages.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    // A window wider than the cap keeps only the pages nearest the pinned one
+    int anchor = pinnedPage >= 0 ? pinnedPage : keepFirst;
+    while (static_cast<int>(pages.size()) > MaxResidentPages) {
+        auto farthest = std::max_element(pages.begin(), pages.end(),
+            [anchor](const auto& a, const auto& b) {
+                return std::abs(a.first - anchor) < std::abs(b.first - anchor);
+            });
+        pages.erase(farthest);
+    }
+}
+
+QVariant TodoListModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    const TodoNode* node = nodeAt(index);
+    if (!node) return QVariant();
+    const Todo* todo = &node->todo;
+
+    switch (role) {
+    case Qt::DisplayRole:
+        // Subtasks under a filter can be from other categories
+        return displayText(*node, !categoryFilter || index.internalId() != 0);
+
+    case Qt::ForegroundRole:
+        if (todo->isCompleted()) {
+            return Theme::colors().completedText;
+        }
+        return QVariant();
+
+    case Qt::FontRole: {
+        QFont font;
+        if (todo->isCompleted()) {
+            font.setStrikeOut(true);
+        } else if (todo->isOverdue() || todo->getPriority() == 3) {
+            font.setBold(true);
+        }
+        return font;
+    }
+
+    case TodoIdRole:
+        return todo->getId();
+    }
+
+    return QVariant();
+}
+
+QString TodoListModel::displayText(const TodoNode& node, bool showCategory) {
+    const Todo& todo = node.todo;
+    QString itemText;
+
+    if (todo.getPriority() == 3 && !todo.isCompleted()) {
+        itemText += "● ";
+    } else {
+        itemText += "  ";
+    }
+
+    itemText += QString::fromStdString(todo.getTitle());
+    itemText += "\n";
+
+    QString metadata = "";
+
+    if (showCategory && !todo.getCategory().empty()) {
+        metadata += QString::fromStdString(todo.getCategory());
+    }
+
+    if (node.descendants > 0) {
+        if (!metadata.isEmpty()) metadata += " • ";
+        metadata += QString("%1/%2 subtasks").arg(node.completedDescendants).arg(node.descendants);
+    }
+
+    if (todo.isOverdue() && !todo.isCompleted()) {
+        if (!metadata.isEmpty()) metadata += " • ";
+        metadata += "overdue";
+    } else if (todo.getDueDate().has_value() && !todo.isCompleted()) {
+        int days = todo.daysUntilDue();
+        if (days == 0) {
+            if (!metadata.isEmpty()) metadata += " • ";
+            metadata += "due today";
+        } else if (days == 1) {
+            if (!metadata.isEmpty()) metadata += " • ";
+            metadata += "due tomorrow";
+        } else if (days > 0 && days <= 7) {
+            if (!metadata.isEmpty()) metadata += " • ";
+            metadata += QString("due in %1d").arg(days);
+        }
+    }
+
+    itemText += metadata;
+    return itemText;
+}
@@ -0,0 +1,122 @@
+#ifndef TODOLISTMODEL_H
+#define TODOLISTMODEL_H
+
+#include <QAbstractItemModel>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "database/TodoDatabase.h"
+#include "models/Todo.h"
+
+// Lazily paged tree of todos. Top-level rows are fetched in keyset pages as
+// the view scrolls (canFetchMore/fetchMore); only pages around the visible
+// window stay hydrated, everything else is evicted and re-queried from its
+// page cursor on demand. Per fetched page we keep just one TodoPageCursor.
+//
+// Subtasks are not loaded until their parent is expanded, then page in the
+// same way below it and are dropped again by releaseChildren() on collapse.
+// Every row carries its subtree rollup, so the expand arrow and "2/5
+// subtasks" need no extra queries.
+//
+// In manual order rows can be dragged within the tree. A drop does not
+// touch the model: it asks for the move with moveRequested() and the owner
+// places the todo and reloads.
+class TodoListModel : public QAbstractItemModel {
+    Q_OBJECT
+
+public:
+    enum Roles {
+        TodoIdRole = Qt::UserRole
+    };
+
+    static constexpr int PageSize = 100;
+    static constexpr int PrefetchPages = 2;     // Kept on each side of the visible window
+    static constexpr int MaxResidentPages = 16; // Hard cap regardless of window size
+
+    explicit TodoListModel(TodoDatabase* database, QObject* parent = nullptr);
+
+    // std::nullopt shows every category. Filters top-level todos; subtasks
+    // always show under their parent.
+    void setCategoryFilter(const std::optional<std::string>& category);
+    std::optional<std::string> getCategoryFilter() const { return categoryFilter; }
+
+    void setOrder(TodoOrder order);
+    TodoOrder getOrder() const { return order; }
+
+    // Drops all pages and loaded subtasks and starts again from the first page
+    void reload();
+
+    // Writes the new fields of bulk-updated todos, and the rollups of their
+    // ancestors, into the rows already loaded. False when a row moved or
+    // left the filter instead; nothing is touched and the caller reloads.
+    bool updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after);
+
+    // Called by the view on scroll/resize with top-level rows; prefetches the
+    // margin and evicts the rest
+    void setVisibleRows(int first, int last);
+
+    // Unloads the subtasks below parent, at every depth; call on collapse
+    void releaseChildren(const QModelIndex& parent);
+
+    // Title line and metadata line of a row, as TodoItemDelegate paints them
+    static QString displayText(const TodoNode& node, bool showCategory);
+    // Whether a write moves the todo in TodoOrder::List
+    static bool listKeyChanged(const Todo& before, const Todo& after);
+
+    const Todo* todoAt(int row) const;  // Top level
+    const TodoNode* nodeAt(const QModelIndex& index) const;
+    int residentPageCount() const { return static_cast<int>(pages.size()); }
+    int loadedChildListCount() const { return static_cast<int>(children.size()); }
+
+    QModelIndex index(int row, int column, const QModelIndex& parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex& child) const override;
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex& parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+    bool canFetchMore(const QModelIndex& parent) const override;
+    void fetchMore(const QModelIndex& parent) override;
+
+    Qt::ItemFlags flags(const QModelIndex& index) const override;
+    Qt::DropActions supportedDropActions() const override;
+    QStringList mimeTypes() const override;
+    QMimeData* mimeData(const QModelIndexList& indexes) const override;
+    bool dropMimeData(const QMimeData* data, Qt::DropAction action, int row, int column,
+                      const QModelIndex& parent) override;
+
+signals:
+    // A drop of todoId under parentId (0 for the top level), just before
+    // beforeId (0 for last)
+    void moveRequested(int todoId, int parentId, int beforeId);
+
+private:
+    // Loaded subtasks of one expanded todo. Indexes below it carry the
+    // parent's id as their internalId; 0 means the top level.
+    struct ChildList {
+        int grandParentId = 0;  // Where the parent itself lives
+        int parentRow = 0;      // Row of the parent in that list
+        std::vector<TodoNode> rows;
+        bool reachedEnd = false;
+    };
+
+    TodoDatabase* database;
+    std::optional<std::string> categoryFilter;
+    TodoOrder order = TodoOrder::List;
+
+    std::vector<TodoPageCursor> pageEnds;  // Cursor of the last row of each fetched page
+    mutable std::unordered_map<int, std::vector<TodoNode>> pages;
+    int fetchedRows = 0;
+    bool reachedEnd = false;
+    int windowFirstPage = 0;
+    int windowLastPage = 0;
+
+    std::unordered_map<int, ChildList> children;  // By parent todo id
+
+    const std::vector<TodoNode>* page(int pageIndex) const;
+    const TodoNode* topLevelNode(int row) const;
+    std::vector<TodoNode> queryPage(int pageIndex) const;
+    void evictPages(int keepFirst, int keepLast, int pinnedPage = -1) const;
+};
+
+#endif // TODOLISTMODEL_H
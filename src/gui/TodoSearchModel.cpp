@@ -0,0 +1,206 @@
+#include "TodoSearchModel.h"
+#include "TodoListModel.h"
+#include "Theme.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
+#include <QColor>
+#include <QFont>
+#include <algorithm>
+#include <cstdlib>
+
+namespace {
+
+Metrics::Histogram& firstPageLatency(const char* path) {
+    return Metrics::histogram("todo_gui_search_first_page_seconds",
+                              "From applying a search query to its first page of results", {{"path", path}});
+}
+
+} // namespace
+
+TodoSearchModel::TodoSearchModel(TodoDatabase* database, QObject* parent)
+    : QAbstractListModel(parent), database(database), search(*database) {
+    debounceTimer.setSingleShot(true);
+    connect(&debounceTimer, &QTimer::timeout, this, &TodoSearchModel::applyQuery);
+
+    sliceTimer.setSingleShot(true);
+    sliceTimer.setInterval(0);
+    connect(&sliceTimer, &QTimer::timeout, this, &TodoSearchModel::scanSlice);
+}
+
+void TodoSearchModel::setQueryText(const QString& text) {
+    if (text == pendingText) return;
+    pendingText = text;
+
+    // The running query stops here. A narrowing one is applied as soon as
+    // the keys already queued have been read, which also folds a paste or
+    // a burst of typing into one pass.
+    sliceTimer.stop();
+    bool immediate = text.isEmpty() || search.narrows(text.toStdString());
+    debounceTimer.start(immediate ? 0 : DebounceMs);
+}
+
+void TodoSearchModel::restart() {
+    if (pendingText.isEmpty()) return;
+
+    beginResetModel();
+    pages.clear();
+    search.restart();
+    shownRows = 0;
+    endResetModel();
+
+    narrowed = false;
+    awaitingFirstPage = true;
+    applied.start();
+    sliceTimer.start();
+}
+
+void TodoSearchModel::updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after) {
+    if (pendingText.isEmpty()) return;
+
+    if (!search.finished()) {
+        for (size_t i = 0; i < before.size(); i++) {
+            if (TodoListModel::listKeyChanged(before[i], after[i])) {
+                restart();
+                return;
+            }
+        }
+    }
+
+    std::unordered_map<int, const Todo*> byId;
+    for (const Todo& todo : after) byId.emplace(todo.getId(), &todo);
+
+    for (auto& [pageIndex, nodes] : pages) {
+        for (size_t i = 0; i < nodes.size(); i++) {
+            auto it = byId.find(nodes[i].todo.getId());
+            if (it == byId.end()) continue;
+            nodes[i].todo = *it->second;
+            QModelIndex changed = index(pageIndex * PageSize + static_cast<int>(i), 0);
+            emit dataChanged(changed, changed);
+        }
+    }
+}
+
+void TodoSearchModel::applyQuery() {
+    Trace::Span span("TodoSearchModel::applyQuery", "refresh");
+
+    beginResetModel();
+    pages.clear();
+    if (pendingText.isEmpty()) {
+        search.clear();
+        narrowed = false;
+    } else {
+        narrowed = search.setQuery(pendingText.toStdString());
+    }
+    shownRows = static_cast<int>(search.matches().size());
+    endResetModel();
+
+    awaitingFirstPage = !pendingText.isEmpty();
+    applied.start();
+    publish();
+    if (!search.finished()) sliceTimer.start();
+}
+
+void TodoSearchModel::scanSlice() {
+    Trace::Span span("TodoSearchModel::scanSlice", "refresh");
+
+    QElapsedTimer budget;
+    budget.start();
+    while (search.step() && budget.elapsed() < SliceBudgetMs) {
+    }
+
+    // Matches only ever append while a query runs
+    int count = static_cast<int>(search.matches().size());
+    if (count > shownRows) {
+        // A partly read last page is read again once it has grown
+        auto last = pages.find((shownRows - 1) / PageSize);
+        if (shownRows > 0 && last != pages.end() && static_cast<int>(last->second.size()) < PageSize) {
+            pages.erase(last);
+        }
+        beginInsertRows(QModelIndex(), shownRows, count - 1);
+        shownRows = count;
+        endInsertRows();
+    }
+
+    publish();
+    if (!search.finished()) sliceTimer.start();
+}
+
+void TodoSearchModel::publish() {
+    if (awaitingFirstPage && (shownRows >= PageSize || search.finished())) {
+        static Metrics::Histogram& narrowLatency = firstPageLatency("narrow");
+        static Metrics::Histogram& scanLatency = firstPageLatency("scan");
+        (narrowed ? narrowLatency : scanLatency).recordNs(applied.nsecsElapsed());
+        awaitingFirstPage = false;
+    }
+    emit progress(shownRows, search.finished());
+}
+
+int TodoSearchModel::rowCount(const QModelIndex& parent) const {
+    return parent.isValid() ? 0 : shownRows;
+}
+
+const TodoNode* TodoSearchModel::nodeAt(int row) const {
+    if (row < 0 || row >= shownRows) return nullptr;
+
+    int pageIndex = row / PageSize;
+    size_t offset = static_cast<size_t>(row % PageSize);
+    auto it = pages.find(pageIndex);
+    if (it == pages.end()) {
+        // Nearest pages stay; the farthest goes once over the cap
+        while (static_cast<int>(pages.size()) >= MaxResidentPages) {
+            auto farthest = std::max_element(pages.begin(), pages.end(),
+                [pageIndex](const auto& a, const auto& b) {
+                    return std::abs(a.first - pageIndex) < std::abs(b.first - pageIndex);
+                });
+            pages.erase(farthest);
+        }
+
+        const std::vector<int>& ids = search.matches();
+        int first = pageIndex * PageSize;
+        int last = std::min(shownRows, first + PageSize);
+        std::vector<TodoNode> nodes(last - first);
+        for (int i = first; i < last; i++) {
+            // A row deleted since it matched shows empty until the next restart()
+            if (auto todo = database->getTodoById(ids[i])) nodes[i - first].todo = *todo;
+        }
+        it = pages.emplace(pageIndex, std::move(nodes)).first;
+    }
+
+    if (offset >= it->second.size() || it->second[offset].todo.getId() == 0) return nullptr;
+    return &it->second[offset];
+}
+
+QVariant TodoSearchModel::data(const QModelIndex& index, int role) const {
+    if (!index.isValid()) return QVariant();
+
+    const TodoNode* node = nodeAt(index.row());
+    if (!node) return QVariant();
+    const Todo& todo = node->todo;
+
+    // The same rows as TodoListModel, so TodoItemDelegate paints them
+    switch (role) {
+    case Qt::DisplayRole:
+        return TodoListModel::displayText(*node, true);
+
+    case Qt::ForegroundRole:
+        if (todo.isCompleted()) {
+            return Theme::colors().completedText;
+        }
+        return QVariant();
+
+    case Qt::FontRole: {
+        QFont font;
+        if (todo.isCompleted()) {
+            font.setStrikeOut(true);
+        } else if (todo.isOverdue() || todo.getPriority() == 3) {
+            font.setBold(true);
+        }
+        return font;
+    }
+
+    case TodoListModel::TodoIdRole:
+        return todo.getId();
+    }
+
+    return QVariant();
+}
@@ -0,0 +1,70 @@
+#ifndef TODOSEARCHMODEL_H
+#define TODOSEARCHMODEL_H
+
+#include <QAbstractListModel>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <unordered_map>
+#include <vector>
+#include "database/TodoDatabase.h"
+#include "search/TodoSearch.h"
+
+// Results of the search field: a flat list in list order. Text that only
+// extends the current query narrows the matches already found on the next
+// turn of the event loop; anything else waits for typing to pause before
+// scanning from the top. The scan runs in slices of a few milliseconds
+// between events, appending rows as they match, and changing the text
+// stops it, so no stale results can land afterwards.
+//
+// Rows are ids until shown; the todos on screen are read a page at a time.
+class TodoSearchModel : public QAbstractListModel {
+    Q_OBJECT
+
+public:
+    static constexpr int DebounceMs = 120;   // Before a query that scans from the top
+    static constexpr int SliceBudgetMs = 8;  // Scanning per turn of the event loop
+    static constexpr int PageSize = 50;
+    static constexpr int MaxResidentPages = 8;
+
+    explicit TodoSearchModel(TodoDatabase* database, QObject* parent = nullptr);
+
+    void setQueryText(const QString& text);
+    QString queryText() const { return pendingText; }  // As last typed
+    bool isActive() const { return !pendingText.isEmpty(); }
+    bool isScanning() const { return sliceTimer.isActive() || debounceTimer.isActive(); }
+
+    // The current query again from the top; call after writes
+    void restart();
+    // After a bulk write, which leaves titles and descriptions and so the
+    // matches alone: loaded rows are rewritten where they are, and rows
+    // that moved in list order keep their place until the next query. A
+    // scan still under way restarts, as its cursor may have been passed.
+    void updateTodos(const std::vector<Todo>& before, const std::vector<Todo>& after);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+signals:
+    // After each slice; finished once every todo has been looked at
+    void progress(int matches, bool finished);
+
+private:
+    TodoDatabase* database;
+    TodoSearch search;
+    QString pendingText;
+    QTimer debounceTimer;
+    QTimer sliceTimer;
+    QElapsedTimer applied;  // Since the query was applied, until its first page
+    bool narrowed = false;
+    bool awaitingFirstPage = false;
+    int shownRows = 0;
+
+    mutable std::unordered_map<int, std::vector<TodoNode>> pages;
+
+    void applyQuery();
+    void scanSlice();
+    void publish();
+    const TodoNode* nodeAt(int row) const;
+};
+
+#endif // TODOSEARCHMODEL_H
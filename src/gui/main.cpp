@@ -1,11 +1,37 @@
 #include <QApplication>
+#include <optional>
 #include "MainWindow.h"
+#include "Theme.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
 
 int main(int argc, char *argv[]) {
-    QApplication app(argc, argv);
-    
-    MainWindow window;
-    window.show();
-    
-    return app.exec();
-}
\ No newline at end of file
+    // TODO_TRACE=<file> records startup phases and refreshes as a Chrome trace
+    std::optional<QApplication> app;
+    {
+        Trace::Span span("QApplication", "startup");
+        app.emplace(argc, argv);
+    }
+
+    // TODO_METRICS=<file> dumps counters and latencies while the app runs
+    std::unique_ptr<Metrics::Dumper> metricsDumper = Metrics::dumperFromEnvironment();
+
+    // One application-wide style sheet, set before any widget is polished
+    {
+        Trace::Span span("Theme::apply", "startup");
+        Theme::apply(*app, Theme::variantFromEnvironment());
+    }
+
+    std::optional<MainWindow> window;
+    {
+        Trace::Span span("MainWindow", "startup");
+        window.emplace();
+    }
+    {
+        // Polishes every widget against the style sheet
+        Trace::Span span("show", "startup");
+        window->show();
+    }
+
+    return app->exec();
+}
@@ -0,0 +1,489 @@
+#include "HttpServer.h"
+#include "metrics/Metrics.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+struct HttpServer::Connection {
+    int fd = -1;
+    uint64_t generation = 0;   // Tells a reused fd apart from the one a response was for
+    std::string in;
+    std::string out;
+    size_t outOffset = 0;
+    bool busy = false;         // A request is with the handler
+    bool closeAfterWrite = false;
+    bool wantWrite = false;    // EPOLLOUT registered
+    time_t lastActive = 0;
+};
+
+namespace {
+
+const int kMaxEvents = 256;
+
+Metrics::Gauge& openConnections() {
+    static Metrics::Gauge& gauge = Metrics::gauge("todo_server_connections", "Open client connections");
+    return gauge;
+}
+
+int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+std::string percentDecode(const std::string& text, bool plusIsSpace) {
+    std::string out;
+    out.reserve(text.size());
+    for (size_t i = 0; i < text.size(); i++) {
+        char c = text[i];
+        if (c == '%' && i + 2 < text.size() && hexValue(text[i + 1]) >= 0 && hexValue(text[i + 2]) >= 0) {
+            out += static_cast<char>(hexValue(text[i + 1]) << 4 | hexValue(text[i + 2]));
+            i += 2;
+        } else if (c == '+' && plusIsSpace) {
+            out += ' ';
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+const char* reasonPhrase(int status) {
+    switch (status) {
+        case 200: return "OK";
+        case 201: return "Created";
+        case 204: return "No Content";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 409: return "Conflict";
+        case 411: return "Length Required";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 500: return "Internal Server Error";
+        case 501: return "Not Implemented";
+        case 503: return "Service Unavailable";
+        default: return "Unknown";
+    }
+}
+
+bool equalsIgnoreCase(const std::string& a, const char* b) {
+    size_t length = std::strlen(b);
+    if (a.size() != length) return false;
+    for (size_t i = 0; i < length; i++) {
+        if (std::tolower(static_cast<unsigned char>(a[i])) != std::tolower(static_cast<unsigned char>(b[i]))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+HttpResponse errorResponse(int status, const std::string& message) {
+    HttpResponse response;
+    response.status = status;
+    response.body = "{\"error\":\"" + message + "\"}";
+    return response;
+}
+
+} // namespace
+
+std::optional<std::string> HttpRequest::param(const std::string& name) const {
+    size_t start = 0;
+    while (start <= query.size()) {
+        size_t end = query.find('&', start);
+        if (end == std::string::npos) end = query.size();
+
+        std::string pair = query.substr(start, end - start);
+        size_t equals = pair.find('=');
+        std::string key = percentDecode(pair.substr(0, equals), true);
+        if (key == name) {
+            return equals == std::string::npos ? std::string() : percentDecode(pair.substr(equals + 1), true);
+        }
+        start = end + 1;
+    }
+    return std::nullopt;
+}
+
+HttpServer::HttpServer(Handler handler)
+    : handler(std::move(handler)) {
+}
+
+HttpServer::~HttpServer() {
+    for (auto& [fd, connection] : connections) {
+        ::close(fd);
+    }
+    if (listenFd >= 0) ::close(listenFd);
+    if (epollFd >= 0) ::close(epollFd);
+    if (wakeFd >= 0) ::close(wakeFd);
+}
+
+bool HttpServer::listen(const std::string& host, uint16_t port) {
+    listenFd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        std::cerr << "socket failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    int enable = 1;
+    ::setsockopt(listenFd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+        std::cerr << "Invalid listen address " << host << std::endl;
+        return false;
+    }
+
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        std::cerr << "Listen on " << host << ":" << port << " failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    socklen_t length = sizeof(address);
+    ::getsockname(listenFd, reinterpret_cast<sockaddr*>(&address), &length);
+    boundPort = ntohs(address.sin_port);
+
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (epollFd < 0 || wakeFd < 0) {
+        std::cerr << "epoll setup failed: " << std::strerror(errno) << std::endl;
+        return false;
+    }
+
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event);
+    event.data.fd = wakeFd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event);
+    return true;
+}
+
+void HttpServer::run() {
+    epoll_event events[kMaxEvents];
+    time_t lastIdleCheck = std::time(nullptr);
+
+    while (!stopping) {
+        int count = ::epoll_wait(epollFd, events, kMaxEvents, 1000);
+        if (count < 0) {
+            if (errno == EINTR) continue;
+            std::cerr << "epoll_wait failed: " << std::strerror(errno) << std::endl;
+            break;
+        }
+
+        for (int i = 0; i < count; i++) {
+            int fd = events[i].data.fd;
+            if (fd == listenFd) {
+                acceptConnections();
+                continue;
+            }
+            if (fd == wakeFd) {
+                uint64_t value;
+                while (::read(wakeFd, &value, sizeof(value)) > 0) {}
+                drainCompletions();
+                continue;
+            }
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) continue;
+            Connection& connection = *it->second;
+
+            if (events[i].events & (EPOLLERR | EPOLLHUP)) {
+                closeConnection(fd);
+                continue;
+            }
+            if (events[i].events & EPOLLOUT) {
+                writeTo(connection);
+                if (connections.find(fd) == connections.end()) continue;
+            }
+            if (events[i].events & (EPOLLIN | EPOLLRDHUP)) {
+                readFrom(connection);
+            }
+        }
+
+        time_t now = std::time(nullptr);
+        if (now != lastIdleCheck) {
+            lastIdleCheck = now;
+            closeIdle();
+        }
+    }
+}
+
+void HttpServer::stop() {
+    stopping = true;
+    uint64_t one = 1;
+    if (wakeFd >= 0) {
+        [[maybe_unused]] ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    }
+}
+
+void HttpServer::acceptConnections() {
+    while (true) {
+        int fd = ::accept4(listenFd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            if (errno == EINTR) continue;
+            // EAGAIN: backlog drained; EMFILE and friends: retry on the next event
+            return;
+        }
+
+        // Responses are written whole; don't hold the last segment back
+        int enable = 1;
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->generation = nextGeneration++;
+        connection->lastActive = std::time(nullptr);
+
+        epoll_event event = {};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.fd = fd;
+        if (::epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            ::close(fd);
+            continue;
+        }
+        connections[fd] = std::move(connection);
+        openConnections().set(static_cast<int64_t>(connections.size()));
+    }
+}
+
+void HttpServer::readFrom(Connection& connection) {
+    char buffer[16 * 1024];
+    int fd = connection.fd;
+
+    while (true) {
+        ssize_t count = ::recv(fd, buffer, sizeof(buffer), 0);
+        if (count > 0) {
+            connection.in.append(buffer, static_cast<size_t>(count));
+            if (connection.in.size() > maxHeaderBytes + maxBodyBytes) break;  // Checked below
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) break;
+
+        // Peer closed or failed; an in-flight response has nowhere to go
+        closeConnection(fd);
+        return;
+    }
+
+    connection.lastActive = std::time(nullptr);
+    processBuffer(connection);
+}
+
+void HttpServer::processBuffer(Connection& connection) {
+    if (connection.busy || connection.closeAfterWrite) return;
+
+    size_t headerEnd = connection.in.find("\r\n\r\n");
+    if (headerEnd == std::string::npos) {
+        if (connection.in.size() > maxHeaderBytes) {
+            queueResponse(connection, errorResponse(431, "headers too large"), false);
+        }
+        return;
+    }
+    if (headerEnd > maxHeaderBytes) {
+        queueResponse(connection, errorResponse(431, "headers too large"), false);
+        return;
+    }
+
+    HttpRequest request;
+    std::string version;
+
+    size_t lineEnd = connection.in.find("\r\n");
+    {
+        std::string line = connection.in.substr(0, lineEnd);
+        size_t first = line.find(' ');
+        size_t second = first == std::string::npos ? std::string::npos : line.find(' ', first + 1);
+        if (second == std::string::npos) {
+            queueResponse(connection, errorResponse(400, "malformed request line"), false);
+            return;
+        }
+        request.method = line.substr(0, first);
+        std::string target = line.substr(first + 1, second - first - 1);
+        version = line.substr(second + 1);
+
+        size_t question = target.find('?');
+        request.path = percentDecode(target.substr(0, question), false);
+        if (question != std::string::npos) request.query = target.substr(question + 1);
+    }
+
+    request.keepAlive = version == "HTTP/1.1";
+    size_t contentLength = 0;
+    bool chunked = false;
+
+    size_t pos = lineEnd + 2;
+    while (pos < headerEnd) {
+        size_t end = connection.in.find("\r\n", pos);
+        size_t colon = connection.in.find(':', pos);
+        if (colon == std::string::npos || colon > end) {
+            queueResponse(connection, errorResponse(400, "malformed header"), false);
+            return;
+        }
+
+        std::string name = connection.in.substr(pos, colon - pos);
+        size_t valueStart = connection.in.find_first_not_of(" \t", colon + 1);
+        std::string value = valueStart < end ? connection.in.substr(valueStart, end - valueStart) : "";
+        while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.pop_back();
+
+        if (equalsIgnoreCase(name, "content-length")) {
+            char* parsedEnd = nullptr;
+            unsigned long long length = std::strtoull(value.c_str(), &parsedEnd, 10);
+            if (value.empty() || *parsedEnd != '\0') {
+                queueResponse(connection, errorResponse(400, "bad content-length"), false);
+                return;
+            }
+            contentLength = static_cast<size_t>(length);
+        } else if (equalsIgnoreCase(name, "connection")) {
+            if (equalsIgnoreCase(value, "close")) request.keepAlive = false;
+            else if (equalsIgnoreCase(value, "keep-alive")) request.keepAlive = true;
+        } else if (equalsIgnoreCase(name, "transfer-encoding")) {
+            chunked = !equalsIgnoreCase(value, "identity");
+        }
+        pos = end + 2;
+    }
+
+    if (chunked) {
+        queueResponse(connection, errorResponse(501, "chunked bodies are not supported"), false);
+        return;
+    }
+    if (contentLength > maxBodyBytes) {
+        queueResponse(connection, errorResponse(413, "body too large"), false);
+        return;
+    }
+
+    size_t bodyStart = headerEnd + 4;
+    if (connection.in.size() < bodyStart + contentLength) return;  // Wait for the rest
+
+    request.body = connection.in.substr(bodyStart, contentLength);
+    connection.in.erase(0, bodyStart + contentLength);
+    connection.busy = true;
+
+    int fd = connection.fd;
+    uint64_t generation = connection.generation;
+    bool keepAlive = request.keepAlive;
+    handler(request, [this, fd, generation, keepAlive](HttpResponse response) {
+        {
+            std::lock_guard<std::mutex> lock(completionMutex);
+            completions.push_back({fd, generation, std::move(response), keepAlive});
+        }
+        uint64_t one = 1;
+        [[maybe_unused]] ssize_t written = ::write(wakeFd, &one, sizeof(one));
+    });
+}
+
+void HttpServer::drainCompletions() {
+    std::deque<Completion> ready;
+    {
+        std::lock_guard<std::mutex> lock(completionMutex);
+        ready.swap(completions);
+    }
+
+    for (Completion& completion : ready) {
+        auto it = connections.find(completion.fd);
+        if (it == connections.end() || it->second->generation != completion.generation) continue;
+
+        Connection& connection = *it->second;
+        connection.busy = false;
+        queueResponse(connection, completion.response, completion.keepAlive);
+
+        // The next pipelined request may already be buffered
+        it = connections.find(completion.fd);
+        if (it != connections.end() && it->second->generation == completion.generation) {
+            processBuffer(*it->second);
+        }
+    }
+}
+
+void HttpServer::queueResponse(Connection& connection, const HttpResponse& response, bool keepAlive) {
+    std::string& out = connection.out;
+    out += "HTTP/1.1 ";
+    out += std::to_string(response.status);
+    out += ' ';
+    out += reasonPhrase(response.status);
+    out += "\r\nContent-Type: ";
+    out += response.contentType;
+    out += "\r\nContent-Length: ";
+    out += std::to_string(response.body.size());
+    out += keepAlive ? "\r\nConnection: keep-alive\r\n\r\n" : "\r\nConnection: close\r\n\r\n";
+    out += response.body;
+
+    if (!keepAlive) connection.closeAfterWrite = true;
+    writeTo(connection);
+}
+
+void HttpServer::writeTo(Connection& connection) {
+    int fd = connection.fd;
+
+    while (connection.outOffset < connection.out.size()) {
+        ssize_t count = ::send(fd, connection.out.data() + connection.outOffset,
+                               connection.out.size() - connection.outOffset, MSG_NOSIGNAL);
+        if (count > 0) {
+            connection.outOffset += static_cast<size_t>(count);
+            continue;
+        }
+        if (count < 0 && errno == EINTR) continue;
+        if (count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            if (!connection.wantWrite) {
+                connection.wantWrite = true;
+                updateInterest(connection);
+            }
+            return;
+        }
+        closeConnection(fd);
+        return;
+    }
+
+    connection.out.clear();
+    connection.outOffset = 0;
+    connection.lastActive = std::time(nullptr);
+
+    if (connection.closeAfterWrite) {
+        closeConnection(fd);
+        return;
+    }
+    if (connection.wantWrite) {
+        connection.wantWrite = false;
+        updateInterest(connection);
+    }
+}
+
+void HttpServer::updateInterest(Connection& connection) {
+    epoll_event event = {};
+    event.events = EPOLLIN | EPOLLRDHUP | (connection.wantWrite ? static_cast<uint32_t>(EPOLLOUT) : 0u);
+    event.data.fd = connection.fd;
+    ::epoll_ctl(epollFd, EPOLL_CTL_MOD, connection.fd, &event);
+}
+
+void HttpServer::closeIdle() {
+    time_t now = std::time(nullptr);
+    std::vector<int> idle;
+    for (const auto& [fd, connection] : connections) {
+        if (!connection->busy && now - connection->lastActive > idleTimeoutSeconds) {
+            idle.push_back(fd);
+        }
+    }
+    for (int fd : idle) {
+        closeConnection(fd);
+    }
+}
+
+void HttpServer::closeConnection(int fd) {
+    ::epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, nullptr);
+    ::close(fd);
+    connections.erase(fd);
+    openConnections().set(static_cast<int64_t>(connections.size()));
+}
@@ -0,0 +1,90 @@
+#ifndef HTTP_SERVER_H
+#define HTTP_SERVER_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+struct HttpRequest {
+    std::string method;
+    std::string path;   // Decoded, without the query
+    std::string query;  // Raw, after '?'
+    std::string body;
+    bool keepAlive = true;
+
+    // Decoded value of a query parameter
+    std::optional<std::string> param(const std::string& name) const;
+};
+
+struct HttpResponse {
+    int status = 200;
+    std::string contentType = "application/json";
+    std::string body;
+};
+
+// Single-threaded HTTP/1.1 server on epoll. Connections are kept alive and
+// handle one request at a time; pipelined requests wait in the read buffer.
+// The handler may answer later from any thread by calling respond once.
+class HttpServer {
+public:
+    using Respond = std::function<void(HttpResponse)>;
+    using Handler = std::function<void(const HttpRequest&, Respond)>;
+
+    explicit HttpServer(Handler handler);
+    ~HttpServer();
+
+    HttpServer(const HttpServer&) = delete;
+    HttpServer& operator=(const HttpServer&) = delete;
+
+    bool listen(const std::string& host, uint16_t port);
+    uint16_t port() const { return boundPort; }
+
+    // Runs the event loop until stop()
+    void run();
+    void stop();  // Any thread
+
+    size_t maxBodyBytes = 1 << 20;
+    size_t maxHeaderBytes = 16 * 1024;
+    int idleTimeoutSeconds = 60;
+
+private:
+    struct Connection;
+    struct Completion {
+        int fd;
+        uint64_t generation;
+        HttpResponse response;
+        bool keepAlive;
+    };
+
+    Handler handler;
+    int listenFd = -1;
+    int epollFd = -1;
+    int wakeFd = -1;  // eventfd: completions are waiting or stop() was called
+    uint16_t boundPort = 0;
+    std::atomic<bool> stopping{false};
+    uint64_t nextGeneration = 1;
+
+    std::unordered_map<int, std::unique_ptr<Connection>> connections;
+
+    std::mutex completionMutex;
+    std::deque<Completion> completions;
+
+    void acceptConnections();
+    void readFrom(Connection& connection);
+    void writeTo(Connection& connection);
+    void processBuffer(Connection& connection);
+    void queueResponse(Connection& connection, const HttpResponse& response, bool keepAlive);
+    void drainCompletions();
+    void closeIdle();
+    void closeConnection(int fd);
+    void updateInterest(Connection& connection);
+};
+
+#endif // HTTP_SERVER_H
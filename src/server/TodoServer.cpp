@@ -0,0 +1,586 @@
+// JSON over HTTP access to todos.db for local tools and the phone companion,
+// so they don't open the SQLite file themselves.
+//
+//   todo_server [--db PATH] [--host 127.0.0.1] [--port 8080]
+//
+//   GET    /todos?category=&limit=&after=   page in list order; "next" is the
+//                                           cursor for the following page
+//   POST   /todos                           create from a JSON object
+//   GET    /todos/{id}
+//   PUT    /todos/{id}                      update the fields present (PATCH too)
+//   DELETE /todos/{id}
+//   GET    /search?q=&limit=
+//   GET    /changes?since=&limit=           sync log entries after a seq
+//   GET    /stats
+//   GET    /metrics                         Prometheus text, answered without the database
+//
+// The epoll loop only moves bytes. One worker thread owns the database and
+// runs requests in arrival order; writes that queue up behind each other
+// share one transaction (group commit), and their responses are sent once it
+// has committed.
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <future>
+#include <memory>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "HttpServer.h"
+#include "database/TodoDatabase.h"
+#include "io/TodoJson.h"
+#include "metrics/Metrics.h"
+
+namespace {
+
+const size_t kMaxQueuedRequests = 10000;
+const size_t kMaxGroupCommit = 64;
+const int kDefaultPageSize = 50;
+const int kMaxPageSize = 1000;
+
+HttpResponse jsonResponse(int status, const std::string& body) {
+    HttpResponse response;
+    response.status = status;
+    response.body = body;
+    return response;
+}
+
+HttpResponse errorResponse(int status, const std::string& message) {
+    std::ostringstream body;
+    body << "{\"error\":";
+    writeJsonString(body, message);
+    body << "}";
+    return jsonResponse(status, body.str());
+}
+
+std::string todoJson(const Todo& todo) {
+    std::ostringstream out;
+    writeTodoJson(out, todo);
+    return out.str();
+}
+
+bool parseInteger(const std::string& text, long long& value) {
+    if (text.empty()) return false;
+    char* end = nullptr;
+    value = std::strtoll(text.c_str(), &end, 10);
+    return *end == '\0';
+}
+
+int pageLimit(const HttpRequest& request) {
+    long long limit = kDefaultPageSize;
+    if (auto text = request.param("limit")) {
+        if (!parseInteger(*text, limit) || limit < 1) limit = kDefaultPageSize;
+    }
+    return static_cast<int>(std::min<long long>(limit, kMaxPageSize));
+}
+
+// completed.priority.due.created.id, with "n" for no due date
+std::string encodeCursor(const TodoPageCursor& cursor) {
+    std::ostringstream out;
+    out << (cursor.completed ? 1 : 0) << '.' << cursor.priority << '.';
+    if (cursor.due_date) out << *cursor.due_date;
+    else out << 'n';
+    out << '.' << cursor.created_at << '.' << cursor.id;
+    return out.str();
+}
+
+bool decodeCursor(const std::string& text, TodoPageCursor& cursor) {
+    std::vector<std::string> parts;
+    std::string part;
+    std::istringstream in(text);
+    while (std::getline(in, part, '.')) parts.push_back(part);
+    if (parts.size() != 5) return false;
+
+    long long completed, priority, created, id;
+    if (!parseInteger(parts[0], completed) || !parseInteger(parts[1], priority) ||
+        !parseInteger(parts[3], created) || !parseInteger(parts[4], id)) {
+        return false;
+    }
+    cursor.completed = completed != 0;
+    cursor.priority = static_cast<int>(priority);
+    cursor.created_at = static_cast<time_t>(created);
+    cursor.id = static_cast<int>(id);
+
+    if (parts[2] == "n") {
+        cursor.due_date.reset();
+    } else {
+        long long due;
+        if (!parseInteger(parts[2], due)) return false;
+        cursor.due_date = static_cast<time_t>(due);
+    }
+    return true;
+}
+
+// Applies the members of a JSON body to todo. Unknown keys are ignored.
+bool applyFields(const std::string& body, Todo& todo, bool requireTitle, std::string& error) {
+    std::unordered_map<std::string, std::optional<std::string>> fields;
+    if (!readJsonObject(body, [&fields](const std::string& key, std::optional<std::string> value) {
+            fields[key] = std::move(value);
+        }, error)) {
+        return false;
+    }
+
+    auto field = [&fields](const char* name) -> const std::optional<std::string>* {
+        auto it = fields.find(name);
+        return it == fields.end() ? nullptr : &it->second;
+    };
+
+    if (auto* title = field("title")) {
+        if (!*title || (*title)->empty()) {
+            error = "title must be a non-empty string";
+            return false;
+        }
+        todo.setTitle(**title);
+    } else if (requireTitle) {
+        error = "title is required";
+        return false;
+    }
+
+    if (auto* description = field("description")) {
+        todo.setDescription(description->value_or(""));
+    }
+    if (auto* category = field("category")) {
+        todo.setCategory(*category && !(*category)->empty() ? **category : "general");
+    }
+    if (auto* priority = field("priority")) {
+        long long value;
+        if (!*priority || !parseInteger(**priority, value) || value < 1 || value > 3) {
+            error = "priority must be 1, 2 or 3";
+            return false;
+        }
+        todo.setPriority(static_cast<int>(value));
+    }
+    if (auto* completed = field("completed")) {
+        if (!*completed || (**completed != "true" && **completed != "false")) {
+            error = "completed must be true or false";
+            return false;
+        }
+        todo.setCompleted(**completed == "true");
+    }
+    if (auto* due = field("due_date")) {
+        long long value;
+        if (!*due) {
+            todo.clearDueDate();
+        } else if (parseInteger(**due, value)) {
+            todo.setDueDate(static_cast<time_t>(value));
+        } else {
+            error = "due_date must be unix seconds or null";
+            return false;
+        }
+    }
+    if (auto* parent = field("parent_id")) {
+        long long value;
+        if (!*parent) {
+            todo.setParentId(std::nullopt);
+        } else if (parseInteger(**parent, value) && value > 0 && value <= INT32_MAX) {
+            todo.setParentId(static_cast<int>(value));
+        } else {
+            error = "parent_id must be a todo id or null";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string hex(const std::string& bytes) {
+    static const char digits[] = "0123456789abcdef";
+    std::string out;
+    out.reserve(bytes.size() * 2);
+    for (unsigned char c : bytes) {
+        out += digits[c >> 4];
+        out += digits[c & 0xf];
+    }
+    return out;
+}
+
+HttpResponse listTodos(TodoDatabase& db, const HttpRequest& request) {
+    int limit = pageLimit(request);
+
+    std::optional<TodoPageCursor> after;
+    if (auto text = request.param("after"); text && !text->empty()) {
+        TodoPageCursor cursor;
+        if (!decodeCursor(*text, cursor)) return errorResponse(400, "invalid cursor");
+        after = cursor;
+    }
+
+    std::optional<std::string> category = request.param("category");
+    if (category && category->empty()) category.reset();
+
+    std::vector<Todo> page = db.getTodosPage(after, limit, category);
+
+    std::ostringstream body;
+    body << "{\"todos\":[";
+    for (size_t i = 0; i < page.size(); i++) {
+        if (i) body << ',';
+        writeTodoJson(body, page[i]);
+    }
+    body << "],\"next\":";
+    if (static_cast<int>(page.size()) == limit) {
+        writeJsonString(body, encodeCursor(TodoPageCursor::fromTodo(page.back())));
+    } else {
+        body << "null";
+    }
+    body << "}";
+    return jsonResponse(200, body.str());
+}
+
+HttpResponse searchTodos(TodoDatabase& db, const HttpRequest& request) {
+    std::optional<std::string> query = request.param("q");
+    if (!query || query->empty()) return errorResponse(400, "q is required");
+
+    int limit = pageLimit(request);
+    int count = 0;
+
+    std::ostringstream body;
+    body << "{\"todos\":[";
+    bool ok = db.searchTodos(*query, [&](const Todo& todo) {
+        if (count++) body << ',';
+        writeTodoJson(body, todo);
+        return count < limit;
+    });
+    body << "]}";
+
+    if (!ok) return errorResponse(500, "search failed");
+    return jsonResponse(200, body.str());
+}
+
+HttpResponse listChanges(TodoDatabase& db, const HttpRequest& request) {
+    long long since = 0;
+    if (auto text = request.param("since"); text && !parseInteger(*text, since)) {
+        return errorResponse(400, "since must be a sequence number");
+    }
+    int limit = pageLimit(request);
+
+    int count = 0;
+    bool more = false;
+    int64_t lastSeq = since;
+
+    std::ostringstream body;
+    body << "{\"changes\":[";
+    bool ok = db.forEachSyncChange(since, std::string(), [&](const SyncRecord& record) {
+        if (count == limit) {
+            more = true;
+            return false;
+        }
+        if (count++) body << ',';
+
+        body << "{\"seq\":" << record.seq << ",\"uuid\":\"" << hex(record.uuid)
+             << "\",\"deleted\":" << (record.deleted ? "true" : "false")
+             << ",\"modified_at\":" << record.modified_at << ",\"origin\":";
+        writeJsonString(body, record.origin);
+        body << ",\"origin_seq\":" << record.origin_seq << ",\"todo\":";
+        if (record.deleted) {
+            body << "null";
+        } else {
+            writeTodoJson(body, record.todo);
+        }
+        body << "}";
+        lastSeq = record.seq;
+        return true;
+    });
+    body << "],\"last_seq\":" << lastSeq << ",\"more\":" << (more ? "true" : "false") << "}";
+
+    if (!ok) return errorResponse(500, "reading changes failed");
+    return jsonResponse(200, body.str());
+}
+
+HttpResponse todoById(TodoDatabase& db, const HttpRequest& request, int id) {
+    if (request.method == "GET") {
+        std::unique_ptr<Todo> todo = db.getTodoById(id);
+        if (!todo) return errorResponse(404, "no todo " + std::to_string(id));
+        return jsonResponse(200, todoJson(*todo));
+    }
+
+    if (request.method == "PUT" || request.method == "PATCH") {
+        std::unique_ptr<Todo> todo = db.getTodoById(id);
+        if (!todo) return errorResponse(404, "no todo " + std::to_string(id));
+
+        std::optional<int> oldParent = todo->getParentId();
+        std::string error;
+        if (!applyFields(request.body, *todo, false, error)) return errorResponse(400, error);
+        // A move goes first: the database refuses one into the todo's own subtree
+        if (todo->getParentId() != oldParent && !db.moveTodo(id, todo->getParentId())) {
+            return errorResponse(409, "parent_id is missing or inside this todo's subtree");
+        }
+        if (!db.updateTodo(*todo)) return errorResponse(500, "update failed");
+        return jsonResponse(200, todoJson(*todo));
+    }
+
+    if (request.method == "DELETE") {
+        if (!db.getTodoById(id)) return errorResponse(404, "no todo " + std::to_string(id));
+        if (!db.deleteTodo(id)) return errorResponse(500, "delete failed");
+        HttpResponse response;
+        response.status = 204;
+        return response;
+    }
+
+    return errorResponse(405, request.method + " is not allowed on /todos/{id}");
+}
+
+HttpResponse route(TodoDatabase& db, const HttpRequest& request) {
+    const std::string& path = request.path;
+
+    if (path == "/todos") {
+        if (request.method == "GET") return listTodos(db, request);
+        if (request.method == "POST") {
+            Todo todo;
+            std::string error;
+            if (!applyFields(request.body, todo, true, error)) return errorResponse(400, error);
+            if (todo.getParentId() && !db.getTodoById(*todo.getParentId())) {
+                return errorResponse(409, "no parent todo " + std::to_string(*todo.getParentId()));
+            }
+            if (!db.createTodo(todo)) return errorResponse(500, "create failed");
+            return jsonResponse(201, todoJson(todo));
+        }
+        return errorResponse(405, request.method + " is not allowed on /todos");
+    }
+
+    if (path.compare(0, 7, "/todos/") == 0) {
+        long long id;
+        if (!parseInteger(path.substr(7), id) || id <= 0 || id > INT32_MAX) {
+            return errorResponse(404, "no such todo");
+        }
+        return todoById(db, request, static_cast<int>(id));
+    }
+
+    if (request.method != "GET") {
+        return errorResponse(path == "/search" || path == "/changes" || path == "/stats" ? 405 : 404,
+                             request.method + " " + path + " is not supported");
+    }
+    if (path == "/search") return searchTodos(db, request);
+    if (path == "/changes") return listChanges(db, request);
+    if (path == "/stats") {
+        TodoCounts counts = db.getTodoCounts();
+        std::ostringstream body;
+        body << "{\"total\":" << counts.total << ",\"completed\":" << counts.completed
+             << ",\"overdue\":" << counts.overdue << "}";
+        return jsonResponse(200, body.str());
+    }
+
+    return errorResponse(404, "no route for " + path);
+}
+
+bool isWrite(const HttpRequest& request) {
+    return request.method != "GET" && request.method != "HEAD";
+}
+
+Metrics::Gauge& queueDepth() {
+    static Metrics::Gauge& gauge = Metrics::gauge("todo_server_queue_depth", "Requests waiting for the database worker");
+    return gauge;
+}
+
+// Wraps respond to record the time from arrival to response, and the status class
+HttpServer::Respond timedResponder(const HttpRequest& request, HttpServer::Respond respond) {
+    static Metrics::Histogram& readLatency = Metrics::histogram(
+        "todo_server_request_seconds", "Time from a complete request to its response", {{"kind", "read"}});
+    static Metrics::Histogram& writeLatency = Metrics::histogram(
+        "todo_server_request_seconds", "Time from a complete request to its response", {{"kind", "write"}});
+    static Metrics::Counter* responses[] = {
+        &Metrics::counter("todo_server_responses_total", "Responses by status class", {{"code", "2xx"}}),
+        &Metrics::counter("todo_server_responses_total", "Responses by status class", {{"code", "3xx"}}),
+        &Metrics::counter("todo_server_responses_total", "Responses by status class", {{"code", "4xx"}}),
+        &Metrics::counter("todo_server_responses_total", "Responses by status class", {{"code", "5xx"}}),
+    };
+
+    Metrics::Histogram* latency = isWrite(request) ? &writeLatency : &readLatency;
+    auto start = std::chrono::steady_clock::now();
+    return [respond = std::move(respond), latency, start](HttpResponse response) {
+        latency->recordNs(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        responses[std::clamp(response.status / 100 - 2, 0, 3)]->add();
+        respond(std::move(response));
+    };
+}
+
+// Owns the connection; everything that touches SQLite runs here
+class DatabaseWorker {
+public:
+    struct Job {
+        HttpRequest request;
+        HttpServer::Respond respond;
+    };
+
+    bool start(const std::string& path) {
+        std::promise<bool> opened;
+        std::future<bool> result = opened.get_future();
+        thread = std::thread([this, path, &opened]() {
+            TodoDatabase db(path);
+            bool ok = db.isOpen() && db.initialize();
+            opened.set_value(ok);
+            if (ok) run(db);
+        });
+
+        if (!result.get()) {
+            thread.join();
+            return false;
+        }
+        return true;
+    }
+
+    // false when the queue is full; the caller answers 503
+    bool post(Job job) {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (jobs.size() >= kMaxQueuedRequests) return false;
+        jobs.push_back(std::move(job));
+        queueDepth().set(static_cast<int64_t>(jobs.size()));
+        wake.notify_one();
+        return true;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+            wake.notify_one();
+        }
+        if (thread.joinable()) thread.join();
+    }
+
+private:
+    std::thread thread;
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::deque<Job> jobs;
+    bool stopping = false;
+
+    void run(TodoDatabase& db) {
+        std::vector<Job> batch;
+        std::vector<HttpResponse> responses;
+
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [this]() { return stopping || !jobs.empty(); });
+                if (jobs.empty()) return;  // Stopping with nothing left
+
+                while (!jobs.empty() && batch.size() < kMaxGroupCommit) {
+                    batch.push_back(std::move(jobs.front()));
+                    jobs.pop_front();
+                }
+                queueDepth().set(static_cast<int64_t>(jobs.size()));
+            }
+
+            size_t writes = 0;
+            for (const Job& job : batch) {
+                if (isWrite(job.request)) writes++;
+            }
+
+            // One fsync for all the writes that queued up meanwhile
+            bool grouped = writes > 1 && db.beginTransaction();
+            if (grouped) {
+                static Metrics::Counter& commits = Metrics::counter(
+                    "todo_server_group_commits_total", "Transactions shared by more than one write");
+                static Metrics::Counter& groupedWrites = Metrics::counter(
+                    "todo_server_grouped_writes_total", "Writes that shared a transaction");
+                commits.add();
+                groupedWrites.add(writes);
+            }
+
+            responses.clear();
+            for (const Job& job : batch) {
+                responses.push_back(route(db, job.request));
+            }
+
+            if (grouped && !db.commitTransaction()) {
+                db.rollbackTransaction();
+                for (size_t i = 0; i < batch.size(); i++) {
+                    if (isWrite(batch[i].request)) responses[i] = errorResponse(500, "commit failed");
+                }
+            }
+
+            for (size_t i = 0; i < batch.size(); i++) {
+                batch[i].respond(std::move(responses[i]));
+            }
+            batch.clear();
+        }
+    }
+};
+
+HttpServer* runningServer = nullptr;
+
+void handleSignal(int) {
+    if (runningServer) runningServer->stop();
+}
+
+void printUsage() {
+    std::cerr << "Usage: todo_server [--db PATH] [--host ADDRESS] [--port N]\n"
+                 "The database defaults to $TODO_DB, then todos.db.\n";
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    const char* envPath = std::getenv("TODO_DB");
+    std::string dbPath = envPath ? envPath : "todos.db";
+    std::string host = "127.0.0.1";
+    long long port = 8080;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            printUsage();
+            return 2;
+        }
+        if (arg == "--db") dbPath = argv[++i];
+        else if (arg == "--host") host = argv[++i];
+        else if (arg == "--port") {
+            if (!parseInteger(argv[++i], port) || port < 0 || port > 65535) {
+                printUsage();
+                return 2;
+            }
+        } else {
+            printUsage();
+            return 2;
+        }
+    }
+
+    DatabaseWorker worker;
+    if (!worker.start(dbPath)) {
+        std::cerr << "todo_server: could not open " << dbPath << std::endl;
+        return 1;
+    }
+
+    std::unique_ptr<Metrics::Dumper> metricsDumper = Metrics::dumperFromEnvironment();
+
+    HttpServer server([&worker](const HttpRequest& request, HttpServer::Respond respond) {
+        respond = timedResponder(request, std::move(respond));
+
+        if (request.path == "/metrics" && request.method == "GET") {
+            HttpResponse response;
+            response.contentType = "text/plain; version=0.0.4";
+            response.body = Metrics::prometheusText();
+            respond(std::move(response));
+            return;
+        }
+        if (!worker.post({request, respond})) {
+            respond(errorResponse(503, "server busy"));
+        }
+    });
+
+    if (!server.listen(host, static_cast<uint16_t>(port))) {
+        worker.stop();
+        return 1;
+    }
+
+    runningServer = &server;
+    std::signal(SIGINT, handleSignal);
+    std::signal(SIGTERM, handleSignal);
+
+    std::cerr << "todo_server: serving " << dbPath << " on http://" << host << ":" << server.port()
+              << std::endl;
+    server.run();
+
+    // Finish queued requests before the server (and their connections) go away
+    worker.stop();
+    runningServer = nullptr;
+    return 0;
+}
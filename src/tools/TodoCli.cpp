@@ -0,0 +1,735 @@
+// Command-line access to todos.db for scripting. Links only TodoCore, so it
+// starts without Qt; list, filter and search stream rows straight from the
+// database cursor and use constant memory regardless of table size.
+//
+//   todo [--db PATH] [--json] <command> [args]
+//
+// With --json every todo is printed as one JSON object per line (JSON Lines)
+// and other results as a single JSON object.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "analytics/TodoAnalytics.h"
+#include "database/TodoDatabase.h"
+#include "io/TodoExporter.h"
+#include "io/TodoImporter.h"
+#include "io/TodoJson.h"
+#include "metrics/Metrics.h"
+#include "metrics/Trace.h"
+#include "sync/TodoSync.h"
+
+namespace {
+
+struct Arguments {
+    std::string dbPath;
+    bool json = false;
+    bool undo = false;
+    bool openOnly = false;
+    bool keepIndexes = false;
+    bool verify = false;
+    bool profile = false;
+    long long limit = -1;
+    std::optional<std::string> description;
+    std::optional<std::string> category;
+    std::optional<std::string> priority;
+    std::optional<std::string> due;
+    std::optional<std::string> parent;
+    std::optional<std::string> format;
+    std::optional<std::string> by;
+    long long days = -1;
+    size_t batch = 50000;
+    std::vector<std::string> positional;
+};
+
+void printUsage() {
+    std::cerr <<
+        "Usage: todo [--db PATH] [--json] [--profile] <command> [args]\n"
+        "\n"
+        "Commands:\n"
+        "  add <title> [--desc TEXT] [--category NAME] [--priority 1-3] [--due YYYY-MM-DD]\n"
+        "      [--parent ID]\n"
+        "  list [--category NAME] [--open] [--limit N]\n"
+        "  filter <category> [--open] [--limit N]\n"
+        "  complete <id>... [--undo]\n"
+        "  delete <id>...                (with their subtasks)\n"
+        "  move <id> <parent-id|top>\n"
+        "  place <id> <before-id|end>    (manual order, among before-id's siblings)\n"
+        "  tree <id>                     (subtasks and progress)\n"
+        "  search <text> [--limit N]\n"
+        "  stats [--verify]              (--verify recounts, and repairs if off)\n"
+        "  report [--by day|week|month] [--days N]\n"
+        "                                (completions, lead time and late rate)\n"
+        "  import <file> [--format csv|jsonl] [--batch N] [--keep-indexes]\n"
+        "  export <file|-> [--format csv|jsonl|ics] [--category NAME]\n"
+        "  sync <other.db>\n"
+        "\n"
+        "The database defaults to $TODO_DB, then todos.db. --profile prints per-statement\n"
+        "timings, rows scanned and the query plans of scanning statements to stderr.\n";
+}
+
+int fail(const std::string& message) {
+    std::cerr << "todo: " << message << std::endl;
+    return 1;
+}
+
+bool parseArguments(int argc, char* argv[], Arguments& args) {
+    const char* envPath = std::getenv("TODO_DB");
+    args.dbPath = envPath ? envPath : "todos.db";
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+
+        if (arg == "--json") { args.json = true; continue; }
+        if (arg == "--undo") { args.undo = true; continue; }
+        if (arg == "--open") { args.openOnly = true; continue; }
+        if (arg == "--keep-indexes") { args.keepIndexes = true; continue; }
+        if (arg == "--verify") { args.verify = true; continue; }
+        if (arg == "--profile") { args.profile = true; continue; }
+        if (arg == "--help" || arg == "-h") return false;
+
+        bool takesValue = arg == "--db" || arg == "--desc" || arg == "--category" ||
+                          arg == "--priority" || arg == "--due" || arg == "--limit" ||
+                          arg == "--format" || arg == "--batch" || arg == "--parent" ||
+                          arg == "--by" || arg == "--days";
+        if (!takesValue) {
+            if (arg.size() > 2 && arg.compare(0, 2, "--") == 0) {
+                std::cerr << "todo: unknown option " << arg << std::endl;
+                return false;
+            }
+            args.positional.push_back(arg);
+            continue;
+        }
+
+        if (i + 1 >= argc) {
+            std::cerr << "todo: missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--db") args.dbPath = value;
+        else if (arg == "--desc") args.description = value;
+        else if (arg == "--category") args.category = value;
+        else if (arg == "--priority") args.priority = value;
+        else if (arg == "--due") args.due = value;
+        else if (arg == "--parent") args.parent = value;
+        else if (arg == "--limit") args.limit = std::atoll(value.c_str());
+        else if (arg == "--format") args.format = value;
+        else if (arg == "--by") args.by = value;
+        else if (arg == "--days") args.days = std::atoll(value.c_str());
+        else if (arg == "--batch") args.batch = std::max(1LL, std::atoll(value.c_str()));
+    }
+
+    return !args.positional.empty();
+}
+
+bool parseId(const std::string& text, int& id) {
+    char* end = nullptr;
+    long value = std::strtol(text.c_str(), &end, 10);
+    if (text.empty() || *end != '\0' || value <= 0) return false;
+    id = static_cast<int>(value);
+    return true;
+}
+
+// YYYY-MM-DD at local midnight, like the date picker in the app
+bool parseDate(const std::string& text, time_t& date) {
+    std::tm tm = {};
+    std::istringstream stream(text);
+    stream >> std::get_time(&tm, "%Y-%m-%d");
+    if (stream.fail()) return false;
+    tm.tm_isdst = -1;
+    date = std::mktime(&tm);
+    return date != -1;
+}
+
+std::string formatDate(time_t date) {
+    std::tm tm = *std::localtime(&date);
+    char buffer[16];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d", &tm);
+    return buffer;
+}
+
+void printTodoLine(std::ostream& out, const Todo& todo, bool json) {
+    if (json) {
+        writeTodoJson(out, todo);
+        out << '\n';
+        return;
+    }
+
+    out << std::setw(6) << todo.getId() << "  [" << (todo.isCompleted() ? 'x' : ' ') << "]  P"
+        << todo.getPriority() << "  " << std::left << std::setw(12) << todo.getCategory()
+        << std::right << "  " << (todo.getDueDate() ? formatDate(*todo.getDueDate()) : "          ")
+        << "  " << todo.getTitle() << '\n';
+}
+
+// Visitor shared by list, filter and search: prints as rows arrive
+std::function<bool(const Todo&)> printer(const Arguments& args, long long& printed) {
+    return [&args, &printed](const Todo& todo) {
+        // List order puts completed todos last, so --open can stop at the first one
+        if (args.openOnly && todo.isCompleted()) return false;
+        if (args.limit >= 0 && printed >= args.limit) return false;
+        printTodoLine(std::cout, todo, args.json);
+        printed++;
+        return true;
+    };
+}
+
+int commandAdd(TodoDatabase& db, const Arguments& args) {
+    if (args.positional.size() < 2) return fail("add needs a title");
+
+    Todo todo(args.positional[1], args.description.value_or(""), args.category.value_or("general"));
+
+    if (args.priority) {
+        int priority = std::atoi(args.priority->c_str());
+        if (priority < 1 || priority > 3) return fail("priority must be 1, 2 or 3");
+        todo.setPriority(priority);
+    }
+    if (args.due) {
+        time_t date;
+        if (!parseDate(*args.due, date)) return fail("due date must be YYYY-MM-DD");
+        todo.setDueDate(date);
+    }
+    if (args.parent) {
+        int parentId;
+        if (!parseId(*args.parent, parentId)) return fail("parent must be a todo id");
+        if (!db.getTodoById(parentId)) return fail("no todo with id " + *args.parent);
+        todo.setParentId(parentId);
+    }
+
+    if (!db.createTodo(todo)) return fail("could not create todo");
+
+    if (args.json) {
+        writeTodoJson(std::cout, todo);
+        std::cout << '\n';
+    } else {
+        std::cout << "Created todo " << todo.getId() << '\n';
+    }
+    return 0;
+}
+
+int commandList(TodoDatabase& db, const Arguments& args, const std::optional<std::string>& category) {
+    long long printed = 0;
+    if (!db.forEachTodo(printer(args, printed), category)) return fail("could not read todos");
+    return 0;
+}
+
+int commandSearch(TodoDatabase& db, const Arguments& args) {
+    if (args.positional.size() < 2) return fail("search needs a query");
+
+    long long printed = 0;
+    if (!db.searchTodos(args.positional[1], printer(args, printed))) return fail("search failed");
+    return 0;
+}
+
+// Ids from positional[1] on; false if any is not one
+bool parseIds(const Arguments& args, std::vector<int>& ids) {
+    for (size_t i = 1; i < args.positional.size(); i++) {
+        int id;
+        if (!parseId(args.positional[i], id)) return false;
+        ids.push_back(id);
+    }
+    return !ids.empty();
+}
+
+int commandComplete(TodoDatabase& db, const Arguments& args) {
+    std::vector<int> ids;
+    if (!parseIds(args, ids)) {
+        return fail("complete needs todo ids");
+    }
+
+    if (ids.size() > 1) {
+        TodoBulkChange change;
+        change.completed = !args.undo;
+        int written = db.updateTodos(ids, change);
+        if (written < 0) return fail("could not update todos");
+
+        if (args.json) {
+            std::cout << "{\"updated\":" << written << "}\n";
+        } else {
+            std::cout << (args.undo ? "Reopened " : "Completed ") << written << " todos\n";
+        }
+        return 0;
+    }
+
+    int id = ids.front();
+
+    auto todo = db.getTodoById(id);
+    if (!todo) return fail("no todo with id " + args.positional[1]);
+
+    todo->setCompleted(!args.undo);
+    if (!db.updateTodo(*todo)) return fail("could not update todo");
+
+    if (args.json) {
+        writeTodoJson(std::cout, *todo);
+        std::cout << '\n';
+    } else {
+        std::cout << (args.undo ? "Reopened" : "Completed") << " todo " << id << '\n';
+    }
+    return 0;
+}
+
+int commandDelete(TodoDatabase& db, const Arguments& args) {
+    std::vector<int> ids;
+    if (!parseIds(args, ids)) {
+        return fail("delete needs todo ids");
+    }
+
+    if (ids.size() > 1) {
+        int deleted = db.deleteTodos(ids);
+        if (deleted < 0) return fail("could not delete todos");
+
+        if (args.json) {
+            std::cout << "{\"deleted\":" << deleted << "}\n";
+        } else {
+            std::cout << "Deleted " << deleted << " todos\n";
+        }
+        return 0;
+    }
+
+    int id = ids.front();
+
+    if (!db.getTodoById(id)) return fail("no todo with id " + args.positional[1]);
+    if (!db.deleteTodo(id)) return fail("could not delete todo");
+
+    if (args.json) {
+        std::cout << "{\"deleted\":" << id << "}\n";
+    } else {
+        std::cout << "Deleted todo " << id << '\n';
+    }
+    return 0;
+}
+
+int commandMove(TodoDatabase& db, const Arguments& args) {
+    int id;
+    if (args.positional.size() < 3 || !parseId(args.positional[1], id)) {
+        return fail("move needs a todo id and a parent id, or top");
+    }
+
+    std::optional<int> parentId;
+    if (args.positional[2] != "top") {
+        int value;
+        if (!parseId(args.positional[2], value)) return fail("parent must be a todo id or top");
+        parentId = value;
+    }
+
+    if (!db.getTodoById(id)) return fail("no todo with id " + args.positional[1]);
+    if (!db.moveTodo(id, parentId)) return fail("could not move todo " + args.positional[1]);
+
+    if (args.json) {
+        std::cout << "{\"moved\":" << id << ",\"parent_id\":";
+        if (parentId) std::cout << *parentId;
+        else std::cout << "null";
+        std::cout << "}\n";
+    } else {
+        std::cout << "Moved todo " << id << (parentId ? " under " + args.positional[2] : " to the top level")
+                  << '\n';
+    }
+    return 0;
+}
+
+int commandPlace(TodoDatabase& db, const Arguments& args) {
+    int id;
+    if (args.positional.size() < 3 || !parseId(args.positional[1], id)) {
+        return fail("place needs a todo id and the id to go before, or end");
+    }
+
+    auto todo = db.getTodoById(id);
+    if (!todo) return fail("no todo with id " + args.positional[1]);
+
+    // Goes among the siblings of the todo it is placed before; at the end of
+    // its own siblings otherwise
+    std::optional<int> parentId = todo->getParentId();
+    std::optional<int> beforeId;
+    if (args.positional[2] != "end") {
+        int value;
+        if (!parseId(args.positional[2], value)) return fail("before must be a todo id or end");
+        auto before = db.getTodoById(value);
+        if (!before) return fail("no todo with id " + args.positional[2]);
+        if (value == id) return 0;
+        parentId = before->getParentId();
+        beforeId = value;
+    }
+
+    if (!db.placeTodo(id, parentId, beforeId)) return fail("could not place todo " + args.positional[1]);
+
+    if (args.json) {
+        std::cout << "{\"placed\":" << id << ",\"before\":";
+        if (beforeId) std::cout << *beforeId;
+        else std::cout << "null";
+        std::cout << "}\n";
+    } else {
+        std::cout << "Placed todo " << id << (beforeId ? " before " + args.positional[2] : " last") << '\n';
+    }
+    return 0;
+}
+
+int commandTree(TodoDatabase& db, const Arguments& args) {
+    int id;
+    if (args.positional.size() < 2 || !parseId(args.positional[1], id)) {
+        return fail("tree needs a todo id");
+    }
+
+    auto root = db.getTodoById(id);
+    if (!root) return fail("no todo with id " + args.positional[1]);
+
+    if (!args.json) {
+        TodoSubtreeProgress progress = db.getSubtreeProgress(id);
+        std::cout << root->getTitle() << ": " << progress.completed << " of " << progress.descendants
+                  << " subtasks done\n";
+    }
+
+    long long printed = 0;
+    if (!db.forEachDescendant(id, printer(args, printed))) return fail("could not read subtasks");
+    return 0;
+}
+
+int commandStats(TodoDatabase& db, const Arguments& args) {
+    if (args.verify) {
+        int mismatched = db.verifyStats();
+        if (mismatched < 0) return fail("could not verify the summary tables");
+        if (mismatched > 0) {
+            std::cerr << "todo: " << mismatched << " summary rows were off; recounting" << std::endl;
+            if (!db.rebuildStats()) return fail("could not rebuild the summary tables");
+        }
+
+        mismatched = db.verifyAnalytics();
+        if (mismatched < 0) return fail("could not verify the completion rollup");
+        if (mismatched > 0) {
+            std::cerr << "todo: " << mismatched << " completion rows were off; recounting" << std::endl;
+            if (!db.rebuildAnalytics()) return fail("could not rebuild the completion rollup");
+        }
+    }
+
+    TodoCounts counts = db.getTodoCounts();
+    std::vector<CategoryCount> categories = db.getCategoryCounts();
+
+    if (args.json) {
+        std::cout << "{\"total\":" << counts.total << ",\"completed\":" << counts.completed
+                  << ",\"overdue\":" << counts.overdue << ",\"categories\":[";
+        for (size_t i = 0; i < categories.size(); i++) {
+            if (i > 0) std::cout << ',';
+            std::cout << "{\"name\":";
+            writeJsonString(std::cout, categories[i].name);
+            std::cout << ",\"total\":" << categories[i].total
+                      << ",\"completed\":" << categories[i].completed << '}';
+        }
+        std::cout << "]}\n";
+        return 0;
+    }
+
+    std::cout << counts.total << " items, " << counts.completed << " completed, "
+              << counts.overdue << " overdue\n";
+    for (const auto& category : categories) {
+        std::cout << "  " << std::left << std::setw(20) << category.name << std::right
+                  << std::setw(8) << category.total << std::setw(8) << category.completed
+                  << " done\n";
+    }
+    return 0;
+}
+
+void writeTotalsJson(std::ostream& out, const CompletionTotals& totals) {
+    out << "\"completed\":" << totals.completed << ",\"with_due\":" << totals.withDue
+        << ",\"late\":" << totals.late << ",\"average_lead_days\":" << totals.averageLeadDays();
+}
+
+std::string percent(double rate) {
+    std::ostringstream text;
+    text << std::fixed << std::setprecision(0) << rate * 100 << '%';
+    return text.str();
+}
+
+int commandReport(TodoDatabase& db, const Arguments& args) {
+    AnalyticsBucket bucket = AnalyticsBucket::Day;
+    long long days = 30;
+    if (args.by == "week") {
+        bucket = AnalyticsBucket::Week;
+        days = 12 * 7;
+    } else if (args.by == "month") {
+        bucket = AnalyticsBucket::Month;
+        days = 365;
+    } else if (args.by && *args.by != "day") {
+        return fail("--by takes day, week or month");
+    }
+    if (args.days > 0) days = args.days;
+
+    int64_t lastDay = TodoAnalytics::today();
+    TodoAnalytics analytics(db);
+    std::optional<AnalyticsReport> report = analytics.report(lastDay - days + 1, lastDay, bucket);
+    if (!report) return fail("could not read the completion rollup");
+
+    if (args.json) {
+        std::cout << "{\"from\":\"" << TodoAnalytics::formatDay(report->firstDay)
+                  << "\",\"to\":\"" << TodoAnalytics::formatDay(report->lastDay) << "\",";
+        writeTotalsJson(std::cout, report->total);
+        std::cout << ",\"buckets\":[";
+        for (size_t i = 0; i < report->buckets.size(); i++) {
+            if (i > 0) std::cout << ',';
+            std::cout << "{\"from\":\"" << TodoAnalytics::formatDay(report->buckets[i].firstDay) << "\",";
+            writeTotalsJson(std::cout, report->buckets[i].totals);
+            std::cout << '}';
+        }
+        std::cout << "],\"categories\":[";
+        for (size_t i = 0; i < report->categories.size(); i++) {
+            if (i > 0) std::cout << ',';
+            std::cout << "{\"name\":";
+            writeJsonString(std::cout, report->categories[i].category);
+            std::cout << ',';
+            writeTotalsJson(std::cout, report->categories[i].totals);
+            std::cout << '}';
+        }
+        std::cout << "]}\n";
+        return 0;
+    }
+
+    const CompletionTotals& total = report->total;
+    std::cout << total.completed << " completed from " << TodoAnalytics::formatDay(report->firstDay)
+              << " to " << TodoAnalytics::formatDay(report->lastDay) << ", "
+              << std::fixed << std::setprecision(1) << total.averageLeadDays() << " days on average, "
+              << percent(total.lateRate()) << " of those due finished late\n";
+    for (const auto& entry : report->buckets) {
+        std::cout << "  " << TodoAnalytics::formatDay(entry.firstDay) << std::setw(8)
+                  << entry.totals.completed << '\n';
+    }
+    if (!report->categories.empty()) std::cout << '\n';
+    for (const auto& entry : report->categories) {
+        std::cout << "  " << std::left << std::setw(20) << entry.category << std::right
+                  << std::setw(8) << entry.totals.completed << " done" << std::setw(8)
+                  << std::setprecision(1) << entry.totals.averageLeadDays() << " days"
+                  << std::setw(6) << percent(entry.totals.lateRate()) << " late\n";
+    }
+    return 0;
+}
+
+int commandImport(TodoDatabase& db, const Arguments& args) {
+    if (args.positional.size() < 2) return fail("import needs a file");
+    const std::string& path = args.positional[1];
+
+    ImportOptions options;
+    options.batchSize = args.batch;
+    options.deferIndexes = !args.keepIndexes;
+
+    std::optional<ImportFormat> format = TodoImporter::formatFromPath(path);
+    if (args.format) {
+        if (*args.format == "csv") format = ImportFormat::Csv;
+        else if (*args.format == "jsonl") format = ImportFormat::JsonLines;
+        else return fail("format must be csv or jsonl");
+    }
+    if (!format) return fail("cannot tell the format of " + path + "; pass --format");
+    options.format = *format;
+
+    bool showedProgress = false;
+    options.onProgress = [&showedProgress](const ImportProgress& progress) {
+        showedProgress = true;
+        std::cerr << "\r" << progress.rowsImported << " rows";
+        if (progress.totalBytes > 0) {
+            std::cerr << " (" << progress.bytesRead * 100 / progress.totalBytes << "%)";
+        }
+        std::cerr << std::flush;
+    };
+
+    auto started = std::chrono::steady_clock::now();
+    TodoImporter importer(db);
+    ImportResult result = importer.importFile(path, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (showedProgress) std::cerr << '\n';
+
+    for (const auto& error : result.errors) {
+        std::cerr << "todo: " << path << ": " << error << '\n';
+    }
+
+    if (args.json) {
+        std::cout << "{\"imported\":" << result.rowsImported << ",\"rejected\":" << result.rowsRejected
+                  << ",\"seconds\":" << seconds << ",\"ok\":" << (result.ok ? "true" : "false") << "}\n";
+    } else {
+        std::cout << "Imported " << result.rowsImported << " todos, rejected " << result.rowsRejected
+                  << " (" << static_cast<long long>(seconds > 0 ? result.rowsImported / seconds : 0)
+                  << " rows/s)\n";
+    }
+    return result.ok ? 0 : 1;
+}
+
+int commandExport(TodoDatabase& db, const Arguments& args) {
+    if (args.positional.size() < 2) return fail("export needs a file, or - for stdout");
+    const std::string& path = args.positional[1];
+
+    ExportOptions options;
+    options.category = args.category;
+
+    std::optional<ExportFormat> format = TodoExporter::formatFromPath(path);
+    if (args.format) {
+        if (*args.format == "csv") format = ExportFormat::Csv;
+        else if (*args.format == "jsonl") format = ExportFormat::JsonLines;
+        else if (*args.format == "ics") format = ExportFormat::ICalendar;
+        else return fail("format must be csv, jsonl or ics");
+    }
+    if (!format) return fail("cannot tell the format of " + path + "; pass --format");
+    options.format = *format;
+
+    auto started = std::chrono::steady_clock::now();
+    TodoExporter exporter(db);
+    ExportResult result = exporter.exportToFile(path, options);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (!result.ok) return fail("export to " + path + " failed");
+
+    // Keep stdout clean when it carries the export itself
+    std::ostream& report = path == "-" ? std::cerr : std::cout;
+    if (args.json) {
+        report << "{\"exported\":" << result.rowsExported << ",\"bytes\":" << result.bytesWritten
+               << ",\"seconds\":" << seconds << "}\n";
+    } else {
+        report << "Exported " << result.rowsExported << " todos, " << result.bytesWritten << " bytes ("
+               << static_cast<long long>(seconds > 0 ? result.rowsExported / seconds : 0)
+               << " rows/s)\n";
+    }
+    return 0;
+}
+
+int commandSync(TodoDatabase& db, const Arguments& args) {
+    if (args.positional.size() < 2) return fail("sync needs the other database");
+    const std::string& otherPath = args.positional[1];
+
+    TodoDatabase other(otherPath);
+    if (!other.isOpen() || !other.initialize()) {
+        return fail("could not open " + otherPath);
+    }
+
+    auto started = std::chrono::steady_clock::now();
+    SyncReport report = TodoSync::syncDatabases(db, other);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    if (!report.ok) return fail("sync with " + otherPath + " failed");
+
+    // What the old workflow moved: the whole database file
+    std::error_code error;
+    auto fullCopy = std::filesystem::file_size(args.dbPath, error);
+    if (error) fullCopy = 0;
+
+    if (args.json) {
+        std::cout << "{\"sent\":" << report.sentChanges << ",\"sent_bytes\":" << report.sentBytes
+                  << ",\"received\":" << report.receivedChanges
+                  << ",\"received_bytes\":" << report.receivedBytes
+                  << ",\"applied\":" << report.applied << ",\"conflicts\":" << report.conflicts
+                  << ",\"full_copy_bytes\":" << fullCopy << ",\"seconds\":" << seconds << "}\n";
+        return 0;
+    }
+
+    if (report.deviceIdReset) {
+        std::cout << otherPath << " was a copy of this database; gave it a new device id\n";
+    }
+    std::cout << "Sent " << report.sentChanges << " changes (" << report.sentBytes << " bytes), received "
+              << report.receivedChanges << " (" << report.receivedBytes << " bytes); "
+              << report.applied << " applied, " << report.conflicts << " conflicts\n"
+              << "Full copy of " << args.dbPath << ": " << fullCopy << " bytes\n";
+    return 0;
+}
+
+// SQL on one line, cut to fit a terminal row
+std::string oneLine(const std::string& sql, size_t width) {
+    std::string line;
+    for (char c : sql) {
+        bool space = std::isspace(static_cast<unsigned char>(c));
+        if (space && (line.empty() || line.back() == ' ')) continue;
+        line += space ? ' ' : c;
+    }
+    while (!line.empty() && line.back() == ' ') line.pop_back();
+    if (line.size() > width) line = line.substr(0, width - 3) + "...";
+    return line;
+}
+
+void printProfile(QueryProfiler& profiler) {
+    std::vector<StatementProfile> statements = profiler.statements();
+    std::vector<SlowStatement> slow = profiler.slowStatements();
+
+    std::cerr << std::fixed << std::setprecision(3)
+              << "\n   calls   total ms    p50 ms    p99 ms    max ms       rows    scanned  statement\n";
+    for (const auto& statement : statements) {
+        const LatencyHistogram& latency = statement.latency;
+        std::cerr << std::setw(8) << latency.count << std::setw(11) << latency.totalNs / 1e6
+                  << std::setw(10) << latency.percentileUs(0.50) / 1000
+                  << std::setw(10) << latency.percentileUs(0.99) / 1000
+                  << std::setw(10) << latency.maxNs / 1e6 << std::setw(11) << statement.rowsReturned
+                  << std::setw(11) << statement.fullScanSteps << "  " << oneLine(statement.sql, 100) << '\n';
+
+        std::istringstream plan(statement.queryPlan);
+        std::string line;
+        while (std::getline(plan, line)) {
+            std::cerr << std::string(73, ' ') << "| " << line << '\n';
+        }
+    }
+
+    if (!slow.empty()) {
+        std::cerr << "\nSlower than " << profiler.slowThresholdUs() / 1000.0 << " ms:\n";
+        for (const auto& statement : slow) {
+            std::cerr << std::setw(10) << statement.durationNs / 1e6 << " ms  "
+                      << oneLine(statement.sql, 120) << '\n';
+        }
+    }
+}
+
+int runCommand(TodoDatabase& db, const Arguments& args) {
+    const std::string& command = args.positional[0];
+    if (command == "add") return commandAdd(db, args);
+    if (command == "list") return commandList(db, args, args.category);
+    if (command == "filter") {
+        if (args.positional.size() < 2) return fail("filter needs a category");
+        return commandList(db, args, args.positional[1]);
+    }
+    if (command == "complete") return commandComplete(db, args);
+    if (command == "delete") return commandDelete(db, args);
+    if (command == "move") return commandMove(db, args);
+    if (command == "place") return commandPlace(db, args);
+    if (command == "tree") return commandTree(db, args);
+    if (command == "search") return commandSearch(db, args);
+    if (command == "stats") return commandStats(db, args);
+    if (command == "report") return commandReport(db, args);
+    if (command == "import") return commandImport(db, args);
+    if (command == "export") return commandExport(db, args);
+    if (command == "sync") return commandSync(db, args);
+
+    printUsage();
+    return 2;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    std::ios::sync_with_stdio(false);
+
+    Arguments args;
+    if (!parseArguments(argc, argv, args)) {
+        printUsage();
+        return 2;
+    }
+
+    // Declared before the database so its final dump follows close()
+    std::unique_ptr<Metrics::Dumper> metricsDumper = Metrics::dumperFromEnvironment();
+
+    TodoDatabase db(args.dbPath);
+    if (!db.isOpen() || !db.initialize()) {
+        return fail("could not open " + args.dbPath);
+    }
+
+    // After initialize, so the report covers the command and not the schema checks
+    QueryProfiler* profiler = args.profile ? db.enableProfiling() : nullptr;
+
+    int status;
+    {
+        Trace::Span span("command", "cli");
+        status = runCommand(db, args);
+    }
+
+    if (profiler) {
+        std::cout.flush();
+        printProfile(*profiler);
+    }
+    return status;
+}
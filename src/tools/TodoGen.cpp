@@ -0,0 +1,232 @@
+// Synthetic todos.db generator for benchmarks and tuning. Output is fully
+// determined by the options, the seed and --now (defaults to the current
+// time, which due dates and timestamps are relative to).
+//
+//   todo_gen --rows 1000000 --out todos.db [--categories 50] [--zipf 1.1]
+//            [--desc-median 60] [--desc-max 2000] [--completed 0.3]
+//            [--due 0.6] [--due-past-days 30] [--due-future-days 90]
+//            [--seed 1] [--now <unix time>] [--batch 50000]
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "database/TodoDatabase.h"
+
+namespace {
+
+struct Options {
+    long long rows = 100000;
+    std::string outPath = "todos.db";
+    int categories = 20;
+    double zipf = 1.0;          // 0 is uniform; larger is more skewed
+    int descMedian = 60;        // Characters; lengths are log-normal around it
+    int descMax = 2000;
+    double emptyDescription = 0.3;
+    double completed = 0.3;
+    double due = 0.6;           // Share of todos with a due date
+    int duePastDays = 30;
+    int dueFutureDays = 90;
+    unsigned seed = 1;
+    time_t now = std::time(nullptr);
+    int batch = 50000;
+};
+
+const char* Words[] = {
+    "review", "draft", "call", "email", "fix", "plan", "book", "order", "pay", "clean",
+    "update", "prepare", "send", "check", "renew", "schedule", "buy", "write", "read", "sort",
+    "the", "quarterly", "report", "garage", "invoice", "dentist", "slides", "budget", "car",
+    "garden", "meeting", "notes", "tickets", "groceries", "backup", "taxes", "letter", "plants",
+    "before", "after", "with", "for", "about", "next", "week", "friday", "team", "client"
+};
+const int WordCount = sizeof(Words) / sizeof(Words[0]);
+
+// Category k (0-based) is drawn with weight 1 / (k + 1)^s
+class ZipfDistribution {
+public:
+    ZipfDistribution(int n, double s) {
+        cdf.reserve(n);
+        double sum = 0;
+        for (int k = 1; k <= n; k++) {
+            sum += 1.0 / std::pow(k, s);
+            cdf.push_back(sum);
+        }
+        for (double& value : cdf) value /= sum;
+    }
+
+    int operator()(std::mt19937_64& rng) {
+        double u = std::uniform_real_distribution<double>(0.0, 1.0)(rng);
+        auto it = std::lower_bound(cdf.begin(), cdf.end(), u);
+        return static_cast<int>(std::min<size_t>(it - cdf.begin(), cdf.size() - 1));
+    }
+
+private:
+    std::vector<double> cdf;
+};
+
+class Generator {
+public:
+    explicit Generator(const Options& options)
+        : options(options),
+          rng(options.seed),
+          category(options.categories, options.zipf),
+          descLength(std::log(std::max(1, options.descMedian)), 0.8),
+          word(0, WordCount - 1),
+          unit(0.0, 1.0),
+          now(options.now) {
+        for (int i = 0; i < options.categories; i++) {
+            categoryNames.push_back("category-" + std::to_string(i + 1));
+        }
+    }
+
+    Todo next(long long n) {
+        std::string title = sentence(2 + static_cast<int>(rng() % 5));
+        title += " #" + std::to_string(n);
+
+        std::string description;
+        if (unit(rng) >= options.emptyDescription) {
+            int length = static_cast<int>(descLength(rng));
+            description = text(std::clamp(length, 1, options.descMax));
+        }
+
+        Todo todo(title, description, categoryNames[category(rng)], 1 + static_cast<int>(rng() % 3));
+        todo.setCompleted(unit(rng) < options.completed);
+
+        if (unit(rng) < options.due) {
+            long long span = static_cast<long long>(options.duePastDays) + options.dueFutureDays;
+            long long offsetDays = span > 0 ? static_cast<long long>(rng() % (span + 1)) : 0;
+            todo.setDueDate(now + (offsetDays - options.duePastDays) * 86400);
+        }
+
+        // Spread creation over the past year; set last, setters touch updated_at
+        time_t created = now - static_cast<time_t>(rng() % (365 * 86400));
+        todo.setCreatedAt(created);
+        todo.setUpdatedAt(created + static_cast<time_t>(rng() % (now - created + 1)));
+        return todo;
+    }
+
+private:
+    const Options& options;
+    std::mt19937_64 rng;
+    ZipfDistribution category;
+    std::lognormal_distribution<double> descLength;
+    std::uniform_int_distribution<int> word;
+    std::uniform_real_distribution<double> unit;
+    std::vector<std::string> categoryNames;
+    time_t now;
+
+    std::string sentence(int words) {
+        std::string result;
+        for (int i = 0; i < words; i++) {
+            if (i > 0) result += ' ';
+            result += Words[word(rng)];
+        }
+        if (!result.empty()) result[0] = static_cast<char>(std::toupper(result[0]));
+        return result;
+    }
+
+    std::string text(int length) {
+        std::string result;
+        result.reserve(length + 16);
+        while (static_cast<int>(result.size()) < length) {
+            if (!result.empty()) result += ' ';
+            result += Words[word(rng)];
+        }
+        result.resize(length);
+        return result;
+    }
+};
+
+bool parseOptions(int argc, char* argv[], Options& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Missing value for " << arg << std::endl;
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (arg == "--rows") options.rows = std::atoll(value.c_str());
+        else if (arg == "--out") options.outPath = value;
+        else if (arg == "--categories") options.categories = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--zipf") options.zipf = std::max(0.0, std::atof(value.c_str()));
+        else if (arg == "--desc-median") options.descMedian = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--desc-max") options.descMax = std::max(1, std::atoi(value.c_str()));
+        else if (arg == "--empty-desc") options.emptyDescription = std::atof(value.c_str());
+        else if (arg == "--completed") options.completed = std::atof(value.c_str());
+        else if (arg == "--due") options.due = std::atof(value.c_str());
+        else if (arg == "--due-past-days") options.duePastDays = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--due-future-days") options.dueFutureDays = std::max(0, std::atoi(value.c_str()));
+        else if (arg == "--seed") options.seed = static_cast<unsigned>(std::strtoul(value.c_str(), nullptr, 10));
+        else if (arg == "--now") options.now = static_cast<time_t>(std::atoll(value.c_str()));
+        else if (arg == "--batch") options.batch = std::max(1, std::atoi(value.c_str()));
+        else {
+            std::cerr << "Unknown option " << arg << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    Options options;
+    if (!parseOptions(argc, argv, options)) {
+        std::cerr << "Usage: todo_gen --rows N --out todos.db [--categories 20] [--zipf 1.0]\n"
+                     "                [--desc-median 60] [--desc-max 2000] [--empty-desc 0.3]\n"
+                     "                [--completed 0.3] [--due 0.6] [--due-past-days 30]\n"
+                     "                [--due-future-days 90] [--seed 1] [--now <unix time>]\n"
+                     "                [--batch 50000]" << std::endl;
+        return 1;
+    }
+
+    // Always start from an empty file so the options alone decide the contents
+    std::filesystem::remove(options.outPath);
+
+    TodoDatabase db(options.outPath);
+    if (!db.isOpen() || !db.initialize() || !db.seedIdentities(options.seed, options.now)) {
+        std::cerr << "Could not create " << options.outPath << std::endl;
+        return 1;
+    }
+
+    Generator generator(options);
+    std::vector<Todo> batch;
+    batch.reserve(options.batch);
+
+    // Indexes and summary tables are built once at the end, as for imports
+    auto started = std::chrono::steady_clock::now();
+    if (!db.beginBulkLoad()) {
+        std::cerr << "Could not drop indexes for bulk load" << std::endl;
+        return 1;
+    }
+    for (long long n = 0; n < options.rows;) {
+        batch.clear();
+        for (; n < options.rows && static_cast<int>(batch.size()) < options.batch; n++) {
+            batch.push_back(generator.next(n));
+        }
+        if (!db.createTodos(batch)) {
+            std::cerr << "Insert failed after " << n - static_cast<long long>(batch.size())
+                      << " rows" << std::endl;
+            return 1;
+        }
+        std::cerr << "\r" << n << " / " << options.rows << std::flush;
+    }
+    if (!db.endBulkLoad()) {
+        std::cerr << "Could not rebuild indexes" << std::endl;
+        return 1;
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+
+    std::cerr << "\rWrote " << options.rows << " todos to " << options.outPath << " in "
+              << seconds << " s (" << static_cast<long long>(seconds > 0 ? options.rows / seconds : 0)
+              << " rows/s)" << std::endl;
+    return 0;
+}